@@ -17,6 +17,8 @@ xinu_devcall etherControl (device *devptr, int req, long arg1, long arg2)
     usb_status_t status;
     struct netaddr *addr;
     struct ether *ethptr;
+    struct packet *(*recvpkt)(int);
+    xinu_devcall (*sendpkt)(int, struct packet *);
 
     ethptr = &ethertab[devptr->minor];
     udev = ethptr->csr;
@@ -47,6 +49,19 @@ xinu_devcall etherControl (device *devptr, int req, long arg1, long arg2)
 			ethptr->set_loopback_mode(udev, (unsigned int)arg1);
         break;
 
+    /* Set the number of Rx and Tx transfers, taking effect on the next
+     * open.  */
+    case ETH_CTRL_SET_REQUESTS:
+        if (ethptr->state != ETH_STATE_DOWN ||
+            arg1 < 1 || arg1 > ETH_MAX_REQUESTS ||
+            arg2 < 1 || arg2 > ETH_MAX_REQUESTS)
+        {
+            return SYSERR;
+        }
+        ethptr->rxRequests = arg1;
+        ethptr->txRequests = arg2;
+        break;
+
     /* Get link header length. */
     case NET_GET_LINKHDRLEN:
         return ETH_HDR_LEN;
@@ -70,6 +85,24 @@ xinu_devcall etherControl (device *devptr, int req, long arg1, long arg2)
         memset(addr->addr, 0xFF, ETH_ADDR_LEN);
         break;
 
+    /* Get the function that hands over received frames without copying.
+     * The netif field it fills may be unaligned, so copy bytewise.  */
+    case NET_GET_RECVPKT:
+        recvpkt = etherRecvPacket;
+        memcpy((void *)arg1, &recvpkt, sizeof(recvpkt));
+        break;
+
+    /* Get the function that sends packets, passing on checksums left to
+     * the device.  */
+    case NET_GET_SENDPKT:
+        sendpkt = etherSendPacket;
+        memcpy((void *)arg1, &sendpkt, sizeof(sendpkt));
+        break;
+
+    /* Get the checksums the device does, set when it is opened.  */
+    case NET_GET_OFFLOAD:
+        return ethptr->offload;
+
     default:
         return SYSERR;
     }
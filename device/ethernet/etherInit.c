@@ -87,6 +87,8 @@ xinu_devcall etherInit (device *devptr)
     ethptr->state = ETH_STATE_DOWN;
     ethptr->mtu = ETH_MTU;
     ethptr->addressLength = ETH_ADDR_LEN;
+    ethptr->rxRequests = ETH_RX_REQUESTS;
+    ethptr->txRequests = ETH_TX_REQUESTS;
     ethptr->isema = semcreate(0);
     if (isbadsem(ethptr->isema))
     {
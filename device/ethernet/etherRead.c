@@ -6,6 +6,7 @@
 #include <xinu.h>
 #include <bufpool.h>
 #include <ether.h>
+#include <network.h>
 #include <CriticalSection.h>
 #include <string.h>
 
@@ -13,15 +14,12 @@
 xinu_devcall etherRead(device *devptr, void *buf, unsigned int len)
 {
     struct ether *ethptr;
-    struct ethPktBuffer *pkt;
-
-	ENTER_KERNEL_CRITICAL_SECTION();
+    struct packet *pkt;
 
     /* Make sure device is actually up.  */
     ethptr = &ethertab[devptr->minor];
     if (ethptr->state != ETH_STATE_UP)
     {
-		EXIT_KERNEL_CRITICAL_SECTION();
         return SYSERR;
     }
 
@@ -29,28 +27,26 @@ xinu_devcall etherRead(device *devptr, void *buf, unsigned int len)
      * queue.  */
     wait(ethptr->isema);
 
-    /* Remove the received packet from the circular queue.  */
+    /* Remove the received packet from the circular queue.  The receive
+     * completion takes its buffers with bufget_nowait(), so the slot can be
+     * given back before the buffer is.  */
+    ENTER_KERNEL_CRITICAL_SECTION();
     pkt = ethptr->in[ethptr->istart];
     ethptr->istart = (ethptr->istart + 1) % ETH_IBLEN;
     ethptr->icount--;
-
-    /* TODO: we'd like to restore interrupts here (before the memcpy()), but
-     * this doesn't work yet because smsc9512_rx_complete() expects a buffer to
-     * be available if icount < ETH_IBLEN; therefore, since we decremented
-     * icount, we can't restore interrupts until we actually release the
-     * corresponding buffer.  */
+    EXIT_KERNEL_CRITICAL_SECTION();
 
     /* Copy the data from the packet buffer, being careful to copy at most the
-     * number of bytes requested. */
-    if (pkt->length < len)
+     * number of bytes requested.  Kept for read(); the network stack takes
+     * the packet itself through etherRecvPacket().  */
+    if (pkt->len < len)
     {
-        len = pkt->length;
+        len = pkt->len;
     }
-	memcpy(buf, pkt->buf, len);
+    memcpy(buf, pkt->data, len);
 
     /* Return the packet buffer to the pool, then return the length of the
      * packet received.  */
     buffree(pkt);
-	EXIT_KERNEL_CRITICAL_SECTION();
     return len;
 }
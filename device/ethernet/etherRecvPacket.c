@@ -0,0 +1,36 @@
+/**
+ * @file etherRecvPacket.c
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <device.h>
+#include <ether.h>
+#include <network.h>
+#include <CriticalSection.h>
+
+/* Implementation of etherRecvPacket(), see the documentation for this function in ether.h.  */
+struct packet *etherRecvPacket(int descrp)
+{
+    struct ether *ethptr;
+    struct packet *pkt;
+
+    ethptr = &ethertab[devtab[descrp].minor];
+    if (ethptr->state != ETH_STATE_UP)
+    {
+        return (struct packet *)SYSERR;
+    }
+
+    /* Wait for received packet to be available in the ethptr->in circular
+     * queue.  The semaphore counts queued packets, so once it lets us
+     * through there is one for us.  */
+    wait(ethptr->isema);
+
+	ENTER_KERNEL_CRITICAL_SECTION();
+    pkt = ethptr->in[ethptr->istart];
+    ethptr->istart = (ethptr->istart + 1) % ETH_IBLEN;
+    ethptr->icount--;
+	EXIT_KERNEL_CRITICAL_SECTION();
+
+    return pkt;
+}
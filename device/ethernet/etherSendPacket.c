@@ -0,0 +1,19 @@
+/**
+ * @file etherSendPacket.c
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <device.h>
+#include <ether.h>
+#include <network.h>
+
+/* Implementation of etherSendPacket(), see the documentation for this function in ether.h.  */
+xinu_devcall etherSendPacket(int descrp, struct packet *pkt)
+{
+    device *devptr = (device *)&devtab[descrp];
+    struct ether *ethptr = &ethertab[devptr->minor];
+
+    return (*ethptr->send) (devptr, pkt->curr, pkt->len,
+                            (0 != (pkt->flags & PKT_CSUM_TX)));
+}
@@ -5,6 +5,7 @@
 
 #include <xinu.h>
 #include <ether.h>
+#include <network.h>
 #include <stdio.h>
 
 void etherStat (unsigned short minor)
@@ -31,6 +32,9 @@ void etherStat (unsigned short minor)
         case ETH_STATE_DOWN:
             printf("          DOWN\n");
             break;
+        case ETH_STATE_OPENING:
+            printf("          OPENING\n");
+            break;
     }
 
     printf("  Rx packets in queue   %u\n",   ethptr->icount);
@@ -38,6 +42,13 @@ void etherStat (unsigned short minor)
     printf("  Rx overruns           %u\n",   ethptr->ovrrun);
     printf("  Rx USB transfers done %lu\n",  ethptr->rxirq);
     printf("  Tx USB transfers done %lu\n",  ethptr->txirq);
+    printf("  Tx frames packed      %lu\n",  ethptr->txFrames);
+    printf("  Rx/Tx USB transfers   %u/%u\n", ethptr->rxRequests,
+           ethptr->txRequests);
+    printf("  Checksum offload      %s%s%s\n",
+           (ethptr->offload & NET_CSUM_TX) ? "Tx " : "",
+           (ethptr->offload & NET_CSUM_RX) ? "Rx" : "",
+           (0 == ethptr->offload) ? "none" : "");
 }
 
 void etherThroughput (unsigned short minor)
@@ -0,0 +1,154 @@
+/**
+ * @file etherTxPack.c
+ *
+ * Packing of outgoing frames into USB bulk transfers.  Each frame sent costs
+ * a USB transaction of its own unless several share a transfer, so while one
+ * transfer is on the bus, frames written meanwhile collect in the next one,
+ * each behind its own Tx command words, and go out together when it
+ * completes.  A frame written to an idle device is sent at once.
+ *
+ * Each frame stays in its own buffer from the device's txPool and joins a
+ * transfer as one of its segments (see struct usb_xfer_segment), which the
+ * Host Controller Driver gathers as it programs the channel.
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <CriticalSection.h>
+#include <bufpool.h>
+#include <ether.h>
+#include <usb_core_driver.h>
+
+/* The segment list of a Tx transfer, which follows it in its outPool
+ * buffer.  */
+static struct usb_xfer_segment *etherTxSegs(struct usb_xfer_request *req)
+{
+    return (struct usb_xfer_segment *)(req + 1);
+}
+
+/* Take the Tx transfer being packed, to be submitted once the kernel lock is
+ * released.  Called in a kernel critical section.  */
+static struct usb_xfer_request *etherTxTake(struct ether *ethptr)
+{
+    struct usb_xfer_request *req = ethptr->txFill;
+
+    ethptr->txFill = NULL;
+    ethptr->txActive++;
+    return req;
+}
+
+/* Leave the kernel critical section, then submit the Tx transfer being
+ * packed if the device is idle.  */
+static void etherTxPush(struct ether *ethptr)
+{
+    struct usb_xfer_request *req = NULL;
+
+    if (0 == ethptr->txActive && NULL != ethptr->txFill)
+    {
+        req = etherTxTake(ethptr);
+    }
+    EXIT_KERNEL_CRITICAL_SECTION();
+    if (NULL != req)
+    {
+        usb_submit_xfer_request(req);
+    }
+}
+
+/* Implementation of etherTxGetbuf(); see the documentation for this
+ * function in ether.h.  */
+uint8_t *etherTxGetbuf(struct ether *ethptr)
+{
+    return bufget(ethptr->txPool);
+}
+
+/* Implementation of etherTxSend(); see the documentation for this function
+ * in ether.h.  */
+void etherTxSend(struct ether *ethptr, uint8_t *frame, unsigned int len,
+                 unsigned int bufsize)
+{
+    struct usb_xfer_request *req;
+    struct usb_xfer_request *spare = NULL;
+    struct usb_xfer_segment *segs;
+    unsigned int offset;
+
+    while (TRUE)
+    {
+        ENTER_KERNEL_CRITICAL_SECTION();
+
+        /* Frames start on a word boundary; the device skips the padding,
+         * which comes from the end of the previous frame's buffer.  A
+         * transfer waited for below is used even if another thread has
+         * started one meanwhile, since it cannot be freed in here.  */
+        req = ethptr->txFill;
+        if (NULL != req)
+        {
+            offset = (req->size + 3) & ~3;
+            if (NULL == spare && req->nsegs < ETH_TX_SEGS &&
+                offset + len <= bufsize)
+            {
+                segs = etherTxSegs(req);
+                segs[req->nsegs - 1].len += offset - req->size;
+                segs[req->nsegs].buf = frame;
+                segs[req->nsegs].len = len;
+                req->nsegs++;
+                req->size = offset + len;
+                break;
+            }
+
+            /* Full; submitting it may wait for a host channel, so it is
+             * done outside the critical section before trying again.  */
+            req = etherTxTake(ethptr);
+            EXIT_KERNEL_CRITICAL_SECTION();
+            usb_submit_xfer_request(req);
+            continue;
+        }
+
+        /* Start a new transfer, if one is free.  */
+        if (NULL == spare)
+        {
+            spare = bufget_nowait(ethptr->outPool);
+            if (SYSERR == (int)spare)
+            {
+                spare = NULL;
+            }
+        }
+        if (NULL != spare)
+        {
+            segs = etherTxSegs(spare);
+            segs[0].buf = frame;
+            segs[0].len = len;
+            spare->nsegs = 1;
+            spare->size = len;
+            ethptr->txFill = spare;
+            break;
+        }
+
+        /* Every transfer is in flight.  Wait for one outside the critical
+         * section, since a thread must not block holding the kernel lock.  */
+        EXIT_KERNEL_CRITICAL_SECTION();
+        spare = bufget(ethptr->outPool);
+    }
+    ethptr->txFrames++;
+    etherTxPush(ethptr);
+}
+
+/* Implementation of etherTxComplete(); see the documentation for this
+ * function in ether.h.  */
+void etherTxComplete(struct usb_xfer_request *req)
+{
+    struct ether *ethptr = req->private;
+    unsigned int i;
+
+    ENTER_KERNEL_CRITICAL_SECTION();
+    ethptr->txActive--;
+    etherTxPush(ethptr);
+
+    /* The transfer is no longer shared, so its frames are freed outside the
+     * critical section, where waking a writer may reschedule.  */
+    for (i = 0; i < req->nsegs; i++)
+    {
+        buffree(req->segs[i].buf);
+    }
+    req->nsegs = 0;
+    buffree(req);
+}
@@ -14,6 +14,7 @@ extern const struct usb_device_driver lan78xx_driver;
 /*           Just linux driver terms to functions we have            */
 #define TX_OVERHEAD							(8)
 #define RX_OVERHEAD							(10)
+#define TX_BUFSIZE							(8 * 1024)		// Most data in a Tx transfer
 #define EIO									(5)				// Error IO = 5
 #define EINVAL								(22)			
 
@@ -218,5 +219,7 @@ void lan78xx_rx_complete(struct usb_xfer_request *req);
 
 xinu_devcall lan78xxOpen(device *devptr, va_list ap);
 xinu_devcall lan78xxWrite(device *devptr, const void *buf, unsigned int len);
+xinu_devcall lan78xx_send(device *devptr, const void *buf, unsigned int len,
+                          bool csum);
 
 #endif                          /* _LAN78XX_H_ */
\ No newline at end of file
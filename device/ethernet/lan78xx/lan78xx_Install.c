@@ -30,5 +30,6 @@ xinu_devcall lan78xx_Install (unsigned int DevTabNum, const char* devname, unsig
 	ethertab[ethNum].set_mac_address = lan78xx_set_mac_address;
 	ethertab[ethNum].get_mac_address = lan78xx_get_mac_address;
 	ethertab[ethNum].set_loopback_mode = lan78xx_set_loopback_mode;
+	ethertab[ethNum].send = lan78xx_send;
 	return DevTabNum;
 }
\ No newline at end of file
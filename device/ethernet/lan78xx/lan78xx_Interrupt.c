@@ -2,6 +2,7 @@
 #include <string.h>
 #include <xinu.h>
 #include <ether.h>
+#include <network.h>
 
 #include <usb_util.h>			// needed for usb_status_t
 #include <usb_core_driver.h>	// needed for usb_xfer_request
@@ -15,7 +16,7 @@ void lan78xx_tx_complete (struct usb_xfer_request *req)
 
     ethptr->txirq++;
     usb_dev_debug(req->dev, "LAN78xx: Tx complete\n");
-    buffree(req);
+    etherTxComplete(req);
 }
 
 void lan78xx_rx_complete (struct usb_xfer_request *req)
@@ -28,7 +29,7 @@ void lan78xx_rx_complete (struct usb_xfer_request *req)
         const uint8_t *data, *edata;
         uint32_t frame_length;
 
-		uint32_t rx_cmd_a; // , rx_cmd_b;
+		uint32_t rx_cmd_a, rx_cmd_b;
 		//uint16_t rx_cmd_c;
 
         /* For each Ethernet frame in the received USB data... */
@@ -39,7 +40,7 @@ void lan78xx_rx_complete (struct usb_xfer_request *req)
             /* Get the RxA, RxB, RxC status word, which contains information about the next
              * Ethernet frame.  */
 			rx_cmd_a = data[0] | data[1] << 8 | data[2] << 16 | data[3] << 24;
-			//rx_cmd_b = data[4] | data[5] << 8 | data[6] << 16 | data[7] << 24;
+			rx_cmd_b = data[4] | data[5] << 8 | data[6] << 16 | data[7] << 24;
 			//rx_cmd_c = data[8] | data[9] << 8;
 
 
@@ -72,18 +73,46 @@ void lan78xx_rx_complete (struct usb_xfer_request *req)
             {
                 /* Buffer the received packet.  */
 
-                struct ethPktBuffer *pkt;
+                struct packet *pkt;
 
-                pkt = bufget(ethptr->inPool);
-                pkt->buf = pkt->data = (uint8_t*)(pkt + 1);
-                pkt->length = frame_length - ETH_CRC_LEN;
-				memcpy(pkt->buf, data + RX_OVERHEAD, pkt->length);
+                /* Completion runs in interrupt context, so it cannot wait
+                 * for etherRead() to hand a buffer back.  */
+                pkt = bufget_nowait(ethptr->inPool);
+                if (SYSERR == (int)pkt)
+                {
+                    usb_dev_debug(req->dev, "LAN78XX: No rx buffer, "
+                                  "tallying overrun\n");
+                    ethptr->ovrrun++;
+                    continue;
+                }
+
+                /* Receive straight into a network packet, which the stack
+                 * takes over without copying.  */
+                pkt->nif = NULL;
+                pkt->len = frame_length - ETH_CRC_LEN;
+                pkt->linkhdr = pkt->curr = pkt->data;
+                pkt->nethdr = NULL;
+				memcpy(pkt->data, data + RX_OVERHEAD, pkt->len);
+
+                /* Hand on the device's sum of an IPv4 packet, unless it
+                 * says the sum is missing or covers a VLAN tag.  */
+                pkt->flags = 0;
+                pkt->csum = 0;
+                if ((ethptr->offload & NET_CSUM_RX) &&
+                    !(rx_cmd_a & (RX_CMD_A_ICSM_ | RX_CMD_A_FVTG_)) &&
+                    (ETHER_TYPE_IPv4 >> 8) == pkt->data[12] &&
+                    (ETHER_TYPE_IPv4 & 0xff) == pkt->data[13])
+                {
+                    pkt->csum = net2hs((rx_cmd_b >> RX_CMD_B_CSUM_SHIFT_)
+                                       & 0xffff);
+                    pkt->flags |= PKT_CSUM_COMPLETE;
+                }
                 ethptr->in[(ethptr->istart + ethptr->icount) % ETH_IBLEN] = pkt;
                 ethptr->icount++;
 
                 usb_dev_debug(req->dev, "LAN78XX: Receiving "
                               "packet (length=%u, icount=%u)\n",
-                              pkt->length, ethptr->icount);
+                              pkt->len, ethptr->icount);
 
                 /* This may wake up a thread in etherRead().  */
                 signal(ethptr->isema);
@@ -3,6 +3,7 @@
 #include <xinu.h>
 #include <CriticalSection.h>
 #include <ether.h>
+#include <network.h>
 #include <ether.h>
 #include <bufpool.h>
 #include <clock.h>		// Needed for clkcount for small time delays
@@ -383,7 +384,7 @@ static int lan78xx_reset(struct usb_device *dev, uint8_t* macaddress)
 	ret = lan78xx_write_reg(dev, RFE_CTL, buf);
 
 	/* Enable or disable checksum offload engines */
-	lan78xx_set_features(dev, 0);
+	lan78xx_set_features(dev, NETIF_F_RXCSUM);
 
 	//lan78xx_set_multicast(dev->net);
 	lan78xx_read_reg(dev, RFE_CTL, &buf);
@@ -446,40 +447,51 @@ xinu_devcall lan78xxOpen (device *devptr, va_list ap)
 {
     struct ether *ethptr;
     struct usb_device *udev;
+    struct usb_xfer_request *reqs[ETH_MAX_REQUESTS];
     int retval = SYSERR;
 
-	ENTER_KERNEL_CRITICAL_SECTION();
-
     /* Wait for USB device to actually be attached.  */
     if (lan78xx_wait_device_attached(devptr->minor) != USB_STATUS_SUCCESS)
     {
-        goto out_restore;
+        return SYSERR;
     }
 
-    /* Fail if device is not down.  */
+    /* Fail if device is not down.  Bringing it up takes USB control
+     * transfers, which wait, so the kernel lock is only held to claim it.  */
     ethptr = &ethertab[devptr->minor];
+    ENTER_KERNEL_CRITICAL_SECTION();
     if (ethptr->state != ETH_STATE_DOWN)
     {
-        goto out_restore;
+        EXIT_KERNEL_CRITICAL_SECTION();
+        return SYSERR;
     }
-
-	/* Create buffer pool for Tx transfers.  */
-#define  LAN78XX_MAX_TX_REQUESTS 1
-	ethptr->outPool = bfpalloc(sizeof(struct usb_xfer_request) + ETH_MAX_PKT_LEN +
-		TX_OVERHEAD,
-		LAN78XX_MAX_TX_REQUESTS);
+    ethptr->state = ETH_STATE_OPENING;
+    EXIT_KERNEL_CRITICAL_SECTION();
+
+	/* Create buffer pool for Tx transfers, each followed by its list of
+	 * segments, and one for the frames they carry.  */
+	STATIC_ASSERT(TX_BUFSIZE >= TX_OVERHEAD + ETH_MAX_PKT_LEN);
+	ethptr->outPool = bfpalloc(sizeof(struct usb_xfer_request) +
+		ETH_TX_SEGS * sizeof(struct usb_xfer_segment), ethptr->txRequests);
 	if (ethptr->outPool == SYSERR)
 	{
-		goto out_restore;
+		goto out_set_state;
+	}
+	ethptr->txPool = bfpalloc(TX_OVERHEAD + ETH_MAX_PKT_LEN,
+		ethptr->txRequests * ETH_TX_SEGS);
+	if (ethptr->txPool == SYSERR)
+	{
+		goto out_free_out_pool;
 	}
 
 	/* Create buffer pool for Rx packets (not the actual USB transfers, which
-	 * are allocated separately).  */
-	ethptr->inPool = bfpalloc(sizeof(struct ethPktBuffer) + ETH_MAX_PKT_LEN,
+	 * are allocated separately).  Buffers are laid out as network packets so
+	 * the network stack can take them without copying.  */
+	ethptr->inPool = bfpalloc(sizeof(struct packet) + NET_MAX_PKTLEN,
 		ETH_IBLEN);
 	if (ethptr->inPool == SYSERR)
 	{
-		goto out_free_out_pool;
+		goto out_free_tx_pool;
 	}
 
     /* We're abusing the csr field to store a pointer to the USB device
@@ -510,36 +522,34 @@ xinu_devcall lan78xxOpen (device *devptr, va_list ap)
 	ethptr->devAddress[3] = 0x71;
 	ethptr->devAddress[4] = 0x5A;
 	ethptr->devAddress[5] = 0x97;*/
-	retval = lan78xx_reset(udev, &ethptr->devAddress[0]);
-	if (retval < 0) goto out_free_in_pool;
+	if (lan78xx_reset(udev, &ethptr->devAddress[0]) < 0) goto out_free_in_pool;
 
 	/* Initialize the Tx requests.  */
+	for (int i = 0; i < ethptr->txRequests; i++)
 	{
-		struct usb_xfer_request *reqs[LAN78XX_MAX_TX_REQUESTS];
-		for (int i = 0; i < LAN78XX_MAX_TX_REQUESTS; i++)
-		{
-			struct usb_xfer_request *req;
-
-			req = bufget(ethptr->outPool);
-			usb_init_xfer_request(req);
-			req->dev = udev;
-			/* Assign Tx endpoint, checked in lan78xx_bind_device() */
-			req->endpoint_desc = udev->endpoints[0][1];
-			req->sendbuf = (uint8_t*)req + sizeof(struct usb_xfer_request);
-			req->completion_cb_func = lan78xx_tx_complete;
-			req->private = ethptr;
-			reqs[i] = req;
-		}
-		for (int i = 0; i < LAN78XX_MAX_TX_REQUESTS; i++)
-		{
-			buffree(reqs[i]);
-		}
+		struct usb_xfer_request *req;
+
+		req = bufget(ethptr->outPool);
+		usb_init_xfer_request(req);
+		req->dev = udev;
+		/* Assign Tx endpoint, checked in lan78xx_bind_device() */
+		req->endpoint_desc = udev->endpoints[0][1];
+		req->segs = (struct usb_xfer_segment *)(req + 1);
+		req->completion_cb_func = lan78xx_tx_complete;
+		req->private = ethptr;
+		reqs[i] = req;
+	}
+	for (int i = 0; i < ethptr->txRequests; i++)
+	{
+		buffree(reqs[i]);
 	}
+	ethptr->txFill = NULL;
+	ethptr->txActive = 0;
 
-	/* Allocate and submit the Rx requests.  TODO: these aren't freed anywhere.
-	 * */
-#define LAN78XX_MAX_RX_REQUESTS 1
-	for (int i = 0; i < LAN78XX_MAX_RX_REQUESTS; i++)
+	/* Allocate and submit the Rx requests, so that the device always has
+	 * somewhere to put a burst while earlier ones are being unpacked.  TODO:
+	 * these aren't freed anywhere.  */
+	for (int i = 0; i < ethptr->rxRequests; i++)
 	{
 		struct usb_xfer_request *req;
 
@@ -556,16 +566,20 @@ xinu_devcall lan78xxOpen (device *devptr, va_list ap)
 		usb_submit_xfer_request(req);
 	}
 
-    /* Success!  Set the device to ETH_STATE_UP. */
-    ethptr->state = ETH_STATE_UP;
+    /* Success!  The device is set to ETH_STATE_UP below. */
+    ethptr->offload = NET_CSUM_TX | NET_CSUM_RX;
     retval = OK;
-    goto out_restore;
+    goto out_set_state;
 
 out_free_in_pool:
     bfpfree(ethptr->inPool);
+out_free_tx_pool:
+    bfpfree(ethptr->txPool);
 out_free_out_pool:
     bfpfree(ethptr->outPool);
-out_restore:
-	EXIT_KERNEL_CRITICAL_SECTION();
+out_set_state:
+    ENTER_KERNEL_CRITICAL_SECTION();
+    ethptr->state = (OK == retval) ? ETH_STATE_UP : ETH_STATE_DOWN;
+    EXIT_KERNEL_CRITICAL_SECTION();
     return retval;
 }
@@ -1,18 +1,28 @@
 
 #include <string.h>
 #include <xinu.h>
+#include <CriticalSection.h>
 #include <bufpool.h>
 #include <ether.h>
 #include <interrupt.h>
+#include <network.h>
 
 #include <usb_core_driver.h>
 #include "lan78xx.h"
 
 
 xinu_devcall lan78xxWrite(device *devptr, const void *buf, unsigned int len)
+{
+    return lan78xx_send(devptr, buf, len, FALSE);
+}
+
+/* Send a frame, having the device fill in the TCP or UDP checksum of the
+ * IPv4 packet it carries if csum is set (PKT_CSUM_TX).  The device finds the
+ * headers itself.  */
+xinu_devcall lan78xx_send(device *devptr, const void *buf, unsigned int len,
+                          bool csum)
 {
     struct ether *ethptr;
-    struct usb_xfer_request *req;
     uint8_t *sendbuf;
     uint32_t tx_cmd_a, tx_cmd_b;
 
@@ -24,15 +34,22 @@ xinu_devcall lan78xxWrite(device *devptr, const void *buf, unsigned int len)
     }
 
     /* Get a buffer for the packet.  (This may block.)  */
-    req = bufget(ethptr->outPool);
+    sendbuf = etherTxGetbuf(ethptr);
+    if (SYSERR == (int)sendbuf)
+    {
+        return SYSERR;
+    }
 
     /* Copy the packet's data into the buffer, but also include two words at the
      * beginning that contain device-specific flags.  These two fields are
-     * required, although we essentially just use them to tell the hardware we
-     * are transmitting one (1) packet with no extra bells and whistles.  */
-
-    sendbuf = req->sendbuf;
+     * required, and tell the hardware where this packet ends and the next one
+     * in the same transfer begins; otherwise there are no extra bells and
+     * whistles.  */
     tx_cmd_a = (len & TX_CMD_A_LEN_MASK_) | TX_CMD_A_FCS_;
+    if (csum)
+    {
+        tx_cmd_a |= TX_CMD_A_IPE_ | TX_CMD_A_TPE_;
+    }
     sendbuf[0] = (tx_cmd_a >> 0)  & 0xff;
     sendbuf[1] = (tx_cmd_a >> 8)  & 0xff;
     sendbuf[2] = (tx_cmd_a >> 16) & 0xff;
@@ -43,17 +60,13 @@ xinu_devcall lan78xxWrite(device *devptr, const void *buf, unsigned int len)
     sendbuf[6] = (tx_cmd_b >> 16) & 0xff;
     sendbuf[7] = (tx_cmd_b >> 24) & 0xff;
     STATIC_ASSERT(TX_OVERHEAD == 8);
-	memcpy(sendbuf + TX_OVERHEAD, buf, len);
-
-    /* Set total size of the data to send over the USB.  */
-    req->size = len + TX_OVERHEAD;
+    memcpy(sendbuf + TX_OVERHEAD, buf, len);
 
-    /* Submit the data as an asynchronous bulk USB transfer.  In other words,
-     * this tells the USB subsystem to send begin sending the data over the USB
-     * to the SMSC LAN9512 USB Ethernet Adapter.  At some later time when all
-     * the data has been transferred over the USB, smsc9512_tx_complete() will
-     * be called by the USB subsystem.  */
-    usb_submit_xfer_request(req);
+    /* Submit the buffer as a segment of an asynchronous bulk USB transfer,
+     * unless one is already in flight.  In that case the packet waits to go
+     * out with any others written in the meantime when lan78xx_tx_complete()
+     * is called by the USB subsystem.  */
+    etherTxSend(ethptr, sendbuf, len + TX_OVERHEAD, TX_BUFSIZE);
 
     /* Return the length of the packet written (not including the
      * device-specific fields that were added). */
@@ -33,6 +33,17 @@ extern const struct usb_device_driver smsc9512_driver;
 /** TODO */
 #define SMSC9512_RX_OVERHEAD 4
 
+/** Length of the preamble before a frame whose TCP or UDP checksum the
+ * device fills in, giving where to start summing and where to put the sum */
+#define SMSC9512_TX_CSUM_OVERHEAD 4
+
+/** Longest frame whose checksum the device gets wrong, which is summed in
+ * software instead */
+#define SMSC9512_TX_CSUM_MIN 45
+
+/** Length of the sum following each received frame with Rx_COE_EN */
+#define SMSC9512_RX_CSUM_LEN 2
+
 /** TODO */
 #define SMSC9512_HS_USB_PKT_SIZE 512
 
@@ -42,10 +53,9 @@ extern const struct usb_device_driver smsc9512_driver;
 /** TODO */
 #define SMSC9512_DEFAULT_BULK_IN_DELAY 0x2000
 
-#define SMSC9512_MAX_TX_REQUESTS 1
-/* TODO */
-//#define SMSC9512_MAX_RX_REQUESTS (DIV_ROUND_UP(60 * 1518, SMSC9512_DEFAULT_HS_BURST_CAP_SIZE))
-#define SMSC9512_MAX_RX_REQUESTS 1
+/** Most data in each Tx transfer, which carries as many frames as fit, each
+ * behind its Tx command words.  */
+#define SMSC9512_TX_BUFSIZE (8 * 1024)
 
 
 usb_status_t smsc9512_write_reg (struct usb_device *udev, uint32_t index, uint32_t data);
@@ -610,6 +620,8 @@ __smsc9512_dump_reg(struct usb_device *udev, uint32_t index, const char *name)
 
 xinu_devcall smsc9512Open(device *devptr, va_list ap);
 xinu_devcall smsc9512Write(device *devptr, const void *buf, unsigned int len);
+xinu_devcall smsc9512_send(device *devptr, const void *buf, unsigned int len,
+                           bool csum);
 
 usb_status_t smsc9512_set_mac_address (struct usb_device *udev, const uint8_t *macaddr);
 usb_status_t smsc9512_get_mac_address (struct usb_device *udev, uint8_t *macaddr);
@@ -17,6 +17,7 @@
 #include <string.h>
 #include <xinu.h>
 #include <ether.h>
+#include <network.h>
 #include <usb_util.h>			// needed for usb_status_t
 #include <usb_core_driver.h>	// needed for usb_xfer_request
 #include <bufpool.h>
@@ -30,7 +31,8 @@
  * Adapter for the purpose of sending an Ethernet packet has successfully
  * completed or has failed.
  *
- * Currently all this function has to do is return the buffer to its pool.  This
+ * Currently all this function has to do is return the buffer to its pool and
+ * send the packets that were written while the transfer was in flight.  This
  * may wake up a thread in etherWrite() that is waiting for a free buffer.
  *
  * @param req
@@ -42,7 +44,7 @@ void smsc9512_tx_complete (struct usb_xfer_request *req)
 
     ethptr->txirq++;
     usb_dev_debug(req->dev, "SMSC9512: Tx complete\n");
-    buffree(req);
+    etherTxComplete(req);
 }
 
 /**
@@ -72,10 +74,18 @@ void smsc9512_rx_complete(struct usb_xfer_request *req)
         const uint8_t *data, *edata;
         uint32_t recv_status;
         uint32_t frame_length;
+        uint32_t trailer;
+
+        /* With Rx checksum offload, each frame is followed by its sum.  */
+        trailer = ETH_CRC_LEN;
+        if (ethptr->offload & NET_CSUM_RX)
+        {
+            trailer += SMSC9512_RX_CSUM_LEN;
+        }
 
         /* For each Ethernet frame in the received USB data... */
         for (data = req->recvbuf, edata = req->recvbuf + req->actual_size;
-             data + SMSC9512_RX_OVERHEAD + ETH_HDR_LEN + ETH_CRC_LEN <= edata;
+             data + SMSC9512_RX_OVERHEAD + ETH_HDR_LEN + trailer <= edata;
              data += SMSC9512_RX_OVERHEAD + ((frame_length + 3) & ~3))
         {
             /* Get the Rx status word, which contains information about the next
@@ -84,14 +94,15 @@ void smsc9512_rx_complete(struct usb_xfer_request *req)
 
             /* Extract frame_length, which specifies the length of the next
              * Ethernet frame from the MAC destination address to end of the CRC
-             * following the payload.  (This does not include the Rx status
-             * word, which we instead account for in SMSC9512_RX_OVERHEAD.) */
+             * following the payload, and of the sum after it.  (This does not
+             * include the Rx status word, which we instead account for in
+             * SMSC9512_RX_OVERHEAD.) */
             frame_length = (recv_status & RX_STS_FL) >> 16;
 
             if ((recv_status & RX_STS_ES) ||
                 (frame_length + SMSC9512_RX_OVERHEAD > edata - data) ||
-                (frame_length > ETH_MAX_PKT_LEN + ETH_CRC_LEN) ||
-                (frame_length < ETH_HDR_LEN + ETH_CRC_LEN))
+                (frame_length > ETH_MAX_PKT_LEN + trailer) ||
+                (frame_length < ETH_HDR_LEN + trailer))
             {
                 /* The Ethernet adapter set the error flag to indicate a problem
                  * or the Ethernet frame size it provided was invalid. */
@@ -110,18 +121,47 @@ void smsc9512_rx_complete(struct usb_xfer_request *req)
             {
                 /* Buffer the received packet.  */
 
-                struct ethPktBuffer *pkt;
+                struct packet *pkt;
+
+                /* Completion runs in interrupt context, so it cannot wait
+                 * for etherRead() to hand a buffer back.  */
+                pkt = bufget_nowait(ethptr->inPool);
+                if (SYSERR == (int)pkt)
+                {
+                    usb_dev_debug(req->dev, "SMSC9512: No rx buffer, "
+                                  "tallying overrun\n");
+                    ethptr->ovrrun++;
+                    continue;
+                }
+
+                /* Copy the frame into a network packet, which the stack
+                 * takes over; etherRecvPacket() hands it on without a second
+                 * copy.  */
+                pkt->nif = NULL;
+                pkt->len = frame_length - trailer;
+                pkt->linkhdr = pkt->curr = pkt->data;
+                pkt->nethdr = NULL;
+                memcpy(pkt->data, data + SMSC9512_RX_OVERHEAD, pkt->len);
 
-                pkt = bufget(ethptr->inPool);
-                pkt->buf = pkt->data = (uint8_t*)(pkt + 1);
-                pkt->length = frame_length - ETH_CRC_LEN;
-				memcpy(pkt->buf, data + SMSC9512_RX_OVERHEAD, pkt->length);
+                /* The device sums every frame; only the sum of an IPv4
+                 * packet is any use to the stack.  */
+                pkt->flags = 0;
+                pkt->csum = 0;
+                if ((ethptr->offload & NET_CSUM_RX) &&
+                    (ETHER_TYPE_IPv4 >> 8) == pkt->data[12] &&
+                    (ETHER_TYPE_IPv4 & 0xff) == pkt->data[13])
+                {
+                    memcpy(&pkt->csum, data + SMSC9512_RX_OVERHEAD +
+                           frame_length - SMSC9512_RX_CSUM_LEN,
+                           SMSC9512_RX_CSUM_LEN);
+                    pkt->flags |= PKT_CSUM_COMPLETE;
+                }
                 ethptr->in[(ethptr->istart + ethptr->icount) % ETH_IBLEN] = pkt;
                 ethptr->icount++;
 
                 usb_dev_debug(req->dev, "SMSC9512: Receiving "
                               "packet (length=%u, icount=%u)\n",
-                              pkt->length, ethptr->icount);
+                              pkt->len, ethptr->icount);
 
                 /* This may wake up a thread in etherRead().  */
                 signal(ethptr->isema);
@@ -10,6 +10,7 @@
 #include <CriticalSection.h>
 #include <bufpool.h>
 #include <ether.h>
+#include <network.h>
 #include <stdlib.h>
 #include <string.h>
 #include <usb_core_driver.h>
@@ -30,40 +31,55 @@ xinu_devcall smsc9512Open(device *devptr, va_list ap)
 {
     struct ether *ethptr;
     struct usb_device *udev;
+    struct usb_xfer_request *reqs[ETH_MAX_REQUESTS];
     unsigned int i;
     int retval = SYSERR;
 
-	ENTER_KERNEL_CRITICAL_SECTION();
-
     /* Wait for USB device to actually be attached.  */
     if (smsc9512_wait_device_attached(devptr->minor) != USB_STATUS_SUCCESS)
     {
-        goto out_restore;
+        return SYSERR;
     }
 
-    /* Fail if device is not down.  */
+    /* Fail if device is not down.  Bringing it up takes USB control
+     * transfers, which wait, so the kernel lock is only held to claim it.  */
     ethptr = &ethertab[devptr->minor];
+    ENTER_KERNEL_CRITICAL_SECTION();
     if (ethptr->state != ETH_STATE_DOWN)
     {
-        goto out_restore;
+        EXIT_KERNEL_CRITICAL_SECTION();
+        return SYSERR;
     }
+    ethptr->state = ETH_STATE_OPENING;
+    EXIT_KERNEL_CRITICAL_SECTION();
 
-    /* Create buffer pool for Tx transfers.  */
-    ethptr->outPool = bfpalloc(sizeof(struct usb_xfer_request) + ETH_MAX_PKT_LEN +
-                                   SMSC9512_TX_OVERHEAD,
-                               SMSC9512_MAX_TX_REQUESTS);
+    /* Create buffer pool for Tx transfers, each followed by its list of
+     * segments, and one for the frames they carry.  */
+    STATIC_ASSERT(SMSC9512_TX_BUFSIZE >= SMSC9512_TX_OVERHEAD +
+                  SMSC9512_TX_CSUM_OVERHEAD + ETH_MAX_PKT_LEN);
+    ethptr->outPool = bfpalloc(sizeof(struct usb_xfer_request) +
+                                   ETH_TX_SEGS * sizeof(struct usb_xfer_segment),
+                               ethptr->txRequests);
     if (ethptr->outPool == SYSERR)
     {
-        goto out_restore;
+        goto out_set_state;
+    }
+    ethptr->txPool = bfpalloc(SMSC9512_TX_OVERHEAD + SMSC9512_TX_CSUM_OVERHEAD +
+                                  ETH_MAX_PKT_LEN,
+                              ethptr->txRequests * ETH_TX_SEGS);
+    if (ethptr->txPool == SYSERR)
+    {
+        goto out_free_out_pool;
     }
 
     /* Create buffer pool for Rx packets (not the actual USB transfers, which
-     * are allocated separately).  */
-    ethptr->inPool = bfpalloc(sizeof(struct ethPktBuffer) + ETH_MAX_PKT_LEN,
+     * are allocated separately).  Buffers are laid out as network packets so
+     * the network stack can take them without copying.  */
+    ethptr->inPool = bfpalloc(sizeof(struct packet) + NET_MAX_PKTLEN,
                               ETH_IBLEN);
     if (ethptr->inPool == SYSERR)
     {
-        goto out_free_out_pool;
+        goto out_free_tx_pool;
     }
 
     /* We're abusing the csr field to store a pointer to the USB device
@@ -78,32 +94,31 @@ xinu_devcall smsc9512Open(device *devptr, va_list ap)
     }
 
     /* Initialize the Tx requests.  */
-	for (i = 0; i < SMSC9512_MAX_TX_REQUESTS; i++)
-	{	
-		struct usb_xfer_request *reqs[SMSC9512_MAX_TX_REQUESTS];
-		for (i = 0; i < SMSC9512_MAX_TX_REQUESTS; i++)
-		{
-			struct usb_xfer_request *req;
+    for (i = 0; i < ethptr->txRequests; i++)
+    {
+        struct usb_xfer_request *req;
 
-			req = bufget(ethptr->outPool);
-			usb_init_xfer_request(req);
-			req->dev = udev;
-			/* Assign Tx endpoint, checked in smsc9512_bind_device() */
-			req->endpoint_desc = udev->endpoints[0][1];
-			req->sendbuf = (uint8_t*)req + sizeof(struct usb_xfer_request);
-			req->completion_cb_func = smsc9512_tx_complete;
-			req->private = ethptr;
-			reqs[i] = req;
-		}
-		for (i = 0; i < SMSC9512_MAX_TX_REQUESTS; i++)
-		{
-			buffree(reqs[i]);
-		}	
-	}
+        req = bufget(ethptr->outPool);
+        usb_init_xfer_request(req);
+        req->dev = udev;
+        /* Assign Tx endpoint, checked in smsc9512_bind_device() */
+        req->endpoint_desc = udev->endpoints[0][1];
+        req->segs = (struct usb_xfer_segment *)(req + 1);
+        req->completion_cb_func = smsc9512_tx_complete;
+        req->private = ethptr;
+        reqs[i] = req;
+    }
+    for (i = 0; i < ethptr->txRequests; i++)
+    {
+        buffree(reqs[i]);
+    }
+    ethptr->txFill = NULL;
+    ethptr->txActive = 0;
 
-    /* Allocate and submit the Rx requests.  TODO: these aren't freed anywhere.
-     * */
-    for (i = 0; i < SMSC9512_MAX_RX_REQUESTS; i++)
+    /* Allocate and submit the Rx requests, so that the device always has
+     * somewhere to put a burst while earlier ones are being unpacked.  TODO:
+     * these aren't freed anywhere.  */
+    for (i = 0; i < ethptr->rxRequests; i++)
     {
         struct usb_xfer_request *req;
         
@@ -120,10 +135,13 @@ xinu_devcall smsc9512Open(device *devptr, va_list ap)
         usb_submit_xfer_request(req);
     }
 
-    /* Enable transmit and receive on the actual hardware.  After doing this and
-     * restoring interrupts, the Rx transfers can complete at any time due to
-     * incoming packets.  */
+    /* Enable transmit and receive on the actual hardware, with TCP and UDP
+     * checksum offload.  Received frames are then followed by the sum of
+     * everything after the Ethernet header.  After doing this and restoring
+     * interrupts, the Rx transfers can complete at any time due to incoming
+     * packets.  */
     udev->last_error = USB_STATUS_SUCCESS;
+    smsc9512_set_reg_bits(udev, COE_CR, Tx_COE_EN | Rx_COE_EN);
     smsc9512_set_reg_bits(udev, MAC_CR, MAC_CR_TXEN | MAC_CR_RXEN);
     smsc9512_write_reg(udev, TX_CFG, TX_CFG_ON);
     if (udev->last_error != USB_STATUS_SUCCESS)
@@ -131,16 +149,20 @@ xinu_devcall smsc9512Open(device *devptr, va_list ap)
         goto out_free_in_pool;
     }
 
-    /* Success!  Set the device to ETH_STATE_UP. */
-    ethptr->state = ETH_STATE_UP;
+    /* Success!  The device is set to ETH_STATE_UP below. */
+    ethptr->offload = NET_CSUM_TX | NET_CSUM_RX;
     retval = OK;
-    goto out_restore;
+    goto out_set_state;
 
 out_free_in_pool:
     bfpfree(ethptr->inPool);
+out_free_tx_pool:
+    bfpfree(ethptr->txPool);
 out_free_out_pool:
     bfpfree(ethptr->outPool);
-out_restore:
-	EXIT_KERNEL_CRITICAL_SECTION();
+out_set_state:
+    ENTER_KERNEL_CRITICAL_SECTION();
+    ethptr->state = (OK == retval) ? ETH_STATE_UP : ETH_STATE_DOWN;
+    EXIT_KERNEL_CRITICAL_SECTION();
     return retval;
 }
@@ -4,20 +4,53 @@
 /* Embedded Xinu, Copyright (C) 2013, 2018.  All rights reserved. */
 
 #include <xinu.h>
+#include <CriticalSection.h>
 #include <bufpool.h>
 #include <ether.h>
+#include <ipv4.h>
+#include <network.h>
+#include <stddef.h>
 #include <string.h>
+#include <tcp.h>
+#include <udp.h>
 #include <usb_core_driver.h>
 #include "smsc9512.h"
 
 /* Implementation of etherWrite() for the SMSC LAN9512; see the documentation
  * for this function in ether.h.  */
 xinu_devcall smsc9512Write(device *devptr, const void *buf, unsigned int len)
+{
+    return smsc9512_send(devptr, buf, len, FALSE);
+}
+
+/**
+ * @ingroup etherspecific
+ *
+ * Send an Ethernet frame, having the device fill in the TCP or UDP checksum
+ * of the IPv4 packet it carries if @p csum is set.  The checksum field must
+ * then hold the pseudo header sum (::PKT_CSUM_TX).
+ *
+ * @param devptr
+ *      Pointer to the entry in Xinu's device table for the Ethernet device.
+ * @param buf
+ *      Ethernet frame to send.
+ * @param len
+ *      Length, in bytes, of the Ethernet frame to send.
+ * @param csum
+ *      Whether the device is to fill in the transport checksum.
+ *
+ * @return
+ *      As etherWrite().
+ */
+xinu_devcall smsc9512_send(device *devptr, const void *buf, unsigned int len,
+                           bool csum)
 {
     struct ether *ethptr;
-    struct usb_xfer_request *req;
-    uint8_t *sendbuf;
-    uint32_t tx_cmd_a, tx_cmd_b;
+    const struct ipv4Pkt *ip;
+    uint8_t *sendbuf, *frame;
+    uint32_t tx_cmd_a, tx_cmd_b, preamble;
+    unsigned int overhead, start, field;
+    uint16_t sum;
 
     ethptr = &ethertab[devptr->minor];
     if (ethptr->state != ETH_STATE_UP ||
@@ -26,36 +59,76 @@ xinu_devcall smsc9512Write(device *devptr, const void *buf, unsigned int len)
         return SYSERR;
     }
 
+    /* Find where the device is to start summing and put the sum, counting
+     * from the start of the frame.  */
+    overhead = SMSC9512_TX_OVERHEAD;
+    start = field = 0;
+    if (csum)
+    {
+        ip = (const struct ipv4Pkt *)((const uint8_t *)buf + ETH_HDR_LEN);
+        start = ETH_HDR_LEN + (ip->ver_ihl & IPv4_IHL) * 4;
+        field = start + ((IPv4_PROTO_TCP == ip->proto) ?
+                         offsetof(struct tcpPkt, chksum) :
+                         offsetof(struct udpPkt, chksum));
+        if (len > SMSC9512_TX_CSUM_MIN)
+        {
+            overhead += SMSC9512_TX_CSUM_OVERHEAD;
+        }
+    }
+
     /* Get a buffer for the packet.  (This may block.)  */
-    req = bufget(ethptr->outPool);
+    sendbuf = etherTxGetbuf(ethptr);
+    if (SYSERR == (int)sendbuf)
+    {
+        return SYSERR;
+    }
 
     /* Copy the packet's data into the buffer, but also include two words at the
      * beginning that contain device-specific flags.  These two fields are
-     * required, although we essentially just use them to tell the hardware we
-     * are transmitting one (1) packet with no extra bells and whistles.  */
-    sendbuf = req->sendbuf;
-    tx_cmd_a = len | TX_CMD_A_FIRST_SEG | TX_CMD_A_LAST_SEG;
+     * required, and tell the hardware where this packet ends and the next one
+     * in the same transfer begins; otherwise there are no extra bells and
+     * whistles.  */
+    tx_cmd_a = (len + overhead - SMSC9512_TX_OVERHEAD) |
+               TX_CMD_A_FIRST_SEG | TX_CMD_A_LAST_SEG;
     sendbuf[0] = (tx_cmd_a >> 0)  & 0xff;
     sendbuf[1] = (tx_cmd_a >> 8)  & 0xff;
     sendbuf[2] = (tx_cmd_a >> 16) & 0xff;
     sendbuf[3] = (tx_cmd_a >> 24) & 0xff;
-    tx_cmd_b = len;
+    tx_cmd_b = len + overhead - SMSC9512_TX_OVERHEAD;
+    if (overhead != SMSC9512_TX_OVERHEAD)
+    {
+        tx_cmd_b |= TX_CMD_B_CSUM_ENABLE;
+    }
     sendbuf[4] = (tx_cmd_b >> 0)  & 0xff;
     sendbuf[5] = (tx_cmd_b >> 8)  & 0xff;
     sendbuf[6] = (tx_cmd_b >> 16) & 0xff;
     sendbuf[7] = (tx_cmd_b >> 24) & 0xff;
     STATIC_ASSERT(SMSC9512_TX_OVERHEAD == 8);
-	memcpy(sendbuf + SMSC9512_TX_OVERHEAD, buf, len);
 
-    /* Set total size of the data to send over the USB.  */
-    req->size = len + SMSC9512_TX_OVERHEAD;
+    /* With checksum offload, the frame also follows a preamble giving the
+     * offsets of the start of the sum and of the checksum field.  The device
+     * gets the sum of the shortest frames wrong, so those are summed here.  */
+    frame = sendbuf + overhead;
+    if (overhead != SMSC9512_TX_OVERHEAD)
+    {
+        preamble = (field << 16) | start;
+        sendbuf[8]  = (preamble >> 0)  & 0xff;
+        sendbuf[9]  = (preamble >> 8)  & 0xff;
+        sendbuf[10] = (preamble >> 16) & 0xff;
+        sendbuf[11] = (preamble >> 24) & 0xff;
+    }
+    memcpy(frame, buf, len);
+    if (csum && overhead == SMSC9512_TX_OVERHEAD)
+    {
+        sum = netChksum(frame + start, len - start);
+        memcpy(frame + field, &sum, sizeof(sum));
+    }
 
-    /* Submit the data as an asynchronous bulk USB transfer.  In other words,
-     * this tells the USB subsystem to send begin sending the data over the USB
-     * to the SMSC LAN9512 USB Ethernet Adapter.  At some later time when all
-     * the data has been transferred over the USB, smsc9512_tx_complete() will
-     * be called by the USB subsystem.  */
-    usb_submit_xfer_request(req);
+    /* Submit the buffer as a segment of an asynchronous bulk USB transfer,
+     * unless one is already in flight.  In that case the packet waits to go
+     * out with any others written in the meantime when
+     * smsc9512_tx_complete() is called by the USB subsystem.  */
+    etherTxSend(ethptr, sendbuf, len + overhead, SMSC9512_TX_BUFSIZE);
 
     /* Return the length of the packet written (not including the
      * device-specific fields that were added). */
@@ -34,5 +34,6 @@ xinu_devcall smsc9512_Install (unsigned int DevTabNum, const char* devname, unsi
 	ethertab[ethNum].set_mac_address = smsc9512_set_mac_address;
 	ethertab[ethNum].get_mac_address = smsc9512_get_mac_address;
 	ethertab[ethNum].set_loopback_mode = smsc9512_set_loopback_mode;
+	ethertab[ethNum].send = smsc9512_send;
 	return DevTabNum;
 }
\ No newline at end of file
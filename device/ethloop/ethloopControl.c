@@ -97,8 +97,10 @@ xinu_devcall ethloopControl(device *devptr, int func, long arg1, long arg2)
 /* Get next packet off hold queue */
     case ELOOP_CTRL_GETHOLD:
         buf = (char *)arg1;
-        /* Wait for held packet */
+        /* Wait for held packet, without the kernel lock */
+        EXIT_KERNEL_CRITICAL_SECTION();
         wait(elpptr->hsem);
+        ENTER_KERNEL_CRITICAL_SECTION();
         /* Get and clear held packet */
         hold = elpptr->hold;
         holdlen = elpptr->holdlen;
@@ -44,8 +44,10 @@ xinu_devcall ethloopRead (device *devptr, void *buf, unsigned int len)
         return SYSERR;
     }
 
-    /* wait until the buffer has a packet */
+    /* wait until the buffer has a packet, without the kernel lock */
+    EXIT_KERNEL_CRITICAL_SECTION();
     wait(elpptr->sem);
+    ENTER_KERNEL_CRITICAL_SECTION();
 
     pkt = elpptr->buffer[elpptr->index];
     pktlen = elpptr->pktlen[elpptr->index];
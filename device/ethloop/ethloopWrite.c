@@ -43,12 +43,25 @@ xinu_devcall ethloopWrite (device *devptr, const void *buf, unsigned int len)
         return SYSERR;
     }
 
+    /* Allocate buffer space.  This is blocking, so it can only fail if the pool
+     * ID was corrupted; it is done before taking the kernel lock, which is
+     * not held across a wait.  */
+    pkt = (char *)bufget(elpptr->poolid);
+    if (SYSERR == (int)pkt)
+    {
+        return SYSERR;
+    }
+
+    /* Copy supplied buffer into allocated buffer */
+    memcpy(pkt, buf, len);
+
 	ENTER_KERNEL_CRITICAL_SECTION();
 
     /* Make sure the ethloop is actually open  */
     if (ELOOP_STATE_ALLOC != elpptr->state)
     {
 		EXIT_KERNEL_CRITICAL_SECTION();
+        buffree(pkt);
         return SYSERR;
     }
 
@@ -57,32 +70,23 @@ xinu_devcall ethloopWrite (device *devptr, const void *buf, unsigned int len)
     {
         elpptr->flags &= ~ELOOP_FLAG_DROPNXT;
 		EXIT_KERNEL_CRITICAL_SECTION();
+        buffree(pkt);
         return len;
     }
 
-    /* Allocate buffer space.  This is blocking, so it can only fail if the pool
-     * ID was corrupted.  */
-    pkt = (char *)bufget(elpptr->poolid);
-    if (SYSERR == (int)pkt)
-    {
-		EXIT_KERNEL_CRITICAL_SECTION();
-        return SYSERR;
-    }
-
-    /* Copy supplied buffer into allocated buffer */
-	memcpy(pkt, buf, len);
-
     /* Hold next packet if the appropriate flag is set */
     if (elpptr->flags & ELOOP_FLAG_HOLDNXT)
     {
+        char *old = elpptr->hold;
+
         elpptr->flags &= ~ELOOP_FLAG_HOLDNXT;
-        if (elpptr->hold != NULL)
-        {
-            buffree(elpptr->hold);
-        }
         elpptr->hold = pkt;
         elpptr->holdlen = len;
 		EXIT_KERNEL_CRITICAL_SECTION();
+        if (old != NULL)
+        {
+            buffree(old);
+        }
         signal(elpptr->hsem);
         return len;
     }
@@ -90,8 +94,8 @@ xinu_devcall ethloopWrite (device *devptr, const void *buf, unsigned int len)
     /* Ensure there is enough buffer space (there always should be)  */
     if (elpptr->count >= ELOOP_NBUF)
     {
-        buffree(pkt);
 		EXIT_KERNEL_CRITICAL_SECTION();
+        buffree(pkt);
         return SYSERR;
     }
 
@@ -7,7 +7,7 @@
 #include <conf.h>
 #include <stddef.h>
 
-#include <interrupt.h>
+#include <CriticalSection.h>
 #include <http.h>
 
 /**
@@ -16,20 +16,19 @@
  */
 int httpAlloc(void)
 {
-    irqmask ps;
     int i;
 
-    ps = disable();
+    ENTER_KERNEL_CRITICAL_SECTION();
     for (i = 0; i < NHTTP; ++i)
     {
         if (HTTP_STATE_FREE == httptab[i].state)
         {
             httptab[i].state = HTTP_STATE_ALLOC;
-            restore(ps);
+            EXIT_KERNEL_CRITICAL_SECTION();
             return i + HTTP0;
         }
     }
-    restore(ps);
+    EXIT_KERNEL_CRITICAL_SECTION();
 
     return SYSERR;
 }
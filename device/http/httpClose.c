@@ -8,7 +8,7 @@
 #include <stdlib.h>
 
 #include <http.h>
-#include <interrupt.h>
+#include <CriticalSection.h>
 #include <semaphore.h>
 
 /**
@@ -18,19 +18,17 @@
  */
 devcall httpClose(device *devptr)
 {
-    irqmask im;
     struct http *webptr;
 
     /* Verify that device is open */
-    im = disable();
+    ENTER_KERNEL_CRITICAL_SECTION();
     webptr = &httptab[devptr->minor];
     if (HTTP_STATE_ALLOC != webptr->state)
     {
-        restore(im);
+        EXIT_KERNEL_CRITICAL_SECTION();
         return SYSERR;
     }
 
-    httpFree(devptr);
     semfree(webptr->closeall);
 
     /* Free memory associated with device malloc calls if necessary */
@@ -65,6 +63,10 @@ devcall httpClose(device *devptr)
 
     bzero(webptr, sizeof(struct http)); /* Clear HTTP structure.    */
     webptr->state = HTTP_STATE_FREE;
-    restore(im);
+    EXIT_KERNEL_CRITICAL_SECTION();
+
+    /* Signal the counter for HTTP threads, as httpFree() does, but outside
+     * the kernel lock since it may reschedule */
+    signal(maxhttp);
     return OK;
 }
@@ -6,7 +6,7 @@
 
 #include <stddef.h>
 #include <http.h>
-#include <interrupt.h>
+#include <CriticalSection.h>
 #include <semaphore.h>
 
 /**
@@ -16,11 +16,10 @@
  */
 int httpFree(device *devptr)
 {
-    irqmask im;
 
-    im = disable();
+    ENTER_KERNEL_CRITICAL_SECTION();
     httptab[devptr->minor].state = HTTP_STATE_FREE;
-    restore(im);
+    EXIT_KERNEL_CRITICAL_SECTION();
 
     /* Signal the counter for HTTP threads */
     signal(maxhttp);
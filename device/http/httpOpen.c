@@ -9,7 +9,7 @@
 #include <stdlib.h>
 
 #include <http.h>
-#include <interrupt.h>
+#include <CriticalSection.h>
 #include <semaphore.h>
 
 /**
@@ -20,7 +20,6 @@
  */
 devcall httpOpen(device *devptr, va_list ap)
 {
-    irqmask im;
     struct http *webptr = NULL;
     int dvnum = 0;
 
@@ -33,12 +32,12 @@ devcall httpOpen(device *devptr, va_list ap)
 
     /* Setup pointer to http */
     webptr = &httptab[devptr->minor];
-    im = disable();
+    ENTER_KERNEL_CRITICAL_SECTION();
 
     /* Check if HTTP is already open */
     if (HTTP_STATE_FREE != webptr->state)
     {
-        restore(im);
+        EXIT_KERNEL_CRITICAL_SECTION();
         return SYSERR;
     }
 
@@ -50,7 +49,7 @@ devcall httpOpen(device *devptr, va_list ap)
     /* Initialize awaiting request flag */
     httpControl(devptr, HTTP_CTRL_SET_FLAG, HTTP_FLAG_AWAITINGRQST, NULL);
 
-    restore(im);
+    EXIT_KERNEL_CRITICAL_SECTION();
 
     /* Initialize underlying hardward device pointer */
     webptr->phw = (device *)&devtab[dvnum];
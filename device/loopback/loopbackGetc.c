@@ -31,21 +31,25 @@ xinu_devcall loopbackGetc (device *devptr)
 
     lbkptr = &looptab[devptr->minor];
 
-	ENTER_KERNEL_CRITICAL_SECTION();
-
-    /* wait until the buffer has data */
+    /* wait until the buffer has data; a wait that may block is made
+     * outside the kernel lock */
     if (LOOP_NONBLOCK == (lbkptr->flags & LOOP_NONBLOCK)) {
+        ENTER_KERNEL_CRITICAL_SECTION();
         if (semcount(lbkptr->sem) <= 0) {
-			EXIT_KERNEL_CRITICAL_SECTION();
+            EXIT_KERNEL_CRITICAL_SECTION();
             return EOF;
         }
+        wait(lbkptr->sem);
+    }
+    else {
+        wait(lbkptr->sem);
+        ENTER_KERNEL_CRITICAL_SECTION();
     }
-
-    wait(lbkptr->sem);
 
     /* Get and return the next character.  */
     ch = lbkptr->buffer[lbkptr->index];
     lbkptr->index = (lbkptr->index + 1) % LOOP_BUFFER;
-	EXIT_KERNEL_CRITICAL_SECTION();
+    lbkptr->count--;
+    EXIT_KERNEL_CRITICAL_SECTION();
     return ch;
 }
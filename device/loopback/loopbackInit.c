@@ -25,6 +25,7 @@ xinu_devcall loopbackInit(device *devptr)
     lbkptr = &looptab[devptr->minor];
     lbkptr->state = LOOP_STATE_FREE;
     lbkptr->index = 0;
+    lbkptr->count = 0;
 
     return OK;
 }
@@ -42,6 +42,8 @@ xinu_devcall loopbackOpen (device *devptr, va_list ap)
 
     /* Zero out the buffer */
     bzero(lbkptr->buffer, LOOP_BUFFER);
+    lbkptr->index = 0;
+    lbkptr->count = 0;
 
     /* Zero out flags */
     lbkptr->flags = 0;
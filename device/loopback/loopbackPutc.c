@@ -33,19 +33,20 @@ xinu_devcall loopbackPutc (device *devptr, char ch)
 	ENTER_KERNEL_CRITICAL_SECTION();
 
     /* Ensure room in buffer */
-    if (LOOP_BUFFER <= semcount(lbkptr->sem))
+    if (LOOP_BUFFER <= lbkptr->count)
     {
 		EXIT_KERNEL_CRITICAL_SECTION();
         return SYSERR;
     }
 
-    i = (lbkptr->index + semcount(lbkptr->sem)) % LOOP_BUFFER;
+    i = (lbkptr->index + lbkptr->count) % LOOP_BUFFER;
     lbkptr->buffer[i] = ch;
+    lbkptr->count++;
+
+	EXIT_KERNEL_CRITICAL_SECTION();
 
     /* signal that more data is on the buffer */
     signal(lbkptr->sem);
 
-	EXIT_KERNEL_CRITICAL_SECTION();
-
     return ch;
 }
@@ -6,6 +6,7 @@
 
 #include <xinu.h>
 #include <device.h>
+#include <memory.h>
 #include <raw.h>
 #include <stdlib.h>
 #include <CriticalSection.h>
@@ -20,6 +21,8 @@
 xinu_devcall rawClose(device *devptr)
 {
     struct raw *rawptr;
+    struct packet *pending[RAW_IBLEN];
+    unsigned int npending;
 
     /* Setup and error check pointers to structures */
     rawptr = &rawtab[devptr->minor];
@@ -37,15 +40,29 @@ xinu_devcall rawClose(device *devptr)
         return SYSERR;
     }
 
-    /* Free all pending packet buffers */
+    /* Take all pending packet buffers, to be freed once the kernel lock is
+     * released */
+    npending = 0;
     while (rawptr->icount > 0)
     {
-        netFreebuf(rawptr->in[rawptr->istart]);
+        pending[npending++] = rawptr->in[rawptr->istart];
         rawptr->istart = (rawptr->istart + 1) % RAW_IBLEN;
         rawptr->icount--;
     }
 
+    /* Free filter program */
+    if (NULL != rawptr->filter.bf_insns)
+    {
+        memfree(rawptr->filter.bf_insns,
+                rawptr->filter.bf_len * sizeof(struct bpf_insn));
+    }
+
     bzero(rawptr, sizeof(struct raw));  /* Clear RAW structure.         */
 	EXIT_KERNEL_CRITICAL_SECTION();
+
+    while (npending > 0)
+    {
+        netFreebuf(pending[--npending]);
+    }
     return OK;
 }
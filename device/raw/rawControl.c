@@ -5,8 +5,11 @@
 /* Embedded Xinu, Copyright (C) 2009, 2018.  All rights reserved. */
 
 #include <xinu.h>
+#include <bpf.h>
 #include <device.h>
+#include <memory.h>
 #include <raw.h>
+#include <string.h>
 #include <CriticalSection.h>
 
 /**
@@ -23,6 +26,8 @@ xinu_devcall rawControl(device *devptr, int func, long arg1, long arg2)
 {
     struct raw *rawptr;
     unsigned char old;
+    struct bpf_program *prog;
+    struct bpf_insn *insns = NULL;
 
     rawptr = &rawtab[devptr->minor];
 	ENTER_KERNEL_CRITICAL_SECTION();
@@ -50,6 +55,36 @@ xinu_devcall rawControl(device *devptr, int func, long arg1, long arg2)
         rawptr->flags &= ~(arg1);
 		EXIT_KERNEL_CRITICAL_SECTION();
         return old;
+
+        /* Set filter: arg1 = program to copy, NULL to clear   */
+        /* return OK, SYSERR if program is invalid             */
+    case RAW_CTRL_SETFILTER:
+        prog = (struct bpf_program *)arg1;
+        if ((NULL != prog) && (prog->bf_len > 0))
+        {
+            if (OK != bpfValidate(prog->bf_insns, prog->bf_len))
+            {
+				EXIT_KERNEL_CRITICAL_SECTION();
+                return SYSERR;
+            }
+            insns = memget(prog->bf_len * sizeof(struct bpf_insn));
+            if (SYSERR == (int)insns)
+            {
+				EXIT_KERNEL_CRITICAL_SECTION();
+                return SYSERR;
+            }
+            memcpy(insns, prog->bf_insns,
+                   prog->bf_len * sizeof(struct bpf_insn));
+        }
+        if (NULL != rawptr->filter.bf_insns)
+        {
+            memfree(rawptr->filter.bf_insns,
+                    rawptr->filter.bf_len * sizeof(struct bpf_insn));
+        }
+        rawptr->filter.bf_insns = insns;
+        rawptr->filter.bf_len = (NULL == insns) ? 0 : prog->bf_len;
+		EXIT_KERNEL_CRITICAL_SECTION();
+        return OK;
     }
 
 	EXIT_KERNEL_CRITICAL_SECTION();
@@ -2,23 +2,50 @@
  * @file rawDemux.c
  *
  */
-/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+/* Embedded Xinu, Copyright (C) 2009, 2018.  All rights reserved. */
 
 #include <stddef.h>
+#include <bpf.h>
 #include <network.h>
 #include <raw.h>
+#include <CriticalSection.h>
+
+/* Determine if a socket's filter, if it has one, accepts a packet */
+static bool rawAccepts(struct raw *rawptr, struct packet *pkt)
+{
+    unsigned int len;
+    bool accept = TRUE;
+
+    if (NULL == pkt)
+    {
+        return TRUE;
+    }
+
+    /* The program must not be replaced while it runs */
+    len = pkt->len - (pkt->nethdr - pkt->linkhdr);
+	ENTER_KERNEL_CRITICAL_SECTION();
+    if (NULL != rawptr->filter.bf_insns)
+    {
+        accept = (0 != bpfFilter(rawptr->filter.bf_insns, pkt->nethdr,
+                                 len, len));
+    }
+	EXIT_KERNEL_CRITICAL_SECTION();
+    return accept;
+}
 
 /**
  * @ingroup raw
  *
- * Locate the raw socket for a packet
+ * Locate the raw socket for a packet.  Sockets whose filter program
+ * rejects the packet are passed over.
+ * @param pkt the packet, NULL to match on addresses and protocol alone
  * @param src source IP address of the packet
  * @param dst destination IP address of the packet
  * @param proto protocol of the packet
  * @return most completely matched socket, NULL if no match
  */
-struct raw *rawDemux(struct netaddr *src, struct netaddr *dst,
-                     unsigned short proto)
+struct raw *rawDemux(struct packet *pkt, struct netaddr *src,
+                     struct netaddr *dst, unsigned short proto)
 {
     struct raw *rawptr;
     unsigned int i;
@@ -50,7 +77,8 @@ struct raw *rawDemux(struct netaddr *src, struct netaddr *dst,
             if (level < 4
                 && (proto == rawtab[i].proto)
                 && (netaddrequal(src, &rawtab[i].remoteip))
-                && (netaddrequal(dst, &rawtab[i].localip)))
+                && (netaddrequal(dst, &rawtab[i].localip))
+                && rawAccepts(&rawtab[i], pkt))
             {
                 rawptr = &rawtab[i];
                 level = 4;
@@ -63,7 +91,8 @@ struct raw *rawDemux(struct netaddr *src, struct netaddr *dst,
                 && (((netaddrequal(src, &rawtab[i].remoteip))
                      && (NULL == rawtab[i].localip.type))
                     || ((netaddrequal(dst, &rawtab[i].localip))
-                        && (NULL == rawtab[i].remoteip.type))))
+                        && (NULL == rawtab[i].remoteip.type)))
+                && rawAccepts(&rawtab[i], pkt))
             {
                 rawptr = &rawtab[i];
                 level = 3;
@@ -74,7 +103,8 @@ struct raw *rawDemux(struct netaddr *src, struct netaddr *dst,
             if (level < 2
                 && (proto == rawtab[i].proto)
                 && (NULL == rawtab[i].remoteip.type)
-                && (NULL == rawtab[i].localip.type))
+                && (NULL == rawtab[i].localip.type)
+                && rawAccepts(&rawtab[i], pkt))
             {
                 rawptr = &rawtab[i];
                 level = 2;
@@ -85,7 +115,8 @@ struct raw *rawDemux(struct netaddr *src, struct netaddr *dst,
             if (level < 1
                 && (NULL == rawtab[i].proto)
                 && (NULL == rawtab[i].remoteip.type)
-                && (NULL == rawtab[i].localip.type))
+                && (NULL == rawtab[i].localip.type)
+                && rawAccepts(&rawtab[i], pkt))
             {
                 rawptr = &rawtab[i];
                 level = 1;
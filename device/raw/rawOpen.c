@@ -77,6 +77,8 @@ xinu_devcall rawOpen(device *devptr, va_list ap)
         return SYSERR;
     }
     rawptr->flags = NULL;
+    rawptr->filter.bf_len = 0;
+    rawptr->filter.bf_insns = NULL;
 
 	EXIT_KERNEL_CRITICAL_SECTION();
     return OK;
@@ -35,8 +35,10 @@ xinu_devcall rawRead(device *devptr, void *buf, unsigned int len)
         return SYSERR;
     }
 
-    /* Read next packet */
+    /* Read next packet; the kernel lock is not held across the wait */
+    EXIT_KERNEL_CRITICAL_SECTION();
     wait(rawptr->isema);
+    ENTER_KERNEL_CRITICAL_SECTION();
     pkt = rawptr->in[rawptr->istart];
     RAW_TRACE("Read packet from pos %d", rawptr->istart);
 
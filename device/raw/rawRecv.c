@@ -29,7 +29,7 @@ xinu_syscall rawRecv(struct packet *pkt, struct netaddr *src,
     }
 
     /* Locate raw socket for the packet */
-    rawptr = rawDemux(src, dst, proto);
+    rawptr = rawDemux(pkt, src, dst, proto);
     if (NULL == rawptr)
     {
         RAW_TRACE("No matching socket");
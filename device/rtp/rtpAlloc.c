@@ -5,7 +5,7 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
-#include <interrupt.h>
+#include <CriticalSection.h>
 #include <rtp.h>
 #include <udp.h>
 
@@ -15,20 +15,19 @@
  */
 ushort rtpAlloc(void)
 {
-    irqmask im;
     int i;
 
-    im = disable();
+    ENTER_KERNEL_CRITICAL_SECTION();
     for (i = 0; i < NRTP; i++)
     {
         if (RTP_FREE == rtptab[i].state)
         {
             rtptab[i].state = RTP_ALLOC;
-            restore(im);
+            EXIT_KERNEL_CRITICAL_SECTION();
             return i + RTP0;
         }
     }
-    restore(im);
+    EXIT_KERNEL_CRITICAL_SECTION();
 
     return SYSERR;
 }
@@ -9,7 +9,7 @@
 #include <device.h>
 #include <stdlib.h>
 #include <rtp.h>
-#include <interrupt.h>
+#include <CriticalSection.h>
 
 /**
  * Close and clear a RTP device
@@ -19,12 +19,11 @@
 devcall rtpClose(device *devptr)
 {
     struct rtp *rtpptr;
-    irqmask im;
 
     /* Setup and error check pointers to structures */
     rtpptr = &rtptab[devptr->minor];
 
-    im = disable();
+    ENTER_KERNEL_CRITICAL_SECTION();
     /* Free the in buffer pool */
     bfpfree(rtpptr->inPool);
 
@@ -37,6 +36,6 @@ devcall rtpClose(device *devptr)
     /* Set device state to free */
     rtpptr->state = RTP_FREE;
 
-    restore(im);
+    EXIT_KERNEL_CRITICAL_SECTION();
     return OK;
 }
@@ -14,7 +14,8 @@ struct rtpPkt *rtpGetbuf(struct rtp *rtpptr)
 {
     struct rtpPkt *rtppkt = NULL;
 
-    rtppkt = bufget(rtpptr->inPool);
+    /* rtpRecv() holds the kernel lock, so this must not wait */
+    rtppkt = bufget_nowait(rtpptr->inPool);
     if (SYSERR == (int)rtppkt)
     {
         return (struct rtpPkt *)SYSERR;
@@ -11,7 +11,7 @@
 #include <network.h>
 #include <rtp.h>
 #include <stdarg.h>
-#include <interrupt.h>
+#include <CriticalSection.h>
 #include <udp.h>
 
 static ushort allocPort(void);
@@ -35,16 +35,15 @@ devcall rtpOpen(device *devptr, va_list ap)
     //rtpptr->rtcp_bw = //specified fraction of session bandwidth
     rtpptr->inital = true;
     //rtpptr->avg_rtcp_size = (1/16) * //packet_size + (15/16) * rtpptr->avg_rtcp_size;
-    irqmask im;
 
     rtpptr = &rtptab[devptr->minor];
 
-    im = disable();
+    ENTER_KERNEL_CRITICAL_SECTION();
     /* Check if RTP is already open */
     if (RTP_OPEN == rtpptr->state)
     {
         RTP_TRACE("rtp%d has already been opened.", devptr->minor);
-        restore(im);
+        EXIT_KERNEL_CRITICAL_SECTION();
         return SYSERR;
     }
 
@@ -65,7 +64,7 @@ devcall rtpOpen(device *devptr, va_list ap)
     RTP_TRACE("rtp%d inPool has been assigned pool ID %d.\r\n",
               devptr->minor, rtpptr->inPool);
 
-    restore(im);
+    EXIT_KERNEL_CRITICAL_SECTION();
     return OK;
 }
 
@@ -7,7 +7,7 @@
 #include <xinu.h>
 #include <device.h>
 #include <ether.h>
-#include <interrupt.h>
+#include <CriticalSection.h>
 #include <ipv4.h>
 #include <network.h>
 #include <rtp.h>
@@ -27,15 +27,11 @@ xinu_devcall rtpRead(device *devptr, void *buf, unsigned int len)
     unsigned char *buffer = buf;
     unsigned char *data = NULL;
     int count = 0;
-    irqmask im;
 
     rtpptr = &rtptab[devptr->minor];
 
-    im = disable();
-
-    restore(im);
     wait(rtpptr->isem);
-    im = disable();
+    ENTER_KERNEL_CRITICAL_SECTION();
 
     /* Get a pointer to the stored packet in the current position */
     //rtppktext = (struct rtpPktExt *)rtpptr->in[rtpptr->istart];
@@ -44,7 +40,7 @@ xinu_devcall rtpRead(device *devptr, void *buf, unsigned int len)
     /* Make sure the packet is not NULL */
     if (NULL == rtppkt)
     {
-        restore(im);
+        EXIT_KERNEL_CRITICAL_SECTION();
         return SYSERR;
     }
 
@@ -57,7 +53,7 @@ xinu_devcall rtpRead(device *devptr, void *buf, unsigned int len)
     count = rtppkt->len - RTP_HDR_LEN;
     data = rtppkt->data;
 
-    restore(im);
+    EXIT_KERNEL_CRITICAL_SECTION();
     if (count > len)
     {
         count = len;
@@ -6,7 +6,7 @@
 
 #include <xinu.h>
 #include <string.h>
-#include <interrupt.h>
+#include <CriticalSection.h>
 #include <ipv4.h>
 #include <icmp.h>
 #include <rtp.h>
@@ -30,7 +30,6 @@ syscall rtpRecv(struct packet *pkt, struct netaddr *src,
     //char strB[20];
 //#endif                          /* TRACE_RTP */
 
-    irqmask im;
 
     /* Point to the start of the RTP header */
     rtppkt = (struct rtpPkt *)pkt->curr;
@@ -43,7 +42,7 @@ syscall rtpRecv(struct packet *pkt, struct netaddr *src,
     }
 //TODO handle rtcp intake
 
-    im = disable();
+    ENTER_KERNEL_CRITICAL_SECTION();
 
     //if (NULL == rtpptr)
     //{
@@ -54,7 +53,7 @@ syscall rtpRecv(struct packet *pkt, struct netaddr *src,
     //RTP_TRACE("Source: %s:%d, Destination: %s:%d", strA,
     //          rtppkt->srcPort, strB, rtppkt->dstPort);
 //#endif                          /* TRACE_RTP */
-    //restore(im);
+    //EXIT_KERNEL_CRITICAL_SECTION();
     /* Send ICMP port unreachable message */
     //icmpDestUnreach(pkt, ICMP_PORT_UNR);
     //netFreebuf(pkt);
@@ -63,7 +62,7 @@ syscall rtpRecv(struct packet *pkt, struct netaddr *src,
     if (rtpptr->icount >= RTP_MAX_PKTS)
     {
         //RTP_TRACE("RTP buffer is full. Dropping RTP packet.");
-        restore(im);
+        EXIT_KERNEL_CRITICAL_SECTION();
         netFreebuf(pkt);
         return SYSERR;
     }
@@ -74,6 +73,7 @@ syscall rtpRecv(struct packet *pkt, struct netaddr *src,
     if (SYSERR == (int)tpkt)
     {
         //RTP_TRACE("Unable to get RTP buffer from pool. Dropping packet.");
+        EXIT_KERNEL_CRITICAL_SECTION();
         netFreebuf(pkt);
         return SYSERR;
     }
@@ -89,7 +89,7 @@ syscall rtpRecv(struct packet *pkt, struct netaddr *src,
     rtpptr->in[(rtpptr->istart + rtpptr->icount) % RTP_MAX_PKTS] = tpkt;
     rtpptr->icount++;
 
-    restore(im);
+    EXIT_KERNEL_CRITICAL_SECTION();
 
     signal(rtpptr->isem);
 
@@ -0,0 +1,176 @@
+/**
+ * @file tcpCongCubic.c
+ *
+ * CUBIC congestion control (RFC 8312).  After a loss the window follows a
+ * cubic function of the time since the loss, rising quickly back towards
+ * the window at which the loss happened, flattening out there, then
+ * probing beyond it.  Growth therefore depends on elapsed time rather than
+ * on the round trip, which lets long paths regain a large window quickly.
+ * Times are in milliseconds and windows in octets.
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <clock.h>
+#include <CriticalSection.h>
+#include <tcp.h>
+
+/* Multiplicative decrease, beta = 0.7 */
+#define CUBIC_BETA(w)   ((unsigned long long)(w) * 7 / 10)
+/* Reno-friendly increase per window, 3 (1 - beta) / (1 + beta) = 9 / 17 */
+#define CUBIC_ALPHA(w)  ((unsigned long long)(w) * 9 / 17)
+/* Time cubed is limited so windows fit in 64 bits */
+#define CUBIC_MAXT      100000
+
+/**
+ * Milliseconds since boot, never 0 so 0 can mark no epoch.
+ */
+static unsigned int cubicNow(void)
+{
+    unsigned long sec, usec;
+    unsigned int now;
+
+    clkgettime(&sec, &usec);
+    now = sec * 1000 + usec / 1000;
+    return (0 == now) ? 1 : now;
+}
+
+/**
+ * Largest integer whose cube does not exceed x.
+ */
+static unsigned int cubicRoot(unsigned long long x)
+{
+    unsigned int lo = 0, hi = 1 << 21, mid;
+
+    while (lo < hi)
+    {
+        mid = (lo + hi + 1) >> 1;
+        if ((unsigned long long)mid * mid * mid <= x)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
+    }
+    return lo;
+}
+
+static void cubicInit(struct tcb *tcbptr)
+{
+    tcbptr->sndcwn = TCP_INIT_CWND(tcbptr->sndmss);
+    tcbptr->sndsst = TCP_MAX_CWND;
+    tcbptr->ccwmax = 0;
+    tcbptr->ccwest = 0;
+    tcbptr->ccepoch = 0;
+    tcbptr->cck = 0;
+    tcbptr->ccrttmin = 0;
+}
+
+static void cubicAck(struct tcb *tcbptr, unsigned int acked)
+{
+    unsigned int cwnd = tcbptr->sndcwn;
+    unsigned int mss = tcbptr->sndmss;
+    long long t, target;
+
+    /* Slow start is the same as Reno's */
+    if (cwnd < tcbptr->sndsst)
+    {
+        cwnd += (acked < mss) ? acked : mss;
+        tcbptr->sndcwn = (cwnd > TCP_MAX_CWND) ? TCP_MAX_CWND : cwnd;
+        return;
+    }
+
+    /* Growth restarts with the first ACK after a loss.  K is the time
+     * the cubic takes to regain the old window, cube root of
+     * (Wmax - cwnd) / C, with C = 0.4 segments per second cubed. */
+    if (0 == tcbptr->ccepoch)
+    {
+        tcbptr->ccepoch = cubicNow();
+        tcbptr->ccwest = cwnd;
+        if (cwnd < tcbptr->ccwmax)
+        {
+            tcbptr->cck = cubicRoot((unsigned long long)
+                                    (tcbptr->ccwmax - cwnd) *
+                                    2500000000ULL / mss);
+        }
+        else
+        {
+            tcbptr->cck = 0;
+            tcbptr->ccwmax = cwnd;
+        }
+    }
+
+    /* Aim for the window the cubic reaches a round trip from now */
+    t = (long long)(cubicNow() - tcbptr->ccepoch) + tcbptr->ccrttmin
+        - tcbptr->cck;
+    if (t > CUBIC_MAXT)
+    {
+        t = CUBIC_MAXT;
+    }
+    else if (t < -CUBIC_MAXT)
+    {
+        t = -CUBIC_MAXT;
+    }
+    target = tcbptr->ccwmax + t * t * t / 1000 * 4 * mss / 10000000;
+    if (target < cwnd)
+    {
+        target = cwnd;
+    }
+    else if (target > cwnd + cwnd / 2)
+    {
+        target = cwnd + cwnd / 2;
+    }
+
+    /* Never grow more slowly than Reno would have */
+    tcbptr->ccwest += CUBIC_ALPHA((unsigned long long)acked * mss) / cwnd;
+    if (tcbptr->ccwest > target)
+    {
+        target = tcbptr->ccwest;
+    }
+
+    cwnd += (target - cwnd) * acked / cwnd;
+    tcbptr->sndcwn = (cwnd > TCP_MAX_CWND) ? TCP_MAX_CWND : cwnd;
+}
+
+static void cubicLoss(struct tcb *tcbptr)
+{
+    unsigned int cwnd = tcbptr->sndcwn;
+
+    /* Losing before regaining the old window suggests a new flow shares
+     * the path, so give up some of it (fast convergence) */
+    tcbptr->ccepoch = 0;
+    if (cwnd < tcbptr->ccwmax)
+    {
+        tcbptr->ccwmax = ((unsigned long long)cwnd + CUBIC_BETA(cwnd)) / 2;
+    }
+    else
+    {
+        tcbptr->ccwmax = cwnd;
+    }
+
+    tcbptr->sndsst = CUBIC_BETA(cwnd);
+    if (tcbptr->sndsst < 2 * tcbptr->sndmss)
+    {
+        tcbptr->sndsst = 2 * tcbptr->sndmss;
+    }
+    tcbptr->sndcwn = tcbptr->sndsst;
+}
+
+static void cubicRtt(struct tcb *tcbptr, unsigned int rtt)
+{
+    if ((0 == tcbptr->ccrttmin) || (rtt < tcbptr->ccrttmin))
+    {
+        tcbptr->ccrttmin = rtt;
+    }
+}
+
+/**
+ * @ingroup tcp
+ *
+ * CUBIC congestion control, for paths with a large bandwidth-delay product.
+ */
+const struct tcpCong tcpcubic = {
+    "cubic", cubicInit, cubicAck, cubicLoss, cubicLoss, cubicRtt
+};
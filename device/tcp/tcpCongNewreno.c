@@ -0,0 +1,65 @@
+/**
+ * @file tcpCongNewreno.c
+ *
+ * Reno congestion control (RFC 5681).  The window doubles each round trip
+ * in slow start, then grows by one segment per round trip, and is halved
+ * on a loss.  NewReno recovery itself (RFC 6582) lives in tcpRecvAck().
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <stddef.h>
+#include <tcp.h>
+
+static void newrenoInit(struct tcb *tcbptr)
+{
+    tcbptr->sndcwn = TCP_INIT_CWND(tcbptr->sndmss);
+    tcbptr->sndsst = TCP_MAX_CWND;
+}
+
+static void newrenoAck(struct tcb *tcbptr, unsigned int acked)
+{
+    unsigned int incr;
+
+    /* Slow start grows by at most one segment per ACK (RFC 3465) */
+    if (tcbptr->sndcwn < tcbptr->sndsst)
+    {
+        incr = (acked < tcbptr->sndmss) ? acked : tcbptr->sndmss;
+    }
+    /* Congestion avoidance grows by about a segment per window */
+    else
+    {
+        incr = (tcbptr->sndmss * tcbptr->sndmss) / tcbptr->sndcwn;
+        if (0 == incr)
+        {
+            incr = 1;
+        }
+    }
+
+    tcbptr->sndcwn += incr;
+    if (tcbptr->sndcwn > TCP_MAX_CWND)
+    {
+        tcbptr->sndcwn = TCP_MAX_CWND;
+    }
+}
+
+static void newrenoLoss(struct tcb *tcbptr)
+{
+    unsigned int flight;
+
+    flight = tcpSeqdiff(tcbptr->sndnxt, tcbptr->snduna);
+    tcbptr->sndsst = flight >> 1;
+    if (tcbptr->sndsst < 2 * tcbptr->sndmss)
+    {
+        tcbptr->sndsst = 2 * tcbptr->sndmss;
+    }
+    tcbptr->sndcwn = tcbptr->sndsst;
+}
+
+/**
+ * @ingroup tcp
+ *
+ * NewReno congestion control, the default for new connections.
+ */
+const struct tcpCong tcpnewreno = {
+    "newreno", newrenoInit, newrenoAck, newrenoLoss, newrenoLoss, NULL
+};
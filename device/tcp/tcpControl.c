@@ -36,6 +36,69 @@ xinu_devcall tcpControl(device *devptr, int func, long arg1, long arg2)
         signal(tcbptr->mutex);
         return bytes;
 
+        /* Set buffer sizes used by the next open */
+    case TCP_CTRL_RCVBUF:
+    case TCP_CTRL_SNDBUF:
+        if ((TCP_CLOSED != tcbptr->state) || (arg1 < TCP_MIN_BUFLEN)
+            || (arg1 > TCP_MAX_BUFLEN))
+        {
+            signal(tcbptr->mutex);
+            return SYSERR;
+        }
+        if (TCP_CTRL_RCVBUF == func)
+        {
+            tcbptr->iblen = arg1;
+        }
+        else
+        {
+            tcbptr->oblen = arg1;
+        }
+        signal(tcbptr->mutex);
+        return OK;
+
+        /* Set congestion control algorithm used by the next open */
+    case TCP_CTRL_CC:
+        if ((TCP_CLOSED != tcbptr->state) || (arg1 < 0)
+            || (arg1 >= TCP_NCC))
+        {
+            signal(tcbptr->mutex);
+            return SYSERR;
+        }
+        tcbptr->sndcc = arg1;
+        signal(tcbptr->mutex);
+        return OK;
+
+        /* Turn the Nagle algorithm off (TRUE) or back on (FALSE) */
+    case TCP_CTRL_NODELAY:
+        if (arg1)
+        {
+            tcbptr->sndmode |= TCP_MODE_NODELAY;
+        }
+        else
+        {
+            tcbptr->sndmode &= ~TCP_MODE_NODELAY;
+        }
+        signal(tcbptr->mutex);
+        return OK;
+
+        /* Hold partial segments (TRUE) or send what was held (FALSE) */
+    case TCP_CTRL_CORK:
+        if (arg1)
+        {
+            tcbptr->sndmode |= TCP_MODE_CORK;
+        }
+        else
+        {
+            tcbptr->sndmode &= ~TCP_MODE_CORK;
+            if ((TCP_ESTAB == tcbptr->state)
+                || (TCP_CLOSEWT == tcbptr->state))
+            {
+                tcpSendData(tcbptr);
+            }
+        }
+        signal(tcbptr->mutex);
+        return OK;
+
         /* Unrecongnized control function */
     default:
         signal(tcbptr->mutex);
@@ -1,12 +1,18 @@
-/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+/* Embedded Xinu, Copyright (C) 2009, 2018.  All rights reserved. */
 
 #include <stddef.h>
+#include <CriticalSection.h>
 #include <tcp.h>
 
 /**
  * @ingroup tcp
  *
- * Locate the TCP socket for a TCP packet
+ * Locate the TCP socket for a TCP packet.  A fully bound connection is
+ * found in the connection table by the packet's 4-tuple; failing that, the
+ * listen table is searched by destination port, preferring a socket bound
+ * to the source port over one bound to the local socket alone.  Only the
+ * chains for the packet's own buckets are examined, so the cost does not
+ * grow with ::NTCP.
  * @param dstpt destination port of the TCP packet
  * @param srcpt source port of the TCP packet
  * @param dstip destination IP of the TCP packet
@@ -16,54 +22,54 @@
 struct tcb *tcpDemux(unsigned short dstpt, unsigned short srcpt, struct netaddr *dstip,
                      struct netaddr *srcip)
 {
-    struct tcb *tcbptr = NULL;
-    unsigned int i;
-    unsigned int level = 0;
+    struct tcb *tcbptr;
+    struct tcb *best = NULL;
 
-    /* Cycle through all tcp devices to find the best match */
-    for (i = 0; i < NTCP; i++)
+	ENTER_KERNEL_CRITICAL_SECTION();
+
+    /* Full match is the best */
+    for (tcbptr = tcphash[tcpHashConn(dstpt, srcpt, srcip)]; NULL != tcbptr;
+         tcbptr = tcbptr->hnext)
+    {
+        if ((tcbptr->state != TCP_CLOSED)
+            && (tcbptr->localpt == dstpt)
+            && (tcbptr->remotept == srcpt)
+            && (netaddrequal(&tcbptr->localip, dstip))
+            && (netaddrequal(&tcbptr->remoteip, srcip)))
+        {
+            TCP_TRACE("Level 3 match, socket %d", tcbptr - tcptab);
+			EXIT_KERNEL_CRITICAL_SECTION();
+            return tcbptr;
+        }
+    }
+
+    for (tcbptr = tcphash[tcpHashListen(dstpt)]; NULL != tcbptr;
+         tcbptr = tcbptr->hnext)
     {
-        wait(tcptab[i].mutex);
-        if (tcptab[i].state != TCP_CLOSED)
+        if ((tcbptr->state == TCP_CLOSED)
+            || (tcbptr->localpt != dstpt)
+            || (tcbptr->remoteip.type != NULL)
+            || (!netaddrequal(&tcbptr->localip, dstip)))
         {
-            /* Full match is the best */
-            if (level < 3
-                && (tcptab[i].localpt == dstpt)
-                && (tcptab[i].remotept == srcpt)
-                && (netaddrequal(&tcptab[i].localip, dstip))
-                && (netaddrequal(&tcptab[i].remoteip, srcip)))
-            {
-                tcbptr = &tcptab[i];
-                level = 3;
-                TCP_TRACE("Level 3 match, socket %d", i);
-            }
+            continue;
+        }
 
-            /* Src and dst ports match */
-            if (level < 2
-                && (tcptab[i].localpt == dstpt)
-                && (tcptab[i].remotept == srcpt)
-                && (netaddrequal(&tcptab[i].localip, dstip))
-                && (tcptab[i].remoteip.type == NULL))
-            {
-                tcbptr = &tcptab[i];
-                level = 2;
-                TCP_TRACE("Level 2 match, socket %d", i);
-            }
+        /* Src and dst ports match */
+        if (tcbptr->remotept == srcpt)
+        {
+            TCP_TRACE("Level 2 match, socket %d", tcbptr - tcptab);
+            best = tcbptr;
+            break;
+        }
 
-            /* Dst ports match is last */
-            if (level < 1
-                && (tcptab[i].localpt == dstpt)
-                && (tcptab[i].remotept == NULL)
-                && (netaddrequal(&tcptab[i].localip, dstip))
-                && (tcptab[i].remoteip.type == NULL))
-            {
-                tcbptr = &tcptab[i];
-                level = 1;
-                TCP_TRACE("Level 1 match, socket %d", i);
-            }
+        /* Dst ports match is last */
+        if ((NULL == best) && (tcbptr->remotept == NULL))
+        {
+            TCP_TRACE("Level 1 match, socket %d", tcbptr - tcptab);
+            best = tcbptr;
         }
-        signal(tcptab[i].mutex);
     }
 
-    return tcbptr;
+	EXIT_KERNEL_CRITICAL_SECTION();
+    return best;
 }
@@ -3,6 +3,7 @@
 #include <xinu.h>
 #include <device.h>
 #include <CriticalSection.h>
+#include <memory.h>
 #include <semaphore.h>
 #include <stdlib.h>
 #include <tcp.h>
@@ -17,6 +18,23 @@
 xinu_devcall tcpFree(struct tcb *tcbptr)
 {
     semaphore temp;
+    unsigned int iblen, oblen;
+    unsigned char cc, mode;
+
+    /* Stop demultiplexing to the TCB, even if it never left CLOSED */
+    tcpHashRemove(tcbptr);
+
+    /* Release buffers, which a failed open may have left behind */
+    if (NULL != tcbptr->in)
+    {
+        memfree(tcbptr->in, tcbptr->iblen);
+        tcbptr->in = NULL;
+    }
+    if (NULL != tcbptr->out)
+    {
+        memfree(tcbptr->out, tcbptr->oblen);
+        tcbptr->out = NULL;
+    }
 
     /* Verify TCB is not already free */
     if (TCP_CLOSED == tcbptr->state)
@@ -31,6 +49,10 @@ xinu_devcall tcpFree(struct tcb *tcbptr)
 
     /* Free TCB */
     temp = tcbptr->mutex;
+    iblen = tcbptr->iblen;
+    oblen = tcbptr->oblen;
+    cc = tcbptr->sndcc;
+    mode = tcbptr->sndmode & ~TCP_MODE_CORK;
     semfree(tcbptr->openclose);
     semfree(tcbptr->readers);
     semfree(tcbptr->writers);
@@ -39,6 +61,10 @@ xinu_devcall tcpFree(struct tcb *tcbptr)
     tcbptr->state = TCP_CLOSED;
     tcbptr->devstate = TCP_FREE;
     tcbptr->mutex = temp;
+    tcbptr->iblen = iblen;
+    tcbptr->oblen = oblen;
+    tcbptr->sndcc = cc;
+    tcbptr->sndmode = mode;
 	EXIT_KERNEL_CRITICAL_SECTION();
     signal(tcbptr->mutex);
     return OK;
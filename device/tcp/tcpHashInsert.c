@@ -0,0 +1,40 @@
+/**
+ * @file tcpHashInsert.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <CriticalSection.h>
+#include <tcp.h>
+
+/**
+ * @ingroup tcp
+ *
+ * Add a TCB to the demux hash under its current local and remote socket.
+ * A TCB bound to both a remote port and remote IP goes in the connection
+ * table, keyed on the 4-tuple; anything else goes in the listen table,
+ * keyed on the local port.  The TCB must not already be in the hash, and
+ * its socket fields must not change until it is removed again.
+ * @param tcbptr pointer to the transmission control block
+ */
+void tcpHashInsert(struct tcb *tcbptr)
+{
+    unsigned int slot;
+
+    if ((NULL != tcbptr->remotept) && (NULL != tcbptr->remoteip.type))
+    {
+        slot = tcpHashConn(tcbptr->localpt, tcbptr->remotept,
+                           &tcbptr->remoteip);
+    }
+    else
+    {
+        slot = tcpHashListen(tcbptr->localpt);
+    }
+
+	ENTER_KERNEL_CRITICAL_SECTION();
+    tcbptr->hnext = tcphash[slot];
+    tcphash[slot] = tcbptr;
+    tcbptr->hslot = slot + 1;
+	EXIT_KERNEL_CRITICAL_SECTION();
+}
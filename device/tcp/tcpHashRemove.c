@@ -0,0 +1,37 @@
+/**
+ * @file tcpHashRemove.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <CriticalSection.h>
+#include <tcp.h>
+
+/**
+ * @ingroup tcp
+ *
+ * Take a TCB out of the demux hash, if it is in it.
+ * @param tcbptr pointer to the transmission control block
+ */
+void tcpHashRemove(struct tcb *tcbptr)
+{
+    struct tcb **link;
+
+	ENTER_KERNEL_CRITICAL_SECTION();
+    if (0 != tcbptr->hslot)
+    {
+        for (link = &tcphash[tcbptr->hslot - 1]; NULL != *link;
+             link = &(*link)->hnext)
+        {
+            if (*link == tcbptr)
+            {
+                *link = tcbptr->hnext;
+                break;
+            }
+        }
+        tcbptr->hnext = NULL;
+        tcbptr->hslot = 0;
+    }
+	EXIT_KERNEL_CRITICAL_SECTION();
+}
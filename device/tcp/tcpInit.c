@@ -10,6 +10,8 @@
 #include <tcp.h>
 
 struct tcb tcptab[NTCP];
+struct tcb *tcphash[2 * TCP_NHASH];     /* Connection, then listen table */
+const struct tcpCong *tcpcongtab[TCP_NCC] = { &tcpnewreno, &tcpcubic };
 
 /**
  * @ingroup tcp
@@ -26,6 +28,9 @@ xinu_devcall tcpInit(device *devptr)
     bzero(tcbptr, sizeof(struct tcb));
     tcbptr->state = TCP_CLOSED;
     tcbptr->devstate = TCP_FREE;
+    tcbptr->iblen = TCP_IBLEN;
+    tcbptr->oblen = TCP_OBLEN;
+    tcbptr->sndcc = TCP_CC_NEWRENO;
     tcbptr->mutex = semcreate(1);
     if (SYSERR == (int)tcbptr->mutex)
     {
@@ -72,6 +72,9 @@ xinu_devcall tcpOpen(device *devptr, va_list ap)
         localpt = allocPort();
     }
 
+    /* A reopened listener is rebound below */
+    tcpHashRemove(tcbptr);
+
     /* Mutually link tcp record with device table entry */
     tcbptr->dev = devptr->num;
 
@@ -88,6 +91,7 @@ xinu_devcall tcpOpen(device *devptr, va_list ap)
         netaddrcpy(&tcbptr->remoteip, remoteip);
     }
     tcbptr->opentype = mode;
+    tcpHashInsert(tcbptr);
 
     /* Setup transmission control block */
     if (SYSERR == tcpSetup(tcbptr))
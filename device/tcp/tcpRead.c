@@ -60,8 +60,7 @@ xinu_devcall tcpRead(device *devptr, void *buf, unsigned int len)
         while ((tcbptr->icount > 0) && (count < len))
         {
             *buffer++ = tcbptr->in[tcbptr->istart];
-            tcbptr->imark[tcbptr->istart] = FALSE;
-            tcbptr->istart = (tcbptr->istart + 1) % TCP_IBLEN;
+            tcbptr->istart = (tcbptr->istart + 1) % tcbptr->iblen;
             tcbptr->icount--;
             count++;
         }
@@ -5,6 +5,7 @@
 /* Embedded Xinu, Copyright (C) 2009, 2018.  All rights reserved. */
 
 #include <xinu.h>
+#include <ipv4.h>
 #include <network.h>
 #include <semaphore.h>
 #include <tcp.h>
@@ -29,8 +30,9 @@ int tcpRecv(struct packet *pkt, struct netaddr *src, struct netaddr *dst)
     tcp = (struct tcpPkt *)pkt->curr;
     tcplen = pkt->len - (pkt->curr - pkt->linkhdr);
 
-    /* Verify TCP checksum is correct */
-    if (tcpChksum(pkt, tcplen, src, dst))
+    /* Verify TCP checksum is correct, from the device's sum if it has one */
+    if (!ipv4ChksumRecv(pkt, src, dst, IPv4_PROTO_TCP, tcplen)
+        && tcpChksum(pkt, tcplen, src, dst))
     {
         netFreebuf(pkt);
         TCP_TRACE("Bad Checksum");
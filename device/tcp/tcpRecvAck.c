@@ -5,13 +5,16 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <string.h>
 #include <tcp.h>
 
 /**
  * @ingroup tcp
  *
  * Process an ackowledgement of data in an incoming TCP segment for a
- * connection which has been fully established.
+ * connection which has been fully established.  Duplicate ACKs trigger
+ * fast retransmit and NewReno fast recovery, whichever congestion control
+ * algorithm sizes the window.
  * @param pkt incoming packet
  * @param tcbptr pointer to transmission control block for connection
  * @precondition TCB mutex is already held 
@@ -20,11 +23,24 @@
 int tcpRecvAck(struct packet *pkt, struct tcb *tcbptr)
 {
     unsigned int amt = 0;
+    unsigned int i;
+    unsigned int window;
+    unsigned int flight;
+    unsigned int tcplen;
     tcpseq oldend, newend;
     struct tcpPkt *tcp;
+    const struct tcpCong *cc = tcpcongtab[tcbptr->sndcc];
 
     /* Setup packet pointers */
     tcp = (struct tcpPkt *)pkt->curr;
+    tcplen = pkt->len - (pkt->curr - pkt->linkhdr);
+
+    /* Windows are scaled in all but SYN segments */
+    window = tcp->window;
+    if (!(tcp->control & TCP_CTRL_SYN))
+    {
+        window <<= tcbptr->sndscale;
+    }
 
     if (seqlt(tcbptr->snduna, tcp->acknum)
         && seqlte(tcp->acknum, tcbptr->sndnxt))
@@ -47,19 +63,60 @@ int tcpRecvAck(struct packet *pkt, struct tcb *tcbptr)
         }
 
         /* Adjust send buffer */
-        tcbptr->ostart = (tcbptr->ostart + amt) % TCP_OBLEN;
+        tcbptr->ostart = (tcbptr->ostart + amt) % tcbptr->oblen;
         tcbptr->ocount -= amt;
         tcbptr->obytes += amt;
-        if (tcbptr->ocount < TCP_OBLEN)
+        if (tcbptr->ocount < tcbptr->oblen)
         {
             signal(tcbptr->writers);
         }
 
         tcbptr->snduna = tcp->acknum;
 
+        /* Forget SACKed ranges the cumulative ACK now covers */
+        for (i = 0; (i < tcbptr->sndnsack)
+             && seqlte(tcbptr->sndsack[i].end, tcbptr->snduna); i++)
+            ;
+        tcbptr->sndnsack -= i;
+        memmove(tcbptr->sndsack, &tcbptr->sndsack[i],
+                tcbptr->sndnsack * sizeof(struct tcpRange));
+        if ((tcbptr->sndnsack > 0)
+            && seqlt(tcbptr->sndsack[0].start, tcbptr->snduna))
+        {
+            tcbptr->sndsack[0].start = tcbptr->snduna;
+        }
+
         /* Remove any segments from retransmission queue which are ACKed */
         tcbptr->rxtcount = 0;
         tcpRecvRtt(tcbptr);
+
+        /* Grow the congestion window, unless recovering from a loss */
+        if (tcbptr->sndndup < TCP_DUPACK_THRESH)
+        {
+            tcbptr->sndndup = 0;
+            cc->ack(tcbptr, amt);
+        }
+        else if (seqlt(tcbptr->snduna, tcbptr->sndrecover))
+        {
+            /* A partial ACK means the next hole was lost as well, so
+             * resend it and deflate the window by what was acknowledged */
+            tcpSendLost(tcbptr);
+            tcbptr->sndcwn -= (amt < tcbptr->sndcwn) ? amt : tcbptr->sndcwn;
+            tcbptr->sndcwn += tcbptr->sndmss;
+        }
+        else
+        {
+            /* A full ACK ends recovery without a burst of new data */
+            tcbptr->sndndup = 0;
+            flight = tcpSeqdiff(tcbptr->sndnxt, tcbptr->snduna);
+            if (flight < tcbptr->sndmss)
+            {
+                flight = tcbptr->sndmss;
+            }
+            tcbptr->sndcwn = (tcbptr->sndsst < flight + tcbptr->sndmss) ?
+                tcbptr->sndsst : flight + tcbptr->sndmss;
+        }
+
         /* If unacknowledged data remains, reschedule retransmit timer */
         if (seqlt(tcbptr->snduna, tcbptr->sndnxt))
         {
@@ -68,6 +125,35 @@ int tcpRecvAck(struct packet *pkt, struct tcb *tcbptr)
 
         tcbptr->sndflg |= TCP_FLG_SNDDATA;
     }
+    /* A duplicate ACK means a segment arrived beyond a hole */
+    else if ((tcp->acknum == tcbptr->snduna)
+             && seqlt(tcbptr->snduna, tcbptr->sndnxt)
+             && !(tcp->control & (TCP_CTRL_SYN | TCP_CTRL_FIN))
+             && (0 == tcpSeglen(tcp, tcplen)) && (window == tcbptr->sndwnd))
+    {
+        tcbptr->sndndup++;
+        if (TCP_DUPACK_THRESH == tcbptr->sndndup)
+        {
+            /* Fast retransmit, at most once per window of data (RFC 6582) */
+            if (seqlt(tcbptr->sndrecover, tcbptr->snduna))
+            {
+                cc->loss(tcbptr);
+                tcbptr->sndrecover = tcbptr->sndnxt;
+                tcpSendLost(tcbptr);
+                tcbptr->sndcwn += TCP_DUPACK_THRESH * tcbptr->sndmss;
+            }
+            else
+            {
+                tcbptr->sndndup = 0;
+            }
+        }
+        else if (tcbptr->sndndup > TCP_DUPACK_THRESH)
+        {
+            /* Each further duplicate means a segment left the network */
+            tcbptr->sndcwn += tcbptr->sndmss;
+            tcbptr->sndflg |= TCP_FLG_SNDDATA;
+        }
+    }
 
     /* Update send window (if packet is not out of order) */
     if (seqlt(tcbptr->sndwl1, tcp->seqnum)
@@ -76,9 +162,9 @@ int tcpRecvAck(struct packet *pkt, struct tcb *tcbptr)
     {
         /* Calculate sequence number for end of old and new send window */
         oldend = seqadd(tcbptr->sndwl2, tcbptr->sndwnd);
-        newend = seqadd(tcp->acknum, tcp->window);
+        newend = seqadd(tcp->acknum, window);
 
-        tcbptr->sndwnd = tcp->window;
+        tcbptr->sndwnd = window;
         tcbptr->sndwl1 = tcp->seqnum;
         tcbptr->sndwl2 = tcp->acknum;
 
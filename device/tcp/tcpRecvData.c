@@ -6,8 +6,55 @@
 
 #include <xinu.h>
 #include <network.h>
+#include <string.h>
 #include <tcp.h>
 
+/* Hand octets now in order over to readers */
+static void tcpRecvAdvance(struct tcb *tcbptr, unsigned int len)
+{
+    tcbptr->icount += len;
+    tcbptr->ibytes += len;
+    tcbptr->inxt = (tcbptr->inxt + len) % tcbptr->iblen;
+    tcbptr->rcvnxt = seqadd(tcbptr->rcvnxt, len);
+}
+
+/*
+ * Note data held in the buffer beyond rcvnxt.  The range is merged with any
+ * it overlaps or touches and goes to the front of the list, since SACK
+ * reports the most recently changed block first.  When the list is full
+ * the least recently changed range is forgotten; its data will be resent.
+ */
+static void tcpRecvHold(struct tcb *tcbptr, tcpseq start, tcpseq end)
+{
+    struct tcpRange *ooo = tcbptr->rcvooo;
+    unsigned int i, n;
+
+    for (i = 0, n = 0; i < tcbptr->rcvnooo; i++)
+    {
+        if (seqlt(ooo[i].end, start) || seqlt(end, ooo[i].start))
+        {
+            ooo[n++] = ooo[i];
+            continue;
+        }
+        if (seqlt(ooo[i].start, start))
+        {
+            start = ooo[i].start;
+        }
+        if (seqlt(end, ooo[i].end))
+        {
+            end = ooo[i].end;
+        }
+    }
+    if (TCP_NRANGE == n)
+    {
+        n--;
+    }
+    memmove(&ooo[1], &ooo[0], n * sizeof(*ooo));
+    ooo[0].start = start;
+    ooo[0].end = end;
+    tcbptr->rcvnooo = n + 1;
+}
+
 /**
  * @ingroup tcp
  *
@@ -26,10 +73,12 @@ int tcpRecvData(struct packet *pkt, struct tcb *tcbptr)
 
     unsigned int start;
     unsigned int i;
-    unsigned int index;
+    tcpseq seqnum;
     tcpseq offset;
+    struct tcpRange *ooo;
     unsigned char *data;
     unsigned int window;
+    bool quick;
 
     /* Setup packet pointers */
     tcp = (struct tcpPkt *)pkt->curr;
@@ -40,6 +89,7 @@ int tcpRecvData(struct packet *pkt, struct tcb *tcbptr)
     /* TODO: Process URG bit */
 
     /* Process data */
+    seqnum = tcp->seqnum;
     if (seglen > 0)
     {
         switch (tcbptr->state)
@@ -51,61 +101,77 @@ int tcpRecvData(struct packet *pkt, struct tcb *tcbptr)
             data = (unsigned char *)tcp + offset2octets(tcp->offset);
 
             /* Calculate where to start in segment and buffer */
-            if (seqlt(tcp->seqnum, tcbptr->rcvnxt))
+            if (seqlt(seqnum, tcbptr->rcvnxt))
             {
-                offset = tcpSeqdiff(tcbptr->rcvnxt, tcp->seqnum);
+                offset = tcpSeqdiff(tcbptr->rcvnxt, seqnum);
+                if (offset >= seglen)
+                {
+                    offset = seglen;
+                }
                 data += offset;
                 seglen -= offset;
-                start = tcbptr->inxt;
+                seqnum = tcbptr->rcvnxt;
+                offset = 0;
             }
             else
             {
-                offset = tcpSeqdiff(tcp->seqnum, tcbptr->rcvnxt);
-                start = (tcbptr->inxt + offset) % TCP_IBLEN;
+                offset = tcpSeqdiff(seqnum, tcbptr->rcvnxt);
             }
+            start = (tcbptr->inxt + offset) % tcbptr->iblen;
 
             /* Copy only part of data if not enough buffer space */
             window = tcpSeqdiff(tcbptr->rcvwnd, tcbptr->rcvnxt);
-            window -= offset;
+            window = (offset < window) ? window - offset : 0;
             if (seglen > window)
             {
                 seglen = window;
                 tcp->control &= ~TCP_CTRL_FIN;
             }
 
-            /* Copy data into buffer */
-            for (i = 0; i < seglen; i++)
+            /* Copy data into buffer, in two pieces if it wraps */
+            i = tcbptr->iblen - start;
+            if (i >= seglen)
             {
-                index = (start + i) % TCP_IBLEN;
-                tcbptr->in[index] = data[i];
-                tcbptr->imark[index] = TRUE;
+                memcpy(&tcbptr->in[start], data, seglen);
+            }
+            else
+            {
+                memcpy(&tcbptr->in[start], data, i);
+                memcpy(tcbptr->in, data + i, seglen - i);
             }
 
-            /* If started at begnning of window, we can ACK */
-            if (start == tcbptr->inxt)
+            /* Anything but plain in-order data is acknowledged at once */
+            quick = TRUE;
+            if ((0 == offset) && (seglen > 0))
             {
-                /* ACK at least current data */
-                tcbptr->icount += seglen;
-                tcbptr->ibytes += seglen;
-                tcbptr->inxt = (tcbptr->inxt + seglen) % TCP_IBLEN;
-                tcbptr->rcvnxt = seqadd(tcbptr->rcvnxt, seglen);
-
-                /* Keep going until data is missing */
-                while ((tcbptr->icount < TCP_IBLEN)
-                       && (tcbptr->imark[tcbptr->inxt]))
+                /* In order; take it and any held data it now joins up */
+                quick = (tcbptr->rcvnooo > 0);
+                tcpRecvAdvance(tcbptr, seglen);
+                i = 0;
+                while (i < tcbptr->rcvnooo)
                 {
-                    tcbptr->icount++;
-                    tcbptr->ibytes++;
-                    tcbptr->inxt = (tcbptr->inxt + 1) % TCP_IBLEN;
-                    tcbptr->rcvnxt = seqadd(tcbptr->rcvnxt, 1);
-
-                    /* If FIN has been seen, stop when we reach it */
-                    if ((tcbptr->rcvflg & TCP_FLG_FIN)
-                        && (tcbptr->rcvnxt == tcbptr->rcvfin))
+                    ooo = &tcbptr->rcvooo[i];
+                    if (!seqlte(ooo->start, tcbptr->rcvnxt))
                     {
-                        tcp->control |= TCP_CTRL_FIN;
-                        break;
+                        i++;
+                        continue;
                     }
+                    if (seqlt(tcbptr->rcvnxt, ooo->end))
+                    {
+                        tcpRecvAdvance(tcbptr,
+                                       tcpSeqdiff(ooo->end, tcbptr->rcvnxt));
+                    }
+                    tcbptr->rcvnooo--;
+                    memmove(ooo, ooo + 1,
+                            (tcbptr->rcvnooo - i) * sizeof(*ooo));
+                    i = 0;
+                }
+
+                /* If FIN has been seen, it may now be next */
+                if ((tcbptr->rcvflg & TCP_FLG_FIN)
+                    && (tcbptr->rcvnxt == tcbptr->rcvfin))
+                {
+                    tcp->control |= TCP_CTRL_FIN;
                 }
 
                 /* Signal readers */
@@ -113,10 +179,26 @@ int tcpRecvData(struct packet *pkt, struct tcb *tcbptr)
                 {
                     signal(tcbptr->readers);
                 }
+            }
+            else if (seglen > 0)
+            {
+                /* Out of order; hold it and report it in SACK blocks */
+                tcpRecvHold(tcbptr, seqnum, seqadd(seqnum, seglen));
+            }
 
+            /* ACK out-of-order data and filled holes at once, so the
+             * sender sees duplicate ACKs and SACK blocks promptly, and
+             * ACK at least every second segment in order; otherwise give
+             * outgoing data a moment to carry the ACK (RFC 1122 4.2.3.2) */
+            tcbptr->rcvnack++;
+            if (quick || (tcbptr->rcvnack >= TCP_DELACK_SEGS))
+            {
                 tcbptr->sndflg |= TCP_FLG_SNDACK;
             }
-
+            else if (tcpTimerRemain(tcbptr, TCP_EVT_DELACK) <= 0)
+            {
+                tcpTimerSched(TCP_DELACK_TIME, tcbptr, TCP_EVT_DELACK);
+            }
             break;
 
             /* Data should not be recevied in CLOSEWT, CLOSING, LASTACK, and TIMEWT
@@ -131,7 +213,7 @@ int tcpRecvData(struct packet *pkt, struct tcb *tcbptr)
         /* If FIN was not received previously, store FIN sequence number */
         if (!(tcbptr->rcvflg & TCP_FLG_FIN))
         {
-            tcbptr->rcvfin = seqadd(tcp->seqnum, seglen);
+            tcbptr->rcvfin = seqadd(seqnum, seglen);
             tcbptr->rcvflg |= TCP_FLG_FIN;
             TCP_TRACE("Store FIN");
         }
@@ -156,8 +238,8 @@ int tcpRecvData(struct packet *pkt, struct tcb *tcbptr)
                 tcbptr->rcvnxt = seqadd(tcbptr->rcvnxt, 1);
                 if (seqlt(tcbptr->sndfin, tcbptr->snduna))
                 {
-                    tcpTimerSched(TCP_TWOMSL, tcbptr, TCP_EVT_TIMEWT);
                     tcpTimerPurge(tcbptr, NULL);
+                    tcpTimerSched(TCP_TWOMSL, tcbptr, TCP_EVT_TIMEWT);
                     tcbptr->state = TCP_TIMEWT;
                 }
                 else
@@ -48,7 +48,9 @@ int tcpRecvListen(struct packet *pkt, struct tcb *tcbptr,
         tcbptr->rcvflg |= TCP_FLG_SYN;
         tcbptr->sndflg |= TCP_FLG_SNDACK;
 
-        /* Finish specifying connection, if not already set */
+        /* Finish specifying connection, if not already set, and move */
+        /* it from the listen table to the connection table           */
+        tcpHashRemove(tcbptr);
         if (NULL == tcbptr->remotept)
         {
             tcbptr->remotept = tcp->srcpt;
@@ -57,6 +59,7 @@ int tcpRecvListen(struct packet *pkt, struct tcb *tcbptr,
         {
             netaddrcpy(&tcbptr->remoteip, src);
         }
+        tcpHashInsert(tcbptr);
 
         /* Update send information */
         tcbptr->sndwnd = tcp->window;
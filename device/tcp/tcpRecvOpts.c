@@ -2,7 +2,7 @@
  * @file tcpRecvOpts.c
  *
  */
-/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+/* Embedded Xinu, Copyright (C) 2009, 2018.  All rights reserved. */
 
 #include <stddef.h>
 #include <network.h>
@@ -22,44 +22,100 @@ int tcpRecvOpts(struct packet *pkt, struct tcb *tcbptr)
 {
     unsigned char *options;
     unsigned char *endopt;
+    unsigned char *blk;
     struct tcpPkt *tcp;
+    unsigned int optlen;
+    tcpseq start, end;
 
     tcp = (struct tcpPkt *)pkt->curr;
 
-    /* Check if the header contains options */
-    if (offset2octets(tcp->offset) == TCP_HDR_LEN)
+    /* SACK and window scaling are only agreed to on the SYN */
+    if (tcp->control & TCP_CTRL_SYN)
     {
-        /* No options */
-        return OK;
+        tcbptr->rcvflg &= ~(TCP_FLG_SACK | TCP_FLG_WSCALE);
+        tcbptr->sndscale = 0;
     }
 
     options = tcp->data;
     endopt = options + (offset2octets(tcp->offset) - TCP_HDR_LEN);
 
     /* Keep handling options until end of otpion list is encountered */
-    while ((*options != TCP_OPT_END) && (options < endopt))
+    while ((options < endopt) && (*options != TCP_OPT_END))
     {
+        /* Every option other than NOP carries its own length */
+        if (TCP_OPT_NOP == *options)
+        {
+            options++;
+            continue;
+        }
+        if ((options + 1 >= endopt) || (options[1] < 2)
+            || (options + options[1] > endopt))
+        {
+            break;
+        }
+        optlen = options[1];
+
         switch (*options)
         {
             /* Maximum segment size */
         case TCP_OPT_MSS:
-            options += 2;
             /*
              * BUG: The options may not be word aligned to deference as
              * a short.  Discovered by RB on 7/2.
              * FIXED by AG on 8/10.
              * TODO: add test case with non-word aligned opts
              */
-            tcbptr->sndmss = *options++;
-            tcbptr->sndmss += *options++ << 8;
-            tcbptr->sndmss -= TCP_HDR_LEN;
+            if (TCP_OPT_MSS_LEN == optlen)
+            {
+                tcbptr->sndmss = (options[2] << 8) + options[3];
+                tcbptr->sndmss -= TCP_HDR_LEN;
+            }
             break;
-            /* Skip over NOP and unknown options */
-        case TCP_OPT_NOP:
+            /* Window scale */
+        case TCP_OPT_WSCALE:
+            if ((tcp->control & TCP_CTRL_SYN)
+                && (TCP_OPT_WSCALE_LEN == optlen))
+            {
+                tcbptr->rcvflg |= TCP_FLG_WSCALE;
+                tcbptr->sndscale = (options[2] > TCP_MAX_WSCALE) ?
+                    TCP_MAX_WSCALE : options[2];
+            }
+            break;
+            /* Selective acknowledgement permitted */
+        case TCP_OPT_SACKOK:
+            if (tcp->control & TCP_CTRL_SYN)
+            {
+                tcbptr->rcvflg |= TCP_FLG_SACK;
+            }
+            break;
+            /* Selective acknowledgement blocks */
+        case TCP_OPT_SACK:
+            if (!(tcbptr->rcvflg & TCP_FLG_SACK)
+                || !(tcp->control & TCP_CTRL_ACK))
+            {
+                break;
+            }
+            for (blk = options + 2; blk + TCP_OPT_SACK_BLK <= options + optlen;
+                 blk += TCP_OPT_SACK_BLK)
+            {
+                start = (blk[0] << 24) | (blk[1] << 16) | (blk[2] << 8)
+                    | blk[3];
+                end = (blk[4] << 24) | (blk[5] << 16) | (blk[6] << 8)
+                    | blk[7];
+                tcpRecvSack(tcbptr, start, end);
+            }
+            break;
+            /* Skip over unknown options */
         default:
-            options++;
             break;
         }
+        options += optlen;
+    }
+
+    /* Scaling applies in both directions or neither */
+    if ((tcp->control & TCP_CTRL_SYN) && !(tcbptr->rcvflg & TCP_FLG_WSCALE))
+    {
+        tcbptr->rcvscale = 0;
     }
 
     return OK;
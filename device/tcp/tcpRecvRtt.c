@@ -37,21 +37,13 @@ int tcpRecvRtt(struct tcb *tcbptr)
         {
             tcbptr->rxttime = TCP_RXT_MINTIME;
         }
-    }
 
-    /* Handle slow start/congestion window increase */
-    /* If the congestion window is less than the slow start threshold, increase
-     * congestion window by MSS */
-    if (tcbptr->sndcwn < tcbptr->sndsst)
-    {
-        tcbptr->sndcwn += tcbptr->sndmss;
-    }
-    /* Otherwise, increase congestion window by MSS for each round trip time
-     * using percentage of current congestion window */
-    else
-    {
-        tcbptr->sndcwn +=
-            (tcbptr->sndmss * tcbptr->sndmss) / tcbptr->sndcwn;
+        /* Pass the sample on to congestion control */
+        if (NULL != tcpcongtab[tcbptr->sndcc]->rtt)
+        {
+            tcpcongtab[tcbptr->sndcc]->rtt(tcbptr, rtt);
+        }
     }
+
     return OK;
 }
@@ -0,0 +1,78 @@
+/**
+ * @file tcpRecvSack.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <stddef.h>
+#include <string.h>
+#include <tcp.h>
+
+/**
+ * @ingroup tcp
+ *
+ * Records a block of data the remote side has selectively acknowledged in
+ * the sender scoreboard.  Overlapping and adjacent ranges are merged, so
+ * the scoreboard stays in sequence order with gaps between every range.
+ * @param tcbptr pointer to transmission control block for connection
+ * @param start sequence number of first octet in the block
+ * @param end sequence number following the last octet in the block
+ * @pre-condition TCB mutex is already held
+ * @post-condition TCB mutex is still held
+ */
+void tcpRecvSack(struct tcb *tcbptr, tcpseq start, tcpseq end)
+{
+    struct tcpRange *sack = tcbptr->sndsack;
+    unsigned int n = tcbptr->sndnsack;
+    unsigned int i, j;
+
+    /* Only blocks covering data sent but not yet acknowledged count */
+    if (seqlt(start, tcbptr->snduna))
+    {
+        start = tcbptr->snduna;
+    }
+    if (!seqlt(start, end) || seqlt(tcbptr->sndnxt, end))
+    {
+        return;
+    }
+
+    /* Find the first range that does not end before the block starts */
+    for (i = 0; (i < n) && seqlt(sack[i].end, start); i++)
+        ;
+
+    /* Absorb every range the block overlaps or touches */
+    for (j = i; (j < n) && seqlte(sack[j].start, end); j++)
+    {
+        if (seqlt(sack[j].start, start))
+        {
+            start = sack[j].start;
+        }
+        if (seqlt(end, sack[j].end))
+        {
+            end = sack[j].end;
+        }
+    }
+
+    if (i == j)
+    {
+        /* A new range; when full, the range furthest ahead gives way */
+        if (TCP_NRANGE == n)
+        {
+            if (i == n)
+            {
+                return;
+            }
+            n--;
+        }
+        memmove(&sack[i + 1], &sack[i], (n - i) * sizeof(*sack));
+        n++;
+    }
+    else
+    {
+        memmove(&sack[i + 1], &sack[j], (n - j) * sizeof(*sack));
+        n -= j - i - 1;
+    }
+    sack[i].start = start;
+    sack[i].end = end;
+    tcbptr->sndnsack = n;
+}
@@ -31,15 +31,27 @@ int tcpSend(struct tcb *tcbptr, unsigned char ctrl, unsigned int seqnum,
     int result;
     unsigned char *data;
     unsigned int i = 0;
-    // ushort window = 0;
-    unsigned short msslen = 0;
+    unsigned int window;
+    unsigned short optlen = 0;
     unsigned short tcplen;
+    unsigned int nsack = 0;
+    struct tcpRange *ooo;
 
-    /* If SYN is set, then don't include in datalen, but include MSS */
+    /* If SYN is set, then don't include in datalen, but include MSS.
+     * Offer window scaling and SACK too, unless answering a SYN that
+     * did not. */
     if (ctrl & TCP_CTRL_SYN)
     {
         datalen--;
-        msslen = ((3 + TCP_OPT_MSS_SIZE) & ~0x03);
+        optlen = TCP_OPT_MSS_LEN;
+        if (!(ctrl & TCP_CTRL_ACK) || (tcbptr->rcvflg & TCP_FLG_WSCALE))
+        {
+            optlen += 1 + TCP_OPT_WSCALE_LEN;
+        }
+        if (!(ctrl & TCP_CTRL_ACK) || (tcbptr->rcvflg & TCP_FLG_SACK))
+        {
+            optlen += 2 + TCP_OPT_SACKOK_LEN;
+        }
         TCP_TRACE("No SYN in datalen, include MSS");
     }
     /* If FIN is set, then don't include in datalen */
@@ -49,8 +61,36 @@ int tcpSend(struct tcb *tcbptr, unsigned char ctrl, unsigned int seqnum,
         TCP_TRACE("No FIN in datalen");
     }
 
+    /* Any ACK covers everything received so far, so no delayed ACK is
+     * owed once this one is sent */
+    if (ctrl & TCP_CTRL_ACK)
+    {
+        tcbptr->rcvnack = 0;
+        tcpTimerPurge(tcbptr, TCP_EVT_DELACK);
+    }
+
+    /* Report data held out of order in as many SACK blocks as fit */
+    if (!(ctrl & TCP_CTRL_SYN) && (ctrl & TCP_CTRL_ACK)
+        && (tcbptr->rcvflg & TCP_FLG_SACK))
+    {
+        nsack = tcbptr->rcvnooo;
+        if (nsack > TCP_OPT_SACK_MAX)
+        {
+            nsack = TCP_OPT_SACK_MAX;
+        }
+        while ((nsack > 0) && (datalen + 4 + nsack * TCP_OPT_SACK_BLK
+                               > tcbptr->sndmss))
+        {
+            nsack--;
+        }
+        if (nsack > 0)
+        {
+            optlen = 4 + nsack * TCP_OPT_SACK_BLK;
+        }
+    }
+
     /* Get space to construct packet */
-    tcplen = TCP_HDR_LEN + datalen + msslen;
+    tcplen = TCP_HDR_LEN + datalen + optlen;
     if (tcplen > NET_MAX_PKTLEN)
     {
         TCP_TRACE("Packet too large");
@@ -73,33 +113,73 @@ int tcpSend(struct tcb *tcbptr, unsigned char ctrl, unsigned int seqnum,
     tcp->dstpt = tcbptr->remotept;
     tcp->seqnum = seqnum;
     tcp->acknum = acknum;
-    tcp->offset = octets2offset(TCP_HDR_LEN + msslen);
+    tcp->offset = octets2offset(TCP_HDR_LEN + optlen);
     tcp->control = ctrl;
-    tcp->window = tcpSendWindow(tcbptr);
-    //window = tcp->window;
+    /* Windows in SYN segments are never scaled */
+    window = tcpSendWindow(tcbptr);
+    if (!(ctrl & TCP_CTRL_SYN))
+    {
+        window >>= tcbptr->rcvscale;
+    }
+    tcp->window = (window > TCP_MAX_WND) ? TCP_MAX_WND : window;
     data = tcp->data;
 
-    /* Add options */
-    if (msslen)
+    /* Add options, a byte at a time since they need not be aligned */
+    if (ctrl & TCP_CTRL_SYN)
     {
         *data++ = TCP_OPT_MSS;
         *data++ = TCP_OPT_MSS_LEN;
-        *((unsigned short *)data) = hs2net((tcbptr->rcvmss + TCP_HDR_LEN));
-        data += TCP_OPT_MSS_LEN;
-        for (i = (TCP_OPT_MSS_LEN % 4); i > 1; i--)
+        *data++ = (tcbptr->rcvmss + TCP_HDR_LEN) >> 8;
+        *data++ = (tcbptr->rcvmss + TCP_HDR_LEN) & 0xFF;
+        TCP_TRACE("Added MSS");
+        if (!(ctrl & TCP_CTRL_ACK) || (tcbptr->rcvflg & TCP_FLG_WSCALE))
         {
             *data++ = TCP_OPT_NOP;
+            *data++ = TCP_OPT_WSCALE;
+            *data++ = TCP_OPT_WSCALE_LEN;
+            *data++ = tcbptr->rcvscale;
+        }
+        if (!(ctrl & TCP_CTRL_ACK) || (tcbptr->rcvflg & TCP_FLG_SACK))
+        {
+            *data++ = TCP_OPT_NOP;
+            *data++ = TCP_OPT_NOP;
+            *data++ = TCP_OPT_SACKOK;
+            *data++ = TCP_OPT_SACKOK_LEN;
         }
-        *data++ = TCP_OPT_END;
-        TCP_TRACE("Added MSS");
+    }
+    if (nsack > 0)
+    {
+        *data++ = TCP_OPT_NOP;
+        *data++ = TCP_OPT_NOP;
+        *data++ = TCP_OPT_SACK;
+        *data++ = 2 + nsack * TCP_OPT_SACK_BLK;
+        for (ooo = tcbptr->rcvooo; ooo < tcbptr->rcvooo + nsack; ooo++)
+        {
+            *data++ = ooo->start >> 24;
+            *data++ = ooo->start >> 16;
+            *data++ = ooo->start >> 8;
+            *data++ = ooo->start;
+            *data++ = ooo->end >> 24;
+            *data++ = ooo->end >> 16;
+            *data++ = ooo->end >> 8;
+            *data++ = ooo->end;
+        }
+        TCP_TRACE("Added %d SACK blocks", nsack);
     }
 
-    /* Copy data into packet */
+    /* Copy data into packet, in two pieces if it wraps the buffer */
     if (datalen > 0)
     {
-        for (i = 0; i < datalen; i++)
+        datastart %= tcbptr->oblen;
+        i = tcbptr->oblen - datastart;
+        if (i >= datalen)
+        {
+            memcpy(data, &tcbptr->out[datastart], datalen);
+        }
+        else
         {
-            *data++ = tcbptr->out[(datastart + i) % TCP_OBLEN];
+            memcpy(data, &tcbptr->out[datastart], i);
+            memcpy(data + i, tcbptr->out, datalen - i);
         }
     }
 
@@ -111,9 +191,9 @@ int tcpSend(struct tcb *tcbptr, unsigned char ctrl, unsigned int seqnum,
     tcp->window = hs2net(tcp->window);
     tcp->urgent = hs2net(tcp->urgent);
 
-    /* Calculate TCP checksum */
-    tcp->chksum = tcpChksum(pkt, tcplen, &tcbptr->localip,
-                            &tcbptr->remoteip);
+    /* Leave TCP checksum for the network device, or ipv4Send() */
+    tcp->chksum = netChksumOffload(pkt, &tcbptr->localip, &tcbptr->remoteip,
+                                   IPv4_PROTO_TCP, tcplen);
 
     /* Send TCP packet */
     result = ipv4Send(pkt, &tcbptr->localip, &tcbptr->remoteip,
@@ -22,6 +22,7 @@ int tcpSendData(struct tcb *tcbptr)
     unsigned int wndused;      /**< amount of window filled with data pending ACK */
     unsigned int pending;      /**< amount of data pending ACK or transmission */
     unsigned int tosend;
+    unsigned int wnd;          /**< smaller of send and congestion windows */
     unsigned int sent;
     unsigned char ctrl;
 
@@ -53,9 +54,16 @@ int tcpSendData(struct tcb *tcbptr)
         return 0;
     }
 
+    /* Send no more than both receiver and network will take */
+    wnd = tcbptr->sndwnd;
+    if (tcbptr->sndcwn < wnd)
+    {
+        wnd = tcbptr->sndcwn;
+    }
+
     /* Check if new transmssion is allowed */
-    /* If (SNDNXT >= SNDUNA + SNDWND), then can't send data */
-    if (seqlte(seqadd(tcbptr->snduna, tcbptr->sndwnd), tcbptr->sndnxt))
+    /* If (SNDNXT >= SNDUNA + WND), then can't send data */
+    if (seqlte(seqadd(tcbptr->snduna, wnd), tcbptr->sndnxt))
     {
         return 0;
     }
@@ -80,9 +88,9 @@ int tcpSendData(struct tcb *tcbptr)
     /* There is data to send and space in the window to send it */
     ctrl = TCP_CTRL_ACK;
     /* Determine how much data to send */
-    if (pending > tcbptr->sndwnd)
+    if (pending > wnd)
     {
-        tosend = tcbptr->sndwnd - wndused;
+        tosend = wnd - wndused;
     }
     else
     {
@@ -98,22 +106,37 @@ int tcpSendData(struct tcb *tcbptr)
     while (tosend > tcbptr->sndmss)
     {
         tcpSend(tcbptr, TCP_CTRL_ACK, tcbptr->sndnxt, tcbptr->rcvnxt,
-                (tcbptr->ostart + wndused) % TCP_OBLEN, tcbptr->sndmss);
+                (tcbptr->ostart + wndused) % tcbptr->oblen, tcbptr->sndmss);
         tosend -= tcbptr->sndmss;
         sent += tcbptr->sndmss;
         wndused += tcbptr->sndmss;
         tcbptr->sndnxt = seqadd(tcbptr->sndnxt, tcbptr->sndmss);
     }
 
+    /* Hold back a final partial segment while corked or, under the Nagle
+     * algorithm, while earlier data is unacknowledged; the ACK that
+     * arrives sends it along with whatever has been written since
+     * (RFC 1122 4.2.3.4).  A FIN always goes out. */
+    if ((tosend < tcbptr->sndmss) && !(ctrl & TCP_CTRL_FIN)
+        && ((tcbptr->sndmode & TCP_MODE_CORK)
+            || (!(tcbptr->sndmode & TCP_MODE_NODELAY) && (wndused > 0))))
+    {
+        tosend = 0;
+    }
+
     /* Send the remainder of the sendable data */
-    tcpSend(tcbptr, ctrl, tcbptr->sndnxt, tcbptr->rcvnxt,
-            (tcbptr->ostart + wndused) % TCP_OBLEN, tosend);
-    sent += tosend;
-    wndused += tosend;
-    tcbptr->sndnxt = seqadd(tcbptr->sndnxt, tosend);
+    if (tosend > 0)
+    {
+        tcpSend(tcbptr, ctrl, tcbptr->sndnxt, tcbptr->rcvnxt,
+                (tcbptr->ostart + wndused) % tcbptr->oblen, tosend);
+        sent += tosend;
+        wndused += tosend;
+        tcbptr->sndnxt = seqadd(tcbptr->sndnxt, tosend);
+    }
 
     /* If one does not already exist, schedule a retransmission event */
-    if (tcpTimerRemain(tcbptr, TCP_EVT_RXT) <= 0)
+    if (seqlt(tcbptr->snduna, tcbptr->sndnxt)
+        && (tcpTimerRemain(tcbptr, TCP_EVT_RXT) <= 0))
     {
         tcpTimerSched(tcbptr->rxttime, tcbptr, TCP_EVT_RXT);
     }
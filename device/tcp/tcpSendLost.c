@@ -0,0 +1,88 @@
+/**
+ * @file tcpSendLost.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009, 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <tcp.h>
+
+/**
+ * @ingroup tcp
+ *
+ * Resends the oldest unacknowledged segment of a TCP connection, along with
+ * its FIN if it fits.  When the remote side uses SACK, only the octets it
+ * has not reported holding are resent, and the start of every other hole
+ * between SACKed ranges goes too.
+ * @param tcbptr pointer to the transmission control block for connection
+ * @return number of octets sent
+ * @pre-condition TCB mutex is already held
+ * @post-condition TCB mutex is still held
+ */
+int tcpSendLost(struct tcb *tcbptr)
+{
+    unsigned int pending;      /**< amount of data pending ACK */
+    unsigned int tosend;
+    unsigned int sent;
+    unsigned int offset;
+    unsigned int i;
+    struct tcpRange *sack = tcbptr->sndsack;
+    unsigned char control;
+
+    /* Calculate amount of data pending ACK */
+    pending = tcpSeqdiff(tcbptr->sndnxt, tcbptr->snduna);
+    control = TCP_CTRL_ACK;
+
+    /* Determine if FIN is pending ACK */
+    if ((tcbptr->sndflg & TCP_FLG_FIN)
+        && seqlte(tcbptr->snduna, tcbptr->sndfin)
+        && seqlt(tcbptr->sndfin, tcbptr->sndnxt))
+    {
+        control |= TCP_CTRL_FIN;
+    }
+
+    /* Calculate amount of data to send */
+    tosend = pending;
+    if (pending > tcbptr->sndmss)
+    {
+        tosend = tcbptr->sndmss;
+        control &= ~TCP_CTRL_FIN;
+    }
+
+    /* A SACKed range at the cumulative ACK means the remote side has
+     * discarded data it reported holding, so stop trusting the scoreboard */
+    if ((tcbptr->sndnsack > 0) && (sack[0].start == tcbptr->snduna))
+    {
+        tcbptr->sndnsack = 0;
+    }
+
+    /* Stop short of data the remote side has already SACKed */
+    if ((tcbptr->sndnsack > 0)
+        && (tcpSeqdiff(sack[0].start, tcbptr->snduna) < tosend))
+    {
+        tosend = tcpSeqdiff(sack[0].start, tcbptr->snduna);
+        control &= ~TCP_CTRL_FIN;
+    }
+
+    /* Send data */
+    tcpSend(tcbptr, control, tcbptr->snduna, tcbptr->rcvnxt,
+            tcbptr->ostart, tosend);
+    sent = tosend;
+
+    /* Resend the start of every other hole between SACKed ranges; data
+     * past the last range may still be in flight */
+    for (i = 0; i + 1 < tcbptr->sndnsack; i++)
+    {
+        offset = tcpSeqdiff(sack[i].end, tcbptr->snduna);
+        tosend = tcpSeqdiff(sack[i + 1].start, sack[i].end);
+        if (tosend > tcbptr->sndmss)
+        {
+            tosend = tcbptr->sndmss;
+        }
+        tcpSend(tcbptr, TCP_CTRL_ACK, sack[i].end, tcbptr->rcvnxt,
+                tcbptr->ostart + offset, tosend);
+        sent += tosend;
+    }
+
+    return sent;
+}
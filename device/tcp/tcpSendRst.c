@@ -80,8 +80,9 @@ int tcpSendRst(struct packet *pkt, struct netaddr *src,
     outtcp->window = hs2net(outtcp->window);
     outtcp->urgent = hs2net(outtcp->urgent);
 
-    /* Calculate TCP checksum */
-    outtcp->chksum = tcpChksum(out, TCP_HDR_LEN, src, dst);
+    /* Leave TCP checksum for the network device, or ipv4Send() */
+    outtcp->chksum = netChksumOffload(out, src, dst, IPv4_PROTO_TCP,
+                                      TCP_HDR_LEN);
 
     /* Send TCP packet */
     result = ipv4Send(out, src, dst, IPv4_PROTO_TCP);
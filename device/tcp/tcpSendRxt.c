@@ -11,14 +11,13 @@
  * @ingroup tcp
  *
  * Retransmitts a segment of pending outbound data (including SYN and FIN) 
- * for a TCP connection.
+ * for a TCP connection after its retransmission timer expires.
  * @param tcpptr pointer to the transmission control block for connection
  * @return number of octets sent
  */
 int tcpSendRxt(struct tcb *tcbptr)
 {
-    unsigned int pending;      /**< amount of data pending ACK */
-    unsigned int tosend;
+    unsigned int sent;
     unsigned char control = NULL;
     int time;
     bool first = FALSE;
@@ -72,49 +71,21 @@ int tcpSendRxt(struct tcb *tcbptr)
         return 1;
     }
 
-    /* Calculate amount of data pending ACK */
-    pending = tcpSeqdiff(tcbptr->sndnxt, tcbptr->snduna);
-    control = TCP_CTRL_ACK;
+    /* The remote side may have discarded data it SACKed, so resend from
+     * the first unacknowledged octet regardless (RFC 2018, section 8) */
+    tcbptr->sndnsack = 0;
+    sent = tcpSendLost(tcbptr);
 
-    /* Determine if FIN is pending ACK */
-    if ((tcbptr->sndflg & TCP_FLG_FIN)
-        && seqlte(tcbptr->snduna, tcbptr->sndfin)
-        && seqlt(tcbptr->sndfin, tcbptr->sndnxt))
-    {
-        control |= TCP_CTRL_FIN;
-    }
-
-    /* Calculate amount of data to send */
-    tosend = pending;
-    if (pending > tcbptr->sndmss)
-    {
-        tosend = tcbptr->sndmss;
-        control &= ~TCP_CTRL_FIN;
-    }
-
-    /* Send data */
-    tcpSend(tcbptr, control, tcbptr->snduna, tcbptr->rcvnxt,
-            tcbptr->ostart, tosend);
-
-    /* Adjust sender congestion window */
+    /* Cut the slow start threshold once per loss, then restart from a
+     * single segment, abandoning any fast recovery under way */
     if (first)
     {
-        tcbptr->sndsst = tcbptr->sndcwn;
-    }
-    if (tcbptr->sndwnd < tcbptr->sndsst)
-    {
-        tcbptr->sndsst = tcbptr->sndwnd >> 1;
-    }
-    else
-    {
-        tcbptr->sndsst = tcbptr->sndsst >> 1;
-    }
-    if (tcbptr->sndsst < tcbptr->sndmss)
-    {
-        tcbptr->sndsst = tcbptr->sndmss;
+        tcpcongtab[tcbptr->sndcc]->rto(tcbptr);
     }
     tcbptr->sndcwn = tcbptr->sndmss;
+    tcbptr->sndndup = 0;
+    tcbptr->sndrecover = tcbptr->sndnxt;
 
     signal(tcbptr->mutex);
-    return tosend;
+    return sent;
 }
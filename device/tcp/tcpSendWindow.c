@@ -10,18 +10,20 @@
 /**
  * @ingroup tcp
  *
- * Calculates the window size to advertise in an outgoing TCP packet.
+ * Calculates the window size to advertise in an outgoing TCP packet.  The
+ * result is unscaled; once the connection is synchronized it is a multiple
+ * of the receive window scale so shifting it loses nothing.
  * @param tcbptr pointer to transmission control block for connection
  * @pre-condition TCB mutex is already held
  * @post-condition TCB mutex is still held
  */
-unsigned short tcpSendWindow(struct tcb *tcbptr)
+unsigned int tcpSendWindow(struct tcb *tcbptr)
 {
-    unsigned short unused = 0;
-    unsigned short window = 0;
+    unsigned int unused = 0;
+    unsigned int window = 0;
 
     /* Set proposed window to maximum possible */
-    window = TCP_IBLEN - tcbptr->icount;        // Correct?
+    window = tcbptr->iblen - tcbptr->icount;
 
     switch (tcbptr->state)
     {
@@ -31,14 +33,19 @@ unsigned short tcpSendWindow(struct tcb *tcbptr)
     case TCP_LISTEN:
     case TCP_SYNSENT:
     case TCP_SYNRECV:
-        /* Don't do receiver-side silly window syndrome avoidance */
+        /* Don't do receiver-side silly window syndrome avoidance, and
+         * remember a SYN's window is never scaled */
+        if (window > TCP_MAX_WND)
+        {
+            window = TCP_MAX_WND;
+        }
         tcbptr->rcvwnd = seqadd(tcbptr->rcvnxt, window);
         return window;
     }
 
     /* Receiver-side silly window syndrome avoidance */
     /* Calculate unsued portion of currently advertised window */
-    unused = (unsigned short)tcpSeqdiff(tcbptr->rcvwnd, tcbptr->rcvnxt);
+    unused = tcpSeqdiff(tcbptr->rcvwnd, tcbptr->rcvnxt);
 #ifdef TCP_FAKEACK
     if (seqlt(tcbptr->rcvwnd, tcbptr->rcvnxt))
     {
@@ -46,10 +53,11 @@ unsigned short tcpSendWindow(struct tcb *tcbptr)
     }
 #endif
     /* Use 0 if proposed window less than 1/4 buffer or less than 1 MSS */
-    if (((window * 4) < TCP_IBLEN) || (window < tcbptr->rcvmss))
+    if (((window * 4) < tcbptr->iblen) || (window < tcbptr->rcvmss))
     {
         window = 0;
     }
+    window &= ~((1 << tcbptr->rcvscale) - 1);
     /* If proposed win is greater than unused advertised win, use new size */
     if (window > unused)
     {
@@ -6,6 +6,7 @@
 
 #include <stddef.h>
 #include <clock.h>
+#include <memory.h>
 #include <network.h>
 #include <semaphore.h>
 #include <tcp.h>
@@ -32,11 +33,31 @@ int tcpSetup(struct tcb *tcbptr)
     /* Intialize connection semaphore */
     tcbptr->openclose = semcreate(0);
 
+    /* Allocate buffers, unless a listener being reopened kept them */
+    if (NULL == tcbptr->in)
+    {
+        tcbptr->in = memget(tcbptr->iblen);
+        if ((void *)SYSERR == tcbptr->in)
+        {
+            tcbptr->in = NULL;
+        }
+    }
+    if (NULL == tcbptr->out)
+    {
+        tcbptr->out = memget(tcbptr->oblen);
+        if ((void *)SYSERR == tcbptr->out)
+        {
+            tcbptr->out = NULL;
+        }
+    }
+
     /* Initialize input buffer */
     tcbptr->istart = 0;
     tcbptr->inxt = 0;
     tcbptr->icount = 0;
     tcbptr->ibytes = 0;
+    tcbptr->rcvnooo = 0;
+    tcbptr->rcvnack = 0;
     tcbptr->readers = semcreate(0);
 
     /* Initialize output buffer */
@@ -52,18 +73,30 @@ int tcpSetup(struct tcb *tcbptr)
     tcbptr->sndwl2 = tcbptr->iss;
     tcbptr->sndmss = TCP_INIT_MSS;
     tcbptr->sndflg = NULL;
-    tcbptr->sndcwn = tcbptr->sndmss;
-    tcbptr->sndsst = TCP_MAX_WND;
     tcbptr->rxttime = TCP_RXT_INITTIME;
     tcbptr->rxtcount = 0;
     tcbptr->psttime = TCP_PST_INITTIME;
+    tcbptr->sndnsack = 0;
+    tcbptr->sndndup = 0;
+    tcbptr->sndrecover = tcbptr->iss;
+    tcpcongtab[tcbptr->sndcc]->init(tcbptr);
 
     /* Initialize receive fields */
     tcbptr->rcvmss = TCP_INIT_MSS - TCP_HDR_LEN;
     tcbptr->rcvflg = NULL;
 
-    /* Verify creation of semaphores */
-    if ((SYSERR == (int)tcbptr->openclose)
+    /* Scale windows just enough to advertise the whole input buffer */
+    tcbptr->sndscale = 0;
+    tcbptr->rcvscale = 0;
+    while (((tcbptr->iblen >> tcbptr->rcvscale) > TCP_MAX_WND)
+           && (tcbptr->rcvscale < TCP_MAX_WSCALE))
+    {
+        tcbptr->rcvscale++;
+    }
+
+    /* Verify creation of buffers and semaphores */
+    if ((NULL == tcbptr->in) || (NULL == tcbptr->out)
+        || (SYSERR == (int)tcbptr->openclose)
         || (SYSERR == (int)tcbptr->readers)
         || (SYSERR == (int)tcbptr->writers))
     {
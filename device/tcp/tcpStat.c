@@ -25,6 +25,8 @@ void tcpStat(struct tcb *tcbptr)
     tcpseq rcvnxt, rcvwnd;
     tcpseq snduna, sndnxt;
     unsigned int sndwnd;
+    unsigned int sndcwn, sndsst;
+    unsigned char sndcc;
     unsigned int istart, icount, ibytes;
     unsigned int ostart, ocount, obytes;
     char strA[20];
@@ -53,6 +55,9 @@ void tcpStat(struct tcb *tcbptr)
     snduna = tcbptr->snduna;
     sndnxt = tcbptr->sndnxt;
     sndwnd = tcbptr->sndwnd;
+    sndcc = tcbptr->sndcc;
+    sndcwn = tcbptr->sndcwn;
+    sndsst = tcbptr->sndsst;
 
     istart = tcbptr->istart;
     icount = tcbptr->icount;
@@ -141,6 +146,9 @@ void tcpStat(struct tcb *tcbptr)
     printf("           ");
     printf("Snd Una: %-10u   Nxt: %-10u   Wnd: %-10u\n",
            snduna, sndnxt, sndwnd);
+    printf("           ");
+    printf("Cong: %-10s      Cwnd: %-10u  Ssthresh: %-10u\n",
+           tcpcongtab[sndcc]->name, sndcwn, sndsst);
 
     /* Buffers */
     printf("           ");
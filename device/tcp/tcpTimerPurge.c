@@ -5,8 +5,8 @@
 /* Embedded Xinu, Copyright (C) 2009, 2018.  All rights reserved. */
 
 #include <xinu.h>
-#include <semaphore.h>
 #include <tcp.h>
+#include <timer.h>
 
 /**
  * @ingroup tcp
@@ -19,33 +19,21 @@
  */
 xinu_devcall tcpTimerPurge(struct tcb *tcbptr, unsigned char type)
 {
-    struct tcpEvent *prev = NULL;
-    struct tcpEvent *cur = NULL;
     int result = SYSERR;
+    int elapsed;
+    int i;
 
-    wait(tcpmutex);
-    prev = &tcptimertab[TCP_EVT_HEAD];
-    cur = prev->next;
-    while (cur != NULL)
+    for (i = 0; i < TCP_NEVENTS; i++)
     {
-        if ((cur->tcbptr == tcbptr)
-            && ((NULL == type) || (cur->type == type)))
+        if ((NULL == type) || (type == i + 1))
         {
+            elapsed = timerCancel(&tcbptr->events[i].timer);
             if (SYSERR == result)
             {
-                result = cur->time - cur->remain;
+                result = elapsed;
             }
-            if (cur->next != NULL)
-            {
-                cur->next->remain += cur->remain;
-            }
-            prev->next = cur->next;
-            cur->used = FALSE;
         }
-        prev = cur;
-        cur = cur->next;
     }
-    signal(tcpmutex);
 
     return result;
 }
@@ -2,11 +2,11 @@
  * @file tcpTimerRemain.c
  *
  */
-/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+/* Embedded Xinu, Copyright (C) 2009, 2018.  All rights reserved. */
 
-#include <semaphore.h>
 #include <stddef.h>
 #include <tcp.h>
+#include <timer.h>
 
 /**
  * @ingroup tcp
@@ -18,22 +18,9 @@
  */
 int tcpTimerRemain(struct tcb *tcbptr, unsigned char type)
 {
-    struct tcpEvent *cur = NULL;
-    int time = 0;
-
-    wait(tcpmutex);
-    cur = tcptimertab[TCP_EVT_HEAD].next;
-    while (cur != NULL)
+    if ((type < 1) || (type > TCP_NEVENTS))
     {
-        time += cur->remain;
-        if ((cur->tcbptr == tcbptr) && (cur->type == type))
-        {
-            signal(tcpmutex);
-            return time;
-        }
-        cur = cur->next;
+        return 0;
     }
-    signal(tcpmutex);
-
-    return 0;
+    return timerRemain(&tcbptr->events[type - 1].timer);
 }
@@ -5,93 +5,44 @@
 /* Embedded Xinu, Copyright (C) 2009, 2018.  All rights reserved. */
 
 #include <xinu.h>
-#include <semaphore.h>
 #include <tcp.h>
+#include <timer.h>
 
-static int allocEvent(void);
+/* Hand a fired timer to the TCP event handler */
+static void tcpTimerFire(void *arg)
+{
+    struct tcpEvent *evtptr = arg;
+
+    tcpTimerTrigger(evtptr->type, evtptr->tcbptr);
+}
 
 /**
  * @ingroup tcp
  *
- * Schedule TCP timer events.
- * @param time milliseconds before timer triggers
- * @param tcbptr TCB with which event is associated
+ * Schedules a TCP timer event, moving it if it is already pending.
+ * @param time milliseconds until the event occurs
+ * @param tcbptr TCB for which the event is scheduled
  * @param type type of timer event
- * @return OK if event is successfully scheduled, otherwise SYSERR
+ * @return OK if the event was scheduled, otherwise SYSERR
  */
 xinu_devcall tcpTimerSched(int time, struct tcb *tcbptr, unsigned char type)
 {
-    int evt = 0;
-    struct tcpEvent *evtptr = NULL;
-    struct tcpEvent *prev = NULL;
-    struct tcpEvent *next = NULL;
+    struct tcpEvent *evtptr;
 
     /* Verify parameters */
-    if ((time < 0) || (NULL == tcbptr))
+    if ((time < 0) || (NULL == tcbptr) || (type < 1)
+        || (type > TCP_NEVENTS))
     {
         return SYSERR;
     }
 
-    wait(tcpmutex);
-    /* Setup timer event */
-    evt = allocEvent();
-    if (SYSERR == evt)
-    {
-        signal(tcpmutex);
-        return SYSERR;
-    }
-    evtptr = &tcptimertab[evt];
-    evtptr->time = time;
+    /* Events are wiped along with the rest of a freed TCB, so bind the
+     * timer afresh each time */
+    evtptr = &tcbptr->events[type - 1];
+    timerCancel(&evtptr->timer);
+    timerSetup(&evtptr->timer, tcpTimerFire, evtptr);
     evtptr->type = type;
     evtptr->tcbptr = tcbptr;
 
-    /* Insert event into delta queue */
-    prev = &tcptimertab[TCP_EVT_HEAD];
-    next = prev->next;
-    while ((next != NULL) && (next->remain <= time))
-    {
-        time -= next->remain;
-        prev = next;
-        next = next->next;
-    }
-    evtptr->next = next;
-    prev->next = evtptr;
-    evtptr->remain = time;
-    if (next != NULL)
-    {
-        next->remain -= time;
-    }
-    signal(tcpmutex);
-
-    return OK;
-}
-
-/**
- * Allocate an unused timer event block
- * @return index to used block, or SYSERR if none exist
- * @precondition TCP Timer mutex is already held
- * @postcondition TCP Timer mutex is still held
- */
-static int allocEvent(void)
-{
-    int evt;
-    static int nextevt = 0;
-
-    /* Check all TCP timer event slots (except the head) */
-    for (evt = 0; evt < TCP_NEVENTS; evt++)
-    {
-        nextevt = (nextevt + 1) % TCP_NEVENTS;
-        /* Ignore head */
-        if (TCP_EVT_HEAD == nextevt)
-        {
-            continue;
-        }
-        if (FALSE == tcptimertab[nextevt].used)
-        {
-            tcptimertab[nextevt].used = TRUE;
-            return nextevt;
-        }
-    }
-    return SYSERR;
-
+    return timerSched(&evtptr->timer, time);
 }
@@ -2,7 +2,7 @@
  * @file tcpTimerTrigger.c
  *
  */
-/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+/* Embedded Xinu, Copyright (C) 2009, 2018.  All rights reserved. */
 
 #include <semaphore.h>
 #include <stddef.h>
@@ -28,5 +28,13 @@ void tcpTimerTrigger(unsigned char type, struct tcb *tcbptr)
     case TCP_EVT_PERSIST:
         tcpSendPersist(tcbptr);
         return;
+    case TCP_EVT_DELACK:
+        wait(tcbptr->mutex);
+        if (tcbptr->rcvnack > 0)
+        {
+            tcpSendAck(tcbptr);
+        }
+        signal(tcbptr->mutex);
+        return;
     }
 }
@@ -55,16 +55,16 @@ xinu_devcall tcpWrite (device *devptr, const void *buf, unsigned int len)
             return check;
         }
 
-        while ((tcbptr->ocount < TCP_OBLEN) && (count < len))
+        while ((tcbptr->ocount < tcbptr->oblen) && (count < len))
         {
             ch = *buffer++;
-            tcbptr->out[((tcbptr->ostart + tcbptr->ocount) % TCP_OBLEN)] =
+            tcbptr->out[((tcbptr->ostart + tcbptr->ocount) % tcbptr->oblen)] =
                 ch;
             tcbptr->ocount++;
             count++;
         }
         /* If space remains, another writer can write */
-        if (tcbptr->ocount < TCP_OBLEN)
+        if (tcbptr->ocount < tcbptr->oblen)
         {
             signal(tcbptr->writers);
         }
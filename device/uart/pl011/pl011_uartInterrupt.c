@@ -55,9 +55,13 @@ interrupt pl011_uartInterrupt (void)
 {
     /* Set resdefer to prevent other threads from being scheduled before this
      * interrupt handler finishes.  This prevents this interrupt handler from
-     * being executed re-entrantly.  */
-    extern int resdefer;
-    resdefer = 1;
+     * being executed re-entrantly.  The platform's dispatcher may already be
+     * deferring rescheduling until all pending interrupts are handled.  */
+    bool defer = (0 == resdefer[getcpuid()]);
+    if (defer)
+    {
+        resdefer[getcpuid()] = 1;
+    }
 
     /* Check for interrupts on each UART.  Note: this assumes all the UARTs in
      * 'uarttab' are PL011 UARTs.  */
@@ -177,9 +181,9 @@ interrupt pl011_uartInterrupt (void)
 
     /* Now that the UART interrupt handler is finished, we can safely wake up
      * any threads that were signaled.  */
-    if (--resdefer > 0)
+    if (defer && --resdefer[getcpuid()] > 0)
     {
-        resdefer = 0;
+        resdefer[getcpuid()] = 0;
         resched();
     }
 }
@@ -27,8 +27,8 @@ void pl011_uartKickTx (struct uart * uartptr)
 		if (uartptr->ostart >= UART_OBLEN) uartptr->ostart = 0;
 		uartptr->ocount--;
 		uartptr->cout += 1;
-		signaln(uartptr->osema, 1);
 
 		EXIT_KERNEL_CRITICAL_SECTION();
+		signaln(uartptr->osema, 1);
 	}
 }
@@ -55,8 +55,11 @@ xinu_devcall uartRead (device *devptr, void *buf, unsigned int len)
         }
 
         /* Wait for there to be at least one byte in the input buffer from the
-         * lower half (interrupt handler), then remove it.  */
+         * lower half (interrupt handler), then remove it.  The kernel lock
+         * is not held across the wait.  */
+        EXIT_KERNEL_CRITICAL_SECTION();
         wait(uartptr->isema);
+        ENTER_KERNEL_CRITICAL_SECTION();
         c = uartptr->in[uartptr->istart];
         ((unsigned char*)buf)[count] = c;
         uartptr->icount--;
@@ -65,7 +68,9 @@ xinu_devcall uartRead (device *devptr, void *buf, unsigned int len)
         /* If the UART is in echo mode, echo the byte back to the UART.  */
         if (uartptr->iflags & UART_IFLAG_ECHO)
         {
-			uartWrite(uartptr->dev, &c, 1);
+            EXIT_KERNEL_CRITICAL_SECTION();
+            uartWrite(uartptr->dev, &c, 1);
+            ENTER_KERNEL_CRITICAL_SECTION();
         }
     }
 
@@ -64,7 +64,9 @@ xinu_devcall uartWrite (device *devptr, const void *buf, unsigned int len)
 			break;
 		}      
 		/* Wait for semaphore to become free .. if blocked thread will sleep in there */
+		EXIT_KERNEL_CRITICAL_SECTION();
 		wait(uartptr->osema);
+		ENTER_KERNEL_CRITICAL_SECTION();
         uartptr->out[(uartptr->ostart + uartptr->ocount) % UART_OBLEN] = inbuf[count];
 		uartptr->ocount++;										// Increment output count
     }
@@ -23,24 +23,8 @@
 unsigned short udpChksum(struct packet *pkt, unsigned short len, const struct netaddr *src,
                  const struct netaddr *dst)
 {
-
-    struct udpPseudoHdr *pseu;
-    struct udpPseudoHdr temp;
-    unsigned short sum;
-
-    pseu = ((struct udpPseudoHdr *)(pkt->curr)) - 1;
-    memcpy(&temp, pseu, sizeof(struct udpPseudoHdr));
-
-    /* Generate UDP pseudo header */
-	memcpy(pseu->srcIp, src->addr, IPv4_ADDR_LEN);
-	memcpy(pseu->dstIp, dst->addr, IPv4_ADDR_LEN);
-    pseu->zero = 0;
-    pseu->proto = IPv4_PROTO_UDP;
-    pseu->len = hs2net(len);
-
-    sum = netChksum(pseu, len + sizeof(struct udpPseudoHdr));
-
-	memcpy(pseu, &temp, sizeof(struct udpPseudoHdr));
-
-    return sum;
+    return netChksumFold(netChksumPartial(pkt->curr, len,
+                                          netChksumPseudo(src, dst,
+                                                          IPv4_PROTO_UDP,
+                                                          len)));
 }
@@ -44,6 +44,16 @@ xinu_devcall udpClose(device *devptr)
         return SYSERR;
     }
 
+    udpHashRemove(udpptr);
+
+    /* Free datagrams nobody read, as some may not be from the pool */
+    while (udpptr->icount > 0)
+    {
+        udpFreebuf(udpptr->in[udpptr->istart]);
+        udpptr->istart = (udpptr->istart + 1) % UDP_MAX_PKTS;
+        udpptr->icount--;
+    }
+
     /* Free the in buffer pool */
     bfpfree(udpptr->inPool);
 
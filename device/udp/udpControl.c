@@ -9,6 +9,7 @@
 #include <device.h>
 #include <network.h>
 #include <udp.h>
+#include <CriticalSection.h>
 
 /**
  * @ingroup udpexternal
@@ -24,6 +25,7 @@ xinu_devcall udpControl(device *devptr, int func, long arg1, long arg2)
 {
     struct udp *udpptr;
     unsigned char old;
+    int result = OK;
 
     udpptr = &udptab[devptr->minor];
 
@@ -31,18 +33,27 @@ xinu_devcall udpControl(device *devptr, int func, long arg1, long arg2)
     {
     case UDP_CTRL_ACCEPT:
         /* arg1 is port and arg2 is pointer to netaddr */
+		ENTER_KERNEL_CRITICAL_SECTION();
+        udpHashRemove(udpptr);
         udpptr->localpt = arg1;
         if (NULL == arg2)
         {
-            return SYSERR;
+            result = SYSERR;
         }
         else
         {
             netaddrcpy(&(udpptr->localip), (struct netaddr *)arg2);
         }
-        return OK;
+        if (UDP_OPEN == udpptr->state)
+        {
+            udpHashInsert(udpptr);
+        }
+		EXIT_KERNEL_CRITICAL_SECTION();
+        return result;
     case UDP_CTRL_BIND:
         /* arg1 is port and arg2 is pointer to netaddr */
+		ENTER_KERNEL_CRITICAL_SECTION();
+        udpHashRemove(udpptr);
         udpptr->remotept = arg1;
         if (NULL == arg2)
         {
@@ -52,6 +63,11 @@ xinu_devcall udpControl(device *devptr, int func, long arg1, long arg2)
         {
             netaddrcpy(&(udpptr->remoteip), (struct netaddr *)arg2);
         }
+        if (UDP_OPEN == udpptr->state)
+        {
+            udpHashInsert(udpptr);
+        }
+		EXIT_KERNEL_CRITICAL_SECTION();
         return OK;
     case UDP_CTRL_CLRFLAG:
         /* arg1 is the flag we are clearing */
@@ -7,15 +7,14 @@
 #include <xinu.h>
 #include <udp.h>
 
-#define NO_MATCH      0
-#define DEST_MATCH    1
-#define PARTIAL_MATCH 2
-#define FULL_MATCH    3
-
 /**
  * @ingroup udpinternal
  *
- * Locate the UDP socket for a UDP packet
+ * Locate the UDP socket for a UDP packet.  A socket bound to the packet's
+ * full 4-tuple is found in the connection table; otherwise the listen table
+ * is searched by destination port, preferring a socket bound to the source
+ * port over one bound only to the local socket.  Only the packet's own
+ * buckets are examined, so the cost does not grow with ::NUDP.
  * @param dstpt destination port of the UDP packet
  * @param srcpt source port of the UDP packet
  * @param dstip destination IP of the UDP packet
@@ -27,56 +26,44 @@
 struct udp *udpDemux(unsigned short dstpt, unsigned short srcpt, const struct netaddr *dstip,
                      const struct netaddr *srcip)
 {
-    struct udp *udpptr = NULL;
-    unsigned int i;
-    unsigned int match = NO_MATCH;
+    struct udp *udpptr;
+    struct udp *best = NULL;
 
-    /* Cycle through all udp devices to find the best match */
-    for (i = 0; i < NUDP; i++)
+    /* Full match is the best */
+    for (udpptr = udphash[udpHashConn(dstpt, srcpt, srcip)]; NULL != udpptr;
+         udpptr = udpptr->hnext)
     {
-        if (udptab[i].state == UDP_FREE)
-        {
-            /* skip this entry */
-            continue;
-        }
-        if (!netaddrequal(&udptab[i].localip, dstip))
+        if ((udpptr->localpt == dstpt)
+            && (udpptr->remotept == srcpt)
+            && (netaddrequal(&udpptr->localip, dstip))
+            && (netaddrequal(&udpptr->remoteip, srcip)))
         {
-            /* entry is not bound to the destination */
-            continue;
+            return udpptr;
         }
+    }
 
-        /* Full match is the best */
-        if (match < FULL_MATCH
-            && (udptab[i].localpt == dstpt)
-            && (udptab[i].remotept == srcpt)
-            && (netaddrequal(&udptab[i].remoteip, srcip)))
+    for (udpptr = udphash[udpHashListen(dstpt)]; NULL != udpptr;
+         udpptr = udpptr->hnext)
+    {
+        if ((udpptr->localpt != dstpt)
+            || (udpptr->remoteip.type != NULL)
+            || (!netaddrequal(&udpptr->localip, dstip)))
         {
-            udpptr = &udptab[i];
-            match = FULL_MATCH;
-            /* you can't beat a full match */
-            break;
+            continue;
         }
 
         /* Src and dst ports match is second */
-        if (match < PARTIAL_MATCH
-            && (udptab[i].localpt == dstpt)
-            && (udptab[i].remotept == srcpt)
-            && (udptab[i].remoteip.type == NULL))
+        if (udpptr->remotept == srcpt)
         {
-            udpptr = &udptab[i];
-            match = PARTIAL_MATCH;
+            return udpptr;
         }
 
         /* Dst ports match is last */
-        if (match < DEST_MATCH
-            && (udptab[i].localpt == dstpt)
-            && (udptab[i].remotept == NULL)
-            && (udptab[i].remoteip.type == NULL))
+        if ((NULL == best) && (udpptr->remotept == NULL))
         {
-            udpptr = &udptab[i];
-            match = DEST_MATCH;
+            best = udpptr;
         }
     }
 
-    return udpptr;
+    return best;
 }
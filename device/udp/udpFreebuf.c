@@ -6,13 +6,24 @@
 
 #include <xinu.h>
 #include <bufpool.h>
+#include <memory.h>
 #include <network.h>
 #include <udp.h>
 
 /**
  * @ingroup udpinternal
+ *
+ * Free a buffer from udpGetbuf().  The length in the pseudo-header at its
+ * start tells whether it came from the socket's pool, so it must be set.
  */
 xinu_syscall udpFreebuf(struct udpPkt *udppkt)
 {
+    const struct udpPseudoHdr *pseudo = (const struct udpPseudoHdr *)udppkt;
+    unsigned int len = sizeof(struct udpPseudoHdr) + pseudo->len;
+
+    if (len > UDP_INBUF_LEN)
+    {
+        return memfree(udppkt, len);
+    }
     return buffree(udppkt);
 }
@@ -6,24 +6,46 @@
 
 #include <xinu.h>
 #include <bufpool.h>
+#include <memory.h>
 #include <network.h>
-#include <stdlib.h>
 #include <udp.h>
 
 /**
  * @ingroup udpinternal
+ *
+ * Get a buffer to hold a received datagram.  The buffer is not cleared,
+ * since udpRecv() writes every octet that udpRead() later reads.  This never
+ * waits, since udpRecv() calls it inside a kernel critical section; as no
+ * thread waits on the pool, udpFreebuf() never reschedules either.
+ *
+ * Most datagrams fit the socket's pool.  A larger one, as IPv4 may
+ * reassemble, gets memory of its own, so sockets need not reserve that
+ * much for every datagram they queue.
+ *
+ * @param udpptr
+ *      UDP socket the datagram is for.
+ * @param len
+ *      Length of the datagram including the pseudo-header it is stored
+ *      behind.
+ * @return
+ *      The buffer, or ::SYSERR if none is free.
  */
-struct udpPkt *udpGetbuf(struct udp *udpptr)
+struct udpPkt *udpGetbuf(struct udp *udpptr, unsigned int len)
 {
     struct udpPkt *udppkt = NULL;
 
-    udppkt = bufget(udpptr->inPool);
+    if (len > UDP_INBUF_LEN)
+    {
+        udppkt = memget(len);
+    }
+    else
+    {
+        udppkt = bufget_nowait(udpptr->inPool);
+    }
     if (SYSERR == (int)udppkt)
     {
         return (struct udpPkt *)SYSERR;
     }
 
-    bzero(udppkt, NET_MAX_PKTLEN);
-
     return udppkt;
 }
@@ -0,0 +1,38 @@
+/**
+ * @file udpHashInsert.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <CriticalSection.h>
+#include <udp.h>
+
+/**
+ * @ingroup udpinternal
+ *
+ * Add a UDP socket to the demux hash.  A socket bound to a remote port and
+ * IP goes in the connection table, others in the listen table by local
+ * port.  Its ports and addresses must not change until it is removed.
+ * @param udpptr pointer to the UDP control block
+ */
+void udpHashInsert(struct udp *udpptr)
+{
+    unsigned int slot;
+
+    if ((0 != udpptr->remotept) && (0 != udpptr->remoteip.type))
+    {
+        slot = udpHashConn(udpptr->localpt, udpptr->remotept,
+                           &udpptr->remoteip);
+    }
+    else
+    {
+        slot = udpHashListen(udpptr->localpt);
+    }
+
+	ENTER_KERNEL_CRITICAL_SECTION();
+    udpptr->hnext = udphash[slot];
+    udphash[slot] = udpptr;
+    udpptr->hslot = slot + 1;
+	EXIT_KERNEL_CRITICAL_SECTION();
+}
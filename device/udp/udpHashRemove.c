@@ -0,0 +1,37 @@
+/**
+ * @file udpHashRemove.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <CriticalSection.h>
+#include <udp.h>
+
+/**
+ * @ingroup udpinternal
+ *
+ * Take a UDP socket out of the demux hash, if it is in it.
+ * @param udpptr pointer to the UDP control block
+ */
+void udpHashRemove(struct udp *udpptr)
+{
+    struct udp **link;
+
+	ENTER_KERNEL_CRITICAL_SECTION();
+    if (0 != udpptr->hslot)
+    {
+        for (link = &udphash[udpptr->hslot - 1]; NULL != *link;
+             link = &(*link)->hnext)
+        {
+            if (*link == udpptr)
+            {
+                *link = udpptr->hnext;
+                break;
+            }
+        }
+        udpptr->hnext = NULL;
+        udpptr->hslot = 0;
+    }
+	EXIT_KERNEL_CRITICAL_SECTION();
+}
@@ -10,6 +10,7 @@
 #include <udp.h>
 
 struct udp udptab[NUDP];
+struct udp *udphash[2 * UDP_NHASH];     /* Connection, then listen table */
 
 /**
  * @ingroup udpexternal
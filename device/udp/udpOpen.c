@@ -106,7 +106,7 @@ xinu_devcall udpOpen(device *devptr, va_list ap)
     udpptr->remotept = remotept;
 
     /* Allocate received UDP packet buffer pool */
-    udpptr->inPool = bfpalloc(NET_MAX_PKTLEN, UDP_MAX_PKTS);
+    udpptr->inPool = bfpalloc(UDP_INBUF_LEN, UDP_MAX_PKTS);
     if (SYSERR == (int)udpptr->inPool)
     {
         retval = SYSERR;
@@ -116,6 +116,7 @@ xinu_devcall udpOpen(device *devptr, va_list ap)
               devptr->minor, udpptr->inPool);
 
     udpptr->flags = 0;
+    udpHashInsert(udpptr);
 
     retval = OK;
     goto out_restore;
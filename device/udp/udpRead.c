@@ -63,8 +63,11 @@ xinu_devcall udpRead(device *devptr, void *buf, unsigned int len)
         return 0;
     }
 
-    /* Wait for a UDP packet to be available.  */
+    /* Wait for a UDP packet to be available.  The kernel lock is not held
+     * across the wait.  */
+    EXIT_KERNEL_CRITICAL_SECTION();
     wait(udpptr->isem);
+    ENTER_KERNEL_CRITICAL_SECTION();
 
     /* Make sure the UDP device wasn't closed while waiting for a packet.  */
     if (UDP_OPEN != udpptr->state)
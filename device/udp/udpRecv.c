@@ -43,8 +43,18 @@ xinu_syscall udpRecv(struct packet *pkt, const struct netaddr *src,
         return SYSERR;
     }
 
-    /* Calculate optional checksum */
+    /* Sockets hold up to the largest datagram IPv4 will reassemble */
+    if (net2hs(udppkt->len) + sizeof(struct udpPseudoHdr) > UDP_MAX_PKTLEN)
+    {
+        UDP_TRACE("UDP packet too large for input buffer.");
+        netFreebuf(pkt);
+        return SYSERR;
+    }
+
+    /* Calculate optional checksum, from the device's sum if it has one */
     if ((udppkt->chksum)
+        && !ipv4ChksumRecv(pkt, src, dst, IPv4_PROTO_UDP,
+                           net2hs(udppkt->len))
         && (0 != udpChksum(pkt, net2hs(udppkt->len), src, dst)))
     {
         UDP_TRACE("Invalid UDP checksum.");
@@ -96,14 +106,16 @@ xinu_syscall udpRecv(struct packet *pkt, const struct netaddr *src,
      * and clear the flag */
     if (UDP_FLAG_BINDFIRST & udpptr->flags)
     {
+        udpHashRemove(udpptr);
         udpptr->remotept = udppkt->srcPort;
         netaddrcpy(&(udpptr->localip), dst);
         netaddrcpy(&(udpptr->remoteip), src);
+        udpHashInsert(udpptr);
         udpptr->flags &= ~UDP_FLAG_BINDFIRST;
     }
 
     /* Get some buffer space to store the packet */
-    tpkt = udpGetbuf(udpptr);
+    tpkt = udpGetbuf(udpptr, sizeof(struct udpPseudoHdr) + udppkt->len);
 
     if (SYSERR == (int)tpkt)
     {
@@ -7,6 +7,7 @@
 #include <xinu.h>
 #include <ipv4.h>
 #include <network.h>
+#include <route.h>
 #include <string.h>
 #include <udp.h>
 
@@ -47,6 +48,8 @@ xinu_syscall udpSend(struct udp *udpptr, unsigned short datalen, const void *buf
     struct packet *pkt;
     struct udpPkt *udppkt;
     struct netaddr localip, remoteip;
+    struct rtEntry *rtptr;
+    uint32_t sum;
     int result;
 
     pkt = netGetbuf();
@@ -90,6 +93,10 @@ xinu_syscall udpSend(struct udp *udpptr, unsigned short datalen, const void *buf
             netFreebuf(pkt);
             return SYSERR;
         }
+
+        /* Leave UDP checksum for the network device, or ipv4Send() */
+        udppkt->chksum = netChksumOffload(pkt, &localip, &remoteip,
+                                          IPv4_PROTO_UDP, datalen);
     }
     else
     {
@@ -107,12 +114,28 @@ xinu_syscall udpSend(struct udp *udpptr, unsigned short datalen, const void *buf
         udppkt->len = hs2net(pkt->len);
         udppkt->chksum = 0;
 
-        memcpy(udppkt->data, buf, datalen - UDP_HDR_LEN);
+        /* Leave the checksum to a network device that can fill it in.
+         * Otherwise sum the payload as it is copied, then add header and
+         * pseudo header to it */
+        rtptr = rtLookup(&remoteip);
+        if ((NULL != rtptr) && (SYSERR != (int)rtptr)
+            && (rtptr->nif->offload & NET_CSUM_TX))
+        {
+			memcpy(udppkt->data, buf, datalen - UDP_HDR_LEN);
+            udppkt->chksum = netChksumOffload(pkt, &localip, &remoteip,
+                                              IPv4_PROTO_UDP, datalen);
+        }
+        else
+        {
+            sum = netChksumCopy(udppkt->data, buf, datalen - UDP_HDR_LEN,
+                                netChksumPseudo(&localip, &remoteip,
+                                                IPv4_PROTO_UDP, datalen));
+            udppkt->chksum = netChksumFold(netChksumPartial(udppkt,
+                                                            UDP_HDR_LEN,
+                                                            sum));
+        }
     }
 
-    /* Calculate UDP checksum (which happens to be the same as TCP's) */
-    udppkt->chksum = udpChksum(pkt, datalen, &localip, &remoteip);
-
     /* Send the UDP packet through IP */
     result = ipv4Send(pkt, &localip, &remoteip, IPv4_PROTO_UDP);
 
@@ -73,6 +73,7 @@
 #include <interrupt.h>
 #include <CriticalSection.h>
 #include <mailbox.h>
+#include <mmu.h>
 #include <string.h>
 #include <thread.h>
 #include <usb_core_driver.h>
@@ -90,6 +91,13 @@ extern uint32_t RPi_ARM_TO_GPU_Alias;								// Defined in start.S
 /** Determines whether a pointer is word-aligned or not.  */
 #define IS_WORD_ALIGNED(ptr) ((unsigned long)(ptr) % sizeof(unsigned long) == 0)
 
+/** Determines whether the hardware can DMA straight to or from a buffer.  The
+ * DMA engine needs word alignment; an IN buffer must also own whole cache
+ * lines, so that invalidating it cannot throw away data next to it.  */
+#define CAN_DMA_DIRECT(ptr, size, dir) \
+    (((dir) == USB_DIRECTION_OUT) ? IS_WORD_ALIGNED(ptr) : \
+     (iscachealigned(ptr) && iscachealigned(size)))
+
 /** Pointer to the memory-mapped registers of the Synopsys DesignWare Hi-Speed
  * USB 2.0 OTG Controller.  */
  /* Synopsys DesignWare Hi-Speed USB 2.0 On-The-Go Controller  */      
@@ -102,6 +110,13 @@ extern uint32_t RPi_ARM_TO_GPU_Alias;								// Defined in start.S
  */
 #define USB2_MAX_PACKET_SIZE 1024
 
+/**
+ * Size of each channel's DMA buffer.  Large enough for a whole receive burst
+ * from either Ethernet chip found on the Raspberry Pi, so that segmented and
+ * unaligned transfers still take one programming of the channel.
+ */
+#define DWC_BOUNCE_SIZE (20 * 1024)
+
 
 /**
  * Stack size of USB transfer request scheduler thread (can be fairly small).
@@ -179,9 +194,14 @@ static struct usb_port_status host_port_status;
  */
 static struct usb_xfer_request *channel_pending_xfers[DWC_NUM_CHANNELS];
 
-/* Aligned buffers for DMA which need to also be multiple of 4 bytes */
-/* Fortunately max packet size under USB2 is 1024 so that is a given */
-static uint8_t aligned_bufs[DWC_NUM_CHANNELS][USB2_MAX_PACKET_SIZE] __aligned(4);
+/* Aligned buffers for DMA, in uncached memory so the CPU and the DMA engine
+ * see the same contents without cache maintenance.  Unaligned and segmented
+ * transfers go through these, DWC_BOUNCE_SIZE bytes at a time.  Allocated by
+ * hcd_start().  */
+static uint8_t *aligned_bufs[DWC_NUM_CHANNELS];
+
+/* Whether the transfer on each channel goes through its aligned buffer */
+static bool channel_bounced[DWC_NUM_CHANNELS];
 
 /***************************************************************************}
 {                PRIVATE INTERNAL CONSTANT DEFINITIONS                      }
@@ -321,8 +341,8 @@ static inline unsigned int first_set_bit(uint32_t word)
 static unsigned int dwc_get_free_channel(void)
 {
 	unsigned int chan;
+	wait(chfree_sema);												// We are blocked if count == 0 AKA no free channels
 	ENTER_KERNEL_CRITICAL_SECTION();								// Entering a critical section
-	wait(chfree_sema);												// We are blocked if count == 0 AKA no free channels									
 	chan = first_set_bit(chfree);									// Find the first free channel .. there must be one because of above
 	chfree &= ~((uint32_t)1 << chan);								// Mark the channel as no longer free										
 	EXIT_KERNEL_CRITICAL_SECTION();									// Exit the critical section
@@ -336,8 +356,8 @@ static void dwc_release_channel(unsigned int chan)
 {
 	ENTER_KERNEL_CRITICAL_SECTION();								// Entering a critical section
 	chfree |= ((uint32_t)1 << chan);								// Mark channel as free
-	signal(chfree_sema);											// Increment the semaphore
 	EXIT_KERNEL_CRITICAL_SECTION();									// Exit the critical section
+	signal(chfree_sema);											// Increment the semaphore, never under the kernel lock
 }
 
 /*-[INTERNAL: dwc_soft_reset ]-----------------------------------------------
@@ -698,6 +718,52 @@ static void dwc_process_root_hub_request (struct usb_xfer_request *req)
 /*-[INTERNAL: dwc_channel_start_transaction ]--------------------------------
 . Starts a low-level transaction on the USB.
 .--------------------------------------------------------------------------*/
+/**
+ * Copies between a segmented transfer's buffers and a channel's DMA buffer.
+ *
+ * @param req
+ *      USB transfer with buffer segments.
+ * @param offset
+ *      Offset of the copy into the data of the whole transfer.
+ * @param dmabuf
+ *      DMA buffer of the channel.
+ * @param len
+ *      Number of bytes to copy.
+ * @param dir
+ *      USB_DIRECTION_OUT to gather the segments into @p dmabuf, or
+ *      USB_DIRECTION_IN to scatter @p dmabuf over the segments.
+ */
+static void dwc_copy_segments(const struct usb_xfer_request *req,
+                              unsigned int offset, uint8_t *dmabuf,
+                              unsigned int len, enum usb_direction dir)
+{
+    const struct usb_xfer_segment *seg = req->segs;
+    const struct usb_xfer_segment *end = req->segs + req->nsegs;
+    unsigned int n;
+
+    /* Skip the segments already transferred.  */
+    while (seg < end && offset >= seg->len)
+    {
+        offset -= seg->len;
+        seg++;
+    }
+    for (; seg < end && len > 0; seg++)
+    {
+        n = min(seg->len - offset, len);
+        if (dir == USB_DIRECTION_OUT)
+        {
+            memcpy(dmabuf, (uint8_t*)seg->buf + offset, n);
+        }
+        else
+        {
+            memcpy((uint8_t*)seg->buf + offset, dmabuf, n);
+        }
+        dmabuf += n;
+        len -= n;
+        offset = 0;
+    }
+}
+
 static void dwc_channel_start_transaction (unsigned int chan, struct usb_xfer_request *req)
 {
     volatile struct dwc_host_channel *chanptr = &regs->host_channels[chan];
@@ -761,6 +827,7 @@ static void dwc_channel_start_xfer (unsigned int chan, struct usb_xfer_request *
     split_control.val = 0;
     transfer.val = 0;
     req->short_attempt = 0;
+    req->cur_offset = 0;
 
     /* Determine the endpoint number, endpoint type, maximum packet size, and
      * packets per frame.  */
@@ -814,6 +881,7 @@ static void dwc_channel_start_xfer (unsigned int chan, struct usb_xfer_request *
                 /* We need to carefully take into account that we might be
                  * re-starting a partially complete transfer.  */
                 data = req->recvbuf + req->actual_size;
+                req->cur_offset = req->actual_size;
                 transfer.size = req->size - req->actual_size;
                 if (req->actual_size == 0)
                 {
@@ -858,8 +926,10 @@ static void dwc_channel_start_xfer (unsigned int chan, struct usb_xfer_request *
 
         /* As is the case for the DATA phase of control transfers, we need to
          * carefully take into account that we might be restarting a partially
-         * complete transfer.  */
-        data = req->recvbuf + req->actual_size;
+         * complete transfer.  A segmented transfer has no single buffer;
+         * its data always goes through the channel's DMA buffer.  */
+        req->cur_offset = req->actual_size;
+        data = (req->nsegs > 0) ? NULL : req->recvbuf + req->actual_size;
         transfer.size = req->size - req->actual_size;
         /* This hardware does not accept interrupt transfers started with more
          * data than fits in one (micro)frame--- that is, the maximum packets
@@ -915,37 +985,54 @@ static void dwc_channel_start_xfer (unsigned int chan, struct usb_xfer_request *
     }
 
     /* Set up DMA buffer.  */
-    if (IS_WORD_ALIGNED(data))
+    if (req->nsegs == 0 &&
+        CAN_DMA_DIRECT(data, transfer.size,
+                       characteristics.endpoint_direction))
     {
-        /* Can DMA directly from source or to destination if word-aligned.  */
+        /* Can DMA directly from source or to destination.  Write the data to
+         * send out of the cache, or drop stale lines over the destination so
+         * none are evicted on top of what the hardware writes.  */
         chanptr->dma_address = (uint32_t)data | RPi_ARM_TO_GPU_Alias;
+        channel_bounced[chan] = FALSE;
+        if (characteristics.endpoint_direction == USB_DIRECTION_OUT)
+        {
+            dcacheClean(data, transfer.size);
+        }
+        else
+        {
+            dcacheInvalidate(data, transfer.size);
+        }
     }
     else
     {
         /* Need to use alternate buffer for DMA, since the actual source or
-         * destination is not word-aligned.  If the attempted transfer size
-         * overflows this alternate buffer, cap it to the greatest number of
-         * whole packets that fit.  */
+         * destination is not suitably aligned or is split over segments.  If
+         * the attempted transfer size overflows this alternate buffer, cap it
+         * to the greatest number of whole packets that fit.  */
         chanptr->dma_address = (uint32_t)aligned_bufs[chan] | RPi_ARM_TO_GPU_Alias;
-        if (transfer.size > sizeof(aligned_bufs[chan]))
+        channel_bounced[chan] = TRUE;
+        if (transfer.size > DWC_BOUNCE_SIZE)
         {
-            transfer.size = sizeof(aligned_bufs[chan]) -
-                            (sizeof(aligned_bufs[chan]) %
+            transfer.size = DWC_BOUNCE_SIZE -
+                            (DWC_BOUNCE_SIZE %
                               characteristics.max_packet_size);
             req->short_attempt = 1;
         }
         /* For OUT endpoints, copy the data to send into the DMA buffer.  */
         if (characteristics.endpoint_direction == USB_DIRECTION_OUT)
         {
-			memcpy(aligned_bufs[chan], data, transfer.size);
+            if (req->nsegs > 0)
+            {
+                dwc_copy_segments(req, req->cur_offset, aligned_bufs[chan],
+                                  transfer.size, USB_DIRECTION_OUT);
+            }
+            else
+            {
+                memcpy(aligned_bufs[chan], data, transfer.size);
+            }
         }
     }
 
-    /* Set pointer to start of next chunk of data to send/receive (may be
-     * different from the actual DMA address to be used by the hardware if an
-     * alternate buffer was selected above).  */
-    req->cur_data_ptr = data;
-
     /* Calculate the number of packets being set up for this transfer.  */
     transfer.packet_count = DIV_ROUND_UP(transfer.size,
                                          characteristics.max_packet_size);
@@ -1036,19 +1123,21 @@ static thread defer_xfer_thread(struct usb_xfer_request *req)
  
             usb_dev_debug(req->dev, "Waiting for start-of-frame\r\n");
 
-			ENTER_KERNEL_CRITICAL_SECTION();
             chan = dwc_get_free_channel();
+            ENTER_KERNEL_CRITICAL_SECTION();
             channel_pending_xfers[chan] = req;
             sofwait |= 1 << chan;
             intr_mask = regs->core_interrupt_mask;
             intr_mask.sof_intr = 1;
             regs->core_interrupt_mask = intr_mask;
+            EXIT_KERNEL_CRITICAL_SECTION();
 
+            /* The SOF interrupt may already have sent the message, in
+             * which case this returns at once.  */
             receive();
 
             dwc_channel_start_xfer(chan, req);
             req->need_sof = 0;
-			EXIT_KERNEL_CRITICAL_SECTION();
         }
         else
 #endif /* START_SPLIT_INTR_TRANSFERS_ON_SOF */
@@ -1170,13 +1259,28 @@ static enum dwc_intr_status dwc_handle_normal_channel_halted(struct usb_xfer_req
              * impossible to determine the length of short packets...)  */
             bytes_transferred = req->attempted_bytes_remaining -
                                 chanptr->transfer.size;
-            /* Copy data from DMA buffer if needed */
-            if (!IS_WORD_ALIGNED(req->cur_data_ptr))
+            /* Copy data from DMA buffer if needed, otherwise drop any
+             * lines the CPU fetched ahead while the hardware wrote.  */
+            if (channel_bounced[chan])
             {
-				memcpy(req->cur_data_ptr,
-                       &aligned_bufs[chan][req->attempted_size -
-                                           req->attempted_bytes_remaining],
-                       bytes_transferred);
+                uint8_t *dmabuf = &aligned_bufs[chan][req->attempted_size -
+                                            req->attempted_bytes_remaining];
+
+                if (req->nsegs > 0)
+                {
+                    dwc_copy_segments(req, req->cur_offset, dmabuf,
+                                      bytes_transferred, USB_DIRECTION_IN);
+                }
+                else
+                {
+                    memcpy(req->recvbuf + req->cur_offset, dmabuf,
+                           bytes_transferred);
+                }
+            }
+            else
+            {
+                dcacheInvalidate(req->recvbuf + req->cur_offset,
+                                 bytes_transferred);
             }
         }
         else
@@ -1210,7 +1314,7 @@ static enum dwc_intr_status dwc_handle_normal_channel_halted(struct usb_xfer_req
         /* Account for packets and bytes transferred  */
         req->attempted_packets_remaining -= packets_transferred;
         req->attempted_bytes_remaining -= bytes_transferred;
-        req->cur_data_ptr += bytes_transferred;
+        req->cur_offset += bytes_transferred;
 
         /* Check if transfer complete (at least to the extent that data was
          * programmed into the channel).  */
@@ -1250,7 +1354,7 @@ static enum dwc_intr_status dwc_handle_normal_channel_halted(struct usb_xfer_req
                 req->next_data_pid = chanptr->transfer.packet_id;
                 if (!usb_is_control_request(req) || req->control_phase == 1)
                 {
-                    req->actual_size = req->cur_data_ptr - req->recvbuf;
+                    req->actual_size = req->cur_offset;
                 }
                 return XFER_NEEDS_RESTART;
             }
@@ -1268,7 +1372,7 @@ static enum dwc_intr_status dwc_handle_normal_channel_halted(struct usb_xfer_req
                  * data phase.  */
                 if (req->control_phase == 1)
                 {
-                    req->actual_size = req->cur_data_ptr - req->recvbuf;
+                    req->actual_size = req->cur_offset;
                 }
 
                 /* Advance to the next phase. */
@@ -1452,7 +1556,7 @@ static void dwc_handle_channel_halted_interrupt(unsigned int chan)
      * and aren't on the DATA phase.  */
     if (!usb_is_control_request(req) || req->control_phase == 1)
     {
-        req->actual_size = req->cur_data_ptr - req->recvbuf;
+        req->actual_size = req->cur_offset;
     }
 
     /* If we got here because we received a NAK or NYET, defer the request for a
@@ -1485,9 +1589,13 @@ static interrupt dwc_interrupt_handler(void)
 {
     /* Set 'resdefer' to prevent other threads from being scheduled before this
      * interrupt handler finishes.  This prevents this interrupt handler from
-     * being executed re-entrantly.  */
-    extern int resdefer;
-    resdefer = 1;
+     * being executed re-entrantly.  dispatch() may already be deferring
+     * rescheduling until all pending interrupts are handled.  */
+    bool defer = (0 == resdefer[getcpuid()]);
+    if (defer)
+    {
+        resdefer[getcpuid()] = 1;
+    }
 
     union dwc_core_interrupts interrupts = regs->core_interrupts;
 
@@ -1584,9 +1692,9 @@ static interrupt dwc_interrupt_handler(void)
     /* Reschedule the currently running thread if the interrupt handler
      * attempted to wake up any threads (for example, threads that might be
      * waiting for a USB transfer to complete).  */
-    if (--resdefer > 0)
+    if (defer && --resdefer[getcpuid()] > 0)
     {
-        resdefer = 0;
+        resdefer[getcpuid()] = 0;
         resched();
     }
 }
@@ -1736,6 +1844,20 @@ static usb_status_t dwc_start_xfer_scheduler(void)
 usb_status_t hcd_start (void)
 {
     usb_status_t status;
+    unsigned int chan;
+
+    for (chan = 0; chan < DWC_NUM_CHANNELS; chan++)
+    {
+        if (NULL == aligned_bufs[chan])
+        {
+            aligned_bufs[chan] = dmaget(DWC_BOUNCE_SIZE);
+            if ((void *)SYSERR == aligned_bufs[chan])
+            {
+                aligned_bufs[chan] = NULL;
+                return USB_STATUS_OUT_OF_MEMORY;
+            }
+        }
+    }
 
     status = usbpoweron();
     if (status != USB_STATUS_SUCCESS)
@@ -1753,6 +1875,39 @@ usb_status_t hcd_start (void)
     return status;
 }
 
+/* Implementation of hcd_alloc_buffer() for the DesignWare Hi-Speed USB 2.0
+ * On-The-Go Controller.  See usb_hcdi.h for the documentation of this
+ * interface of the Host Controller Driver.  */
+/**
+ * @details
+ *
+ * The buffer is cache-line aligned and a whole number of cache lines long, so
+ * the channels can DMA straight into it; the pointer memget() returned is kept
+ * in the word before it.
+ */
+void *hcd_alloc_buffer(unsigned int size)
+{
+    uint8_t *raw;
+    void **buf;
+
+    raw = memget(roundcl(size) + CACHE_LINE_SIZE);
+    if ((void *)SYSERR == raw)
+    {
+        return NULL;
+    }
+    buf = (void **)roundcl(raw + sizeof(void *));
+    buf[-1] = raw;
+    return buf;
+}
+
+/* Implementation of hcd_free_buffer() for the DesignWare Hi-Speed USB 2.0
+ * On-The-Go Controller.  See usb_hcdi.h for the documentation of this
+ * interface of the Host Controller Driver.  */
+void hcd_free_buffer(void *buf, unsigned int size)
+{
+    memfree(((void **)buf)[-1], roundcl(size) + CACHE_LINE_SIZE);
+}
+
 /* Implementation of hcd_stop() for the DesignWare Hi-Speed USB 2.0 On-The-Go
  * Controller.  See usb_hcdi.h for the documentation of this interface of the
  * Host Controller Driver.  */
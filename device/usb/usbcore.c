@@ -120,6 +120,8 @@ void usb_init_xfer_request (struct usb_xfer_request *req)
  * @ingroup usbcore
  *
  * Dynamically allocates a struct usb_xfer_request, including a data buffer.
+ * The buffer comes from the Host Controller Driver, which can transfer to and
+ * from it directly.
  *
  * @param bufsize
  *      Length of the data buffer for sending and/or receiving.
@@ -147,13 +149,14 @@ struct usb_xfer_request *usb_alloc_xfer_request (unsigned int bufsize)
 
     usb_init_xfer_request(req);
 	if (bufsize > 0) {
-		req->sendbuf = memget(bufsize);
-		if (req->sendbuf == 0)
+		req->sendbuf = hcd_alloc_buffer(bufsize);
+		if (req->sendbuf == NULL)
 		{
 			req->in_use = 0;
 			return 0;
 		}
-		req->buf_allocated = 1;
+		req->buf_allocated = TRUE;
+		req->buf_size = bufsize;
 	}
 
 	req->size = bufsize;
@@ -176,10 +179,10 @@ void usb_free_xfer_request (struct usb_xfer_request *req)
         /* TODO: HCD-specific variables need to be handled better.  */
 		kill(req->deferer_thread_tid);
 		semfree(req->deferer_thread_sema);
-		if (req->buf_allocated == 1)
+		if (req->buf_allocated)
 		{
-			memfree(req, req->size);
-			req->buf_allocated = 0;
+			hcd_free_buffer(req->sendbuf, req->buf_size);
+			req->buf_allocated = FALSE;
 		}
 		req->in_use = 0;
     }
@@ -240,6 +243,13 @@ usb_status_t usb_submit_xfer_request (struct usb_xfer_request *req)
         return USB_STATUS_INVALID_PARAMETER;
     }
 
+    if (req->nsegs > 0 && usb_is_control_request(req))
+    {
+        usb_error("Bad usb_xfer_request: buffer segments for a control "
+                  "transfer\n");
+        return USB_STATUS_INVALID_PARAMETER;
+    }
+
 	ENTER_KERNEL_CRITICAL_SECTION();
 
     /* Don't allow submitting new transfers to devices that are going away.  */
@@ -283,12 +293,28 @@ usb_status_t usb_submit_xfer_request (struct usb_xfer_request *req)
     req->complete_split = 0;
     req->control_phase = 0;
     ++req->dev->xfer_pending_count;
+	EXIT_KERNEL_CRITICAL_SECTION();
+
+    /* The host controller driver may wait for a free channel, so it is not
+     * called under the kernel lock; the pending count keeps the device from
+     * being freed meanwhile.  */
     status = hcd_submit_xfer_request(req);
     if (status != USB_STATUS_SUCCESS)
     {
-        --req->dev->xfer_pending_count;
+        tid_typ waiter = BADTID;
+
+        ENTER_KERNEL_CRITICAL_SECTION();
+        if (--req->dev->xfer_pending_count == 0 &&
+            req->dev->state == USB_DEVICE_DETACHMENT_PENDING)
+        {
+            waiter = req->dev->quiescent_state_waiter;
+        }
+        EXIT_KERNEL_CRITICAL_SECTION();
+        if (BADTID != waiter)
+        {
+            send(waiter, 0);
+        }
     }
-	EXIT_KERNEL_CRITICAL_SECTION();
     return status;
 }
 
@@ -304,6 +330,7 @@ usb_status_t usb_submit_xfer_request (struct usb_xfer_request *req)
  */
 void usb_complete_xfer(struct usb_xfer_request *req)
 {
+    tid_typ waiter = BADTID;
 
 	ENTER_KERNEL_CRITICAL_SECTION();
 
@@ -344,10 +371,14 @@ void usb_complete_xfer(struct usb_xfer_request *req)
     if (req->dev->state == USB_DEVICE_DETACHMENT_PENDING &&
         req->dev->xfer_pending_count == 0)
     {
-        send(req->dev->quiescent_state_waiter, 0);
+        waiter = req->dev->quiescent_state_waiter;
     }
 
 	EXIT_KERNEL_CRITICAL_SECTION();
+    if (BADTID != waiter)
+    {
+        send(waiter, 0);
+    }
 }
 
 static void
@@ -816,9 +847,16 @@ usb_free_device(struct usb_device *dev)
         usb_dev_debug(dev, "Waiting for %u pending xfers to complete\n",
                       dev->xfer_pending_count);
         dev->quiescent_state_waiter = gettid();
+        EXIT_KERNEL_CRITICAL_SECTION();
+
+        /* The last completion sends a message, which receive() returns
+         * at once if it is already here.  */
         receive();
     }
-	EXIT_KERNEL_CRITICAL_SECTION();
+    else
+    {
+        EXIT_KERNEL_CRITICAL_SECTION();
+    }
 
     /* Unbind the device driver if needed.  */
     if (dev->driver != NULL && dev->driver->unbind_device != NULL)
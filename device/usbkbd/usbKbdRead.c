@@ -52,8 +52,11 @@ xinu_devcall usbKbdRead(device *devptr, void *buf, unsigned int len)
         }
 
         /* Wait for there to be at least one byte in the input buffer from the
-         * interrupt handler, then remove it.  */
+         * interrupt handler, then remove it.  The kernel lock is not held
+         * across the wait.  */
+        EXIT_KERNEL_CRITICAL_SECTION();
         wait(kbd->isema);
+        ENTER_KERNEL_CRITICAL_SECTION();
         ((unsigned char*)buf)[count] = kbd->in[kbd->istart];
         kbd->icount--;
         kbd->istart = (kbd->istart + 1) % USBKBD_IBLEN;
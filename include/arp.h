@@ -45,6 +45,7 @@
 /* ARP entry is resolved if it is USED and RESOLVED (0b11) */
 #define ARP_RESOLVED        3      /**< Entry is used and resolved      */
 #define ARP_NTHRWAIT        10     /**< Num threads that can wait       */
+#define ARP_NHASH           32     /**< Hash buckets, power of 2        */
 
 /* ARP Lookup */
 #define ARP_MAX_LOOKUP      5     /**< Num ARP lookup attempts per pkt  */
@@ -53,6 +54,7 @@
 /* Timing info */
 #define ARP_TTL_UNRESOLVED  5    /**< TTL in secs for unresolv entry  */
 #define ARP_TTL_RESOLVED    300   /**< TTL in secs for resolved entry  */
+#define ARP_EXPIRE_FREQ     1     /**< Secs between expiry sweeps      */
 
 /* ARP thread constants */
 #define ARP_THR_PRIO        NET_THR_PRIO   /**< ARP thread priority     */
@@ -105,20 +107,35 @@ struct arpEntry
     unsigned int expires;               /**< clktime when entry expires    */
     tid_typ waiting[ARP_NTHRWAIT];		/**< Threads waiting for entry     */
     int count;							/**< Count of threads waiting      */
+    unsigned short hslot;               /**< Hash bucket + 1, 0 if none    */
+    struct arpEntry *hnext;             /**< Next entry in hash bucket     */
+    struct arpEntry *enext;             /**< Next entry to expire          */
+    struct arpEntry *eprev;             /**< Previous entry to expire      */
 };
 
+/** Hash bucket of a protocol address */
+#define arpHash(praddr)     (netaddrhash(praddr) & (ARP_NHASH - 1))
+
 /* ARP table */
 extern struct arpEntry arptab[ARP_NENTRY];
 
+/* ARP table index by protocol address, and entries in order of expiry */
+extern struct arpEntry *arphash[ARP_NHASH];
+extern struct arpEntry *arpexphead;
+extern struct arpEntry *arpexptail;
+
 /* ARP packet queue for packets requiring reply */
 extern mailbox arpqueue;
 
 /* ARP Function Prototypes */
 struct arpEntry *arpAlloc(void);
 thread arpDaemon(void);
+void arpExpire(void);
 struct arpEntry *arpGetEntry(const struct netaddr *);
 xinu_syscall arpFree(struct arpEntry *);
 xinu_syscall arpInit(void);
+void arpInsert(struct arpEntry *);
+void arpRemove(struct arpEntry *);
 xinu_syscall arpLookup(struct netif *, const struct netaddr *, struct netaddr *);
 xinu_syscall arpNotify(struct arpEntry *, xinu_message);
 xinu_syscall arpRecv(struct packet *);
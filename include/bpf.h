@@ -0,0 +1,110 @@
+/**
+ * @file bpf.h
+ * Definitions for the packet filter engine.  Filters are programs for the
+ * classic BSD packet filter machine, so programs built by tcpdump -dd and
+ * friends run unchanged.  A program sees a packet as an array of octets
+ * and returns how many of them to accept, 0 to reject the packet.
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#ifndef _BPF_H_
+#define _BPF_H_
+
+#include <stddef.h>
+
+/* Program limits */
+#define BPF_MAXINSNS    512     /**< Longest program accepted           */
+#define BPF_MEMWORDS    16      /**< Scratch memory words, M[]          */
+
+/* Instruction classes */
+#define BPF_CLASS(code) ((code) & 0x07)
+#define BPF_LD          0x00
+#define BPF_LDX         0x01
+#define BPF_ST          0x02
+#define BPF_STX         0x03
+#define BPF_ALU         0x04
+#define BPF_JMP         0x05
+#define BPF_RET         0x06
+#define BPF_MISC        0x07
+
+/* Load sizes */
+#define BPF_SIZE(code)  ((code) & 0x18)
+#define BPF_W           0x00
+#define BPF_H           0x08
+#define BPF_B           0x10
+
+/* Load modes */
+#define BPF_MODE(code)  ((code) & 0xE0)
+#define BPF_IMM         0x00
+#define BPF_ABS         0x20
+#define BPF_IND         0x40
+#define BPF_MEM         0x60
+#define BPF_LEN         0x80
+#define BPF_MSH         0xA0
+
+/* ALU and jump operations */
+#define BPF_OP(code)    ((code) & 0xF0)
+#define BPF_ADD         0x00
+#define BPF_SUB         0x10
+#define BPF_MUL         0x20
+#define BPF_DIV         0x30
+#define BPF_OR          0x40
+#define BPF_AND         0x50
+#define BPF_LSH         0x60
+#define BPF_RSH         0x70
+#define BPF_NEG         0x80
+#define BPF_MOD         0x90
+#define BPF_XOR         0xA0
+#define BPF_JA          0x00
+#define BPF_JEQ         0x10
+#define BPF_JGT         0x20
+#define BPF_JGE         0x30
+#define BPF_JSET        0x40
+
+/* Operand sources */
+#define BPF_SRC(code)   ((code) & 0x08)
+#define BPF_K           0x00
+#define BPF_X           0x08
+
+/* Return values */
+#define BPF_RVAL(code)  ((code) & 0x18)
+#define BPF_A           0x10
+
+/* Miscellaneous operations */
+#define BPF_MISCOP(code) ((code) & 0xF8)
+#define BPF_TAX         0x00
+#define BPF_TXA         0x80
+
+/**
+ * Filter instruction
+ */
+struct bpf_insn
+{
+    unsigned short code;        /**< Operation                          */
+    unsigned char jt;           /**< Forward jump if condition holds    */
+    unsigned char jf;           /**< Forward jump if it does not        */
+    unsigned int k;             /**< Operand                            */
+};
+
+/**
+ * Filter program
+ */
+struct bpf_program
+{
+    unsigned int bf_len;        /**< Number of instructions             */
+    struct bpf_insn *bf_insns;  /**< Instructions                       */
+};
+
+/** Build a statement */
+#define BPF_STMT(code, k) { (unsigned short)(code), 0, 0, (k) }
+/** Build a conditional jump */
+#define BPF_JUMP(code, k, jt, jf) { (unsigned short)(code), (jt), (jf), (k) }
+
+/* Function prototypes */
+int bpfCompile(const char *, unsigned int, unsigned int, struct bpf_insn *,
+               unsigned int);
+unsigned int bpfFilter(const struct bpf_insn *, const unsigned char *,
+                       unsigned int, unsigned int);
+int bpfValidate(const struct bpf_insn *, unsigned int);
+
+#endif                          /* _BPF_H_ */
@@ -35,6 +35,11 @@ struct bfpentry
     void *head;
     struct poolbuf *next;
     semaphore freebuf;
+    unsigned int nalloc;        /**< buffers handed out since bfpalloc  */
+    unsigned int nwait;         /**< bufget() calls that had to block   */
+    unsigned int nfail;         /**< bufget_nowait() calls that failed  */
+    unsigned int inuse;         /**< buffers currently handed out       */
+    unsigned int highwater;     /**< most buffers ever handed out       */
 };
 
 /**
@@ -52,6 +57,7 @@ extern struct bfpentry bfptab[];	// Defined in bpalloc
 
 /* function prototypes */
 void *bufget(int);
+void *bufget_nowait(int);
 xinu_syscall buffree(void *);
 int bfpalloc(unsigned int, unsigned int);
 xinu_syscall bfpfree(int);
@@ -19,9 +19,20 @@
  */
 #define CLKTICKS_PER_SEC  1000
 
+/**
+ * @ingroup timer
+ *
+ * Longest time, in ticks, a tickless platform leaves the timer unarmed
+ * when no thread is sleeping and no preemption is due.
+ */
+#define CLK_MAXIDLE       CLKTICKS_PER_SEC
+
 extern volatile unsigned long clkticks;
 extern volatile unsigned long clktime;
 extern qid_typ sleepq;
+#if TICKLESS
+extern unsigned long clklast;
+#endif
 
 /* Clock function prototypes.  Note:  clkupdate() and clkcount() are documented
  * here because their implementations are platform-dependent.  */
@@ -54,6 +65,24 @@ void clkupdate (unsigned long cycles);
  */
 unsigned long clkcount( void);
 
+#if TICKLESS
+/**
+ * @ingroup timer
+ *
+ * Sets up a one-shot timer interrupt at an absolute time.  If the time
+ * has already passed the interrupt triggers as soon as possible.
+ *
+ * @param count
+ *     Value of clkcount() at which the timer interrupt is to be triggered.
+ */
+void clkalarm (unsigned long count);
+
+void clkrearm (void);
+void clkcatchup (void);
+#endif
+
+void clkgettime (unsigned long *sec, unsigned long *usec);
+
 interrupt clkhandler(void);
 void udelay (unsigned long);
 void mdelay (unsigned long);
@@ -96,16 +96,18 @@ extern device devtab[NDEVS]; /* one entry per device */
 #define BYTE_ORDER    LITTLE_ENDIAN
 
 #define NTHREAD   100           /* number of user threads           */
+#define NCORE     4             /* max number of cores scheduled    */
 #define NSEM      100           /* number of semaphores             */
 #define NMAILBOX  15            /* number of mailboxes              */
 #define RTCLOCK   TRUE          /* timer support                    */
+#define TICKLESS  TRUE          /* one-shot timer, no idle ticks    */
 #define NETEMU    FALSE         /* Network Emulator support         */
 #define NVRAM     FALSE         /* nvram support                    */
 #define SB_BUS    FALSE         /* Silicon Backplane support        */
 #define USE_TLB   FALSE         /* make use of TLB                  */
 #define USE_TAR   FALSE         /* enable data archives             */
-#define NPOOL     8             /* number of buffer pools available */
-#define POOL_MAX_BUFSIZE 2048   /* max size of a buffer in a pool   */
+#define NPOOL     12            /* number of buffer pools available */
+#define POOL_MAX_BUFSIZE 9216   /* max size of a buffer in a pool   */
 #define POOL_MIN_BUFSIZE 8      /* min size of a buffer in a pool   */
 #define POOL_MAX_NBUFS   8192   /* max number of buffers in a pool  */
 #define WITH_USB                /* USB support                      */
@@ -8,6 +8,7 @@
 #define _ETHER_H_
 
 #include <stdarg.h>
+#include <stdbool.h>
 #include <xinu.h>
 #include <device.h>
 #include <usb_util.h>    // needed for usb_status_t
@@ -48,6 +49,7 @@
 #define ETH_STATE_FREE       0
 #define ETH_STATE_DOWN       1
 #define ETH_STATE_UP         2
+#define ETH_STATE_OPENING    3  /**< open() is bringing the device up  */
 
 /* ETH control codes */
 #define ETH_CTRL_CLEAR_STATS 1  /**< Clear Ethernet Statistics          */
@@ -56,6 +58,13 @@
 #define ETH_CTRL_SET_LOOPBK  4  /**< Set Loopback Mode                  */
 #define ETH_CTRL_RESET       5  /**< Reset the Ethernet device          */
 #define ETH_CTRL_DISABLE     6  /**< Disable the Ethernet device        */
+#define ETH_CTRL_SET_REQUESTS 7 /**< Set Rx and Tx transfer ring sizes  */
+
+/* USB bulk transfer rings */
+#define ETH_RX_REQUESTS      4  /**< Default Rx transfers kept submitted */
+#define ETH_TX_REQUESTS      4  /**< Default Tx transfers in the ring    */
+#define ETH_MAX_REQUESTS     16 /**< Largest ring of either kind         */
+#define ETH_TX_SEGS          8  /**< Most frames packed in a Tx transfer */
 
 /**
  * Ethernet packet buffer
@@ -67,6 +76,9 @@ struct ethPktBuffer
     int length;                 /**< Length of packet data              */
 };
 
+struct packet;                  /* network.h, received frames         */
+struct usb_xfer_request;        /* usb_core_driver.h, bulk transfers  */
+
 /* Ethernet control block */
 #define ETH_INVALID  (-1)       /**< Invalid data (virtual devices)     */
 
@@ -112,10 +124,17 @@ struct ether
     unsigned short istart;          /**< Index of first byte                */
     unsigned short icount;          /**< Packets in buffer                  */
 
-    struct ethPktBuffer *in[ETH_IBLEN]; /**< Input buffer               */
+    struct packet *in[ETH_IBLEN];   /**< Received frames, from inPool   */
 
     int inPool;						/**< buffer pool id for input           */
     int outPool;					 /**< buffer pool id for output          */
+    int txPool;						/**< buffer pool id for Tx frames       */
+    unsigned short rxRequests;		/**< Rx transfers kept submitted        */
+    unsigned short txRequests;		/**< Tx transfers in outPool            */
+    unsigned short txActive;		/**< Tx transfers submitted             */
+    struct usb_xfer_request *txFill;	/**< Tx transfer being packed       */
+    unsigned long txFrames;			/**< Frames packed into Tx transfers    */
+    unsigned int offload;			/**< Checksums the device does, NET_CSUM_* */
 
 
 	/* The device driver header */
@@ -125,6 +144,7 @@ struct ether
 	usb_status_t (*set_mac_address)(struct usb_device *udev, const uint8_t *macaddr);
 	usb_status_t (*get_mac_address)(struct usb_device *udev, uint8_t *macaddr);
 	usb_status_t (*set_loopback_mode)(struct usb_device *udev, unsigned int on_off);
+	xinu_devcall (*send)(device *devptr, const void *buf, unsigned int len, bool csum);
 
 
 };
@@ -207,6 +227,27 @@ xinu_devcall etherClose (device *devptr);
  */
 xinu_devcall etherRead (device *devptr, void *buf, unsigned int len);
 
+/**
+ * \ingroup ether
+ *
+ * Take the next received Ethernet frame from an Ethernet device without
+ * copying it.  The driver receives each frame straight into a network
+ * ::packet buffer, with packet::data and packet::curr at the MAC
+ * destination address and packet::len set to the frame length.  The caller
+ * owns the packet and releases it with netFreebuf().  The network stack
+ * finds this function through control() with ::NET_GET_RECVPKT.
+ *
+ * This function blocks until a frame has actually been received.  There is no
+ * timeout.
+ *
+ * @param descrp
+ *      Index of the Ethernet device in Xinu's device table.
+ *
+ * @return
+ *      The received packet, or ::SYSERR if the device is not up.
+ */
+struct packet *etherRecvPacket(int descrp);
+
 /**
  * \ingroup ether
  *
@@ -232,6 +273,25 @@ xinu_devcall etherRead (device *devptr, void *buf, unsigned int len);
  */
 xinu_devcall etherWrite (device *devptr, const void *buf, unsigned int len);
 
+/**
+ * \ingroup ether
+ *
+ * Send a network ::packet on an Ethernet device, from packet::curr for
+ * packet::len bytes.  This is etherWrite() for the network stack, which
+ * finds this function through control() with ::NET_GET_SENDPKT, and also
+ * passes on a transport checksum left to the device (::PKT_CSUM_TX).  The
+ * packet still belongs to the caller when this returns.
+ *
+ * @param descrp
+ *      Index of the Ethernet device in Xinu's device table.
+ * @param pkt
+ *      Packet to send, starting with the MAC destination address.
+ *
+ * @return
+ *      As etherWrite().
+ */
+xinu_devcall etherSendPacket(int descrp, struct packet *pkt);
+
 /**
  * \ingroup ether
  *
@@ -275,6 +335,56 @@ void etherThroughput (unsigned short minor);
 
 interrupt etherInterrupt(void);
 
+/**
+ * \ingroup ether
+ *
+ * Get a buffer for an outgoing frame from the device's txPool.  This may
+ * block waiting for a Tx transfer to complete, so it must be called outside
+ * any kernel critical section.
+ *
+ * @param ethptr
+ *      Ethernet device to send on.
+ *
+ * @return
+ *      Where to write the frame, behind the device's Tx command words.
+ */
+uint8_t *etherTxGetbuf(struct ether *ethptr);
+
+/**
+ * \ingroup ether
+ *
+ * Queue a frame from etherTxGetbuf() as the next segment of the Tx transfer
+ * being packed, starting a new transfer if there is none or it is full, and
+ * submit the transfer if the device is idle.  While a transfer is in flight,
+ * frames queued meanwhile are left to collect in the next one, which
+ * etherTxComplete() submits.  The buffer belongs to the transfer until it
+ * completes.  This may block, so it must be called outside any kernel
+ * critical section.
+ *
+ * @param ethptr
+ *      Ethernet device to send on.
+ * @param frame
+ *      The frame, including the device's Tx command words.
+ * @param len
+ *      Length of the frame, including the device's Tx command words.
+ * @param bufsize
+ *      Most data the device takes in one Tx transfer.
+ */
+void etherTxSend(struct ether *ethptr, uint8_t *frame, unsigned int len,
+                 unsigned int bufsize);
+
+/**
+ * \ingroup ether
+ *
+ * Return a completed Tx transfer and its frames to their pools, and submit
+ * the frames that collected while it was in flight.  Called from the
+ * driver's Tx completion callback.
+ *
+ * @param req
+ *      Tx transfer that has completed.
+ */
+void etherTxComplete(struct usb_xfer_request *req);
+
 /**
  * \ingroup ether
  */
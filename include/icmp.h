@@ -130,11 +130,9 @@ struct icmpEcho
     unsigned short id;
     unsigned short seq;
     unsigned long timesec;                  /**< Clock time in seconds, */
-    unsigned long timetic;                  /**< Clock time in tics,    */
-    unsigned long timecyc;                  /**< Clock time in cycles   */
+    unsigned long timeusec;                 /**< and microseconds       */
     unsigned long arrivsec;
-    unsigned long arrivtic;
-    unsigned long arrivcyc;
+    unsigned long arrivusec;
 };
 
 #define NPINGQUEUE 5
@@ -103,8 +103,59 @@ struct ipv4Pkt             /**< IPv4 Packet Variables                   */
     uint8_t   opts[1];            /**< Options and padding is variable       */
 };
 
+/* Fragment reassembly */
+#define IPv4_FRAG_NENTRY    8       /**< Datagrams reassembled at once      */
+#define IPv4_FRAG_NBUF      12      /**< Reassembly buffers, incl. delivered */
+#define IPv4_FRAG_MAXLEN    8192    /**< Largest payload reassembled        */
+#define IPv4_FRAG_NHOLE     16      /**< Holes tracked per datagram         */
+#define IPv4_FRAG_TTL       30      /**< Seconds to wait for all fragments  */
+#define IPv4_FRAG_SWEEP     1       /**< Seconds between expiry sweeps      */
+#define IPv4_FRAG_LINKROOM  32      /**< Room for the link-level header     */
+#define IPv4_FRAG_HDRROOM   (IPv4_FRAG_LINKROOM + IPv4_MAX_HDRLEN)
+
+#define IPv4_FRAG_FREE      0
+#define IPv4_FRAG_USED      1
+
+/**
+ * Range of payload octets not yet received
+ */
+struct ipv4Hole
+{
+    uint16_t first;               /**< First missing octet                   */
+    uint16_t last;                /**< Last missing octet                    */
+};
+
+/**
+ * Datagram being reassembled.  The link-level and IPv4 headers of the first
+ * fragment sit at the start of the buffer; payload is gathered at
+ * ::IPv4_FRAG_HDRROOM and moved up behind the headers once complete.
+ */
+struct ipv4Frag
+{
+    uint8_t state;                /**< IPv4_FRAG_FREE or IPv4_FRAG_USED      */
+    uint8_t proto;                /**< IPv4 protocol                         */
+    uint16_t id;                  /**< IPv4 identification, network order    */
+    uint8_t src[IPv4_ADDR_LEN];   /**< IPv4 source                           */
+    uint8_t dst[IPv4_ADDR_LEN];   /**< IPv4 destination                      */
+    unsigned long expires;        /**< clktime reassembly is abandoned       */
+    struct packet *pkt;           /**< Reassembly buffer                     */
+    uint16_t hdrlen;              /**< Header octets, 0 until offset 0 seen  */
+    uint16_t datalen;             /**< Payload octets, 0 until last seen     */
+    uint16_t nhole;               /**< Number of holes                       */
+    struct ipv4Hole hole[IPv4_FRAG_NHOLE];  /**< Missing payload ranges      */
+};
+
+extern struct ipv4Frag ipv4fragtab[];
+extern int ipv4fragpool;
+
 /* Function prototypes */
 xinu_syscall dot2ipv4(const char *, struct netaddr *);
+void ipv4ChksumFinish(struct packet *, struct ipv4Pkt *);
+bool ipv4ChksumRecv(const struct packet *, const struct netaddr *,
+                    const struct netaddr *, uint8_t, uint16_t);
+void ipv4FragExpire(void);
+xinu_syscall ipv4FragInit(void);
+struct packet *ipv4FragRecv(struct packet *);
 xinu_syscall ipv4Recv(struct packet *);
 bool ipv4RecvValid(struct ipv4Pkt *);
 bool ipv4RecvDemux(struct netaddr *);
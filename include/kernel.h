@@ -15,6 +15,14 @@
 #include <stdarg.h>
 #include <compiler.h>
 
+/** Platforms that do not schedule several cores run on one */
+#ifndef NCORE
+#define NCORE 1
+#endif
+#if NCORE == 1
+#define getcpuid() 0
+#endif
+
 /* Kernel function prototypes */
 void nulluser(void);
 
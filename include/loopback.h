@@ -35,8 +35,9 @@ struct loopback
 {
     int state;							/**< LOOP_STATE_*above                  */
     int index;							/**< index of first char in buffer      */
+    int count;							/**< number of characters in buffer     */
     int flags;							/**< loopback control flags             */
-    semaphore sem;						/**< number of characters in buffer     */
+    semaphore sem;						/**< characters no reader has claimed   */
     uint8_t buffer[LOOP_BUFFER];		/**< input buffer                       */
 };
 
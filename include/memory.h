@@ -44,6 +44,38 @@ struct memblock
 
 extern struct memblock memlist;     /**< head of free memory list           */
 
+/* Slab allocator for small kernel objects */
+#ifndef SLAB_NPAGES
+#define SLAB_NPAGES   128           /**< pages in the slab arena            */
+#endif
+#define SLAB_PAGESIZE 4096          /**< bytes per slab page                */
+#define SLAB_MAXSIZE  512           /**< largest request served by slabs    */
+#define SLAB_NCLASS   12            /**< number of slab size classes        */
+
+/**
+ * Descriptor of one slab page.  Kept outside the page so that objects pack
+ * the whole page and keep their memblock alignment.
+ */
+struct slabpage
+{
+    struct slabpage *next;          /**< next page in class or free list    */
+    struct slabpage *prev;          /**< previous page in class list        */
+    void *free;                     /**< list of freed objects              */
+    unsigned short carved;          /**< objects handed out from fresh page */
+    unsigned short inuse;           /**< objects currently allocated        */
+    unsigned char sclass;           /**< size class, SLAB_NCLASS if free    */
+};
+
+extern uintptr_t slabarena;         /**< base of slab arena, 0 if none      */
+extern struct slabpage slabtab[];   /**< slab page descriptors              */
+
+/**
+ * isslab - test whether an address lies in the slab arena
+ * @param p address to test
+ */
+#define isslab(p) (((uintptr_t)(p) - slabarena) < \
+                   ((0 == slabarena) ? 0 : SLAB_NPAGES * SLAB_PAGESIZE))
+
 /* Other memory data */
 
 extern void *_end;              /**< linker provides end of image           */
@@ -55,5 +87,8 @@ extern uintptr_t memheap;       /**< bottom of heap                         */
 void *memget(unsigned int);
 xinu_syscall memfree(void *, unsigned int);
 void *stkget(unsigned int);
+void slabinit(void);
+void *slabget(unsigned int);
+xinu_syscall slabfree(void *, unsigned int);
 
 #endif                          /* _MEMORY_H_ */
@@ -0,0 +1,74 @@
+/**
+ * @file mmu.h
+ * Definitions for the ARM memory management unit, data cache maintenance
+ * and DMA memory on the Raspberry Pi.  RAM is mapped write-back cacheable,
+ * except for a region at the top of ARM memory that is left uncached for
+ * buffers shared with the GPU and the USB controller.
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#ifndef _MMU_H_
+#define _MMU_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <xinu.h>
+#include <memory.h>
+
+#define MMU_SECTION_SIZE 0x100000   /**< Memory mapped by one section       */
+#define MMU_NSECTION     4096       /**< Sections covering 4GB              */
+
+/** Largest data cache line of any Pi, for aligning DMA buffers */
+#define CACHE_LINE_SIZE  64
+
+/** Uncached memory reserved for DMA at the top of ARM memory */
+#define DMA_REGION_SIZE  MMU_SECTION_SIZE
+
+/** Round up to a whole number of cache lines */
+#define roundcl(x)  (((uintptr_t)(x) + CACHE_LINE_SIZE - 1) \
+                     & ~(uintptr_t)(CACHE_LINE_SIZE - 1))
+
+/** Test if an address or length is a whole number of cache lines */
+#define iscachealigned(x)   (0 == ((uintptr_t)(x) & (CACHE_LINE_SIZE - 1)))
+
+/* Barriers; ARMv6 spells them as CP15 operations */
+#if __ARM_ARCH >= 7
+#define dsb()   __asm__ volatile ("dsb" : : : "memory")
+#define isb()   __asm__ volatile ("isb" : : : "memory")
+#else
+#define dsb()   __asm__ volatile ("mcr p15, 0, %0, c7, c10, 4" \
+                                  : : "r" (0) : "memory")
+#define isb()   __asm__ volatile ("mcr p15, 0, %0, c7, c5, 4" \
+                                  : : "r" (0) : "memory")
+#endif
+
+/**
+ * Test for the ARMv7 cache model of the Pi2 and Pi3.  Kernels built for the
+ * Pi1 also run on them, so this is decided at run time.
+ */
+static inline bool iscachev7(void)
+{
+    uint32_t ctr;
+
+    __asm__ volatile ("mrc p15, 0, %0, c0, c0, 1" : "=r" (ctr));  // CTR
+    return (4 == (ctr >> 29));
+}
+
+extern uint32_t mmutable[];     /**< first level translation table     */
+extern uintptr_t dmaregion;     /**< base of the DMA region, 0 if none */
+extern struct memblock dmalist; /**< free list of the DMA region       */
+
+/* Function prototypes */
+void mmuinit(uintptr_t armtop);
+void mmuenable(void);
+void mmudisable(void);
+void dcacheClean(const void *addr, unsigned int len);
+void dcacheInvalidate(void *addr, unsigned int len);
+void dcacheFlush(const void *addr, unsigned int len);
+void dcacheFlushAll(void);
+void dcacheInvalidateL1(void);
+void *dmaget(unsigned int nbytes);
+xinu_syscall dmafree(void *memptr, unsigned int nbytes);
+
+#endif                          /* _MMU_H_ */
@@ -1,6 +1,10 @@
 /**
  * @file netemu.h
- *
+ * Definitions for the network emulator.  Each network interface has an
+ * emulation stage on its ingress and egress paths that can drop,
+ * duplicate, corrupt, rate limit, delay and reorder packets, to reproduce
+ * the conditions of a wide area link.  Packets held back wait on a delay
+ * queue, which a timer hands to the emulator thread once they are due.
  */
 /* Embedded Xinu, Copyright (C) 2009, 2018.  All rights reserved. */
 
@@ -8,11 +12,100 @@
 #define _NETEMU_H_
 
 #include <xinu.h>
+#include <network.h>
+
+/* Tracing macros */
+//#define TRACE_NETEMU     TTY1
+#ifdef TRACE_NETEMU
+#include <stdio.h>
+#define NETEMU_TRACE(...)     { \
+		fprintf(TRACE_NETEMU, "%s:%d (%d) ", __FILE__, __LINE__, gettid()); \
+		fprintf(TRACE_NETEMU, __VA_ARGS__); \
+		fprintf(TRACE_NETEMU, "\n"); }
+#else
+#define NETEMU_TRACE(...)
+#endif
+
+/* Directions */
+#define NETEMU_IN       0       /**< Packets received on the interface  */
+#define NETEMU_OUT      1       /**< Packets sent on the interface      */
+#define NETEMU_NDIR     2
+
+/* Limits */
+#define NETEMU_PROB     10000   /**< Chances are out of this many       */
+#define NETEMU_QLEN     128     /**< Packets held on the delay queue    */
+#define NETEMU_MAXWAIT  1000    /**< Most ms a packet waits for the
+                                     rate limit before it is dropped    */
+#define NETEMU_BURST    (2 * NET_MAX_PKTLEN) /**< Default bucket octets */
+#define NETEMU_MAXRATE  1000000 /**< Highest rate limit, kbit/s         */
+#define NETEMU_MAXBURST 1000000 /**< Deepest token bucket, octets       */
+#define NETEMU_MAXDELAY 10000   /**< Longest delay or jitter, ms        */
+
+/* Emulator thread constants */
+#define NETEMU_THR_PRIO NET_THR_PRIO    /**< Emulator thread priority   */
+#define NETEMU_THR_STK  NET_THR_STK     /**< Emulator thread stack size */
+
+/**
+ * Emulation stage of one direction of a network interface.  Settings are
+ * changed inside a kernel critical section.
+ */
+struct netemu
+{
+    bool active;                /**< Any emulation configured           */
+    unsigned char dir;          /**< NETEMU_IN or NETEMU_OUT            */
+
+    /* Settings */
+    unsigned short loss;        /**< Chance of dropping a packet        */
+    unsigned short duplicate;   /**< Chance of sending a packet twice   */
+    unsigned short corrupt;     /**< Chance of flipping a bit           */
+    unsigned short reorder;     /**< Chance of skipping the delay       */
+    unsigned int delay;         /**< Latency added, ms                  */
+    unsigned int jitter;        /**< Most latency varies either way, ms */
+    unsigned int rate;          /**< Rate limit in kbit/s, 0 for none   */
+    unsigned int burst;         /**< Token bucket depth, octets         */
+
+    /* Token bucket */
+    int tokens;                 /**< Bits that may be sent at once, less
+                                     than 0 while packets wait          */
+    unsigned long tokstamp;     /**< Time tokens were last added, ms    */
+
+    /* Statistics */
+    unsigned int nin;           /**< Packets entering the stage         */
+    unsigned int ndrop;         /**< Packets lost                       */
+    unsigned int ndup;          /**< Packets duplicated                 */
+    unsigned int ncorrupt;      /**< Packets corrupted                  */
+    unsigned int nreorder;      /**< Packets sent ahead of others       */
+    unsigned int nlimit;        /**< Packets dropped over the rate limit
+                                     or for want of queue space         */
+    unsigned int nqueue;        /**< Packets on the delay queue         */
+};
+
+extern struct netemu netemutab[][NETEMU_NDIR];
+
+/** Emulation stage of an interface */
+#define netemuStage(netptr, dir)    (&netemutab[(netptr) - netiftab][dir])
+
+/* Function prototypes */
+xinu_syscall netemu(struct packet *pkt, int dir);
+xinu_syscall netemuInit(void);
+xinu_syscall emuCorrupt(struct netemu *emu, struct packet *pkt);
+xinu_syscall emuDelay(struct netemu *emu, struct packet *pkt,
+                      unsigned int wait);
+xinu_syscall emuDeliver(struct netemu *emu, struct packet *pkt);
+xinu_syscall emuDrop(struct netemu *emu, struct packet *pkt);
+xinu_syscall emuDuplicate(struct netemu *emu, struct packet *pkt);
+struct packet *emuCopy(struct packet *pkt);
+unsigned long emuNow(void);
+xinu_syscall emuQueue(struct netemu *emu, struct packet *pkt,
+                      unsigned int wait);
+xinu_syscall emuQueueInit(void);
+thread emuDaemon(void);
+xinu_syscall emuRate(struct netemu *emu, struct packet *pkt);
+xinu_syscall emuReorder(struct netemu *emu, struct packet *pkt,
+                        unsigned int wait);
+
+/** Decide by chance, out of ::NETEMU_PROB */
+#define emuChance(prob) \
+    (((prob) > 0) && ((prob) > (rand() % NETEMU_PROB)))
 
-xinu_syscall netemu(struct packet *pkt);
-xinu_syscall emuCorrupt(struct packet *pkt);
-xinu_syscall emuDelay(struct packet *pkt);
-xinu_syscall emuDrop(struct packet *pkt);
-xinu_syscall emuDuplicate(struct packet *pkt);
-xinu_syscall emuReorder(struct packet *pkt);
 #endif                          /* _NETEMU_H_ */
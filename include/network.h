@@ -71,6 +71,7 @@ extern const struct netaddr NETADDR_GLOBAL_ETH_BRC;
 
 /* Network address macros */
 bool netaddrequal(const struct netaddr *, const struct netaddr *);
+unsigned int netaddrhash(const struct netaddr *);
 xinu_syscall netaddrmask (struct netaddr *, const struct netaddr *);
 xinu_syscall netaddrhost (struct netaddr *, const struct netaddr *);
 /** @ingroup network */
@@ -83,6 +84,13 @@ int netaddrsprintf(char *, const struct netaddr *);
 #define NET_GET_LINKHDRLEN  201
 #define NET_GET_HWADDR      203
 #define NET_GET_HWBRC       204
+#define NET_GET_RECVPKT     205
+#define NET_GET_SENDPKT     206
+#define NET_GET_OFFLOAD     207
+
+/* Checksum offload capabilities of an underlying device (NET_GET_OFFLOAD) */
+#define NET_CSUM_TX         0x01      /**< Fills in TCP and UDP checksums */
+#define NET_CSUM_RX         0x02      /**< Sums received IPv4 packets     */
 
 /* Network interface structure definitions */
 #ifdef NETHER
@@ -103,6 +111,9 @@ int netaddrsprintf(char *, const struct netaddr *);
 #define NET_FREE   0                  /**< Netif state free             */
 #define NET_ALLOC  1                  /**< Netif state allocated        */
 
+struct packet;
+struct arpEntry;
+
 /** Net interface control block */
 struct __attribute__((__packed__))netif
 {
@@ -120,6 +131,11 @@ struct __attribute__((__packed__))netif
     uint32_t nin;                     /**< Num recv pkts                */
     uint32_t nproc;                   /**< Num recv pkts processed      */
     void *capture;                    /**< Snoop capture structure      */
+    struct packet *(*recvpkt)(int);   /**< Zero-copy receive, or NULL   */
+    xinu_devcall (*sendpkt)(int, struct packet *); /**< Send with flags,
+                                                        or NULL          */
+    uint32_t offload;                 /**< NET_CSUM_* of the device     */
+    struct arpEntry *arplast;         /**< Last ARP entry sent to       */
 };
 
 extern struct netif netiftab[];
@@ -141,12 +157,30 @@ struct __attribute__((__packed__)) packet
     uint8_t *linkhdr;           /**< Pointer to link layer header       */
     uint8_t *nethdr;            /**< Pointer to network layer header    */
     uint8_t *curr;              /**< Pointer to location into packet    */
+    uint16_t flags;             /**< PKT_* flags                        */
+    uint16_t csum;              /**< Device's sum of a received network
+                                     layer packet, if PKT_CSUM_COMPLETE */
     uint8_t pad[2];             /**< Padding for word alignment         */
     uint8_t data[1];            /**< Pointer to incoming packet         */
 };
 
+/* Packet flags */
+#define PKT_CSUM_TX         0x0001  /**< TCP or UDP checksum left for the
+                                         device, holding the pseudo header
+                                         sum                            */
+#define PKT_CSUM_COMPLETE   0x0002  /**< csum is valid                  */
+
 /* Function Prototypes */
 uint16_t netChksum (void *, unsigned int);
+uint32_t netChksumPartial(const void *, unsigned int, uint32_t);
+uint32_t netChksumCopy(void *, const void *, unsigned int, uint32_t);
+uint32_t netChksumPseudo(const struct netaddr *, const struct netaddr *,
+                         uint8_t, uint16_t);
+uint16_t netChksumFold(uint32_t);
+uint16_t netChksumUpdate(uint16_t, uint16_t, uint16_t);
+uint16_t netChksumOffload(struct packet *, const struct netaddr *,
+                          const struct netaddr *, uint8_t, uint16_t);
+xinu_syscall netDeliver(struct packet *);
 xinu_syscall netDown(int);
 xinu_syscall netFreebuf (struct packet *);
 struct packet *netGetbuf(void);
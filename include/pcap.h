@@ -42,6 +42,7 @@
 #define _PCAP_H_
 
 #include <stddef.h>
+#include <bpf.h>
 
 #define PCAP_VERSION_MAJOR 2
 #define PCAP_VERSION_MINOR 4
@@ -52,26 +53,6 @@
 #define endswap(x)   ((((x)& 0xff)<<24) | (((x)>>24) & 0xff) | \
     (((x) & 0xff0000)>>8) | (((x) & 0xff00)<<8))
 
-/**
- *
- */
-struct bpf_insn
-{
-    unsigned short code;
-    unsigned char jt;
-    unsigned char jf;
-    unsigned int k;
-};
-
-/**
- *
- */
-struct bpf_program
-{
-    unsigned int bf_len;
-    struct bpf_insn *bf_insns;
-};
-
 /**
  *  PCAP file header 
  */
@@ -25,11 +25,30 @@
 #define _QUEUE_H_
 
 #include <kernel.h>
+#if NCORE > 1
+#include <CriticalSection.h>
+#endif
+
+/**
+ * Number of distinct priority levels in the ready list.  Each level is
+ * a FIFO of its own.  Thread priorities must lie in [0, NPRIO-1], which
+ * covers every priority the drivers use; create() and chprio() refuse
+ * any other.
+ */
+#ifndef NPRIO
+#define NPRIO   128
+#endif
+
+/** Check for a thread priority the ready list has no level for */
+#define isbadprio(p) ((p) < 0 || (p) >= NPRIO)
+
+/** Number of 32-bit words in one core's ready list priority bitmap */
+#define RDQ_NWORDS  ((NPRIO + 31) / 32)
 
 #ifndef NQENT
 
-/** NQENT = 1 per thread, 2 per list, 2 per sem */
-#define NQENT   (NTHREAD + 4 + NSEM + NSEM)
+/** NQENT = 1 per thread, 2 per ready priority per core, 2 per list, 2 per sem */
+#define NQENT   (NTHREAD + (NPRIO + NPRIO) * NCORE + 2 + NSEM + NSEM)
 #endif
 
 #define EMPTY (-2)              /**< null pointer for queues            */
@@ -50,6 +69,7 @@ struct queent
 
 extern struct queent quetab[];
 extern qid_typ readylist;
+extern unsigned int rdqbitmap[];
 
 #define quehead(q) (q)
 #define quetail(q) ((q) + 1)
@@ -60,11 +80,103 @@ extern qid_typ readylist;
                       (quehead(x) != (quetail(x) - 1)) || \
                       (quetail(x) >= NQENT))
 
-#define isempty(q)   (quetab[quehead(q)].next >= NTHREAD)
-#define nonempty(q)  (quetab[quehead(q)].next <  NTHREAD)
-#define firstkey(q)  (quetab[quetab[quehead(q)].next].key)
-#define lastkey(q)   (quetab[quetab[quetail(q)].prev].key)
-#define firstid(q)   (quetab[quehead(q)].next)
+/* Each core has a ready list of NPRIO consecutive queues, one per      */
+/* priority level; the lists of all cores follow each other starting   */
+/* at readylist.  rdqbitmap has RDQ_NWORDS words per core with a bit   */
+/* set for each level that holds at least one thread.                  */
+#define rdqhead(c, p) (readylist + ((((c) * NPRIO) + (p)) << 1))
+#define rdqbits(c)   (&rdqbitmap[(c) * RDQ_NWORDS])
+#define isrdqhead(x) (((x) >= readylist) && \
+                      ((x) < readylist + (NPRIO + NPRIO) * NCORE) && \
+                      (0 == (((x) - readylist) & 1)))
+
+/**
+ * Find the highest priority level of a core's ready list holding a thread.
+ * @param core  core whose ready list to search
+ * @return priority level, or EMPTY if no thread is ready
+ */
+static inline int rdqtop(unsigned int core)
+{
+    unsigned int *bits = rdqbits(core);
+    int i;
+
+    for (i = RDQ_NWORDS - 1; i >= 0; i--)
+    {
+        if (bits[i])
+        {
+            return (i << 5) + 31 - __builtin_clz(bits[i]);
+        }
+    }
+    return EMPTY;
+}
+
+/**
+ * Find the lowest priority level of a core's ready list holding a thread.
+ * @param core  core whose ready list to search
+ * @return priority level, or EMPTY if no thread is ready
+ */
+static inline int rdqbottom(unsigned int core)
+{
+    unsigned int *bits = rdqbits(core);
+    int i;
+
+    for (i = 0; i < RDQ_NWORDS; i++)
+    {
+        if (bits[i])
+        {
+            return (i << 5) + __builtin_ctz(bits[i]);
+        }
+    }
+    return EMPTY;
+}
+
+/**
+ * Find the queue head that precedes the first thread of a queue.  For
+ * the ready list this is the head of the highest non-empty level of the
+ * calling core's list.
+ * @param q  target queue
+ * @return queue table index of the head
+ */
+static inline int firsthead(qid_typ q)
+{
+    int prio;
+
+    if (q == readylist)
+    {
+        unsigned int core = getcpuid();
+
+        prio = rdqtop(core);
+        return rdqhead(core, (EMPTY == prio) ? 0 : prio);
+    }
+    return quehead(q);
+}
+
+/**
+ * Find the queue tail that follows the last thread of a queue.  For
+ * the ready list this is the tail of the lowest non-empty level of the
+ * calling core's list.
+ * @param q  target queue
+ * @return queue table index of the tail
+ */
+static inline int lasttail(qid_typ q)
+{
+    int prio;
+
+    if (q == readylist)
+    {
+        unsigned int core = getcpuid();
+
+        prio = rdqbottom(core);
+        return quetail(rdqhead(core, (EMPTY == prio) ? 0 : prio));
+    }
+    return quetail(q);
+}
+
+#define isempty(q)   (firstid(q) >= NTHREAD)
+#define nonempty(q)  (firstid(q) <  NTHREAD)
+#define firstkey(q)  (quetab[firstid(q)].key)
+#define lastkey(q)   (quetab[quetab[lasttail(q)].prev].key)
+#define firstid(q)   (quetab[firsthead(q)].next)
 
 /* Queue function prototypes */
 tid_typ getfirst(qid_typ);
@@ -75,5 +187,6 @@ tid_typ dequeue(qid_typ);
 int insert(tid_typ, qid_typ, int);
 int insertd(tid_typ, qid_typ, int);
 qid_typ queinit(void);
+qid_typ readyinit(void);
 
 #endif                          /* _QUEUE_H_ */
@@ -8,6 +8,7 @@
 #define _RAW_H_
 
 #include <xinu.h>
+#include <bpf.h>
 #include <ipv4.h>
 #include <network.h>
 #include <semaphore.h>
@@ -43,6 +44,7 @@
 /* Control functions */
 #define RAW_CTRL_SETFLAG   1    /**< Set flags                         */
 #define RAW_CTRL_CLRFLAG   2    /**< Clear flags                       */
+#define RAW_CTRL_SETFILTER 3    /**< Set or clear filter program       */
 
 /**
  *  Raw socket control block 
@@ -66,6 +68,9 @@ struct raw
     semaphore isema;                /**< Count of input packets ready       */
 
     unsigned char flags;            /**< Flags                              */
+    struct bpf_program filter;      /**< Program choosing packets accepted,
+                                         run on the network layer header,
+                                         all accepted if no insns           */
 };
 
 extern struct raw rawtab[];
@@ -73,8 +78,8 @@ extern struct raw rawtab[];
 /* Function Prototypes */
 xinu_devcall rawClose(device *pdev);
 xinu_devcall rawControl(device *pdev, int func, long arg1, long arg2);
-struct raw *rawDemux(struct netaddr *src, struct netaddr *dst,
-                     unsigned short proto);
+struct raw *rawDemux(struct packet *pkt, struct netaddr *src,
+                     struct netaddr *dst, unsigned short proto);
 xinu_devcall rawInit(device *pdev);
 xinu_devcall rawOpen(device *pdev, va_list ap);
 xinu_devcall rawRead(device *pdev, void *buf, unsigned int len);
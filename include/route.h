@@ -24,11 +24,17 @@
 #endif
 
 /* Route Table (Must include at least one entry for default route) */
-#define RT_NENTRY         32       /**< Number of ARP table entries     */
+#ifndef RT_NENTRY
+#define RT_NENTRY         32       /**< Number of route table entries   */
+#endif
 #define RT_FREE           0        /**< Entry is free                   */
 #define RT_USED           1        /**< Entry is used                   */
 #define RT_PEND           2        /**< Entry is pending                */
 
+/* Route lookup structures */
+#define RT_NNODE      (2 * RT_NENTRY)   /**< Trie nodes, 2 per route at most  */
+#define RT_NCACHE         64       /**< Destination cache slots, power of 2 */
+
 /* Route thread constants */
 #define RT_THR_PRIO        NET_THR_PRIO   /**< Route thread priority    */
 #define RT_THR_STK         NET_THR_STK    /**< Route thread stack size  */
@@ -45,11 +51,36 @@ struct rtEntry
     struct netaddr gateway;
     struct netaddr mask;
     struct netif *nif;
+    struct rtEntry *next;          /**< Next route with the same prefix */
+};
+
+/**
+ * Path-compressed binary trie node.  A node stands for the first @c bits
+ * bits of @c key; children extend it by at least one bit.  Nodes that only
+ * join two subtrees carry no routes.
+ */
+struct rtNode
+{
+    struct rtNode *child[2];       /**< Subtrees for next bit 0 and 1   */
+    struct rtEntry *routes;        /**< Routes for exactly this prefix  */
+    unsigned short bits;           /**< Prefix length in bits           */
+    unsigned char key[NET_MAX_ALEN];   /**< Prefix, valid to @c bits    */
+};
+
+/** Destination cache entry */
+struct rtCache
+{
+    unsigned int gen;              /**< Table generation when filled    */
+    struct netaddr addr;           /**< Destination looked up           */
+    struct rtEntry *route;         /**< Result of lookup, may be NULL   */
 };
 
 /* Route table */
 extern struct rtEntry rttab[RT_NENTRY];
 
+/* Route table generation, changes whenever a route is added or removed */
+extern unsigned int rtgen;
+
 /* Route pakcet queue for packets requiring routing */
 extern mailbox rtqueue;
 
@@ -65,5 +96,9 @@ xinu_syscall rtRecv(struct packet *pkt);
 xinu_syscall rtRemove(const struct netaddr *dst);
 xinu_syscall rtClear(struct netif *nif);
 xinu_syscall rtSend(struct packet *pkt);
+void rtTrieInit(void);
+xinu_syscall rtTrieInsert(struct rtEntry *rtptr);
+void rtTrieRemove(struct rtEntry *rtptr);
+struct rtEntry *rtTrieLookup(const struct netaddr *addr);
 
 #endif                          /* _ROUTE_H_ */
@@ -93,6 +93,7 @@ shellcmd xsh_exit(int, char *[]);
 shellcmd xsh_flashstat(int, char *[]);
 shellcmd xsh_gpiostat(int, char *[]);
 shellcmd xsh_help(int, char *[]);
+shellcmd xsh_irqstat(int, char *[]);
 shellcmd xsh_kexec(int, char *[]);
 shellcmd xsh_kill(int, char *[]);
 shellcmd xsh_led(int, char *[]);
@@ -9,10 +9,12 @@
 
 #include <xinu.h>
 #include <arp.h>
+#include <bpf.h>
 #include <ethernet.h>
 #include <ipv4.h>
-#include <mailbox.h>
 #include <network.h>
+#include <pcap.h>
+#include <semaphore.h>
 #include <tcp.h>
 #include <udp.h>
 
@@ -38,28 +40,56 @@
 #define SNOOP_VERBOSE_ONE   1
 #define SNOOP_VERBOSE_TWO   2
 
-/* Filter constants */
-#define SNOOP_FILTER_ALL	0
-#define SNOOP_FILTER_ARP	1
-#define SNOOP_FILTER_IPv4   2
-#define SNOOP_FILTER_UDP    3
-#define SNOOP_FILTER_TCP    4
-#define SNOOP_FILTER_ICMP   5
+/* Capture ring */
+#define SNOOP_RINGLEN       (64 * 1024) /**< default ring size, power of 2 */
+/** Largest ring, so that a record padding out its end fits snoopRec.size */
+#define SNOOP_RINGMAX       (64 * 1024)
+#define SNOOP_LINKTYPE      1           /**< pcap link type, Ethernet     */
+/** Largest snaplen that keeps each exported record in one UDP datagram */
+#define SNOOP_UDP_SNAPLEN   (UDP_MAX_DATALEN - sizeof(struct pcap_pkthdr))
 
-#define SNOOP_QLEN          100
+/* Capture record states */
+#define SNOOP_REC_BUSY      0   /**< still being copied in             */
+#define SNOOP_REC_READY     1   /**< holds a captured packet           */
+#define SNOOP_REC_SKIP      2   /**< pads out the end of the ring      */
+
+/**
+ * Record in a capture ring.  The pcap header and captured octets follow
+ * each other, so a record can be exported as it stands.
+ */
+struct snoopRec
+{
+    unsigned short size;                /**< octets up to the next record */
+    volatile unsigned short state;      /**< SNOOP_REC_* above            */
+    struct pcap_pkthdr hdr;             /**< pcap record header           */
+    unsigned char data[1];              /**< captured octets              */
+};
+
+#define SNOOP_REC_HDRLEN    offsetof(struct snoopRec, data)
 
 struct snoop
 {
     unsigned int caplen;				/**< bytes of packet to capture   */
 
     bool promisc;						/**< promiscous mode enabled      */
-    unsigned char type;                 /**< type of packets to capture   */
-    struct netaddr srcaddr;             /**< source address of packets    */
-    unsigned short srcport;             /**< source port of packets       */
-    struct netaddr dstaddr;             /**< destination address of pkts  */
-    unsigned short dstport;             /**< destination port of packets  */
+    struct bpf_program filter;          /**< program choosing packets to
+                                             capture, all if no insns     */
+
+    struct netaddr expaddr;             /**< exporter's remote address,
+                                             never captured               */
+    unsigned short expport;             /**< exporter's remote port       */
 
-    mailbox queue;                      /**< mailbox for queueing packets */
+    unsigned char *ring;                /**< capture ring, from snoopOpen */
+    unsigned int ringlen;               /**< ring size, 0 for default     */
+    unsigned int head;                  /**< ring offset of next record
+                                             to fill, running free        */
+    unsigned int tail;                  /**< ring offset of next record
+                                             to read, running free        */
+    semaphore nready;                   /**< count of records filled      */
+    unsigned int nbusy;                 /**< records still being filled   */
+    unsigned int nwait;                 /**< threads waiting on a fill    */
+    semaphore filled;                   /**< signalled for each waiter
+                                             when a record is filled      */
 
     unsigned int ncap;
     unsigned int nmatch;
@@ -70,7 +100,7 @@ struct snoop
 /* Function prototypes */
 int snoopCapture(struct snoop *cap, struct packet *pkt);
 int snoopClose(struct snoop *cap);
-bool snoopFilter(struct snoop *cap, struct packet *pkt);
+unsigned int snoopFilter(struct snoop *cap, struct packet *pkt);
 int snoopOpen(struct snoop *cap, char *devname);
 int snoopPrint(struct packet *pkt, char dump, char verbose);
 int snoopPrintArp(struct arpPkt *arp, char verbose);
@@ -78,6 +108,8 @@ int snoopPrintEthernet(struct etherPkt *ether, char verbose);
 int snoopPrintIpv4(struct ipv4Pkt *ip, char verbose);
 int snoopPrintTcp(struct tcpPkt *tcp, char verbose);
 int snoopPrintUdp(struct udpPkt *udp, char verbose);
-struct packet *snoopRead(struct snoop *cap);
+struct snoopRec *snoopRead(struct snoop *cap);
+void snoopDone(struct snoop *cap, struct snoopRec *rec);
+int snoopExport(struct snoop *cap, int dev, unsigned int count);
 
 #endif                          /* _SNOOP_H_ */
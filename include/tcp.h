@@ -15,6 +15,7 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <thread.h>
+#include <timer.h>
 
 /* Tracing macros */
 //#define TRACE_TCP     TTY1
@@ -75,6 +76,13 @@ struct tcpPkt
 #define TCP_OPT_MSS      2 /**< maximum segment size */
 #define TCP_OPT_MSS_SIZE 6 /**< bytes needed for MSS option */
 #define TCP_OPT_MSS_LEN  4 /**< length of MSS option */
+#define TCP_OPT_WSCALE   3 /**< window scale */
+#define TCP_OPT_WSCALE_LEN 3 /**< length of window scale option */
+#define TCP_OPT_SACKOK   4 /**< selective acknowledgement permitted */
+#define TCP_OPT_SACKOK_LEN 2 /**< length of SACK permitted option */
+#define TCP_OPT_SACK     5 /**< selective acknowledgement blocks */
+#define TCP_OPT_SACK_BLK 8 /**< length of each SACK block */
+#define TCP_OPT_SACK_MAX 3 /**< most SACK blocks sent in a segment */
 
 /* TCP Checksum Pseudo Header */
 struct tcpPseudo
@@ -88,15 +96,61 @@ struct tcpPseudo
 
 #define TCP_PSEUDO_LEN  12
 
-/* Buffer lengths */
-#define TCP_IBLEN 16384  /**< Size of input buffer, must be multiple of 8 */
-#define TCP_OBLEN 16384  /**< Size of output buffer */
+/* Buffer lengths, allocated when a connection is opened */
+#define TCP_IBLEN 16384  /**< Default size of input buffer */
+#define TCP_OBLEN 16384  /**< Default size of output buffer */
+#define TCP_MIN_BUFLEN 2048     /**< Smallest buffer set by tcpControl */
+#define TCP_MAX_BUFLEN (1 << 20)    /**< Largest buffer set by tcpControl */
 
 /* Initial sizes */
 #define TCP_INIT_MSS (1440 + TCP_HDR_LEN)
 //#define TCP_INIT_MSS (4 + TCP_HDR_LEN) 
 #define TCP_INIT_WND TCP_INIT_MSS
 #define TCP_MAX_WND 65535
+#define TCP_MAX_WSCALE 14   /**< Largest window scale shift (RFC 7323) */
+
+/* Congestion control algorithms, selected with TCP_CTRL_CC */
+#define TCP_CC_NEWRENO 0    /**< Reno with NewReno recovery (RFC 6582) */
+#define TCP_CC_CUBIC   1    /**< CUBIC (RFC 8312) */
+#define TCP_NCC        2    /**< Number of algorithms */
+#define TCP_DUPACK_THRESH 3 /**< Duplicate ACKs that signal a loss */
+#define TCP_MAX_CWND (TCP_MAX_WND << TCP_MAX_WSCALE)
+
+/** Initial congestion window for a sender MSS (RFC 5681) */
+#define TCP_INIT_CWND(mss) \
+    (((mss) > 2190) ? 2 * (mss) : ((mss) > 1095) ? 3 * (mss) : 4 * (mss))
+
+/* Sequence ranges tracked for selective acknowledgement */
+#define TCP_NRANGE 8     /**< Out-of-order ranges held by each side */
+
+/* TCP Timer Events */
+#define TCP_NEVENTS     4   /**< Timer events embedded in each TCB */
+#define TCP_EVT_TIMEWT  1   /**< 2MSL time-wait timeout */
+#define TCP_EVT_RXT     2   /**< retransmit event */
+#define TCP_EVT_PERSIST 3   /**< persist event, for zero window */
+#define TCP_EVT_DELACK  4   /**< delayed acknowledgement */
+
+struct tcb;
+
+/**
+ * TCP timer event.  Each TCB has one of each type, so scheduling an event
+ * that is already pending moves it.
+ */
+struct tcpEvent
+{
+    struct timer timer;             /**< Kernel timer for event */
+    unsigned char type;             /**< Type of event */
+    struct tcb *tcbptr;             /**< TCB for event */
+};
+
+/**
+ * Range of sequence numbers, from start up to but not including end
+ */
+struct tcpRange
+{
+    tcpseq start;
+    tcpseq end;
+};
 
 /**
  * Transmission control block 
@@ -115,6 +169,8 @@ struct tcb
     struct netaddr remoteip;		/**< Remote IP address */
     unsigned char opentype;			/**< Type of open call */
     semaphore openclose;
+    struct tcb *hnext;				/**< Next TCB in demux hash chain */
+    unsigned short hslot;			/**< Demux hash slot + 1, 0 if none */
 
     /* Receive variables */
     tcpseq rcvnxt;					/**< receive next */
@@ -123,22 +179,26 @@ struct tcb
     tcpseq rcvfin;					/**< sequence number for received FIN */
     unsigned short rcvmss;			/**< maximum receive segment size */
     unsigned char rcvflg;			/**< receive flags */
+    unsigned char rcvnack;			/**< in-order segments not yet ACKed */
+    unsigned char rcvscale;			/**< shift applied to windows we send */
 
     /* Receive buffer */
     semaphore readers;				/**< Count of readers waiting for data */
     unsigned int istart;            /**< Index of first octet ready for user */
     unsigned int icount;            /**< Count of octets ready for user */
     unsigned int inxt;
-    unsigned char in[TCP_IBLEN];    /**< Input buffer */
-    unsigned char imark[TCP_IBLEN];
+    unsigned char *in;              /**< Input buffer, NULL while closed */
+    unsigned int iblen;             /**< Size of input buffer */
     unsigned int ibytes;            /**< Count of bytes passed to user */
+    struct tcpRange rcvooo[TCP_NRANGE]; /**< Data held beyond rcvnxt,
+                                             most recently changed first */
+    unsigned int rcvnooo;           /**< Number of out-of-order ranges */
 
     /* Send variables */
     tcpseq snduna;                  /**< send unacknowledged */
     tcpseq sndnxt;                  /**< send next */
     unsigned int sndwnd;            /**< send window */
-    unsigned int sndcwn;            /**< send congestion window */
-    unsigned int sndsst;            /**< send slow start threshold */
+    unsigned char sndscale;         /**< shift applied to windows received */
     tcpseq sndup;                   /**< send urgent pointer */
     tcpseq sndwl1;                  /**< seq num for last win update */
     tcpseq sndwl2;                  /**< ack num for last win update */
@@ -146,22 +206,67 @@ struct tcb
     tcpseq sndfin;                  /**< sequence number for sent FIN */
     unsigned short sndmss;          /**< maximum send segment size */
     unsigned char sndflg;           /**< send flags */
+    unsigned char sndmode;          /**< send options set by tcpControl */
     int sndrtt;                     /**< smoothed sending round trip time */
     int sndrtd;                     /**< sending round trip deviation */
     int rxttime;                    /**< retransmission timer */
     unsigned int rxtcount;          /**< number of retransmissions */
     int psttime;                    /**< persist timer */
+    struct tcpEvent events[TCP_NEVENTS];    /**< Timer events, indexed
+                                                 by type - 1 */
+    struct tcpRange sndsack[TCP_NRANGE];    /**< Ranges SACKed by remote
+                                                 side, in sequence order */
+    unsigned int sndnsack;          /**< Number of SACKed ranges */
+
+    /* Congestion control */
+    unsigned char sndcc;            /**< congestion control algorithm */
+    unsigned int sndcwn;            /**< send congestion window */
+    unsigned int sndsst;            /**< send slow start threshold */
+    unsigned int sndndup;           /**< duplicate ACKs in a row, at least
+                                         TCP_DUPACK_THRESH in recovery */
+    tcpseq sndrecover;              /**< sndnxt when recovery began */
+    unsigned int ccwmax;            /**< CUBIC window before last loss */
+    unsigned int ccwest;            /**< CUBIC estimate of a Reno window */
+    unsigned int ccepoch;           /**< CUBIC start of growth, ms, or 0 */
+    unsigned int cck;               /**< CUBIC time to regain ccwmax, ms */
+    unsigned int ccrttmin;          /**< CUBIC smallest round trip, ms */
 
     /* Send buffer */
     semaphore writers;				/**< Count of writers waiting for buffer */
     unsigned int ostart;            /**< Index of first octet */
     unsigned int ocount;            /**< Octets in buffer */
-    unsigned char out[TCP_OBLEN];   /**< Output buffer */
+    unsigned char *out;             /**< Output buffer, NULL while closed */
+    unsigned int oblen;             /**< Size of output buffer */
     unsigned int obytes;            /**< Count of bytes acknowledged by receiver */
 };
 
 extern struct tcb tcptab[];
 
+/**
+ * Congestion control algorithm.  Each hook is called with the TCB mutex
+ * held and adjusts sndcwn and sndsst.  Entering and leaving fast recovery
+ * is common to all algorithms and handled by tcpRecvAck().
+ */
+struct tcpCong
+{
+    char *name;                     /**< Name shown to users */
+    /** Set the initial window when a connection is opened */
+    void (*init) (struct tcb *);
+    /** Grow the window as new data is acknowledged outside recovery */
+    void (*ack) (struct tcb *, unsigned int);
+    /** Shrink the window on entering fast recovery */
+    void (*loss) (struct tcb *);
+    /** Set the slow start threshold on the first retransmission timeout;
+     *  the window then collapses to one segment */
+    void (*rto) (struct tcb *);
+    /** Take a round trip time sample in milliseconds, may be NULL */
+    void (*rtt) (struct tcb *, unsigned int);
+};
+
+extern const struct tcpCong tcpnewreno;
+extern const struct tcpCong tcpcubic;
+extern const struct tcpCong *tcpcongtab[];
+
 /* Local port allocation ranges */
 #define TCP_PSTART 10000     /**< start port for allocating */
 #define TCP_PMAX   65000        /**< max TCP port */
@@ -190,6 +295,12 @@ extern struct tcb tcptab[];
 #define TCP_FLG_SNDDATA  0x08   /**< Need to send data */
 #define TCP_FLG_SNDRST   0x10   /**< Need to send a RST */
 #define TCP_FLG_PERSIST  0x20   /**< In persist output state */
+#define TCP_FLG_SACK     0x40   /**< Remote side permits SACK */
+#define TCP_FLG_WSCALE   0x80   /**< Remote side scales windows */
+
+/* Send options, set with TCP_CTRL_NODELAY and TCP_CTRL_CORK */
+#define TCP_MODE_NODELAY 0x01   /**< Send small segments without waiting */
+#define TCP_MODE_CORK    0x02   /**< Hold small segments until uncorked */
 
 #define TCP_SEQINCR 904 /**< amount to increment ISS each time */
 
@@ -211,18 +322,22 @@ extern struct tcb tcptab[];
 /* TCP Length Macros */
 #define tcpSeglen(tcppkt, len) (len - offset2octets(tcppkt->offset))
 
-/* TCP Timer Constants */
-#define TCP_NEVENTS     (3*NTCP)+1 /**< max number events (incl dummy head) */
-#define TCP_EVT_HEAD    0   /**< Head entry */
-#define TCP_FREQ        10  /**< milliseconds per timer tick */
-#define TCP_EVT_TIMEWT  1   /**< 2MSL time-wait timeout */
-#define TCP_EVT_RXT     2   /**< retransmit event */
-#define TCP_EVT_PERSIST 3   /**< persist event, for zero window */
+/* TCP Demux Hash */
+#define TCP_NHASH       32  /**< buckets per demux table, power of 2 */
+/** Bucket of a connection bound to both local and remote socket */
+#define tcpHashConn(lpt, rpt, rip) \
+    (((lpt) ^ ((rpt) << 5) ^ netaddrhash(rip)) & (TCP_NHASH - 1))
+/** Bucket of a listening or partially bound connection */
+#define tcpHashListen(lpt) (TCP_NHASH + ((lpt) & (TCP_NHASH - 1)))
+
+extern struct tcb *tcphash[];
 
 /* TCP Timer Durations */
 #define TCP_TWOMSL  (5*1000)
 #define TCP_PST_INITTIME (3*1000)  /**< initial persist time */
 #define TCP_PST_MAXTIME  (64*1000) /**< maximum persist time */
+#define TCP_DELACK_TIME  200        /**< longest an ACK is delayed */
+#define TCP_DELACK_SEGS  2          /**< segments that force an ACK */
 
 /* TCP Retransmit */
 #define TCP_RXT_MAXCOUNT 10         /** maximum number of retransmissions */
@@ -230,23 +345,14 @@ extern struct tcb tcptab[];
 #define TCP_RXT_MINTIME  (100)    /**< minimum retransmission time */
 #define TCP_RXT_MAXTIME  (32*1000) /**< maximum retransmission time */
 
-/* TCP Timer Event */
-struct tcpEvent
-{
-    bool used;                      /**< Is timer event record used? */
-    int time;                       /**< number of TCP timer ticks for event */
-    int remain;                     /**< TCP timer ticks remain */
-    unsigned char type;             /**< Type of event */
-    struct tcb *tcbptr;             /**< TCB for event */
-    struct tcpEvent *next;          /**< Next timer event */
-};
-
-extern struct tcpEvent tcptimertab[];
-extern semaphore tcpmutex;
-
 /* TCP Control Functions */
 #define TCP_CTRL_RECVBYTES 2 /**< Get number of bytes recevied */
 #define TCP_CTRL_SENTBYTES 3 /**< Get number of bytes sent */
+#define TCP_CTRL_RCVBUF    4 /**< Set input buffer size, while closed */
+#define TCP_CTRL_SNDBUF    5 /**< Set output buffer size, while closed */
+#define TCP_CTRL_CC        6 /**< Set congestion control, while closed */
+#define TCP_CTRL_NODELAY   7 /**< Turn the Nagle algorithm off or on */
+#define TCP_CTRL_CORK      8 /**< Hold or release partial segments */
 
 /* TCP Ports */
 #define TCP_PORT_TELNET    23
@@ -270,6 +376,8 @@ void tcpAbort(struct tcb *, int);
 int tcpSetup(struct tcb *);
 
 struct tcb *tcpDemux(unsigned short, unsigned short, struct netaddr *, struct netaddr *);
+void tcpHashInsert(struct tcb *);
+void tcpHashRemove(struct tcb *);
 int tcpRecv(struct packet *, struct netaddr *, struct netaddr *);
 int tcpRecvOpts(struct packet *, struct tcb *);
 int tcpRecvListen(struct packet *, struct tcb *, struct netaddr *);
@@ -279,19 +387,20 @@ int tcpRecvData(struct packet *, struct tcb *);
 bool tcpRecvValid(struct packet *, struct tcb *);
 int tcpRecvAck(struct packet *, struct tcb *);
 int tcpRecvRtt(struct tcb *);
+void tcpRecvSack(struct tcb *, tcpseq, tcpseq);
 
 int tcpSend(struct tcb *, unsigned char, unsigned int, unsigned int, unsigned int, unsigned short);
-unsigned short tcpSendWindow(struct tcb *);
+unsigned int tcpSendWindow(struct tcb *);
 int tcpSendAck(struct tcb *);
 int tcpSendSyn(struct tcb *);
 int tcpSendData(struct tcb *);
 int tcpSendRxt(struct tcb *);
+int tcpSendLost(struct tcb *);
 int tcpSendPersist(struct tcb *);
 int tcpSendRst(struct packet *, struct netaddr *, struct netaddr *);
 
 void tcpStat(struct tcb *);
 
-thread tcpTimer(void);
 void tcpTimerTrigger(unsigned char, struct tcb *);
 xinu_devcall tcpTimerSched(int, struct tcb *, unsigned char);
 xinu_devcall tcpTimerPurge(struct tcb *, unsigned char);
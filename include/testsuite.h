@@ -13,6 +13,7 @@
 thread test_bigargs(bool);
 thread test_schedule(bool);
 thread test_preempt(bool);
+thread test_schedbench(bool);
 thread test_recursion(bool);
 thread test_semaphore(bool);
 thread test_semaphore2(bool);
@@ -20,6 +21,7 @@ thread test_semaphore3(bool);
 thread test_semaphore4(bool);
 thread test_procQueue(bool);
 thread test_deltaQueue(bool);
+thread test_timer(bool);
 thread test_libStdio(bool);
 thread test_libCtype(bool);
 thread test_libString(bool);
@@ -37,10 +39,15 @@ thread test_system(bool);
 thread test_mailbox(bool);
 thread test_messagePass(bool);
 thread test_netaddr(bool);
+thread test_chksum(bool);
+thread test_route(bool);
 thread test_netif(bool);
 thread test_arp(bool);
+thread test_bpf(bool);
 thread test_snoop(bool);
+thread test_netemu(bool);
 thread test_udp(bool);
+thread test_tcp(bool);
 thread test_raw(bool);
 thread test_ip(bool);
 thread test_umemory(bool);
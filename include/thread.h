@@ -38,7 +38,11 @@
 
 /* Check for invalid thread ids.  Note that interrupts must be disabled */
 /* for the condition to hold true between statements.                   */
-#define isbadtid(x) ((x)>=NTHREAD || (x)<0 || THRFREE == thrtab[(x)].state)
+#define isbadtid(x) ((x)>=NTHREAD || (x)<0 || THRFREE == thrtab[(x)].state \
+                     || THRDEAD == thrtab[(x)].state)
+
+/** Passed as a core to run a thread on any core */
+#define THRNOAFFINITY (-1)
 
 /** Maximum number of file descriptors a thread can hold */
 #define NDESC       5
@@ -68,6 +72,7 @@ struct thrent
 		THRWAIT     = 7,
 		THRTMOUT    = 8,
 		THRMIGRATE  = 9,
+		THRDEAD     = 10,
 	} state;						/**< thread state: THRCURR, etc.        */
     int prio;						/**< thread priority                    */
 	void *stkptr;					/**< saved stack pointer                */
@@ -81,7 +86,8 @@ struct thrent
 	struct {
 		unsigned hasmsg : 1;		/**< nonzero iff msg is valid           */
 		unsigned coreaffinity : 1;	/**< nonzero if core affinity is set	*/
-		unsigned coreid : 3;		/**< core affinity for the thread       */
+		unsigned coreid : 3;		/**< pinned core, else last core run on */
+		unsigned killed : 1;		/**< killed, dies at next reschedule    */
 	};
     struct memblock memlist;		/**< free memory list of thread         */
     int fdesc[NDESC];				/**< device descriptors for thread      */
@@ -89,7 +95,14 @@ struct thrent
 
 extern struct thrent thrtab[];
 extern int thrcount;				/**< currently active threads           */
+#if NCORE > 1
+#include <CriticalSection.h>
+extern tid_typ corecurrent[];		/**< thread executing on each core      */
+#define thrcurrent (corecurrent[getcpuid()])
+#else
 extern tid_typ thrcurrent;			/**< currently executing thread         */
+#endif
+extern int resdefer[];				/**< >0 if rescheduling deferred, per core */
 
 /* Inter-Thread Communication prototypes */
 xinu_syscall send (tid_typ, xinu_message);
@@ -100,11 +113,16 @@ xinu_message recvtime (int);
 /* Thread management function prototypes */
 tid_typ create(void *procaddr, unsigned int ssize, int priority,
                const char *name, int nargs, ...);
+tid_typ createon(int core, void *procaddr, unsigned int ssize,
+                 int priority, const char *name, int nargs, ...);
+xinu_syscall chaffinity (tid_typ, int);
 tid_typ gettid (void);
 xinu_syscall getprio (tid_typ);
 xinu_syscall kill (int);
 int ready (tid_typ);
 int resched (void);
+void thrdie (tid_typ);
+void thrreap (void);
 xinu_syscall sleep (unsigned int);
 xinu_syscall unsleep (tid_typ);
 xinu_syscall yield (void);
@@ -0,0 +1,56 @@
+/**
+ * @file timer.h
+ * Definitions for the kernel timer service.  Subsystems embed a struct
+ * timer in their own records and schedule it to have a function called
+ * from the timer thread once a delay has passed.  Timers live on a
+ * hierarchical timing wheel, so scheduling and cancelling take constant
+ * time however many are pending, and there is no table of events to run
+ * out of.
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#ifndef _TIMER_H_
+#define _TIMER_H_
+
+#include <stddef.h>
+#include <thread.h>
+
+/* Wheel geometry */
+#define TIMER_FREQ      10      /**< Milliseconds per wheel tick          */
+#define TIMER_SLOTBITS  6       /**< log2 of slots per level              */
+#define TIMER_NSLOT     (1 << TIMER_SLOTBITS)
+#define TIMER_NLEVEL    4       /**< Levels, covering 2^24 ticks          */
+#define TIMER_MAXTICKS  ((1UL << (TIMER_SLOTBITS * TIMER_NLEVEL)) - 1)
+
+/* Timer thread */
+#define TIMER_THR_PRIO  INITPRIO    /**< Timer thread priority          */
+#define TIMER_THR_STK   INITSTK     /**< Timer thread stack size        */
+
+/**
+ * @ingroup timer
+ *
+ * Timer, embedded in whatever it times.  Fields are private to the timer
+ * service once timerSetup() has been called.
+ */
+struct timer
+{
+    struct timer *next;         /**< Next timer in the same slot          */
+    struct timer **pprev;       /**< Link to this timer, NULL if idle     */
+    unsigned long expires;      /**< Wheel tick at which timer fires      */
+    unsigned long start;        /**< Wheel tick at which it was scheduled */
+    void (*func) (void *);      /**< Function to call when timer fires    */
+    void *arg;                  /**< Argument passed to func              */
+};
+
+/** Is a timer waiting to fire? */
+#define timerPending(tmr) (NULL != (tmr)->pprev)
+
+/* Function prototypes */
+xinu_syscall timerInit(void);
+void timerSetup(struct timer *, void (*)(void *), void *);
+xinu_syscall timerSched(struct timer *, unsigned int);
+xinu_syscall timerCancel(struct timer *);
+unsigned int timerRemain(struct timer *);
+thread timerDaemon(void);
+
+#endif                          /* _TIMER_H_ */
@@ -33,6 +33,12 @@
 #define UDP_HDR_LEN	        8
 #define UDP_MAX_PKTS        100
 #define UDP_MAX_DATALEN     1024
+/** Largest datagram held for a socket, as reassembled by IPv4, plus the
+ *  pseudo-header it is stored behind */
+#define UDP_MAX_PKTLEN      (sizeof(struct udpPseudoHdr) + IPv4_FRAG_MAXLEN)
+/** Size of a socket's pooled input buffers; larger datagrams get memory
+ *  of their own as they arrive */
+#define UDP_INBUF_LEN       NET_MAX_PKTLEN
 #define UDP_TTL             64
 
 /** @}
@@ -71,6 +77,14 @@
 #define UDP_PSTART  10000   /**< start port for allocating */
 #define UDP_PMAX    65000   /**< max UDP port */
 
+/* Demux hash */
+#define UDP_NHASH   16      /**< buckets per demux table, power of 2 */
+/** Bucket of a socket bound to both local and remote socket */
+#define udpHashConn(lpt, rpt, rip) \
+    (((lpt) ^ ((rpt) << 5) ^ netaddrhash(rip)) & (UDP_NHASH - 1))
+/** Bucket of a socket bound to its local socket only */
+#define udpHashListen(lpt) (UDP_NHASH + ((lpt) & (UDP_NHASH - 1)))
+
 #ifndef __ASSEMBLER__
 
 /*
@@ -141,9 +155,12 @@ struct udp
 
     unsigned char state;                /**< UDP state                      */
     unsigned char flags;                /**< UDP flags                      */
+    unsigned short hslot;               /**< Demux hash slot + 1, 0 if none */
+    struct udp *hnext;                  /**< Next socket in demux chain     */
 };
 
 extern struct udp udptab[];
+extern struct udp *udphash[];
 
 /** @} */
 
@@ -158,11 +175,13 @@ unsigned short udpChksum(struct packet *, unsigned short, const struct netaddr *
                          const struct netaddr *);
 struct udp *udpDemux(unsigned short, unsigned short, const struct netaddr *,
                      const struct netaddr *);
+void udpHashInsert(struct udp *);
+void udpHashRemove(struct udp *);
 xinu_syscall udpRecv(struct packet *, const struct netaddr *,
                      const struct netaddr *);
 xinu_syscall udpSend(struct udp *, unsigned short, const void *);
 xinu_devcall udpControl(device *, int, long, long);
-struct udpPkt *udpGetbuf(struct udp *);
+struct udpPkt *udpGetbuf(struct udp *, unsigned int);
 xinu_syscall udpFreebuf(struct udpPkt *);
 
 #endif                          /* __ASSEMBLER__ */
@@ -31,6 +31,21 @@ struct usb_xfer_request;
  */
 typedef void (*usb_xfer_completed_t)(struct usb_xfer_request *req);
 
+/**
+ * @ingroup usbcore
+ *
+ * One piece of the data of a bulk or interrupt transfer spread over several
+ * buffers.  See @ref usb_xfer_request::segs "segs".
+ */
+struct usb_xfer_segment
+{
+    /** Data to send, or space for received data.  */
+    void *buf;
+
+    /** Length of the buffer in bytes.  */
+    unsigned int len;
+};
+
 /**
  * @ingroup usbcore
  *
@@ -81,6 +96,16 @@ struct usb_xfer_request
      * exact number of bytes of data to send.  */
     unsigned int size;
 
+    /** Optional list of buffers to send from or receive into, in order,
+     * instead of sendbuf or recvbuf.  size must be their total length.  The
+     * Host Controller Driver gathers or scatters them through its own DMA
+     * buffer, so the transfer still takes one programming of the hardware.
+     * Ignored if nsegs is 0; not allowed for control transfers.  */
+    const struct usb_xfer_segment *segs;
+
+    /** Number of entries in segs.  */
+    unsigned int nsegs;
+
     /** Setup data for the USB control request.  Must be filled in for control
      * transfers; ignored otherwise.  Note: consider using usb_control_msg() for
      * control transfers instead.  */
@@ -111,13 +136,21 @@ struct usb_xfer_request
      * whatever reason the device was unable to provide the full size.  */
     unsigned int actual_size;
 
+    /*****************************************************************
+     * Variables of the USB core driver (set by                      *
+     * usb_alloc_xfer_request(); do not touch from device drivers or *
+     * Host Controller Drivers).                                     *
+     *****************************************************************/
+    unsigned int buf_size;
+    bool buf_allocated;
+
     /*****************************************************************
      * Private variables (mainly for Host Controller Drivers; do not *
      * touch from device drivers).  TODO: a better design might      *
      * allow HCDs to customize the variables they can use, perhaps   *
      * by embedding the usb_xfer_request in another struct.          *
      *****************************************************************/
-    uint8_t*cur_data_ptr;
+    unsigned int cur_offset;
 	struct {
 		unsigned complete_split : 1;
 		unsigned short_attempt : 1;
@@ -125,9 +158,8 @@ struct usb_xfer_request
 		unsigned control_phase : 2;
 		unsigned next_data_pid : 2;
 		unsigned in_use : 1;
-		unsigned buf_allocated : 1;
 		unsigned csplit_retries : 7;
-		unsigned _reserved : 16;
+		unsigned _reserved : 17;
 	} __packed;
     unsigned int attempted_size;
     unsigned int attempted_packets_remaining;
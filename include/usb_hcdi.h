@@ -65,4 +65,30 @@ void hcd_stop(void);
  */
 usb_status_t hcd_submit_xfer_request(struct usb_xfer_request *req);
 
+/**
+ * @ingroup usbhcd
+ *
+ * Allocates a data buffer the Host Controller can transfer to and from
+ * directly, without copying through a buffer of its own.
+ *
+ * @param size
+ *      Size of the buffer in bytes.
+ *
+ * @return
+ *      Pointer to the buffer, or @c NULL if out of memory.
+ */
+void *hcd_alloc_buffer(unsigned int size);
+
+/**
+ * @ingroup usbhcd
+ *
+ * Frees a buffer allocated with hcd_alloc_buffer().
+ *
+ * @param buf
+ *      Pointer to the buffer.
+ * @param size
+ *      Size of the buffer in bytes (same value passed to hcd_alloc_buffer()).
+ */
+void hcd_free_buffer(void *buf, unsigned int size);
+
 #endif /* _USB_HCDI_H_ */
@@ -2,15 +2,24 @@
  * @file memcmp.c
  */
 
-/* Embedded Xinu, Copyright (C) 2009, 2013.  All rights reserved. */
+/* Embedded Xinu, Copyright (C) 2009, 2013, 2018.  All rights reserved. */
 
+#include <stdint.h>
 #include <string.h>
 
+#if defined(__arm__) || defined(__aarch64__)
+/* Word that may alias the caller's byte buffers */
+typedef uint32_t __attribute__((__may_alias__)) word_t;
+#endif
+
 /**
  * @ingroup libxc
  *
  * Compares two memory regions of a specified length.
  *
+ * On ARM, regions with the same word alignment are compared a word at a
+ * time up to the first differing word, which is then compared bytewise.
+ *
  * @param s1
  *      Pointer to the first memory location.
  * @param s2
@@ -28,6 +37,35 @@ int memcmp(const void *s1, const void *s2, size_t n)
     const unsigned char *p1 = s1, *p2 = s2;
     size_t i;
 
+#if defined(__arm__) || defined(__aarch64__)
+    if ((n >= 2 * sizeof(word_t)) &&
+        (0 == (((uintptr_t)p1 ^ (uintptr_t)p2) & (sizeof(word_t) - 1))))
+    {
+        const word_t *w1, *w2;
+
+        while ((uintptr_t)p1 & (sizeof(word_t) - 1))
+        {
+            if (*p1 != *p2)
+            {
+                return (int)*p1 - (int)*p2;
+            }
+            p1++;
+            p2++;
+            n--;
+        }
+        w1 = (const word_t *)p1;
+        w2 = (const word_t *)p2;
+        while ((n >= sizeof(word_t)) && (*w1 == *w2))
+        {
+            w1++;
+            w2++;
+            n -= sizeof(word_t);
+        }
+        p1 = (const unsigned char *)w1;
+        p2 = (const unsigned char *)w2;
+    }
+#endif
+
     for (i = 0; i < n; i++)
     {
         if (p1[i] != p2[i])
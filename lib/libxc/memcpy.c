@@ -1,16 +1,29 @@
 /**
  * @file memcpy.c
  */
-/* Embedded Xinu, Copyright (C) 2009, 2013.  All rights reserved. */
+/* Embedded Xinu, Copyright (C) 2009, 2013, 2018.  All rights reserved. */
 
+#include <stdint.h>
 #include <string.h>
 
+#if defined(__arm__) || defined(__aarch64__)
+/* Word that may alias the caller's byte buffers */
+typedef uint32_t __attribute__((__may_alias__)) word_t;
+#endif
+
 /**
  * @ingroup libxc
  *
  * Copy the specified number of bytes of memory to another location.  The memory
  * locations must not overlap.
  *
+ * On ARM the destination is brought to word alignment and the bulk is moved
+ * a word, or a block of eight words (LDM/STM or NEON), at a time.  A source
+ * with different alignment is read as aligned words and shifted into place,
+ * since the MMU-less kernel cannot take unaligned loads.  Bytes are copied
+ * strictly in ascending order of blocks, each read before it is written,
+ * which memmove() relies on.  Other architectures copy bytes.
+ *
  * @param dest
  *      Pointer to the destination memory.
  * @param src
@@ -25,11 +38,79 @@ void *memcpy(void *dest, const void *src, size_t n)
 {
     unsigned char *dest_p = dest;
     const unsigned char *src_p = src;
-    size_t i;
 
-    for (i = 0; i < n; i++)
+#if defined(__arm__) || defined(__aarch64__)
+    if (n >= 2 * sizeof(word_t))
+    {
+        word_t *dw;
+        const word_t *sw;
+        unsigned int shift;
+        word_t w, next;
+
+        /* Copy the head up to the destination's word boundary */
+        while ((uintptr_t)dest_p & (sizeof(word_t) - 1))
+        {
+            *dest_p++ = *src_p++;
+            n--;
+        }
+        dw = (word_t *)dest_p;
+
+        if (0 == ((uintptr_t)src_p & (sizeof(word_t) - 1)))
+        {
+            sw = (const word_t *)src_p;
+#if defined(__arm__) && defined(__ARM_NEON)
+            if (0 == ((uintptr_t)dw & 7) && 0 == ((uintptr_t)sw & 7))
+            {
+                while (n >= 32)
+                {
+                    __asm__ volatile ("vld1.64 {d0-d3}, [%0:64]!\n\t"
+                                      "vst1.64 {d0-d3}, [%1:64]!"
+                                      : "+r" (sw), "+r" (dw)
+                                      : : "d0", "d1", "d2", "d3", "memory");
+                    n -= 32;
+                }
+            }
+#endif
+#if defined(__arm__)
+            while (n >= 32)
+            {
+                __asm__ volatile ("ldmia %0!, {r3-r6, r8-r10, r12}\n\t"
+                                  "stmia %1!, {r3-r6, r8-r10, r12}"
+                                  : "+r" (sw), "+r" (dw)
+                                  : : "r3", "r4", "r5", "r6", "r8", "r9",
+                                  "r10", "r12", "memory");
+                n -= 32;
+            }
+#endif
+            while (n >= sizeof(word_t))
+            {
+                *dw++ = *sw++;
+                n -= sizeof(word_t);
+            }
+            src_p = (const unsigned char *)sw;
+        }
+        else
+        {
+            /* Merge neighbouring aligned source words (little endian) */
+            shift = ((uintptr_t)src_p & (sizeof(word_t) - 1)) * 8;
+            sw = (const word_t *)((uintptr_t)src_p & ~(sizeof(word_t) - 1));
+            w = *sw++;
+            while (n >= sizeof(word_t))
+            {
+                next = *sw++;
+                *dw++ = (w >> shift) | (next << (32 - shift));
+                w = next;
+                n -= sizeof(word_t);
+                src_p += sizeof(word_t);
+            }
+        }
+        dest_p = (unsigned char *)dw;
+    }
+#endif
+
+    while (n--)
     {
-        dest_p[i] = src_p[i];
+        *dest_p++ = *src_p++;
     }
 
     return dest;
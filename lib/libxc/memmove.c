@@ -0,0 +1,75 @@
+/**
+ * @file memmove.c
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__arm__) || defined(__aarch64__)
+/* Word that may alias the caller's byte buffers */
+typedef uint32_t __attribute__((__may_alias__)) word_t;
+#endif
+
+/**
+ * @ingroup libxc
+ *
+ * Copy the specified number of bytes of memory to another location.  The memory
+ * locations may overlap.
+ *
+ * @param dest
+ *      Pointer to the destination memory.
+ * @param src
+ *      Pointer to the source memory.
+ * @param n
+ *      The amount of data (in bytes) to copy.
+ *
+ * @return
+ *      @p dest
+ */
+void *memmove(void *dest, const void *src, size_t n)
+{
+    unsigned char *dest_p = dest;
+    const unsigned char *src_p = src;
+
+    /* memcpy() copies upwards reading ahead of writing, which is safe
+     * whenever the destination does not start inside the source.  */
+    if ((dest_p <= src_p) || (dest_p >= src_p + n))
+    {
+        return memcpy(dest, src, n);
+    }
+
+    /* Copy downwards from the end */
+    dest_p += n;
+    src_p += n;
+#if defined(__arm__) || defined(__aarch64__)
+    if ((n >= 2 * sizeof(word_t)) &&
+        (0 == (((uintptr_t)dest_p ^ (uintptr_t)src_p) & (sizeof(word_t) - 1))))
+    {
+        word_t *dw;
+        const word_t *sw;
+
+        while ((uintptr_t)dest_p & (sizeof(word_t) - 1))
+        {
+            *--dest_p = *--src_p;
+            n--;
+        }
+        dw = (word_t *)dest_p;
+        sw = (const word_t *)src_p;
+        while (n >= sizeof(word_t))
+        {
+            *--dw = *--sw;
+            n -= sizeof(word_t);
+        }
+        dest_p = (unsigned char *)dw;
+        src_p = (const unsigned char *)sw;
+    }
+#endif
+
+    while (n--)
+    {
+        *--dest_p = *--src_p;
+    }
+
+    return dest;
+}
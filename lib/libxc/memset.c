@@ -1,15 +1,24 @@
 /**
  * @file memset.c
  */
-/* Embedded Xinu, Copyright (C) 2009, 2013.  All rights reserved. */
+/* Embedded Xinu, Copyright (C) 2009, 2013, 2018.  All rights reserved. */
 
+#include <stdint.h>
 #include <string.h>
 
+#if defined(__arm__) || defined(__aarch64__)
+/* Word that may alias the caller's byte buffers */
+typedef uint32_t __attribute__((__may_alias__)) word_t;
+#endif
+
 /** 
  * @ingroup libxc
  *
  * Fills a region of memory with a byte.
  *
+ * On ARM the aligned bulk of the region is stored a word, or a block of
+ * eight words (STM or NEON), at a time.  Other architectures store bytes.
+ *
  * @param s
  *      pointer to the memory to place byte into
  * @param c
@@ -24,11 +33,61 @@ void *memset(void *s, int c, size_t n)
 {
     unsigned char *p = s;
     unsigned char byte = c;
-    size_t i;
 
-    for (i = 0; i < n; i++)
+#if defined(__arm__) || defined(__aarch64__)
+    if (n >= 2 * sizeof(word_t))
+    {
+        word_t *wp;
+        word_t w = byte * 0x01010101u;
+
+        while ((uintptr_t)p & (sizeof(word_t) - 1))
+        {
+            *p++ = byte;
+            n--;
+        }
+        wp = (word_t *)p;
+#if defined(__arm__) && defined(__ARM_NEON)
+        if ((n >= 32) && (0 == ((uintptr_t)wp & 7)))
+        {
+            size_t blocks = n >> 5;
+
+            __asm__ volatile ("vdup.32 q0, %2\n\t"
+                              "vmov q1, q0\n"
+                              "1:\n\t"
+                              "vst1.64 {d0-d3}, [%0:64]!\n\t"
+                              "subs %1, %1, #1\n\t"
+                              "bne 1b"
+                              : "+r" (wp), "+r" (blocks) : "r" (w)
+                              : "d0", "d1", "d2", "d3", "cc", "memory");
+            n &= 31;
+        }
+#endif
+#if defined(__arm__)
+        while (n >= 32)
+        {
+            __asm__ volatile ("mov r3, %1\n\t"
+                              "mov r4, %1\n\t"
+                              "mov r5, %1\n\t"
+                              "mov r6, %1\n\t"
+                              "stmia %0!, {r3-r6}\n\t"
+                              "stmia %0!, {r3-r6}"
+                              : "+r" (wp) : "r" (w)
+                              : "r3", "r4", "r5", "r6", "memory");
+            n -= 32;
+        }
+#endif
+        while (n >= sizeof(word_t))
+        {
+            *wp++ = w;
+            n -= sizeof(word_t);
+        }
+        p = (unsigned char *)wp;
+    }
+#endif
+
+    while (n--)
     {
-        p[i] = byte;
+        *p++ = byte;
     }
     return s;
 }
@@ -1,15 +1,28 @@
 /**
  * @file strlen.c
  */
-/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+/* Embedded Xinu, Copyright (C) 2013, 2018.  All rights reserved. */
 
+#include <stdint.h>
 #include <string.h>
 
+#if defined(__arm__) || defined(__aarch64__)
+/* Word that may alias the caller's byte buffers */
+typedef uint32_t __attribute__((__may_alias__)) word_t;
+
+/* Nonzero if any byte of w is zero */
+#define haszero(w) (((w) - 0x01010101u) & ~(w) & 0x80808080u)
+#endif
+
 /**
  * @ingroup libxc
  *
  * Calculates the length of a null-terminated string.
  *
+ * On ARM the string is scanned an aligned word at a time.  An aligned word
+ * never spans past the end of the memory holding its first byte, so reading
+ * beyond the terminator within it is safe.
+ *
  * @param s
  *      String to calculate the length of.
  *
@@ -20,6 +33,23 @@ size_t strlen(const char *s)
 {
     size_t n = 0;
 
+#if defined(__arm__) || defined(__aarch64__)
+    const word_t *wp;
+
+    while ((uintptr_t)(s + n) & (sizeof(word_t) - 1))
+    {
+        if (s[n] == '\0')
+        {
+            return n;
+        }
+        n++;
+    }
+    for (wp = (const word_t *)(s + n); !haszero(*wp); wp++)
+    {
+        n += sizeof(word_t);
+    }
+#endif
+
     while (s[n] != '\0')
     {
         n++;
@@ -32,14 +32,16 @@ xinu_syscall mailboxReceive(mailbox box)
     }
 
     mbxptr = &mboxtab[box];
-	ENTER_KERNEL_CRITICAL_SECTION();
     retval = SYSERR;
     if (MAILBOX_ALLOC == mbxptr->state)
     {
+        bool received = FALSE;
+
         /* wait until there is a mailmsg in the mailmsg queue */
         wait(mbxptr->receiver);
 
         /* only continue if the mailbox hasn't been freed  */
+        ENTER_KERNEL_CRITICAL_SECTION();
         if (MAILBOX_ALLOC == mbxptr->state)
         {
             /* recieve the first mailmsg in the mailmsg queue */
@@ -47,12 +49,16 @@ xinu_syscall mailboxReceive(mailbox box)
 
             mbxptr->start = (mbxptr->start + 1) % mbxptr->max;
             mbxptr->count--;
+            received = TRUE;
+        }
+        EXIT_KERNEL_CRITICAL_SECTION();
 
-            /* signal that there is another empty space in the mailmsg queue */
+        /* signal that there is another empty space in the mailmsg queue */
+        if (received)
+        {
             signal(mbxptr->sender);
         }
     }
 
-	EXIT_KERNEL_CRITICAL_SECTION();
     return retval;
 }
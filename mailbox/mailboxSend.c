@@ -34,7 +34,6 @@ xinu_syscall mailboxSend(mailbox box, int mailmsg)
     }
 
     mbxptr = &mboxtab[box];
-	ENTER_KERNEL_CRITICAL_SECTION();
     retval = SYSERR;
     if (MAILBOX_ALLOC == mbxptr->state)
     {
@@ -42,20 +41,23 @@ xinu_syscall mailboxSend(mailbox box, int mailmsg)
         wait(mbxptr->sender);
 
         /* only continue if the mailbox hasn't been freed  */
+        ENTER_KERNEL_CRITICAL_SECTION();
         if (MAILBOX_ALLOC == mbxptr->state)
         {
             /* write mailmsg to this mailbox's mailmsg queue */
             mbxptr->msgs[((mbxptr->start + mbxptr->count) % mbxptr->max)] =
                 mailmsg;
             mbxptr->count++;
+            retval = OK;
+        }
+        EXIT_KERNEL_CRITICAL_SECTION();
 
-            /* signal that there is another mailmsg in the mailmsg queue */
+        /* signal that there is another mailmsg in the mailmsg queue */
+        if (OK == retval)
+        {
             signal(mbxptr->receiver);
-
-            retval = OK;
         }
     }
 
-	EXIT_KERNEL_CRITICAL_SECTION();
     return retval;
 }
@@ -8,7 +8,7 @@
 #include <xinu.h>
 #include <memory.h>
 #include <safemem.h>
-#include <interrupt.h>
+#include <CriticalSection.h>
 #include <thread.h>
 
 /**
@@ -21,7 +21,6 @@ void free(void *base)
 #ifdef UHEAP_SIZE
     struct thrent *thread;
     struct memblock *block, *next, *prev;
-    irqmask im;
     unsigned int top;
 
 
@@ -40,7 +39,7 @@ void free(void *base)
     /* unmap pages from system page table */
     safeUnmapRange(block, block->length);
 
-    im = disable();
+    ENTER_KERNEL_CRITICAL_SECTION();
 
     /* get pointer to current thread */
     thread = &thrtab[thrcurrent];
@@ -68,7 +67,7 @@ void free(void *base)
         || ((next != NULL)
             && ((ulong)block + block->length) > (ulong)next))
     {
-        restore(im);
+        EXIT_KERNEL_CRITICAL_SECTION();
         return;
     }
 
@@ -93,6 +92,6 @@ void free(void *base)
         block->next = next->next;
     }
 
-    restore(im);
+    EXIT_KERNEL_CRITICAL_SECTION();
 #endif                          /* UHEAP_SIZE */
 }
@@ -8,7 +8,7 @@
 #include <xinu.h>
 #include <memory.h>
 #include <safemem.h>
-#include <interrupt.h>
+#include <CriticalSection.h>
 #include <thread.h>
 #include <stdlib.h>
 
@@ -21,7 +21,6 @@
 void *malloc(unsigned int nbytes)
 {
 #ifdef UHEAP_SIZE
-    irqmask im;
     struct thrent *thread;
     struct memregion *region;
     struct memblock *prev, *curr, *leftover;
@@ -41,7 +40,7 @@ void *malloc(unsigned int nbytes)
     /* setup thread pointer */
     thread = &thrtab[thrcurrent];
 
-    im = disable();
+    ENTER_KERNEL_CRITICAL_SECTION();
 
     prev = &(thread->memlist);
     curr = thread->memlist.next;
@@ -76,7 +75,7 @@ void *malloc(unsigned int nbytes)
         curr->next = curr;
         curr->length = nbytes;
 
-        restore(im);
+        EXIT_KERNEL_CRITICAL_SECTION();
         return (void *)(curr + 1);
     }
 
@@ -84,7 +83,7 @@ void *malloc(unsigned int nbytes)
     region = memRegionAlloc(nbytes);
     if (SYSERR == (int)region)
     {
-        restore(im);
+        EXIT_KERNEL_CRITICAL_SECTION();
         return NULL;
     }
 
@@ -109,7 +108,7 @@ void *malloc(unsigned int nbytes)
     /* map memory to system page table */
     safeMapRange(curr, nbytes, ENT_USER);
 
-    restore(im);
+    EXIT_KERNEL_CRITICAL_SECTION();
     return (void *)(curr + 1);
 #else
     return NULL;
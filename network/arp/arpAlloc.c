@@ -49,8 +49,10 @@ struct arpEntry *arpAlloc(void)
         return (struct arpEntry *)SYSERR;
     }
 
-    /* Return entry with minimum expires */
-    bzero(minexpires, sizeof(struct arpEntry));
+    /* Return entry with minimum expires; the caller is in the critical
+     * section, so its waiting threads are left to time out on their own */
+    minexpires->count = 0;
+    arpFree(minexpires);
     minexpires->state = ARP_USED;
     return minexpires;
 }
@@ -7,16 +7,35 @@
 #include <xinu.h>
 #include <arp.h>
 #include <mailbox.h>
+#include <thread.h>
+#include <timer.h>
+
+static struct timer arptimer;
+
+/* Wake arpDaemon once per sweep period with an empty message */
+static void arpTick(void *arg)
+{
+    if (mailboxCount(arpqueue) < ARP_NQUEUE)
+    {
+        mailboxSend(arpqueue, NULL);
+    }
+    timerSched(&arptimer, ARP_EXPIRE_FREQ * 1000);
+}
 
 /**
  * @ingroup arp
  *
- * ARP daemon to manage the ARP table.
+ * ARP daemon to manage the ARP table.  Replies to queued requests and,
+ * when woken by its timer, frees expired entries so that lookups on the
+ * send path never have to.
  */
 thread arpDaemon(void)
 {
     struct packet *pkt = NULL;
 
+    timerSetup(&arptimer, arpTick, NULL);
+    timerSched(&arptimer, ARP_EXPIRE_FREQ * 1000);
+
     while (TRUE)
     {
         pkt = (struct packet *)mailboxReceive(arpqueue);
@@ -25,6 +44,11 @@ thread arpDaemon(void)
         {
             continue;
         }
+        if (NULL == pkt)
+        {
+            arpExpire();
+            continue;
+        }
 
         arpSendReply(pkt);
 
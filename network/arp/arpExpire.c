@@ -0,0 +1,48 @@
+/**
+ * @file arpExpire.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <arp.h>
+#include <clock.h>
+#include <CriticalSection.h>
+#include <string.h>
+#include <thread.h>
+
+/**
+ * @ingroup arp
+ *
+ * Free every ARP table entry whose time has run out.  Only the front of
+ * the expiry queue is examined.  Each expired entry is freed within the
+ * kernel critical section and the threads waiting on it are notified
+ * after leaving it.  Called periodically by arpDaemon().
+ */
+void arpExpire(void)
+{
+    tid_typ waiting[ARP_NTHRWAIT];
+    int count;
+    int i;
+
+    while (TRUE)
+    {
+		ENTER_KERNEL_CRITICAL_SECTION();
+        if ((NULL == arpexphead) || (arpexphead->expires >= clktime))
+        {
+			EXIT_KERNEL_CRITICAL_SECTION();
+            break;
+        }
+        ARP_TRACE("Entry %d expired", arpexphead - arptab);
+        count = arpexphead->count;
+        memcpy(waiting, arpexphead->waiting, sizeof(tid_typ) * count);
+        arpexphead->count = 0;
+        arpFree(arpexphead);
+		EXIT_KERNEL_CRITICAL_SECTION();
+
+        for (i = 0; i < count; i++)
+        {
+            send(waiting[i], TIMEOUT);
+        }
+    }
+}
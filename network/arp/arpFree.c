@@ -12,7 +12,9 @@
 /**
  * @ingroup arp
  *
- * Frees an entry from the ARP table.
+ * Frees an entry from the ARP table.  Threads still waiting on the entry
+ * are notified, which may reschedule; callers within the kernel critical
+ * section must first clear the entry's list of waiting threads.
  * @return SYSERR if error occurs, otherwise OK
  */
 xinu_syscall arpFree ( struct arpEntry *entry)
@@ -33,6 +35,7 @@ xinu_syscall arpFree ( struct arpEntry *entry)
     }
 
     /* Clear ARP table entry */
+    arpRemove(entry);
     bzero(entry, sizeof(struct arpEntry));
     entry->state = ARP_FREE;
     ARP_TRACE("Freed entry %d",
@@ -12,7 +12,8 @@
 /**
  * @ingroup arp
  *
- * Obtains an entry from the ARP table given a protocol address.
+ * Obtains an entry from the ARP table given a protocol address.  Only the
+ * entries hashed to the same bucket are examined.
  * @param praddr protocol address
  * @return entry for correspoding praddr in ARP table, NULL if none exists
  */
@@ -23,29 +24,23 @@ struct arpEntry *arpGetEntry(const struct netaddr *praddr)
     ARP_TRACE("Getting ARP entry");
 	ENTER_KERNEL_CRITICAL_SECTION();
 
-    /* Loop through ARP table */
-    for (int i = 0; i < ARP_NENTRY; i++)
+    for (entry = arphash[arpHash(praddr)]; NULL != entry;
+         entry = entry->hnext)
     {
-        /* If ARP entry is not used, skip to next entry */
-        if (!(ARP_USED & arptab[i].state))
-        {
-            continue;
-        }
-
-        entry = &arptab[i];
-        /* Check if entry has timed out */
-        if (entry->expires < clktime)
-        {
-            ARP_TRACE("\tEntry %d expired", i);
-            arpFree(entry);
-            continue;
-        }
-
         /* Check if protocol type and address match */
         if (netaddrequal(&entry->praddr, praddr))
         {
+            /* An entry arpDaemon has not yet swept may have timed out */
+            if (entry->expires < clktime)
+            {
+                ARP_TRACE("\tEntry %d expired", entry - arptab);
+                /* Its waiting threads time out on their own */
+                entry->count = 0;
+                arpFree(entry);
+                break;
+            }
 			EXIT_KERNEL_CRITICAL_SECTION();
-            ARP_TRACE("\tEntry %d matches", i);
+            ARP_TRACE("\tEntry %d matches", entry - arptab);
             return entry;
         }
     }
@@ -11,6 +11,9 @@
 #include <thread.h>
 
 struct arpEntry arptab[ARP_NENTRY];
+struct arpEntry *arphash[ARP_NHASH];
+struct arpEntry *arpexphead;
+struct arpEntry *arpexptail;
 mailbox arpqueue;
 
 /**
@@ -28,6 +31,12 @@ xinu_syscall arpInit(void)
         bzero(&arptab[i], sizeof(struct arpEntry));
         arptab[i].state = ARP_FREE;
     }
+    for (int i = 0; i < ARP_NHASH; i++)
+    {
+        arphash[i] = NULL;
+    }
+    arpexphead = NULL;
+    arpexptail = NULL;
 
     /* Initialize ARP queue */
     arpqueue = mailboxAlloc(ARP_NQUEUE);
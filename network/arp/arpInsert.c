@@ -0,0 +1,58 @@
+/**
+ * @file arpInsert.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <arp.h>
+#include <CriticalSection.h>
+
+/**
+ * @ingroup arp
+ *
+ * Index a populated ARP table entry by its protocol address and queue it
+ * for expiry.  The expiry queue is kept in order of expires; entries are
+ * placed from the tail, so the usual refresh to the longest TTL is O(1).
+ * Call arpRemove() before changing the protocol address or expiry of an
+ * indexed entry.
+ * @param entry ARP table entry, not already indexed
+ */
+void arpInsert(struct arpEntry *entry)
+{
+    struct arpEntry *prev;
+    unsigned int slot;
+
+    slot = arpHash(&entry->praddr);
+
+	ENTER_KERNEL_CRITICAL_SECTION();
+    entry->hnext = arphash[slot];
+    arphash[slot] = entry;
+    entry->hslot = slot + 1;
+
+    prev = arpexptail;
+    while ((NULL != prev) && (prev->expires > entry->expires))
+    {
+        prev = prev->eprev;
+    }
+    entry->eprev = prev;
+    if (NULL == prev)
+    {
+        entry->enext = arpexphead;
+        arpexphead = entry;
+    }
+    else
+    {
+        entry->enext = prev->enext;
+        prev->enext = entry;
+    }
+    if (NULL == entry->enext)
+    {
+        arpexptail = entry;
+    }
+    else
+    {
+        entry->enext->eprev = entry;
+    }
+	EXIT_KERNEL_CRITICAL_SECTION();
+}
@@ -15,6 +15,8 @@
  * @ingroup arp
  *
  * Obtains a hardware address from the ARP table given a protocol address.
+ * The entry last resolved through each interface is tried first, so a
+ * stream of packets to one destination skips the table altogether.
  * @param netptr network interface
  * @param praddr protocol address
  * @param hwaddr buffer into which hardware address should be placed
@@ -36,6 +38,19 @@ xinu_syscall arpLookup (struct netif *netptr, const struct netaddr *praddr,
 
     ARP_TRACE("Looking up protocol address");
 
+    /* Last destination fast path; the entry may since have been reused */
+    ENTER_KERNEL_CRITICAL_SECTION();
+    entry = netptr->arplast;
+    if ((NULL != entry) && (ARP_RESOLVED == entry->state)
+        && (entry->expires >= clktime)
+        && (netaddrequal(&entry->praddr, praddr)))
+    {
+        netaddrcpy(hwaddr, &entry->hwaddr);
+        EXIT_KERNEL_CRITICAL_SECTION();
+        return OK;
+    }
+    EXIT_KERNEL_CRITICAL_SECTION();
+
     /* Attempt to obtain destination hardware address from ARP table until:
      * 1) lookup succeeds; 2) TIMEOUT occurs; 3) SYSERR occurs; or
      * 4) maximum number of lookup attempts occrus. */
@@ -63,12 +78,15 @@ xinu_syscall arpLookup (struct netif *netptr, const struct netaddr *praddr,
             netaddrcpy(&entry->praddr, praddr);
             entry->expires = clktime + ARP_TTL_UNRESOLVED;
             entry->count = 0;
+            arpInsert(entry);
         }
 
         /* Place hardware address in buffer if entry is resolved */
         if (ARP_RESOLVED == entry->state)
         {
             netaddrcpy(hwaddr, &entry->hwaddr);
+            netptr->arplast = entry;
+			EXIT_KERNEL_CRITICAL_SECTION();
             ARP_TRACE("Entry exists");
             return OK;
         }
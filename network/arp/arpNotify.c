@@ -8,39 +8,48 @@
 #include <arp.h>
 #include <CriticalSection.h>
 #include <stdlib.h>
+#include <string.h>
 #include <thread.h>
 
 /**
  * @ingroup arp
  *
  * Send a message to threads waiting on resolution of an ARP table entry.
+ * The list of waiting threads is taken within the kernel critical section
+ * and the messages are sent after leaving it, since sending may reschedule;
+ * so the caller must not be in the critical section itself.
  * @param entry ARP table entry
  * @param msg message to send to waiting threads
  * @return OK if successful, SYSERR if error occurs
  */
 xinu_syscall arpNotify (struct arpEntry *entry, xinu_message msg)
 {
+    tid_typ waiting[ARP_NTHRWAIT];
+    int count;
+    int result = OK;
+
     /* Error check pointers */
     if (NULL == entry)
     {
         return SYSERR;
     }
 
-    /* Send message to each waiting thread */
+    /* Take and clear list of waiting threads */
 	ENTER_KERNEL_CRITICAL_SECTION();
-    for (int i = 0; i < entry->count; i++)
+    count = entry->count;
+    memcpy(waiting, entry->waiting, sizeof(tid_typ) * count);
+    entry->count = 0;
+    bzero(entry->waiting, sizeof(tid_typ) * ARP_NTHRWAIT);
+	EXIT_KERNEL_CRITICAL_SECTION();
+
+    /* Send message to each waiting thread */
+    for (int i = 0; i < count; i++)
     {
-        if (SYSERR == send(entry->waiting[i], msg))
+        if (SYSERR == send(waiting[i], msg))
         {
-			EXIT_KERNEL_CRITICAL_SECTION();
-            return SYSERR;
+            result = SYSERR;
         }
     }
 
-    /* Clear list of waiting threads */
-    entry->count = 0;
-    bzero(entry->waiting, sizeof(tid_typ) * ARP_NTHRWAIT);
-
-	EXIT_KERNEL_CRITICAL_SECTION();
-    return OK;
+    return result;
 }
@@ -26,6 +26,8 @@ xinu_syscall arpRecv(struct packet *pkt)
     struct netif *netptr = NULL;
     struct arpPkt *arp = NULL;
     struct arpEntry *entry = NULL;  /**< pointer to ARP table entry     */
+    struct arpEntry *resolved = NULL;   /**< entry just resolved        */
+    bool reply = FALSE;             /**< request for daemon to answer   */
     struct netaddr sha;             /**< source hardware address        */
     struct netaddr spa;             /**< source protocol address        */
     struct netaddr dpa;             /**< destination protocol address   */
@@ -83,14 +85,16 @@ xinu_syscall arpRecv(struct packet *pkt)
     {
         ARP_TRACE("Entry already exists");
         netaddrcpy(&entry->hwaddr, &sha);
+        arpRemove(entry);
         entry->expires = clktime + ARP_TTL_RESOLVED;
+        arpInsert(entry);
 
-        /* Notify threads waiting on resolution */
+        /* Threads waiting on resolution are notified once out of the
+         * critical section, since that may reschedule */
         if (ARP_UNRESOLVED == entry->state)
         {
             entry->state = ARP_RESOLVED;
-            arpNotify(entry, ARP_MSG_RESOLVED);
-            ARP_TRACE("Notified waiting threads");
+            resolved = entry;
         }
     }
 
@@ -118,6 +122,7 @@ xinu_syscall arpRecv(struct packet *pkt)
             netaddrcpy(&entry->hwaddr, &sha);
             netaddrcpy(&entry->praddr, &spa);
             entry->expires = clktime + ARP_TTL_RESOLVED;
+            arpInsert(entry);
             ARP_TRACE("Added entry %d (state = %d)",
                       ((int)entry -
                        (int)arptab) / sizeof(struct arpEntry),
@@ -125,22 +130,28 @@ xinu_syscall arpRecv(struct packet *pkt)
         }
 
         /* If entry is a request, send a reply */
-        if (ARP_OP_RQST == net2hs(arp->op))
+        reply = (ARP_OP_RQST == net2hs(arp->op));
+    }
+	EXIT_KERNEL_CRITICAL_SECTION();
+
+    if (NULL != resolved)
+    {
+        arpNotify(resolved, ARP_MSG_RESOLVED);
+        ARP_TRACE("Notified waiting threads");
+    }
+
+    if (reply)
+    {
+        if (mailboxCount(arpqueue) >= ARP_NQUEUE)
         {
-            if (mailboxCount(arpqueue) >= ARP_NQUEUE)
-            {
-				EXIT_KERNEL_CRITICAL_SECTION();
-                netFreebuf(pkt);
-                return SYSERR;
-            }
-            mailboxSend(arpqueue, (int)pkt);
-            ARP_TRACE("Enqueued request for daemon to reply");
-			EXIT_KERNEL_CRITICAL_SECTION();
-            return OK;
+            netFreebuf(pkt);
+            return SYSERR;
         }
+        mailboxSend(arpqueue, (int)pkt);
+        ARP_TRACE("Enqueued request for daemon to reply");
+        return OK;
     }
 
-	EXIT_KERNEL_CRITICAL_SECTION();
     netFreebuf(pkt);
     return OK;
 }
@@ -0,0 +1,61 @@
+/**
+ * @file arpRemove.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <arp.h>
+#include <CriticalSection.h>
+
+/**
+ * @ingroup arp
+ *
+ * Take an ARP table entry out of the address index and expiry queue, if it
+ * is in them.
+ * @param entry ARP table entry
+ */
+void arpRemove(struct arpEntry *entry)
+{
+    struct arpEntry **link;
+
+	ENTER_KERNEL_CRITICAL_SECTION();
+    if (0 == entry->hslot)
+    {
+		EXIT_KERNEL_CRITICAL_SECTION();
+        return;
+    }
+
+    for (link = &arphash[entry->hslot - 1]; NULL != *link;
+         link = &(*link)->hnext)
+    {
+        if (*link == entry)
+        {
+            *link = entry->hnext;
+            break;
+        }
+    }
+
+    if (NULL == entry->eprev)
+    {
+        arpexphead = entry->enext;
+    }
+    else
+    {
+        entry->eprev->enext = entry->enext;
+    }
+    if (NULL == entry->enext)
+    {
+        arpexptail = entry->eprev;
+    }
+    else
+    {
+        entry->enext->eprev = entry->eprev;
+    }
+
+    entry->hslot = 0;
+    entry->hnext = NULL;
+    entry->enext = NULL;
+    entry->eprev = NULL;
+	EXIT_KERNEL_CRITICAL_SECTION();
+}
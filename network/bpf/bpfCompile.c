@@ -0,0 +1,511 @@
+/**
+ * @file bpfCompile.c
+ *
+ * Compiler from filter expressions to filter programs.  Expressions are a
+ * subset of the tcpdump language:
+ *
+ *     expr := term { ("or" | "||") term }
+ *     term := factor { ["and" | "&&"] factor }
+ *     factor := ("not" | "!") factor | "(" expr ")" | primitive
+ *     primitive := "arp" | "ip" | "icmp" | "tcp" | "udp" | "proto" N
+ *                | ["src" | "dst"] "host" A.B.C.D
+ *                | ["src" | "dst"] "port" N
+ *                | "greater" N | "less" N
+ *
+ * Code is generated in one pass.  Each piece jumps to a true or a false
+ * label handed down by its caller, so "and", "or" and "not" cost no code
+ * of their own.  Labels are numbered, kept in the jump fields until the
+ * end, and may stand for another label when a piece turns out to be the
+ * last of its list.  All jumps run forward, as the filter machine needs.
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <bpf.h>
+#include <ethernet.h>
+#include <ipv4.h>
+#include <string.h>
+
+#define BPF_NLABEL  255         /* labels must fit in a jump field */
+#define BPF_TOKLEN  20
+#define BPF_NOLABEL (-1)
+
+#define BPF_DIR_ANY 0
+#define BPF_DIR_SRC 1
+#define BPF_DIR_DST 2
+
+/* Compiler state */
+struct bpfComp
+{
+    const char *next;           /* expression after current token   */
+    char tok[BPF_TOKLEN];       /* current token, "" at end         */
+    unsigned int linklen;       /* octets before the IPv4 header    */
+    struct bpf_insn *insns;     /* program being built              */
+    unsigned int max;           /* room in insns                    */
+    unsigned int n;             /* instructions so far              */
+    unsigned int nlabel;        /* labels so far                    */
+    short pos[BPF_NLABEL];      /* instruction at label             */
+    short alias[BPF_NLABEL];    /* label this one stands for        */
+    bool error;
+};
+
+static void bpfOr(struct bpfComp *, int, int);
+
+/* Read the next token */
+static void bpfToken(struct bpfComp *c)
+{
+    const char *s = c->next;
+    unsigned int len = 0;
+
+    while (' ' == *s || '\t' == *s)
+    {
+        s++;
+    }
+    if (('(' == *s) || (')' == *s) || ('!' == *s))
+    {
+        len = 1;
+    }
+    else if ((('&' == *s) && ('&' == s[1])) || (('|' == *s) && ('|' == s[1])))
+    {
+        len = 2;
+    }
+    else
+    {
+        while (('\0' != s[len]) && (NULL == strchr(" \t()!&|", s[len])))
+        {
+            len++;
+        }
+    }
+
+    if (len >= BPF_TOKLEN)
+    {
+        c->error = TRUE;
+        len = 0;
+    }
+    memcpy(c->tok, s, len);
+    c->tok[len] = '\0';
+    c->next = s + len;
+}
+
+/* Is the current token the given word? */
+static bool bpfIs(struct bpfComp *c, const char *word)
+{
+    return (0 == strcmp(c->tok, word));
+}
+
+/* Take the current token as a number and move past it */
+static unsigned int bpfNumber(struct bpfComp *c)
+{
+    unsigned int value = 0;
+    char *s = c->tok;
+
+    if ('\0' == *s)
+    {
+        c->error = TRUE;
+    }
+    for (; '\0' != *s; s++)
+    {
+        if ((*s < '0') || (*s > '9'))
+        {
+            c->error = TRUE;
+            break;
+        }
+        value = value * 10 + (*s - '0');
+    }
+    bpfToken(c);
+    return value;
+}
+
+static int bpfLabel(struct bpfComp *c)
+{
+    if (c->nlabel >= BPF_NLABEL)
+    {
+        c->error = TRUE;
+        return 0;
+    }
+    c->pos[c->nlabel] = BPF_NOLABEL;
+    c->alias[c->nlabel] = BPF_NOLABEL;
+    return c->nlabel++;
+}
+
+static void bpfPlace(struct bpfComp *c, int label)
+{
+    c->pos[label] = c->n;
+}
+
+static void bpfEmit(struct bpfComp *c, unsigned short code, int jt, int jf,
+                    unsigned int k)
+{
+    if (c->n >= c->max)
+    {
+        c->error = TRUE;
+        return;
+    }
+    c->insns[c->n].code = code;
+    c->insns[c->n].jt = jt;
+    c->insns[c->n].jf = jf;
+    c->insns[c->n].k = k;
+    c->n++;
+}
+
+#define bpfStmt(c, code, k)  bpfEmit(c, code, 0, 0, k)
+#define bpfJump(c, op, k, lt, lf) \
+    bpfEmit(c, BPF_JMP | (op) | BPF_K, lt, lf, k)
+#define bpfGoto(c, label)    bpfEmit(c, BPF_JMP | BPF_JA, 0, 0, label)
+
+/* Test the link layer type; with no link header only IPv4 is seen */
+static void bpfEthertype(struct bpfComp *c, unsigned int type, int lt,
+                         int lf)
+{
+    if (0 == c->linklen)
+    {
+        bpfGoto(c, (ETHER_TYPE_IPv4 == type) ? lt : lf);
+        return;
+    }
+    bpfStmt(c, BPF_LD | BPF_H | BPF_ABS, c->linklen - 2);
+    bpfJump(c, BPF_JEQ, type, lt, lf);
+}
+
+static void bpfProto(struct bpfComp *c, unsigned int proto, int lt, int lf)
+{
+    int ip = bpfLabel(c);
+
+    bpfEthertype(c, ETHER_TYPE_IPv4, ip, lf);
+    bpfPlace(c, ip);
+    bpfStmt(c, BPF_LD | BPF_B | BPF_ABS, c->linklen + 9);
+    bpfJump(c, BPF_JEQ, proto, lt, lf);
+}
+
+/* Match an IPv4 address, or the protocol address of an ARP packet */
+static void bpfHost(struct bpfComp *c, int dir, unsigned int addr, int lt,
+                    int lf)
+{
+    int ip, notip, arp, other;
+
+    if (BPF_DIR_ANY == dir)
+    {
+        other = bpfLabel(c);
+        bpfHost(c, BPF_DIR_SRC, addr, lt, other);
+        bpfPlace(c, other);
+        bpfHost(c, BPF_DIR_DST, addr, lt, lf);
+        return;
+    }
+
+    if (0 == c->linklen)
+    {
+        bpfStmt(c, BPF_LD | BPF_W | BPF_ABS,
+                (BPF_DIR_SRC == dir) ? 12 : 16);
+        bpfJump(c, BPF_JEQ, addr, lt, lf);
+        return;
+    }
+
+    ip = bpfLabel(c);
+    notip = bpfLabel(c);
+    arp = bpfLabel(c);
+    bpfStmt(c, BPF_LD | BPF_H | BPF_ABS, c->linklen - 2);
+    bpfJump(c, BPF_JEQ, ETHER_TYPE_IPv4, ip, notip);
+    bpfPlace(c, ip);
+    bpfStmt(c, BPF_LD | BPF_W | BPF_ABS,
+            c->linklen + ((BPF_DIR_SRC == dir) ? 12 : 16));
+    bpfJump(c, BPF_JEQ, addr, lt, lf);
+    bpfPlace(c, notip);
+    bpfJump(c, BPF_JEQ, ETHER_TYPE_ARP, arp, lf);
+    bpfPlace(c, arp);
+    bpfStmt(c, BPF_LD | BPF_W | BPF_ABS,
+            c->linklen + ((BPF_DIR_SRC == dir) ? 14 : 24));
+    bpfJump(c, BPF_JEQ, addr, lt, lf);
+}
+
+/* Match a TCP or UDP port in the first fragment of an IPv4 datagram */
+static void bpfPort(struct bpfComp *c, int dir, unsigned int port, int lt,
+                    int lf)
+{
+    int ip, udp, ports, first, other;
+
+    ip = bpfLabel(c);
+    udp = bpfLabel(c);
+    ports = bpfLabel(c);
+    first = bpfLabel(c);
+    bpfEthertype(c, ETHER_TYPE_IPv4, ip, lf);
+    bpfPlace(c, ip);
+    bpfStmt(c, BPF_LD | BPF_B | BPF_ABS, c->linklen + 9);
+    bpfJump(c, BPF_JEQ, IPv4_PROTO_TCP, ports, udp);
+    bpfPlace(c, udp);
+    bpfJump(c, BPF_JEQ, IPv4_PROTO_UDP, ports, lf);
+    bpfPlace(c, ports);
+    bpfStmt(c, BPF_LD | BPF_H | BPF_ABS, c->linklen + 6);
+    bpfJump(c, BPF_JSET, IPv4_FROFF, lf, first);
+    bpfPlace(c, first);
+    bpfStmt(c, BPF_LDX | BPF_B | BPF_MSH, c->linklen);
+    if (BPF_DIR_DST != dir)
+    {
+        other = (BPF_DIR_ANY == dir) ? bpfLabel(c) : lf;
+        bpfStmt(c, BPF_LD | BPF_H | BPF_IND, c->linklen);
+        bpfJump(c, BPF_JEQ, port, lt, other);
+        if (BPF_DIR_SRC == dir)
+        {
+            return;
+        }
+        bpfPlace(c, other);
+    }
+    bpfStmt(c, BPF_LD | BPF_H | BPF_IND, c->linklen + 2);
+    bpfJump(c, BPF_JEQ, port, lt, lf);
+}
+
+static void bpfPrimitive(struct bpfComp *c, int lt, int lf)
+{
+    struct netaddr addr;
+    unsigned int n;
+    int dir = BPF_DIR_ANY;
+
+    if (bpfIs(c, "src"))
+    {
+        dir = BPF_DIR_SRC;
+        bpfToken(c);
+    }
+    else if (bpfIs(c, "dst"))
+    {
+        dir = BPF_DIR_DST;
+        bpfToken(c);
+    }
+
+    if (bpfIs(c, "host"))
+    {
+        bpfToken(c);
+        if (SYSERR == dot2ipv4(c->tok, &addr))
+        {
+            c->error = TRUE;
+            return;
+        }
+        bpfToken(c);
+        bpfHost(c, dir, (addr.addr[0] << 24) | (addr.addr[1] << 16)
+                | (addr.addr[2] << 8) | addr.addr[3], lt, lf);
+        return;
+    }
+    if (bpfIs(c, "port"))
+    {
+        bpfToken(c);
+        n = bpfNumber(c);
+        bpfPort(c, dir, n, lt, lf);
+        return;
+    }
+    if (BPF_DIR_ANY != dir)
+    {
+        c->error = TRUE;
+        return;
+    }
+
+    if (bpfIs(c, "arp"))
+    {
+        bpfToken(c);
+        bpfEthertype(c, ETHER_TYPE_ARP, lt, lf);
+    }
+    else if (bpfIs(c, "ip"))
+    {
+        bpfToken(c);
+        bpfEthertype(c, ETHER_TYPE_IPv4, lt, lf);
+    }
+    else if (bpfIs(c, "icmp"))
+    {
+        bpfToken(c);
+        bpfProto(c, IPv4_PROTO_ICMP, lt, lf);
+    }
+    else if (bpfIs(c, "tcp"))
+    {
+        bpfToken(c);
+        bpfProto(c, IPv4_PROTO_TCP, lt, lf);
+    }
+    else if (bpfIs(c, "udp"))
+    {
+        bpfToken(c);
+        bpfProto(c, IPv4_PROTO_UDP, lt, lf);
+    }
+    else if (bpfIs(c, "proto"))
+    {
+        bpfToken(c);
+        n = bpfNumber(c);
+        bpfProto(c, n, lt, lf);
+    }
+    else if (bpfIs(c, "greater"))
+    {
+        bpfToken(c);
+        n = bpfNumber(c);
+        bpfStmt(c, BPF_LD | BPF_W | BPF_LEN, 0);
+        bpfJump(c, BPF_JGE, n, lt, lf);
+    }
+    else if (bpfIs(c, "less"))
+    {
+        bpfToken(c);
+        n = bpfNumber(c);
+        bpfStmt(c, BPF_LD | BPF_W | BPF_LEN, 0);
+        bpfJump(c, BPF_JGT, n, lf, lt);
+    }
+    else
+    {
+        c->error = TRUE;
+    }
+}
+
+static void bpfFactor(struct bpfComp *c, int lt, int lf)
+{
+    if (bpfIs(c, "not") || bpfIs(c, "!"))
+    {
+        bpfToken(c);
+        bpfFactor(c, lf, lt);
+    }
+    else if (bpfIs(c, "("))
+    {
+        bpfToken(c);
+        bpfOr(c, lt, lf);
+        if (!bpfIs(c, ")"))
+        {
+            c->error = TRUE;
+            return;
+        }
+        bpfToken(c);
+    }
+    else
+    {
+        bpfPrimitive(c, lt, lf);
+    }
+}
+
+/* Factors side by side are joined by an implicit "and" */
+static void bpfAnd(struct bpfComp *c, int lt, int lf)
+{
+    int next;
+
+    while (!c->error)
+    {
+        next = bpfLabel(c);
+        bpfFactor(c, next, lf);
+        if (bpfIs(c, "and") || bpfIs(c, "&&"))
+        {
+            bpfToken(c);
+        }
+        else if (bpfIs(c, "") || bpfIs(c, "or") || bpfIs(c, "||")
+                 || bpfIs(c, ")"))
+        {
+            c->alias[next] = lt;
+            return;
+        }
+        bpfPlace(c, next);
+    }
+}
+
+static void bpfOr(struct bpfComp *c, int lt, int lf)
+{
+    int next;
+
+    while (!c->error)
+    {
+        next = bpfLabel(c);
+        bpfAnd(c, lt, next);
+        if (!bpfIs(c, "or") && !bpfIs(c, "||"))
+        {
+            c->alias[next] = lf;
+            return;
+        }
+        bpfToken(c);
+        bpfPlace(c, next);
+    }
+}
+
+/* Turn a label into a jump distance from the instruction at pc */
+static unsigned int bpfResolve(struct bpfComp *c, int label,
+                               unsigned int pc)
+{
+    while (BPF_NOLABEL != c->alias[label])
+    {
+        label = c->alias[label];
+    }
+    if ((BPF_NOLABEL == c->pos[label]) || (c->pos[label] <= pc))
+    {
+        c->error = TRUE;
+        return 0;
+    }
+    return c->pos[label] - pc - 1;
+}
+
+/**
+ * @ingroup bpf
+ *
+ * Compile a filter expression into a program for bpfFilter().
+ * @param expr expression, empty or NULL to accept every packet
+ * @param linklen length of the link header in front of the IPv4 header,
+ *        ETH_HDR_LEN for captured frames, 0 for datagrams
+ * @param snaplen octets of an accepted packet the program returns
+ * @param insns space for the program
+ * @param max number of instructions that fit in insns
+ * @return number of instructions, SYSERR if the expression is invalid or
+ *         too long
+ */
+int bpfCompile(const char *expr, unsigned int linklen, unsigned int snaplen,
+               struct bpf_insn *insns, unsigned int max)
+{
+    struct bpfComp comp;
+    struct bpfComp *c = &comp;
+    int accept, reject;
+    unsigned int pc, d;
+
+    if ((NULL == insns) || (0 == max))
+    {
+        return SYSERR;
+    }
+
+    c->next = (NULL == expr) ? "" : expr;
+    c->linklen = linklen;
+    c->insns = insns;
+    c->max = max;
+    c->n = 0;
+    c->nlabel = 0;
+    c->error = FALSE;
+    bpfToken(c);
+
+    accept = bpfLabel(c);
+    reject = bpfLabel(c);
+    if (!bpfIs(c, ""))
+    {
+        bpfOr(c, accept, reject);
+        if (!bpfIs(c, ""))
+        {
+            c->error = TRUE;
+        }
+    }
+    bpfPlace(c, accept);
+    bpfStmt(c, BPF_RET | BPF_K, snaplen);
+    bpfPlace(c, reject);
+    bpfStmt(c, BPF_RET | BPF_K, 0);
+
+    /* Replace labels with jump distances */
+    for (pc = 0; !c->error && (pc < c->n); pc++)
+    {
+        if (BPF_JMP != BPF_CLASS(insns[pc].code))
+        {
+            continue;
+        }
+        if (BPF_JA == BPF_OP(insns[pc].code))
+        {
+            insns[pc].k = bpfResolve(c, insns[pc].k, pc);
+            continue;
+        }
+        d = bpfResolve(c, insns[pc].jt, pc);
+        insns[pc].jt = d;
+        if (d > 0xFF)
+        {
+            c->error = TRUE;
+        }
+        d = bpfResolve(c, insns[pc].jf, pc);
+        insns[pc].jf = d;
+        if (d > 0xFF)
+        {
+            c->error = TRUE;
+        }
+    }
+
+    if (c->error || (OK != bpfValidate(insns, c->n)))
+    {
+        return SYSERR;
+    }
+    return c->n;
+}
@@ -0,0 +1,226 @@
+/**
+ * @file bpfFilter.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <bpf.h>
+
+/**
+ * @ingroup bpf
+ *
+ * Run a filter program over a packet.  Loads are big-endian, as packet
+ * fields are.  A load beyond the octets present, or a division by a zero
+ * X register, rejects the packet.  Scratch memory starts out zeroed, so
+ * loading a word never stored reads 0, as in BSD.
+ * @param insns program, which must have passed bpfValidate()
+ * @param pkt first octet of the packet
+ * @param wirelen length of the packet as it was on the wire
+ * @param buflen number of octets present at pkt
+ * @return number of octets of the packet to accept, 0 to reject it
+ */
+unsigned int bpfFilter(const struct bpf_insn *insns,
+                       const unsigned char *pkt, unsigned int wirelen,
+                       unsigned int buflen)
+{
+    const struct bpf_insn *p = insns;
+    unsigned int a = 0;
+    unsigned int x = 0;
+    unsigned int mem[BPF_MEMWORDS] = { 0 };
+    unsigned int k;
+
+    for (;; p++)
+    {
+        switch (p->code)
+        {
+        case BPF_RET | BPF_K:
+            return p->k;
+        case BPF_RET | BPF_A:
+            return a;
+
+        case BPF_LD | BPF_W | BPF_ABS:
+        case BPF_LD | BPF_W | BPF_IND:
+            k = p->k;
+            if (BPF_IND == BPF_MODE(p->code))
+            {
+                k += x;
+            }
+            if ((k < p->k) || (k > buflen) || (buflen - k < 4))
+            {
+                return 0;
+            }
+            a = (pkt[k] << 24) | (pkt[k + 1] << 16) | (pkt[k + 2] << 8)
+                | pkt[k + 3];
+            continue;
+        case BPF_LD | BPF_H | BPF_ABS:
+        case BPF_LD | BPF_H | BPF_IND:
+            k = p->k;
+            if (BPF_IND == BPF_MODE(p->code))
+            {
+                k += x;
+            }
+            if ((k < p->k) || (k > buflen) || (buflen - k < 2))
+            {
+                return 0;
+            }
+            a = (pkt[k] << 8) | pkt[k + 1];
+            continue;
+        case BPF_LD | BPF_B | BPF_ABS:
+        case BPF_LD | BPF_B | BPF_IND:
+            k = p->k;
+            if (BPF_IND == BPF_MODE(p->code))
+            {
+                k += x;
+            }
+            if ((k < p->k) || (k >= buflen))
+            {
+                return 0;
+            }
+            a = pkt[k];
+            continue;
+        case BPF_LD | BPF_W | BPF_LEN:
+            a = wirelen;
+            continue;
+        case BPF_LDX | BPF_W | BPF_LEN:
+            x = wirelen;
+            continue;
+        case BPF_LD | BPF_IMM:
+            a = p->k;
+            continue;
+        case BPF_LDX | BPF_IMM:
+            x = p->k;
+            continue;
+        case BPF_LD | BPF_MEM:
+            a = mem[p->k];
+            continue;
+        case BPF_LDX | BPF_MEM:
+            x = mem[p->k];
+            continue;
+        case BPF_LDX | BPF_B | BPF_MSH:
+            if (p->k >= buflen)
+            {
+                return 0;
+            }
+            x = (pkt[p->k] & 0x0F) << 2;
+            continue;
+        case BPF_ST:
+            mem[p->k] = a;
+            continue;
+        case BPF_STX:
+            mem[p->k] = x;
+            continue;
+
+        case BPF_JMP | BPF_JA:
+            p += p->k;
+            continue;
+        case BPF_JMP | BPF_JEQ | BPF_K:
+            p += (a == p->k) ? p->jt : p->jf;
+            continue;
+        case BPF_JMP | BPF_JGT | BPF_K:
+            p += (a > p->k) ? p->jt : p->jf;
+            continue;
+        case BPF_JMP | BPF_JGE | BPF_K:
+            p += (a >= p->k) ? p->jt : p->jf;
+            continue;
+        case BPF_JMP | BPF_JSET | BPF_K:
+            p += (a & p->k) ? p->jt : p->jf;
+            continue;
+        case BPF_JMP | BPF_JEQ | BPF_X:
+            p += (a == x) ? p->jt : p->jf;
+            continue;
+        case BPF_JMP | BPF_JGT | BPF_X:
+            p += (a > x) ? p->jt : p->jf;
+            continue;
+        case BPF_JMP | BPF_JGE | BPF_X:
+            p += (a >= x) ? p->jt : p->jf;
+            continue;
+        case BPF_JMP | BPF_JSET | BPF_X:
+            p += (a & x) ? p->jt : p->jf;
+            continue;
+
+        case BPF_ALU | BPF_ADD | BPF_K:
+            a += p->k;
+            continue;
+        case BPF_ALU | BPF_SUB | BPF_K:
+            a -= p->k;
+            continue;
+        case BPF_ALU | BPF_MUL | BPF_K:
+            a *= p->k;
+            continue;
+        case BPF_ALU | BPF_DIV | BPF_K:
+            a /= p->k;
+            continue;
+        case BPF_ALU | BPF_MOD | BPF_K:
+            a %= p->k;
+            continue;
+        case BPF_ALU | BPF_AND | BPF_K:
+            a &= p->k;
+            continue;
+        case BPF_ALU | BPF_OR | BPF_K:
+            a |= p->k;
+            continue;
+        case BPF_ALU | BPF_XOR | BPF_K:
+            a ^= p->k;
+            continue;
+        case BPF_ALU | BPF_LSH | BPF_K:
+            a <<= p->k;
+            continue;
+        case BPF_ALU | BPF_RSH | BPF_K:
+            a >>= p->k;
+            continue;
+        case BPF_ALU | BPF_ADD | BPF_X:
+            a += x;
+            continue;
+        case BPF_ALU | BPF_SUB | BPF_X:
+            a -= x;
+            continue;
+        case BPF_ALU | BPF_MUL | BPF_X:
+            a *= x;
+            continue;
+        case BPF_ALU | BPF_DIV | BPF_X:
+            if (0 == x)
+            {
+                return 0;
+            }
+            a /= x;
+            continue;
+        case BPF_ALU | BPF_MOD | BPF_X:
+            if (0 == x)
+            {
+                return 0;
+            }
+            a %= x;
+            continue;
+        case BPF_ALU | BPF_AND | BPF_X:
+            a &= x;
+            continue;
+        case BPF_ALU | BPF_OR | BPF_X:
+            a |= x;
+            continue;
+        case BPF_ALU | BPF_XOR | BPF_X:
+            a ^= x;
+            continue;
+        case BPF_ALU | BPF_LSH | BPF_X:
+            a = (x < 32) ? a << x : 0;
+            continue;
+        case BPF_ALU | BPF_RSH | BPF_X:
+            a = (x < 32) ? a >> x : 0;
+            continue;
+        case BPF_ALU | BPF_NEG:
+            a = -a;
+            continue;
+
+        case BPF_MISC | BPF_TAX:
+            x = a;
+            continue;
+        case BPF_MISC | BPF_TXA:
+            a = x;
+            continue;
+
+        default:
+            /* Encodings with stray bits set reject the packet */
+            return 0;
+        }
+    }
+}
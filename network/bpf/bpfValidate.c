@@ -0,0 +1,146 @@
+/**
+ * @file bpfValidate.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <bpf.h>
+
+/**
+ * @ingroup bpf
+ *
+ * Check that a filter program is safe to run.  Every instruction must be
+ * known, scratch memory references in range, jumps forward and inside the
+ * program, constant shifts under 32 and constant divisors non-zero; the
+ * program must end with a return.  A program that passes cannot loop or
+ * touch memory outside the packet, however it is written.
+ * @param insns instructions of the program
+ * @param len number of instructions
+ * @return OK if the program is valid, otherwise SYSERR
+ */
+int bpfValidate(const struct bpf_insn *insns, unsigned int len)
+{
+    const struct bpf_insn *p;
+    unsigned int pc;
+
+    if ((NULL == insns) || (0 == len) || (len > BPF_MAXINSNS))
+    {
+        return SYSERR;
+    }
+
+    for (pc = 0; pc < len; pc++)
+    {
+        p = &insns[pc];
+        switch (BPF_CLASS(p->code))
+        {
+        case BPF_LD:
+        case BPF_LDX:
+            switch (BPF_MODE(p->code))
+            {
+            case BPF_IMM:
+            case BPF_LEN:
+                break;
+            case BPF_ABS:
+            case BPF_IND:
+                if ((BPF_LDX == BPF_CLASS(p->code))
+                    || (BPF_SIZE(p->code) > BPF_B))
+                {
+                    return SYSERR;
+                }
+                break;
+            case BPF_MSH:
+                if ((BPF_LDX != BPF_CLASS(p->code))
+                    || (BPF_B != BPF_SIZE(p->code)))
+                {
+                    return SYSERR;
+                }
+                break;
+            case BPF_MEM:
+                if (p->k >= BPF_MEMWORDS)
+                {
+                    return SYSERR;
+                }
+                break;
+            default:
+                return SYSERR;
+            }
+            break;
+
+        case BPF_ST:
+        case BPF_STX:
+            if (p->k >= BPF_MEMWORDS)
+            {
+                return SYSERR;
+            }
+            break;
+
+        case BPF_ALU:
+            switch (BPF_OP(p->code))
+            {
+            case BPF_ADD:
+            case BPF_SUB:
+            case BPF_MUL:
+            case BPF_OR:
+            case BPF_AND:
+            case BPF_XOR:
+            case BPF_NEG:
+                break;
+            case BPF_LSH:
+            case BPF_RSH:
+                if ((BPF_K == BPF_SRC(p->code)) && (p->k >= 32))
+                {
+                    return SYSERR;
+                }
+                break;
+            case BPF_DIV:
+            case BPF_MOD:
+                if ((BPF_K == BPF_SRC(p->code)) && (0 == p->k))
+                {
+                    return SYSERR;
+                }
+                break;
+            default:
+                return SYSERR;
+            }
+            break;
+
+        case BPF_JMP:
+            /* Jumps run forward from the next instruction */
+            switch (BPF_OP(p->code))
+            {
+            case BPF_JA:
+                if (p->k >= len - pc - 1)
+                {
+                    return SYSERR;
+                }
+                break;
+            case BPF_JEQ:
+            case BPF_JGT:
+            case BPF_JGE:
+            case BPF_JSET:
+                if ((p->jt >= len - pc - 1) || (p->jf >= len - pc - 1))
+                {
+                    return SYSERR;
+                }
+                break;
+            default:
+                return SYSERR;
+            }
+            break;
+
+        case BPF_RET:
+            break;
+
+        case BPF_MISC:
+            if ((BPF_TAX != BPF_MISCOP(p->code))
+                && (BPF_TXA != BPF_MISCOP(p->code)))
+            {
+                return SYSERR;
+            }
+            break;
+        }
+    }
+
+    return (BPF_RET == BPF_CLASS(insns[len - 1].code)) ? OK : SYSERR;
+}
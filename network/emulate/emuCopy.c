@@ -0,0 +1,41 @@
+/*
+ * @file emuCopy.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <network.h>
+#include <netemu.h>
+#include <string.h>
+
+/**
+ * @ingroup netemu
+ *
+ * Copy a packet into a buffer of its own, keeping the offsets of its
+ * headers and any sum the device took of it.
+ * @param pkt pointer to the packet to copy
+ * @return pointer to the copy, SYSERR if there are no free buffers
+ */
+struct packet *emuCopy(struct packet *pkt)
+{
+    struct packet *copy;
+
+    copy = netGetbuf();
+    if (SYSERR == (int)copy)
+    {
+        return (struct packet *)SYSERR;
+    }
+
+    memcpy(copy->data, pkt->data, (pkt->curr - pkt->data) + pkt->len);
+    copy->nif = pkt->nif;
+    copy->len = pkt->len;
+    copy->flags = pkt->flags;
+    copy->csum = pkt->csum;
+    copy->curr = copy->data + (pkt->curr - pkt->data);
+    copy->linkhdr = (NULL == pkt->linkhdr) ? NULL
+        : copy->data + (pkt->linkhdr - pkt->data);
+    copy->nethdr = (NULL == pkt->nethdr) ? NULL
+        : copy->data + (pkt->nethdr - pkt->data);
+    return copy;
+}
@@ -7,17 +7,32 @@
 #include <xinu.h>
 #include <network.h>
 #include <netemu.h>
-#include <route.h>
+#include <stdlib.h>
 
 /**
  * @ingroup netemu
  *
- * Corrupts packets as specified by user
+ * Corrupts packets as specified by user.  One bit past the link layer
+ * header is flipped, as if the frame had been damaged in a way its check
+ * sequence did not catch.  A sum the device took of the packet no longer
+ * holds, so the stack is left to find the damage itself.
+ * @param emu emulation stage the packet is passing through
  * @param pkt pointer to the incoming packet
  * @return OK if packet was processed succesfully, otherwise SYSERR
  */
-xinu_syscall emuCorrupt(struct packet *pkt)
+xinu_syscall emuCorrupt(struct netemu *emu, struct packet *pkt)
 {
+    unsigned int hdrlen = pkt->nif->linkhdrlen;
+    unsigned int bit;
 
-    return rtRecv(pkt);
+    if ((pkt->len > hdrlen) && emuChance(emu->corrupt))
+    {
+        bit = rand() % ((pkt->len - hdrlen) * 8);
+        pkt->curr[hdrlen + bit / 8] ^= 1 << (bit % 8);
+        pkt->flags &= ~PKT_CSUM_COMPLETE;
+        NETEMU_TRACE("Corrupted by emulator");
+        emu->ncorrupt++;
+    }
+
+    return emuRate(emu, pkt);
 }
@@ -7,26 +7,31 @@
 #include <xinu.h>
 #include <network.h>
 #include <stdlib.h>
-#include <thread.h>
 #include <netemu.h>
 
 /**
  * @ingroup netemu
  *
- * Delay packets as specified by user
+ * Delay packets as specified by user.  Latency varies by up to the jitter
+ * either way, so packets close together may trade places.
+ * @param emu emulation stage the packet is passing through
  * @param pkt pointer to the incoming packet
+ * @param wait ms the packet must already wait for the rate limit
  * @return OK if packet was processed succesfully, otherwise SYSERR
  */
-xinu_syscall emuDelay(struct packet *pkt)
+xinu_syscall emuDelay(struct netemu *emu, struct packet *pkt,
+                      unsigned int wait)
 {
-    /*
-       short delayTime = 100;
-       short delayPercent = 100;
+    int latency = emu->delay;
 
-       if ((rand() % 100) < delayPercent)
-       {
-       sleep(delayTime);
-       }
-     */
-    return emuDuplicate(pkt);
+    if (emu->jitter > 0)
+    {
+        latency += rand() % (2 * emu->jitter + 1) - emu->jitter;
+        if (latency < 0)
+        {
+            latency = 0;
+        }
+    }
+
+    return emuQueue(emu, pkt, wait + latency);
 }
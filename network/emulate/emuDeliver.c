@@ -0,0 +1,50 @@
+/*
+ * @file emuDeliver.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <device.h>
+#include <network.h>
+#include <netemu.h>
+#include <snoop.h>
+
+/**
+ * @ingroup netemu
+ *
+ * Hand on a packet that has come out of the emulator.  A received packet
+ * goes to the protocols; a packet being sent is written to the device and
+ * freed.
+ * @param emu emulation stage the packet passed through
+ * @param pkt pointer to the packet
+ * @return OK if packet was processed succesfully, otherwise SYSERR
+ */
+xinu_syscall emuDeliver(struct netemu *emu, struct packet *pkt)
+{
+    struct netif *netptr = pkt->nif;
+    int result = OK;
+
+    /* The interface may have gone down while the packet was held */
+    if (NET_ALLOC != netptr->state)
+    {
+        netFreebuf(pkt);
+        return SYSERR;
+    }
+
+    if (NETEMU_IN == emu->dir)
+    {
+        return netDeliver(pkt);
+    }
+
+    if (pkt->len != write(netptr->dev, pkt->curr, pkt->len))
+    {
+        result = SYSERR;
+    }
+    else if (NULL != netptr->capture)
+    {
+        snoopCapture(netptr->capture, pkt);
+    }
+    netFreebuf(pkt);
+    return result;
+}
@@ -8,30 +8,25 @@
 #include <stdlib.h>
 #include <network.h>
 #include <netemu.h>
-#include <route.h>
-#include <date.h>
-#include <stdio.h>
-#include <udp.h>
 
 /**
  * @ingroup netemu
  *
  * Drop packets based on user settings
+ * @param emu emulation stage the packet is passing through
  * @param pkt pointer to the incoming packet
  * @return OK if packet was processed succesfully, otherwise SYSERR
  */
-xinu_syscall emuDrop(struct packet *pkt)
+xinu_syscall emuDrop(struct netemu *emu, struct packet *pkt)
 {
-    /* TODO: make this user specifiable */
-    short dropPercent = 0;
-
-    /* drop packet when random value < percent to drop */
-    if ((rand() % 100) < dropPercent)
+    /* drop packet when random value < chance to drop */
+    if (emuChance(emu->loss))
     {
-        RT_TRACE("Dropped by Emulator: %d\n");
+        NETEMU_TRACE("Dropped by emulator");
+        emu->ndrop++;
         netFreebuf(pkt);
         return OK;
     }
 
-    return emuDelay(pkt);
+    return emuDuplicate(emu, pkt);
 }
@@ -9,35 +9,30 @@
 #include <stdlib.h>
 #include <netemu.h>
 
-//int test(struct packet *pkt, int dupes);
 /**
  * @ingroup netemu
  *
- * Duplicate packets as specified by user
+ * Duplicate packets as specified by user.  The copy goes through the rest
+ * of the emulator on its own, so it may be corrupted or delayed
+ * differently from the original.
+ * @param emu emulation stage the packet is passing through
  * @param pkt pointer to the incoming packet
  * @return OK if packet was processed succesfully, otherwise SYSERR
  */
-xinu_syscall emuDuplicate(struct packet *pkt)
+xinu_syscall emuDuplicate(struct netemu *emu, struct packet *pkt)
 {
-    /*
-       short dupePercent = 100;
-       int dupes = 2;
+    struct packet *copy;
 
-       if ((rand() % 100) < dupePercent)
-       {
-       return test(pkt, dupes);
-       }
-     */
-    return emuReorder(pkt);
-}
-
-/*
-syscall test(struct packet *pkt, int dupes)
-{
-    if (dupes == 1)
+    if (emuChance(emu->duplicate))
     {
-        return emuReorder(pkt);
+        copy = emuCopy(pkt);
+        if (SYSERR != (int)copy)
+        {
+            NETEMU_TRACE("Duplicated by emulator");
+            emu->ndup++;
+            emuCorrupt(emu, copy);
+        }
     }
 
-    return (emuReorder(pkt) | test(pkt, dupes - 1));
-}*/
+    return emuCorrupt(emu, pkt);
+}
@@ -0,0 +1,189 @@
+/**
+ * @file emuQueue.c
+ *
+ * Delay queue of the network emulator.  Packets held back by any stage
+ * wait here in the order they are due, an array being plenty for the few
+ * a queue holds.  The emulator thread keeps one kernel timer running for
+ * the packet due first; the timer wakes the thread, which takes every
+ * packet that is due off the queue and hands each on.  Packets are handed
+ * on from the thread rather than the timer, since delivery may block.
+ * Only the thread schedules the timer, outside the kernel critical
+ * section since timerSched() may reschedule.
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <clock.h>
+#include <CriticalSection.h>
+#include <network.h>
+#include <netemu.h>
+#include <semaphore.h>
+#include <string.h>
+#include <thread.h>
+#include <timer.h>
+
+/* Packet waiting on the delay queue */
+struct emuEntry
+{
+    unsigned long due;          /* time packet is handed on, ms */
+    struct netemu *emu;         /* stage that held it back      */
+    struct packet *pkt;
+};
+
+static struct emuEntry emuqueue[NETEMU_QLEN];
+static unsigned int emucount;
+static struct timer emutimer;
+static semaphore emuwake;
+
+/* Is time a before time b? */
+#define emuBefore(a, b)   ((long)((a) - (b)) < 0)
+
+static void emuWake(void *arg)
+{
+    signal(emuwake);
+}
+
+/**
+ * @ingroup netemu
+ *
+ * Milliseconds since boot, wrapping.
+ */
+unsigned long emuNow(void)
+{
+    unsigned long sec, usec;
+
+    clkgettime(&sec, &usec);
+    return sec * 1000 + usec / 1000;
+}
+
+/**
+ * @ingroup netemu
+ *
+ * Initialize the delay queue and start the emulator thread.
+ * @return OK if the queue is ready, otherwise SYSERR
+ */
+xinu_syscall emuQueueInit(void)
+{
+    tid_typ tid;
+
+    emucount = 0;
+    timerSetup(&emutimer, emuWake, NULL);
+    emuwake = semcreate(0);
+    if (SYSERR == (int)emuwake)
+    {
+        return SYSERR;
+    }
+
+    tid = create((void *)emuDaemon, NETEMU_THR_STK, NETEMU_THR_PRIO,
+                 "netemu", 0);
+    if (SYSERR == tid)
+    {
+        semfree(emuwake);
+        return SYSERR;
+    }
+    ready(tid);
+    return OK;
+}
+
+/**
+ * @ingroup netemu
+ *
+ * Hold a packet back for a while, or hand it on at once if it need not
+ * wait.  Packets due at the same time leave in the order they arrived.
+ * @param emu emulation stage the packet is passing through
+ * @param pkt pointer to the incoming packet
+ * @param wait ms to hold the packet back
+ * @return OK if packet was processed succesfully, otherwise SYSERR
+ */
+xinu_syscall emuQueue(struct netemu *emu, struct packet *pkt,
+                      unsigned int wait)
+{
+    unsigned long due;
+    unsigned int i;
+
+    if (0 == wait)
+    {
+        return emuDeliver(emu, pkt);
+    }
+
+    ENTER_KERNEL_CRITICAL_SECTION();
+    if (NETEMU_QLEN == emucount)
+    {
+        EXIT_KERNEL_CRITICAL_SECTION();
+        NETEMU_TRACE("Delay queue full");
+        emu->nlimit++;
+        netFreebuf(pkt);
+        return OK;
+    }
+
+    due = emuNow() + wait;
+    for (i = emucount; (i > 0) && emuBefore(due, emuqueue[i - 1].due); i--)
+        ;
+    memmove(&emuqueue[i + 1], &emuqueue[i],
+            (emucount - i) * sizeof(struct emuEntry));
+    emuqueue[i].due = due;
+    emuqueue[i].emu = emu;
+    emuqueue[i].pkt = pkt;
+    emucount++;
+    emu->nqueue++;
+
+    EXIT_KERNEL_CRITICAL_SECTION();
+
+    /* The timer runs for whichever packet is due first, so have the
+     * emulator thread set it again for this one */
+    if (0 == i)
+    {
+        signal(emuwake);
+    }
+
+    return OK;
+}
+
+/**
+ * @ingroup netemu
+ *
+ * Emulator thread.  Hands on packets from the delay queue as they come
+ * due.
+ */
+thread emuDaemon(void)
+{
+    static struct emuEntry due[NETEMU_QLEN];
+    unsigned long now, next = 0;
+    unsigned int n, i;
+    bool arm;
+
+    while (TRUE)
+    {
+        wait(emuwake);
+
+        ENTER_KERNEL_CRITICAL_SECTION();
+        now = emuNow();
+        for (n = 0; (n < emucount) && !emuBefore(now, emuqueue[n].due);
+             n++)
+        {
+            due[n] = emuqueue[n];
+            due[n].emu->nqueue--;
+        }
+        emucount -= n;
+        memmove(&emuqueue[0], &emuqueue[n],
+                emucount * sizeof(struct emuEntry));
+        arm = (emucount > 0);
+        if (arm)
+        {
+            next = emuqueue[0].due - now;
+        }
+        EXIT_KERNEL_CRITICAL_SECTION();
+
+        if (arm)
+        {
+            timerSched(&emutimer, next);
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            emuDeliver(due[i].emu, due[i].pkt);
+        }
+    }
+
+    return OK;
+}
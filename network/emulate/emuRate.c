@@ -0,0 +1,80 @@
+/*
+ * @file emuRate.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <CriticalSection.h>
+#include <network.h>
+#include <netemu.h>
+
+/**
+ * @ingroup netemu
+ *
+ * Limit the rate packets pass at with a token bucket.  Tokens are bits,
+ * added at the rate limit up to the depth of the bucket.  A packet with
+ * tokens to spare passes at once; otherwise it borrows them and waits
+ * until they would have been added.  Packets that would wait longer than
+ * ::NETEMU_MAXWAIT are dropped, as a full queue on a slow link would drop
+ * them.
+ * @param emu emulation stage the packet is passing through
+ * @param pkt pointer to the incoming packet
+ * @return OK if packet was processed succesfully, otherwise SYSERR
+ */
+xinu_syscall emuRate(struct netemu *emu, struct packet *pkt)
+{
+    unsigned long now, elapsed;
+    unsigned int wait = 0;
+    int bits = pkt->len * 8;
+    int depth;
+    bool drop = FALSE;
+
+    if (0 == emu->rate)
+    {
+        return emuReorder(emu, pkt, 0);
+    }
+
+    ENTER_KERNEL_CRITICAL_SECTION();
+    /* A kbit/s is a bit per ms */
+    depth = emu->burst * 8;
+    now = emuNow();
+    elapsed = now - emu->tokstamp;
+    emu->tokstamp = now;
+    if (elapsed > depth / emu->rate)
+    {
+        emu->tokens = depth;
+    }
+    else
+    {
+        emu->tokens += elapsed * emu->rate;
+        if (emu->tokens > depth)
+        {
+            emu->tokens = depth;
+        }
+    }
+
+    if (emu->tokens - bits < -(int)(emu->rate * NETEMU_MAXWAIT))
+    {
+        drop = TRUE;
+    }
+    else
+    {
+        emu->tokens -= bits;
+        if (emu->tokens < 0)
+        {
+            wait = (-emu->tokens + emu->rate - 1) / emu->rate;
+        }
+    }
+    EXIT_KERNEL_CRITICAL_SECTION();
+
+    if (drop)
+    {
+        NETEMU_TRACE("Over rate limit");
+        emu->nlimit++;
+        netFreebuf(pkt);
+        return OK;
+    }
+
+    return emuReorder(emu, pkt, wait);
+}
@@ -7,16 +7,27 @@
 #include <xinu.h>
 #include <network.h>
 #include <netemu.h>
+#include <stdlib.h>
 
 /**
  * @ingroup netemu
  *
- * Reorder packets as specified by the user
+ * Reorder packets as specified by the user.  A packet chosen skips the
+ * added latency, so it overtakes packets still on the delay queue.
+ * @param emu emulation stage the packet is passing through
  * @param pkt pointer to the incoming packet
+ * @param wait ms the packet must already wait for the rate limit
  * @return OK if packet was processed succesfully, otherwise SYSERR
  */
-xinu_syscall emuReorder(struct packet *pkt)
+xinu_syscall emuReorder(struct netemu *emu, struct packet *pkt,
+                        unsigned int wait)
 {
+    if ((emu->nqueue > 0) && emuChance(emu->reorder))
+    {
+        NETEMU_TRACE("Reordered by emulator");
+        emu->nreorder++;
+        return emuQueue(emu, pkt, wait);
+    }
 
-    return emuCorrupt(pkt);
+    return emuDelay(emu, pkt, wait);
 }
@@ -11,12 +11,35 @@
 /**
  * @ingroup netemu
  *
- * Process a packet through the network emulator
- * @param pkt pointer to the incoming packet
+ * Process a packet through the network emulator of the interface it is
+ * on.  A received packet is taken over by the emulator and reaches the
+ * protocols when it comes out.  A packet being sent stays with the caller;
+ * the emulator works on a copy and writes it to the device when it comes
+ * out.
+ * @param pkt pointer to the packet, with its link layer header in place
+ * @param dir NETEMU_IN for a received packet, NETEMU_OUT for one to send
  * @return OK if packet was processed succesfully, otherwise SYSERR
  */
-xinu_syscall netemu(struct packet *pkt)
+xinu_syscall netemu(struct packet *pkt, int dir)
 {
+    struct netemu *emu;
 
-    return emuDrop(pkt);
+    if ((NULL == pkt) || (NULL == pkt->nif)
+        || ((NETEMU_IN != dir) && (NETEMU_OUT != dir)))
+    {
+        return SYSERR;
+    }
+    emu = netemuStage(pkt->nif, dir);
+
+    if (NETEMU_OUT == dir)
+    {
+        pkt = emuCopy(pkt);
+        if (SYSERR == (int)pkt)
+        {
+            return SYSERR;
+        }
+    }
+
+    emu->nin++;
+    return emuDrop(emu, pkt);
 }
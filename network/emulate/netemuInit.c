@@ -0,0 +1,36 @@
+/*
+ * @file netemuInit.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <network.h>
+#include <netemu.h>
+#include <stdlib.h>
+
+#ifndef NNETIF
+#define NNETIF 0
+#endif
+
+struct netemu netemutab[NNETIF][NETEMU_NDIR];
+
+/**
+ * @ingroup netemu
+ *
+ * Initialize the network emulator, with no emulation on any interface.
+ * @return OK if initialized properly, otherwise SYSERR
+ */
+xinu_syscall netemuInit(void)
+{
+    int i;
+
+    for (i = 0; i < NNETIF; i++)
+    {
+        bzero(netemutab[i], sizeof(netemutab[i]));
+        netemutab[i][NETEMU_IN].dir = NETEMU_IN;
+        netemutab[i][NETEMU_OUT].dir = NETEMU_OUT;
+    }
+
+    return emuQueueInit();
+}
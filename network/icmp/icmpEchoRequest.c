@@ -24,6 +24,7 @@ xinu_syscall icmpEchoRequest(struct netaddr *dst, unsigned short id, unsigned sh
     struct icmpEcho *echo;
     int result;
     struct netaddr src;
+    unsigned long sec, usec;
 
     ICMP_TRACE("echo request(%d, %d)", id, seq);
     pkt = netGetbuf();
@@ -40,20 +41,16 @@ xinu_syscall icmpEchoRequest(struct netaddr *dst, unsigned short id, unsigned sh
     echo->id = hs2net(id);
     echo->seq = hs2net(seq);
     /* Our optional data payload includes room for the departure */
-    /*  and arrival timestamps, in seconds, milliseconds, and    */
-    /*  clock cycles.                                            */
-	ENTER_KERNEL_CRITICAL_SECTION();
-    echo->timecyc = hl2net(clkcount());
-    echo->timetic = hl2net(clkticks);
-    echo->timesec = hl2net(clktime);
-	EXIT_KERNEL_CRITICAL_SECTION();
-    echo->arrivcyc = 0;
-    echo->arrivtic = 0;
+    /*  and arrival timestamps, in seconds and microseconds.     */
+    clkgettime(&sec, &usec);
+    echo->timesec = hl2net(sec);
+    echo->timeusec = hl2net(usec);
     echo->arrivsec = 0;
+    echo->arrivusec = 0;
 
     ICMP_TRACE("Sending Echo Request id = %d, seq = %d, time = %lu.%lu",
                net2hs(echo->id), net2hs(echo->seq),
-               net2hl(echo->timesec), net2hl(echo->timetic));
+               net2hl(echo->timesec), net2hl(echo->timeusec));
 
     src.type = 0;
 
@@ -45,9 +45,7 @@ xinu_syscall icmpRecv(struct packet *pkt)
      
 			ENTER_KERNEL_CRITICAL_SECTION();
 
-            echo->arrivcyc = clkcount();
-            echo->arrivtic = clkticks;
-            echo->arrivsec = clktime;
+            clkgettime(&echo->arrivsec, &echo->arrivusec);
 
             for (i = 0; i < NPINGQUEUE; i++)
             {
@@ -66,8 +64,8 @@ xinu_syscall icmpRecv(struct packet *pkt)
                     }
                     eq->pkts[eq->head] = pkt;
                     eq->head = ((eq->head + 1) % NPINGHOLD);
-                    send(id, (xinu_message)pkt);
 					EXIT_KERNEL_CRITICAL_SECTION();
+                    send(id, (xinu_message)pkt);
                     return OK;
                 }
             }
@@ -0,0 +1,68 @@
+/**
+ * @file ipv4Chksum.c
+ *
+ * TCP and UDP checksums of IPv4 packets whose network device sums them, or
+ * was asked to and cannot.
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <xinu.h>
+#include <ipv4.h>
+#include <network.h>
+#include <tcp.h>
+#include <udp.h>
+
+/**
+ * @ingroup ipv4
+ *
+ * Fill in the TCP or UDP checksum of an outgoing packet that was left for
+ * the network device, for an interface that cannot or a packet that is to
+ * be fragmented.
+ * @param pkt outgoing packet marked ::PKT_CSUM_TX
+ * @param ip  IPv4 header of the packet
+ */
+void ipv4ChksumFinish(struct packet *pkt, struct ipv4Pkt *ip)
+{
+    unsigned int ihl = (ip->ver_ihl & IPv4_IHL) * 4;
+    unsigned int len = net2hs(ip->len) - ihl;
+    uint8_t *data = (uint8_t *)ip + ihl;
+
+    /* The checksum field already holds the pseudo header sum */
+    if (IPv4_PROTO_TCP == ip->proto)
+    {
+        ((struct tcpPkt *)data)->chksum = netChksum(data, len);
+    }
+    else
+    {
+        ((struct udpPkt *)data)->chksum = netChksum(data, len);
+    }
+    pkt->flags &= ~PKT_CSUM_TX;
+}
+
+/**
+ * @ingroup ipv4
+ *
+ * Check the TCP or UDP checksum of a received packet against the sum its
+ * network device computed, without summing the payload again.  The device
+ * sums everything after the link header; the IPv4 header, already found
+ * valid, adds nothing to that.
+ * @param pkt   received packet
+ * @param src   source address
+ * @param dst   destination address
+ * @param proto IPv4 protocol number
+ * @param len   length of transport header and payload in bytes
+ * @return TRUE if the checksum is correct, FALSE if it is not or the
+ *      device did not sum the packet, and it must be checked in software
+ */
+bool ipv4ChksumRecv(const struct packet *pkt, const struct netaddr *src,
+                    const struct netaddr *dst, uint8_t proto, uint16_t len)
+{
+    if (!(pkt->flags & PKT_CSUM_COMPLETE))
+    {
+        return FALSE;
+    }
+    return (0 == netChksumFold(netChksumPseudo(src, dst, proto, len)
+                               + pkt->csum));
+}
@@ -0,0 +1,334 @@
+/**
+ * @file ipv4Frag.c
+ *
+ * Reassembly of fragmented IPv4 datagrams addressed to us.  Datagrams in
+ * progress live in the fixed table ::ipv4fragtab, keyed on source,
+ * destination, identification and protocol.  Each fragment is copied into
+ * its datagram's reassembly buffer as it arrives and the ranges still
+ * missing are kept as a list of holes (RFC 815).  Reassembly buffers come
+ * from a pool of their own, so however many fragments arrive the table pins
+ * at most ::IPv4_FRAG_NENTRY buffers; a flood of fragments only pushes out
+ * the oldest partial datagram.  While any datagram is in progress a timer
+ * sweeps the table for ones that have run out of time.
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <bufpool.h>
+#include <clock.h>
+#include <CriticalSection.h>
+#include <icmp.h>
+#include <ipv4.h>
+#include <network.h>
+#include <string.h>
+#include <timer.h>
+
+struct ipv4Frag ipv4fragtab[IPv4_FRAG_NENTRY];
+int ipv4fragpool = SYSERR;
+
+static struct timer ipv4fragtimer;
+
+/* Sweep for expired datagrams, and again later while any remain */
+static void ipv4FragTick(void *arg)
+{
+    bool busy = FALSE;
+    int i;
+
+    ipv4FragExpire();
+
+    ENTER_KERNEL_CRITICAL_SECTION();
+    for (i = 0; i < IPv4_FRAG_NENTRY; i++)
+    {
+        if (IPv4_FRAG_USED == ipv4fragtab[i].state)
+        {
+            busy = TRUE;
+        }
+    }
+    EXIT_KERNEL_CRITICAL_SECTION();
+
+    if (busy)
+    {
+        timerSched(&ipv4fragtimer, IPv4_FRAG_SWEEP * 1000);
+    }
+}
+
+/**
+ * Move the gathered payload up behind the headers and point the packet at
+ * the result.
+ */
+static void ipv4FragAssemble(struct ipv4Frag *frag, unsigned int datalen)
+{
+    struct packet *pkt = frag->pkt;
+
+    memmove(pkt->data + frag->hdrlen, pkt->data + IPv4_FRAG_HDRROOM,
+            datalen);
+    pkt->linkhdr = pkt->data;
+    pkt->nethdr = pkt->data + pkt->nif->linkhdrlen;
+    pkt->curr = pkt->nethdr;
+    pkt->len = frag->hdrlen + datalen;
+    pkt->flags &= ~PKT_CSUM_COMPLETE;
+}
+
+/**
+ * Find the entry for a fragment's datagram, claiming one if it is new.
+ * Must be called inside a kernel critical section.
+ * @return table entry, NULL if no reassembly buffer is free
+ */
+static struct ipv4Frag *ipv4FragLookup(const struct ipv4Pkt *ip)
+{
+    struct ipv4Frag *frag, *slot = NULL, *oldest = NULL;
+    struct packet *pkt;
+    int i;
+
+    for (i = 0; i < IPv4_FRAG_NENTRY; i++)
+    {
+        frag = &ipv4fragtab[i];
+        if (IPv4_FRAG_FREE == frag->state)
+        {
+            slot = frag;
+            continue;
+        }
+        if ((frag->id == ip->id) && (frag->proto == ip->proto)
+            && (0 == memcmp(frag->src, ip->src, IPv4_ADDR_LEN))
+            && (0 == memcmp(frag->dst, ip->dst, IPv4_ADDR_LEN)))
+        {
+            return frag;
+        }
+        if ((NULL == oldest) || (frag->expires < oldest->expires))
+        {
+            oldest = frag;
+        }
+    }
+
+    /* Failing a free entry, the oldest datagram gives way */
+    if (NULL == slot)
+    {
+        IPv4_TRACE("Evicting partial datagram %d", net2hs(oldest->id));
+        slot = oldest;
+        slot->state = IPv4_FRAG_FREE;
+        netFreebuf(slot->pkt);
+    }
+    pkt = bufget_nowait(ipv4fragpool);
+    if (SYSERR == (int)pkt)
+    {
+        return NULL;
+    }
+
+    slot->state = IPv4_FRAG_USED;
+    slot->proto = ip->proto;
+    slot->id = ip->id;
+    memcpy(slot->src, ip->src, IPv4_ADDR_LEN);
+    memcpy(slot->dst, ip->dst, IPv4_ADDR_LEN);
+    slot->expires = clktime + IPv4_FRAG_TTL;
+    slot->pkt = pkt;
+    slot->hdrlen = 0;
+    slot->datalen = 0;
+    slot->nhole = 1;
+    slot->hole[0].first = 0;
+    slot->hole[0].last = IPv4_FRAG_MAXLEN - 1;
+    return slot;
+}
+
+/**
+ * Remove the octets first through last from the holes of a datagram.
+ * @param more TRUE if more fragments follow this one
+ * @return FALSE if the datagram needs more holes than an entry can hold
+ */
+static bool ipv4FragFill(struct ipv4Frag *frag, unsigned int first,
+                         unsigned int last, bool more)
+{
+    struct ipv4Hole hole;
+    int i = 0;
+
+    while (i < frag->nhole)
+    {
+        hole = frag->hole[i];
+        if ((first > hole.last) || (last < hole.first))
+        {
+            i++;
+            continue;
+        }
+
+        /* Replace the hole with whatever the fragment leaves uncovered */
+        frag->hole[i] = frag->hole[--frag->nhole];
+        if (first > hole.first)
+        {
+            if (IPv4_FRAG_NHOLE == frag->nhole)
+            {
+                return FALSE;
+            }
+            frag->hole[frag->nhole].first = hole.first;
+            frag->hole[frag->nhole].last = first - 1;
+            frag->nhole++;
+        }
+        if ((last < hole.last) && more)
+        {
+            if (IPv4_FRAG_NHOLE == frag->nhole)
+            {
+                return FALSE;
+            }
+            frag->hole[frag->nhole].first = last + 1;
+            frag->hole[frag->nhole].last = hole.last;
+            frag->nhole++;
+        }
+    }
+    return TRUE;
+}
+
+/**
+ * @ingroup ipv4
+ *
+ * Allocate the reassembly buffers and empty the reassembly table.  If no
+ * pool can be had, reassembly stays disabled and fragments are dropped.
+ * @return OK if reassembly is enabled, otherwise SYSERR
+ */
+xinu_syscall ipv4FragInit(void)
+{
+    int i;
+
+    for (i = 0; i < IPv4_FRAG_NENTRY; i++)
+    {
+        ipv4fragtab[i].state = IPv4_FRAG_FREE;
+        ipv4fragtab[i].pkt = NULL;
+    }
+    timerSetup(&ipv4fragtimer, ipv4FragTick, NULL);
+
+    ipv4fragpool = bfpalloc(sizeof(struct packet) + IPv4_FRAG_HDRROOM +
+                            IPv4_FRAG_MAXLEN, IPv4_FRAG_NBUF);
+    IPv4_TRACE("ipv4fragpool has been assigned pool ID %d", ipv4fragpool);
+    return (SYSERR == ipv4fragpool) ? SYSERR : OK;
+}
+
+/**
+ * @ingroup ipv4
+ *
+ * Abandon datagrams whose fragments have not all arrived in time.  If the
+ * first fragment was received, the sender is told with an ICMP time
+ * exceeded message.
+ */
+void ipv4FragExpire(void)
+{
+    struct ipv4Frag *frag;
+    struct ipv4Frag expired;
+    int i;
+
+    for (i = 0; i < IPv4_FRAG_NENTRY; i++)
+    {
+        frag = &ipv4fragtab[i];
+		ENTER_KERNEL_CRITICAL_SECTION();
+        if ((IPv4_FRAG_USED != frag->state) || (frag->expires > clktime))
+        {
+			EXIT_KERNEL_CRITICAL_SECTION();
+            continue;
+        }
+        frag->state = IPv4_FRAG_FREE;
+        expired = *frag;
+		EXIT_KERNEL_CRITICAL_SECTION();
+
+        IPv4_TRACE("Reassembly of datagram %d timed out",
+                   net2hs(expired.id));
+        if (0 != expired.hdrlen)
+        {
+            ipv4FragAssemble(&expired, ICMP_DEF_DATALEN);
+            icmpTimeExceeded(expired.pkt, ICMP_FRA_EXC);
+        }
+        netFreebuf(expired.pkt);
+    }
+}
+
+/**
+ * @ingroup ipv4
+ *
+ * Add an incoming fragment to its datagram.  The fragment's buffer is
+ * always consumed.
+ * @param pkt fragment, with nethdr pointing to its IPv4 header
+ * @return the reassembled datagram once its last missing fragment arrives,
+ *         laid out as if received whole, otherwise NULL
+ */
+struct packet *ipv4FragRecv(struct packet *pkt)
+{
+    struct ipv4Pkt *ip = (struct ipv4Pkt *)pkt->nethdr;
+    struct ipv4Frag *frag;
+    struct ipv4Frag done;
+    struct packet *whole = NULL;
+    unsigned int ihl, len, first, last;
+    bool more;
+
+    ihl = (ip->ver_ihl & IPv4_IHL) << 2;
+    len = net2hs(ip->len) - ihl;
+    first = (net2hs(ip->flags_froff) & IPv4_FROFF) << 3;
+    last = first + len - 1;
+    more = (0 != (net2hs(ip->flags_froff) & IPv4_FLAG_MF));
+
+    /* All but the last fragment carry a multiple of 8 octets */
+    if ((SYSERR == ipv4fragpool) || (net2hs(ip->len) <= ihl)
+        || (pkt->len < pkt->nif->linkhdrlen + net2hs(ip->len))
+        || (more && (len & 0x7)) || (last >= IPv4_FRAG_MAXLEN)
+        || (pkt->nif->linkhdrlen > IPv4_FRAG_LINKROOM))
+    {
+        IPv4_TRACE("Dropping fragment");
+        netFreebuf(pkt);
+        return NULL;
+    }
+
+    ipv4FragExpire();
+
+	ENTER_KERNEL_CRITICAL_SECTION();
+    frag = ipv4FragLookup(ip);
+    if (NULL == frag)
+    {
+		EXIT_KERNEL_CRITICAL_SECTION();
+        IPv4_TRACE("No reassembly buffer");
+        netFreebuf(pkt);
+        return NULL;
+    }
+
+    memcpy(frag->pkt->data + IPv4_FRAG_HDRROOM + first,
+           (unsigned char *)ip + ihl, len);
+    if (0 == first)
+    {
+        frag->hdrlen = pkt->nif->linkhdrlen + ihl;
+        memcpy(frag->pkt->data, pkt->linkhdr, frag->hdrlen);
+        frag->pkt->nif = pkt->nif;
+    }
+    if (!more)
+    {
+        frag->datalen = last + 1;
+    }
+
+    if (FALSE == ipv4FragFill(frag, first, last, more))
+    {
+        IPv4_TRACE("Too many holes in datagram %d", net2hs(ip->id));
+        frag->state = IPv4_FRAG_FREE;
+        netFreebuf(frag->pkt);
+    }
+    else if ((0 == frag->nhole) && (0 != frag->hdrlen)
+             && (0 != frag->datalen))
+    {
+        frag->state = IPv4_FRAG_FREE;
+        done = *frag;
+        whole = done.pkt;
+    }
+	EXIT_KERNEL_CRITICAL_SECTION();
+
+    netFreebuf(pkt);
+    if (NULL == whole)
+    {
+        /* Make sure the datagram is abandoned if it is never completed */
+        if (!timerPending(&ipv4fragtimer))
+        {
+            timerSched(&ipv4fragtimer, IPv4_FRAG_SWEEP * 1000);
+        }
+        return NULL;
+    }
+
+    /* Present the datagram as though it had never been fragmented */
+    ipv4FragAssemble(&done, done.datalen);
+    ip = (struct ipv4Pkt *)whole->nethdr;
+    ihl = (ip->ver_ihl & IPv4_IHL) << 2;
+    ip->len = hs2net(whole->len - whole->nif->linkhdrlen);
+    ip->flags_froff = ip->flags_froff & hs2net(IPv4_FLAG_DF);
+    ip->chksum = 0;
+    ip->chksum = netChksum((unsigned char *)ip, ihl);
+    return whole;
+}
@@ -12,7 +12,6 @@
 #include <udp.h>
 #include <tcp.h>
 #include <icmp.h>
-#include <netemu.h>
 
 /**
  * @ingroup ipv4
@@ -59,25 +58,20 @@ xinu_syscall ipv4Recv(struct packet *pkt)
     if (FALSE == ipv4RecvDemux(&dst))
     {
         IPv4_TRACE("Packet sent to routing subsystem");
-
-#if NETEMU
-        /* Run the packet through the network emulator if enabled */
-        return netemu(pkt);
-#else
         return rtRecv(pkt);
-#endif
     }
 
-    /* Check if packet is fragmented */
+    /* Hold fragments until the whole datagram has arrived */
     if ((IPv4_FLAG_MF & net2hs(ip->flags_froff))
         || (0 != (net2hs(ip->flags_froff) & IPv4_FROFF)))
     {
-        // TODO: Handle fragmenting of packet
-        // TODO: Should send icmp time exceeded
-        // return ipRecvSendFrag(pkt, &dst);
         IPv4_TRACE("Packet fragmented");
-        netFreebuf(pkt);
-        return SYSERR;
+        pkt = ipv4FragRecv(pkt);
+        if (NULL == pkt)
+        {
+            return OK;
+        }
+        ip = (struct ipv4Pkt *)pkt->nethdr;
     }
 
     /* The Ethernet driver pads packets less than 60 bytes in length.
@@ -88,6 +82,8 @@ xinu_syscall ipv4Recv(struct packet *pkt)
     if ((pkt->len - pkt->nif->linkhdrlen) > iplen)
     {
         pkt->len = pkt->nif->linkhdrlen + iplen;
+        /* The device's sum covered the padding too */
+        pkt->flags &= ~PKT_CSUM_COMPLETE;
     }
 
     /* Move current pointer to application level header */
@@ -94,6 +94,15 @@ xinu_syscall ipv4Send(struct packet *pkt, struct netaddr *src,
     ip->chksum = netChksum((unsigned char *)ip, IPv4_HDR_LEN);
     IPv4_TRACE("Setup IPv4 header");
 
+    /* Fill in a transport checksum left for the device if the interface
+     * cannot, or if it would have to be split across fragments */
+    if ((pkt->flags & PKT_CSUM_TX)
+        && (!(pkt->nif->offload & NET_CSUM_TX)
+            || (pkt->len > pkt->nif->mtu)))
+    {
+        ipv4ChksumFinish(pkt, ip);
+    }
+
     /* Fragment and send packet */
     return ipv4SendFrag(pkt, nxthop);
 }
@@ -11,11 +11,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ethernet.h>
+#include <CriticalSection.h>
+
+static unsigned short ipv4id;   /* Identification of last datagram fragmented */
 
 /**
  * Fragments packet into maximum transmission unit sized chunks.
  * @param pkt the packet to fragment
- * @return OK
+ * @param nxthop protocol address of the next hop
+ * @return OK if every fragment was sent, otherwise the error from netSend
  */
 xinu_syscall ipv4SendFrag(struct packet *pkt, struct netaddr *nxthop)
 {
@@ -25,6 +29,7 @@ xinu_syscall ipv4SendFrag(struct packet *pkt, struct netaddr *nxthop)
     unsigned short froff;
     unsigned short lastFlag;
     unsigned short dLen;
+    int result;
 
     // Incoming packet structures
     struct ipv4Pkt *ip;
@@ -69,7 +74,20 @@ xinu_syscall ipv4SendFrag(struct packet *pkt, struct netaddr *nxthop)
     data = ((unsigned char *)ip) + ihl;
     dRem = net2hs(ip->len) - ihl;
     froff = net2hs(ip->flags_froff) & IPv4_FROFF;
-    lastFlag = net2hs(ip->flags_froff) & IPv4_FLAGS;
+    lastFlag = net2hs(ip->flags_froff) & IPv4_FLAG_MF;
+
+    // Datagrams built with no identification get one now, so that the
+    //  receiver can tell their fragments from other datagrams'.
+    if ((0 == ip->id) && (0 == froff) && (0 == lastFlag))
+    {
+		ENTER_KERNEL_CRITICAL_SECTION();
+        if (0 == ++ipv4id)
+        {
+            ++ipv4id;
+        }
+        ip->id = hs2net(ipv4id);
+		EXIT_KERNEL_CRITICAL_SECTION();
+    }
 
     // Length of data in this packet will be MTU - header length,
     //  rounded down to nearest multiple of 8 bytes.
@@ -79,13 +97,16 @@ xinu_syscall ipv4SendFrag(struct packet *pkt, struct netaddr *nxthop)
     ip->len = hs2net(pkt->len);
 
     // Set more fragments flag
-    ip->flags_froff = IPv4_FLAG_MF & froff;
-    ip->flags_froff = hs2net(ip->flags_froff);
+    ip->flags_froff = hs2net(IPv4_FLAG_MF | froff);
 
     ip->chksum = 0;
     ip->chksum = netChksum((unsigned char *)ip, ihl);
 
-    netSend(pkt, NULL, nxthop, ETHER_TYPE_IPv4);
+    result = netSend(pkt, NULL, nxthop, ETHER_TYPE_IPv4);
+    if (OK != result)
+    {
+        return result;
+    }
     dRem -= dLen;
     data += dLen;
     froff += (dLen / 8);
@@ -99,17 +120,18 @@ xinu_syscall ipv4SendFrag(struct packet *pkt, struct netaddr *nxthop)
         return SYSERR;
     }
 
-    // Set up outgoing packet pointers and variables
-    outpkt->curr -= pkt->nif->mtu;
-    outip = (struct ipv4Pkt *)outpkt->curr;
+    // Set up outgoing packet pointers and variables.  Options are not
+    //  copied into later fragments.
+    outip = (struct ipv4Pkt *)(outpkt->curr - pkt->nif->mtu);
     outpkt->nif = pkt->nif;
 
 	memcpy(outip, ip, IPv4_HDR_LEN);
+    outip->ver_ihl = (IPv4_VERSION << 4) | IPv4_MIN_IHL;
 
     // While packet must be fragmented
     while (dRem > 0)
     {
-        if (((dRem + 7) & ~0x7) > pkt->nif->mtu + IPv4_HDR_LEN)
+        if (dRem > pkt->nif->mtu - IPv4_HDR_LEN)
         {
             dLen = (pkt->nif->mtu - IPv4_HDR_LEN) & ~0x7;
         }
@@ -123,11 +145,11 @@ xinu_syscall ipv4SendFrag(struct packet *pkt, struct netaddr *nxthop)
         // Set more fragments flag
         if (dLen == dRem)
         {
-            outip->flags_froff = lastFlag & froff;
+            outip->flags_froff = lastFlag | froff;
         }
         else
         {
-            outip->flags_froff = IPv4_FLAG_MF & froff;
+            outip->flags_froff = IPv4_FLAG_MF | froff;
         }
         outip->flags_froff = hs2net(outip->flags_froff);
 
@@ -136,11 +158,16 @@ xinu_syscall ipv4SendFrag(struct packet *pkt, struct netaddr *nxthop)
         outip->chksum = 0;
         outip->chksum = netChksum((unsigned char *)outip, IPv4_HDR_LEN);
 
-        // Update outgoing packet length
-        outpkt->len = net2hs(outip->len);
+        // netSend prepends the link header, so start each fragment afresh
+        outpkt->curr = (unsigned char *)outip;
+        outpkt->len = IPv4_HDR_LEN + dLen;
 
         // Send fragment
-        netSend(outpkt, NULL, nxthop, ETHER_TYPE_IPv4);
+        result = netSend(outpkt, NULL, nxthop, ETHER_TYPE_IPv4);
+        if (OK != result)
+        {
+            break;
+        }
 
         dRem -= dLen;
         data += dLen;
@@ -149,5 +176,5 @@ xinu_syscall ipv4SendFrag(struct packet *pkt, struct netaddr *nxthop)
 
     IPv4_TRACE("freeing outpkt");
     netFreebuf(outpkt);
-    return OK;
+    return result;
 }
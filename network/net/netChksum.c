@@ -1,41 +1,254 @@
 /**
  * @file netChksum.c
  *
+ * Internet checksum (RFC 1071) engine.  Partial sums are kept in the byte
+ * order the data has in memory, so they may be added together, folded and
+ * stored into a header without conversion.
  */
 /* Embedded Xinu, Copyright (C) 2009, 2018.  All rights reserved. */
 
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 #include <xinu.h>
+#include <ipv4.h>
 #include <network.h>
 
+/* A halfword made of two bytes in memory order */
+union chksumhalf
+{
+    uint16_t half;
+    uint8_t byte[2];
+};
+
+/* Fold a wide one's complement accumulator down to 16 bits */
+static uint32_t chksumfold16(uint64_t acc)
+{
+    acc = (acc >> 32) + (acc & 0xFFFFFFFF);
+    acc = (acc >> 32) + (acc & 0xFFFFFFFF);
+    acc = (acc >> 16) + (acc & 0xFFFF);
+    acc = (acc >> 16) + (acc & 0xFFFF);
+    return (uint32_t)((acc >> 16) + (acc & 0xFFFF));
+}
+
 /**
  * @ingroup network
+ *
+ * Add a block of data to a running one's complement sum.  The data is read
+ * a 32-bit word at a time into a 64-bit accumulator, four words to a loop,
+ * once its address is word aligned.  Data at an odd address is summed
+ * from the following halfword and byte swapped into place.
+ *
+ * Blocks may be summed separately and combined by passing the result of one
+ * as @p sum to the next, provided every block but the last has even length.
+ *
+ * @param data start of block
+ * @param len  length of block in bytes
+ * @param sum  running sum from earlier blocks, 0 to start
+ * @return new running sum, at most 16 bits wide
  */
-unsigned short netChksum(void *data, unsigned int len)
+uint32_t netChksumPartial(const void *data, unsigned int len, uint32_t sum)
 {
-    unsigned int sum;
-    unsigned short *ptr;
+    const uint8_t *ptr = data;
+    const uint32_t *word;
+    union chksumhalf edge;
+    uint64_t acc = 0;
+    bool odd = FALSE;
 
-    /* Add data to sum */
-    ptr = (unsigned short *)data;
-    sum = 0;
-    while (len > 1)
+    /* Pair a leading odd byte as the high address half of a halfword */
+    if ((len > 0) && ((uintptr_t)ptr & 1))
+    {
+        edge.byte[0] = 0;
+        edge.byte[1] = *ptr++;
+        acc = edge.half;
+        len--;
+        odd = TRUE;
+    }
+    if ((len >= 2) && ((uintptr_t)ptr & 2))
     {
-        sum += *ptr;
-        ptr++;
+        acc += *(const uint16_t *)ptr;
+        ptr += 2;
         len -= 2;
     }
 
-    /* Add left-over byte, if any */
+    word = (const uint32_t *)ptr;
+    while (len >= 16)
+    {
+        acc += word[0];
+        acc += word[1];
+        acc += word[2];
+        acc += word[3];
+        word += 4;
+        len -= 16;
+    }
+    while (len >= 4)
+    {
+        acc += *word++;
+        len -= 4;
+    }
+    ptr = (const uint8_t *)word;
+
+    if (len >= 2)
+    {
+        acc += *(const uint16_t *)ptr;
+        ptr += 2;
+        len -= 2;
+    }
+    /* Pad a trailing byte with zero */
     if (len > 0)
     {
-        sum += net2hs(*((unsigned char *)ptr) << 8);
+        edge.byte[0] = *ptr;
+        edge.byte[1] = 0;
+        acc += edge.half;
     }
 
-    /* Fold 32-bit sum into 16 bits */
-    while (sum >> 16)
+    acc = chksumfold16(acc);
+    if (odd)
     {
-        sum = (sum >> 16) + (sum & 0xFFFF);
+        acc = ((acc & 0xFF) << 8) | (acc >> 8);
     }
+    return chksumfold16(acc + sum);
+}
 
-    return (~sum);
+/**
+ * @ingroup network
+ *
+ * Copy a block of data and add it to a running one's complement sum in the
+ * same pass.  Same rules as netChksumPartial() for combining blocks.
+ *
+ * @param dest destination of copy
+ * @param src  start of block
+ * @param len  length of block in bytes
+ * @param sum  running sum from earlier blocks, 0 to start
+ * @return new running sum, at most 16 bits wide
+ */
+uint32_t netChksumCopy(void *dest, const void *src, unsigned int len,
+                       uint32_t sum)
+{
+    uint32_t *dw = dest;
+    const uint32_t *sw = src;
+    uint64_t acc = 0;
+    uint32_t w;
+
+    /* Only word aligned copies are fused; others take two passes */
+    if (((uintptr_t)dest | (uintptr_t)src) & 3)
+    {
+        memcpy(dest, src, len);
+        return netChksumPartial(dest, len, sum);
+    }
+
+    while (len >= 4)
+    {
+        w = *sw++;
+        *dw++ = w;
+        acc += w;
+        len -= 4;
+    }
+    if (len > 0)
+    {
+        memcpy(dw, sw, len);
+        acc += netChksumPartial(dw, len, 0);
+    }
+    return chksumfold16(acc + sum);
+}
+
+/**
+ * @ingroup network
+ *
+ * Start the running sum of a TCP or UDP checksum with the IPv4 pseudo
+ * header.
+ *
+ * @param src   source address
+ * @param dst   destination address
+ * @param proto IPv4 protocol number
+ * @param len   length of transport header and payload in bytes
+ * @return running sum of the pseudo header
+ */
+uint32_t netChksumPseudo(const struct netaddr *src, const struct netaddr *dst,
+                         uint8_t proto, uint16_t len)
+{
+    struct
+    {
+        uint8_t srcIp[IPv4_ADDR_LEN];
+        uint8_t dstIp[IPv4_ADDR_LEN];
+        uint8_t zero;
+        uint8_t proto;
+        uint16_t len;
+    } __attribute__((aligned(4))) pseudo;
+
+    memcpy(pseudo.srcIp, src->addr, IPv4_ADDR_LEN);
+    memcpy(pseudo.dstIp, dst->addr, IPv4_ADDR_LEN);
+    pseudo.zero = 0;
+    pseudo.proto = proto;
+    pseudo.len = hs2net(len);
+
+    return netChksumPartial(&pseudo, sizeof(pseudo), 0);
+}
+
+/**
+ * @ingroup network
+ *
+ * Turn a running sum into the checksum to store in a header.
+ *
+ * @param sum running sum
+ * @return one's complement of the folded sum
+ */
+uint16_t netChksumFold(uint32_t sum)
+{
+    return (uint16_t)~chksumfold16(sum);
+}
+
+/**
+ * @ingroup network
+ *
+ * Patch a stored checksum for one changed 16-bit field without summing the
+ * rest of the data again (RFC 1624, equation 3).  The field values are
+ * given as they appear in the header.
+ *
+ * @param chksum checksum currently stored
+ * @param old    previous value of the field
+ * @param new    new value of the field
+ * @return checksum to store
+ */
+uint16_t netChksumUpdate(uint16_t chksum, uint16_t old, uint16_t new)
+{
+    return netChksumFold((uint16_t)~chksum + (uint16_t)~old + (uint32_t)new);
+}
+
+/**
+ * @ingroup network
+ *
+ * Compute the Internet checksum of a block of data.
+ *
+ * @param data start of block
+ * @param len  length of block in bytes
+ * @return checksum to store, or 0 when checking a block that includes a
+ *      correct checksum
+ */
+uint16_t netChksum(void *data, unsigned int len)
+{
+    return netChksumFold(netChksumPartial(data, len, 0));
+}
+
+/**
+ * @ingroup network
+ *
+ * Leave the TCP or UDP checksum of an outgoing packet to be filled in by
+ * the network device, or by ipv4Send() when the device cannot.  The
+ * checksum field is seeded with the pseudo header sum, so that summing the
+ * transport header and payload from there gives the checksum to store.
+ *
+ * @param pkt   outgoing packet, marked ::PKT_CSUM_TX
+ * @param src   source address
+ * @param dst   destination address
+ * @param proto IPv4 protocol number
+ * @param len   length of transport header and payload in bytes
+ * @return value to store in the checksum field
+ */
+uint16_t netChksumOffload(struct packet *pkt, const struct netaddr *src,
+                          const struct netaddr *dst, uint8_t proto,
+                          uint16_t len)
+{
+    pkt->flags |= PKT_CSUM_TX;
+    return (uint16_t)~netChksumFold(netChksumPseudo(src, dst, proto, len));
 }
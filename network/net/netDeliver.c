@@ -0,0 +1,72 @@
+/**
+ * @file     netDeliver.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <arp.h>
+#include <ethernet.h>
+#include <network.h>
+#include <ipv4.h>
+#include <string.h>
+
+/**
+ * @ingroup network
+ *
+ * Hand a received packet to the protocol it carries, if it was sent to
+ * this interface.
+ * @param pkt packet, with curr at its link layer header
+ * @return OK if packet was processed, otherwise SYSERR
+ */
+xinu_syscall netDeliver(struct packet *pkt)
+{
+    struct netif *netptr = pkt->nif;
+    struct etherPkt *ether;
+    struct netaddr dst;
+
+    ether = (struct etherPkt *)pkt->linkhdr;
+
+    /* Obtain destination hardware address */
+    dst.type = NETADDR_ETHERNET;
+    dst.len = ETH_ADDR_LEN;
+	memcpy(dst.addr, ether->dst, ETH_ADDR_LEN);
+
+#ifdef TRACE_NET
+    char str[20];
+    NET_TRACE("Read packet len %d", pkt->len);
+    netaddrsprintf(str, &dst);
+    NET_TRACE("\tPacket dst %s", str);
+    NET_TRACE("\tPacket proto 0x%04X", net2hs(ether->type));
+#endif
+
+    /* Verify that packet belongs to our mac or is broadcast mac */
+    if ((!netaddrequal(&dst, &netptr->hwaddr))
+        && (!netaddrequal(&dst, &netptr->hwbrc)))
+    {
+        netFreebuf(pkt);
+        return OK;
+    }
+
+    /* Move current pointer to network level header */
+    pkt->curr = pkt->data + netptr->linkhdrlen;
+
+    /* Call necessary routine based on packet type */
+    switch (net2hs(ether->type))
+    {
+        /* IP Packet */
+    case ETHER_TYPE_IPv4:
+        netptr->nproc++;
+        return ipv4Recv(pkt);
+
+        /* ARP Packet */
+    case ETHER_TYPE_ARP:
+        netptr->nproc++;
+        return arpRecv(pkt);
+
+        /* Unknown ether packet type */
+    default:
+        netFreebuf(pkt);
+        return OK;
+    }
+}
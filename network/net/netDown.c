@@ -26,6 +26,7 @@
 xinu_syscall netDown(int descrp)
 {
     struct netif *netptr;
+    tid_typ recvthr[NET_NTHR];
     unsigned int i;
 
 	ENTER_KERNEL_CRITICAL_SECTION();
@@ -41,13 +42,20 @@ xinu_syscall netDown(int descrp)
 
     NET_TRACE("Stopping netif %u on device %d", netptr - netiftab, descrp);
 
-    /* Kill receiver threads.  TODO: There is a known bug here: this can kill
-     * the receiver threads at inopportune times and leak resources (such as
-     * packet buffers allocated with netGetbuf()).  */
+    /* Kill receiver threads, which may reschedule, so not under the kernel
+     * lock.  TODO: There is a known bug here: this can kill the receiver
+     * threads at inopportune times and leak resources (such as packet buffers
+     * allocated with netGetbuf()).  */
     for (i = 0; i < NET_NTHR; i++)
     {
-        kill(netptr->recvthr[i]);
+        recvthr[i] = netptr->recvthr[i];
     }
+    EXIT_KERNEL_CRITICAL_SECTION();
+    for (i = 0; i < NET_NTHR; i++)
+    {
+        kill(recvthr[i]);
+    }
+    ENTER_KERNEL_CRITICAL_SECTION();
 
     /* Clear all entries in the route table for this network interface.  */
     rtClear(netptr);
@@ -6,8 +6,10 @@
 #include <xinu.h>
 #include <arp.h>
 #include <icmp.h>
+#include <ipv4.h>
 #include <bufpool.h>
 #include <network.h>
+#include <netemu.h>
 #include <route.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -46,6 +48,9 @@ xinu_syscall netInit(void)
         return SYSERR;
     }
 
+    /* Reassembly is optional, fragments are dropped without it */
+    ipv4FragInit();
+
     /* Initialize ARP */
     if (SYSERR == arpInit())
     {
@@ -63,18 +68,13 @@ xinu_syscall netInit(void)
         return SYSERR;
     }
 
-    /* Initialize TCP */
-#if NTCP
-    i = create((void *)tcpTimer, INITSTK, INITPRIO, "tcpTimer", 0);
-    if (SYSERR == i)
+#if NETEMU
+    /* Start the network emulator, with nothing to emulate */
+    if (SYSERR == netemuInit())
     {
         return SYSERR;
     }
-    else
-    {
-        ready(i);
-    }
-#endif                          /* NTCP */
+#endif
 
     return OK;
 }
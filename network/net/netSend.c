@@ -8,7 +8,9 @@
 #include <arp.h>
 #include <device.h>
 #include <ethernet.h>
+#include <ipv4.h>
 #include <network.h>
+#include <netemu.h>
 #include <snoop.h>
 #include <string.h>
 
@@ -74,8 +76,32 @@ xinu_syscall netSend(struct packet *pkt, const struct netaddr *hwaddr,
     /* Copy destination hardware address into link-level header */
 	memcpy(ether->dst, hwaddr->addr, hwaddr->len);
 
-    /* Write the packet to the underlying device */
-    if (pkt->len != write(netptr->dev, pkt->curr, pkt->len))
+#if NETEMU
+    /* Run the packet through the network emulator if enabled, which may
+     * corrupt it and writes it to the device itself, so any checksum left
+     * for the device is filled in first */
+    if (netemuStage(netptr, NETEMU_OUT)->active)
+    {
+        if (pkt->flags & PKT_CSUM_TX)
+        {
+            ipv4ChksumFinish(pkt, (struct ipv4Pkt *)(pkt->curr +
+                                                     netptr->linkhdrlen));
+        }
+        return netemu(pkt, NETEMU_OUT);
+    }
+#endif
+
+    /* Write the packet to the underlying device, with any checksum left for
+     * it to fill in */
+    if (NULL != netptr->sendpkt)
+    {
+        result = netptr->sendpkt(netptr->dev, pkt);
+    }
+    else
+    {
+        result = write(netptr->dev, pkt->curr, pkt->len);
+    }
+    if (pkt->len != result)
     {
         return SYSERR;
     }
@@ -40,6 +40,7 @@ xinu_syscall netUp(int descrp, const struct netaddr *ip, const struct netaddr *m
     struct netif *netptr;
     unsigned int i;
     unsigned int nthreads;
+    int offload;
     int retval = SYSERR;
 
     /* Error check arguments */
@@ -80,6 +81,11 @@ xinu_syscall netUp(int descrp, const struct netaddr *ip, const struct netaddr *m
     bzero(netptr, sizeof(struct netif));
     netptr->dev = descrp;
     netptr->state = NET_ALLOC;
+	EXIT_KERNEL_CRITICAL_SECTION();
+
+    /* NET_ALLOC keeps the interface ours while the device is queried and
+     * the receive threads are started, which may block, so not under the
+     * kernel lock.  */
     netptr->mtu = control(descrp, NET_GET_MTU, 0, 0);
     netptr->linkhdrlen = control(descrp, NET_GET_LINKHDRLEN, 0, 0);
     if (SYSERR == netptr->mtu || SYSERR == netptr->linkhdrlen)
@@ -98,6 +104,30 @@ xinu_syscall netUp(int descrp, const struct netaddr *ip, const struct netaddr *m
         goto out_free_nif;
     }
 
+    /* Devices that receive straight into packets hand them over directly;
+     * others are read() into packets by netRecv().  */
+    if (SYSERR == control(descrp, NET_GET_RECVPKT, (long)&netptr->recvpkt, 0))
+    {
+        netptr->recvpkt = NULL;
+    }
+
+    /* Devices that can fill in or check transport checksums take packets
+     * marked for them; for others, such as ELOOP and RAW, the stack does
+     * the checksums.  */
+    netptr->offload = 0;
+    if (SYSERR == control(descrp, NET_GET_SENDPKT, (long)&netptr->sendpkt, 0))
+    {
+        netptr->sendpkt = NULL;
+    }
+    else
+    {
+        offload = control(descrp, NET_GET_OFFLOAD, 0, 0);
+        if (SYSERR != offload)
+        {
+            netptr->offload = offload;
+        }
+    }
+
     /* Set protocol addresses */
     netaddrcpy(&netptr->ip, ip);
     netaddrcpy(&netptr->mask, mask);
@@ -161,7 +191,7 @@ xinu_syscall netUp(int descrp, const struct netaddr *ip, const struct netaddr *m
     }
 
     retval = OK;
-    goto out_restore;
+    goto out;
 
 out_kill_recv_threads:
     for (i = 0; i < nthreads; i++)
@@ -169,6 +199,7 @@ out_kill_recv_threads:
         kill(netptr->recvthr[i]);
     }
 out_free_nif:
+    ENTER_KERNEL_CRITICAL_SECTION();
     netptr->state = NET_FREE;
 out_restore:
 	EXIT_KERNEL_CRITICAL_SECTION();
@@ -0,0 +1,28 @@
+/**
+ * @file     netaddrhash.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <network.h>
+
+/**
+ * @ingroup network
+ *
+ * Hash a network address for table lookups.  Equal addresses (as defined by
+ * netaddrequal()) always hash to the same value.
+ * @param addr network address
+ * @return 32-bit FNV-1a hash of the address type and octets
+ */
+unsigned int netaddrhash(const struct netaddr *addr)
+{
+    unsigned int hash = 2166136261u;
+    int i;
+
+    hash = (hash ^ addr->type) * 16777619u;
+    for (i = 0; i < addr->len; i++)
+    {
+        hash = (hash ^ addr->addr[i]) * 16777619u;
+    }
+    return hash;
+}
@@ -5,6 +5,7 @@
 /* Embedded Xinu, Copyright (C) 2009, 2018.  All rights reserved. */
 
 #include <xinu.h>
+#include <CriticalSection.h>
 #include <network.h>
 #include <route.h>
 
@@ -33,6 +34,27 @@ xinu_syscall rtAdd(const struct netaddr *dst, const struct netaddr *gate,
                  gate->addr[2], gate->addr[3]);
     RT_TRACE("nif = %d", nif - netiftab);
 
+    /* Calculate mask length; routes are matched by prefix, so the mask */
+    /* must be contiguous                                               */
+    length = 0;
+    for (i = 0; i < mask->len; i++)
+    {
+        octet = mask->addr[i];
+        if (length == i * 8)
+        {
+            while (octet & 0x80)
+            {
+                length++;
+                octet = octet << 1;
+            }
+        }
+        if (0 != octet)
+        {
+            RT_TRACE("Non-contiguous mask");
+            return SYSERR;
+        }
+    }
+
     /* Allocate an entry in the route table */
     rtptr = rtAlloc();
     if ((SYSERR == (int)rtptr) || (NULL == rtptr))
@@ -53,24 +75,16 @@ xinu_syscall rtAdd(const struct netaddr *dst, const struct netaddr *gate,
     }
     netaddrcpy(&rtptr->mask, mask);
     rtptr->nif = nif;
+    rtptr->masklen = length;
 
-    /* Calculate mask length */
-    length = 0;
-    for (i = 0; i < mask->len; i++)
+	ENTER_KERNEL_CRITICAL_SECTION();
+    if (SYSERR == rtTrieInsert(rtptr))
     {
-        octet = mask->addr[i];
-        // This totals non-zero bits
-        while (octet > 0)
-        {
-            if (octet & 0x01)
-            {
-                length++;
-            }
-            octet = octet >> 1;
-        }
+        rtptr->state = RT_FREE;
+		EXIT_KERNEL_CRITICAL_SECTION();
+        return SYSERR;
     }
-    rtptr->masklen = length;
-
     rtptr->state = RT_USED;
+	EXIT_KERNEL_CRITICAL_SECTION();
     return OK;
 }
@@ -31,6 +31,7 @@ xinu_syscall rtClear(struct netif *nif)
     {
         if ((RT_USED == rttab[i].state) && (nif == rttab[i].nif))
         {
+            rtTrieRemove(&rttab[i]);
             rttab[i].state = RT_FREE;
             rttab[i].nif = NULL;
         }
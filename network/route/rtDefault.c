@@ -5,6 +5,7 @@
 /* Embedded Xinu, Copyright (C) 2009, 2018.  All rights reserved. */
 
 #include <xinu.h>
+#include <CriticalSection.h>
 #include <network.h>
 #include <route.h>
 #include <stdlib.h>
@@ -64,7 +65,16 @@ xinu_syscall rtDefault (const struct netaddr *gate, struct netif *nif)
     /* Calculate mask length */
     rtptr->masklen = 0;
 
+	ENTER_KERNEL_CRITICAL_SECTION();
+    if (SYSERR == rtTrieInsert(rtptr))
+    {
+        rtptr->state = RT_FREE;
+		EXIT_KERNEL_CRITICAL_SECTION();
+        RT_TRACE("Failed to index default route");
+        return SYSERR;
+    }
     rtptr->state = RT_USED;
+	EXIT_KERNEL_CRITICAL_SECTION();
     RT_TRACE("Populated default route");
     return OK;
 }
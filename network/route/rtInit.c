@@ -12,6 +12,7 @@
 #include <thread.h>
 
 struct rtEntry rttab[RT_NENTRY];
+unsigned int rtgen;
 mailbox rtqueue;
 
 /**
@@ -30,6 +31,7 @@ xinu_syscall rtInit(void)
         bzero(&rttab[i], sizeof(struct rtEntry));
         rttab[i].state = RT_FREE;
     }
+    rtTrieInit();
 
     /* Initialize route queue */
     rtqueue = mailboxAlloc(RT_NQUEUE);
@@ -9,45 +9,38 @@
 #include <network.h>
 #include <route.h>
 
+static struct rtCache rtcache[RT_NCACHE];
+
 /**
  * @ingroup route
  *
- * Looks up an entry in the routing table
+ * Looks up an entry in the routing table.  Recent destinations are answered
+ * from a direct-mapped cache that is discarded whenever a route is added or
+ * removed; other lookups take the longest prefix match from the route trie.
  * @param addr the IP address that needs routing
  * @return a route table entry, NULL if none matches, SYSERR on error
  */
 struct rtEntry *rtLookup(const struct netaddr *addr)
 {
-    int i;
+    struct rtCache *cache;
     struct rtEntry *rtptr;
-    struct netaddr masked;
-
-    rtptr = NULL;
 
     RT_TRACE("Addr = %d.%d.%d.%d", addr->addr[0], addr->addr[1],
              addr->addr[2], addr->addr[3]);
 
 	ENTER_KERNEL_CRITICAL_SECTION();
-    for (i = 0; i < RT_NENTRY; i++)
+    cache = &rtcache[netaddrhash(addr) & (RT_NCACHE - 1)];
+    if ((cache->gen == rtgen) && (netaddrequal(&cache->addr, addr)))
     {
-        if (RT_USED == rttab[i].state)
-        {
-            /* Mask off address */
-            netaddrcpy(&masked, addr);
-            netaddrmask(&masked, &rttab[i].mask);
-
-            /* Check if match  */
-            if (netaddrequal(&masked, &rttab[i].dst))
-            {
-                RT_TRACE("Matched entry %d", i);
-                /* Remember match if no match so far or match is better */
-                if ((NULL == rtptr)
-                    || (rtptr->masklen < rttab[i].masklen))
-                {
-                    rtptr = &rttab[i];
-                }
-            }
-        }
+        rtptr = cache->route;
+    }
+    else
+    {
+        rtptr = rtTrieLookup(addr);
+        cache->gen = rtgen;
+        netaddrcpy(&cache->addr, addr);
+        cache->route = rtptr;
+        RT_TRACE("Matched entry %d", (NULL == rtptr) ? -1 : rtptr - rttab);
     }
 	EXIT_KERNEL_CRITICAL_SECTION();
 
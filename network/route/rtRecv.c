@@ -32,16 +32,17 @@ xinu_syscall rtRecv(struct packet *pkt)
         return OK;
     }
 
-    /* Place packet in queue */
+	EXIT_KERNEL_CRITICAL_SECTION();
+
+    /* Place packet in queue; mailboxSend() may reschedule, so not under the
+     * kernel lock */
     if (SYSERR == mailboxSend(rtqueue, (int)pkt))
     {
-		EXIT_KERNEL_CRITICAL_SECTION();
         RT_TRACE("Failed to enqueue packet");
         netFreebuf(pkt);
         return SYSERR;
     }
 
-	EXIT_KERNEL_CRITICAL_SECTION();
     RT_TRACE("Enqueued packet for routing");
     return OK;
 }
@@ -23,6 +23,7 @@ xinu_syscall rtSend(struct packet *pkt)
     struct netaddr dst;
     struct rtEntry *route;
     struct netaddr *nxthop;
+    uint16_t ttlproto;
 
     /* Error check pointers */
     if (NULL == pkt)
@@ -57,7 +58,8 @@ xinu_syscall rtSend(struct packet *pkt)
         }
     }
 
-    /* Update IP header */
+    /* Update IP header, patching the checksum for the new TTL */
+    ttlproto = hs2net((ip->ttl << 8) | ip->proto);
     ip->ttl--;
     if (0 == ip->ttl)
     {
@@ -65,8 +67,8 @@ xinu_syscall rtSend(struct packet *pkt)
         icmpTimeExceeded(pkt, ICMP_TTL_EXC);
         return SYSERR;
     }
-    ip->chksum = 0;
-    ip->chksum = netChksum((unsigned char *)ip, IPv4_HDR_LEN);
+    ip->chksum = netChksumUpdate(ip->chksum, ttlproto,
+                                 hs2net((ip->ttl << 8) | ip->proto));
 
     /* Change packet to new network interface */
     pkt->nif = route->nif;
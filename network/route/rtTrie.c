@@ -0,0 +1,259 @@
+/**
+ * @file rtTrie.c
+ *
+ * Longest prefix match index over the route table.  Routes are kept in a
+ * path-compressed binary trie keyed on destination prefix, so a lookup
+ * visits at most one node per distinct prefix length on the path to the
+ * address rather than every entry of ::rttab.  All functions must be
+ * called inside a kernel critical section.
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <network.h>
+#include <route.h>
+#include <string.h>
+
+static struct rtNode rtnodes[RT_NNODE];
+static struct rtNode *rtroot;           /* Root of trie, NULL if empty */
+static struct rtNode *rtfreenodes;      /* Free nodes, linked by child[0] */
+static int rtnfree;                     /* Number of free nodes */
+
+/* Bit i of a key, counting from the most significant bit of octet 0 */
+#define rtbit(key, i)   (((key)[(i) >> 3] >> (7 - ((i) & 7))) & 1)
+
+/**
+ * Number of leading bits two keys share, at most max.
+ */
+static unsigned int rtMatchlen(const unsigned char *a, const unsigned char *b,
+                               unsigned int max)
+{
+    unsigned int i = 0;
+    unsigned char diff;
+
+    while ((i + 8 <= max) && (a[i >> 3] == b[i >> 3]))
+    {
+        i += 8;
+    }
+    if (i < max)
+    {
+        diff = a[i >> 3] ^ b[i >> 3];
+        while ((i < max) && !(diff & (0x80 >> (i & 7))))
+        {
+            i++;
+        }
+    }
+    return i;
+}
+
+static struct rtNode *rtNodeAlloc(const unsigned char *key, unsigned int bits)
+{
+    struct rtNode *node = rtfreenodes;
+
+    rtfreenodes = node->child[0];
+    rtnfree--;
+    node->child[0] = NULL;
+    node->child[1] = NULL;
+    node->routes = NULL;
+    node->bits = bits;
+    memcpy(node->key, key, NET_MAX_ALEN);
+    return node;
+}
+
+static void rtNodeFree(struct rtNode *node)
+{
+    node->child[0] = rtfreenodes;
+    rtfreenodes = node;
+    rtnfree++;
+}
+
+/**
+ * @ingroup route
+ *
+ * Empty the trie and return every node to the free list.
+ */
+void rtTrieInit(void)
+{
+    int i;
+
+    rtroot = NULL;
+    rtfreenodes = NULL;
+    rtnfree = 0;
+    for (i = RT_NNODE - 1; i >= 0; i--)
+    {
+        rtNodeFree(&rtnodes[i]);
+    }
+    rtgen++;
+}
+
+/**
+ * @ingroup route
+ *
+ * Index a populated route table entry by its destination and mask length.
+ * @param rtptr route table entry, with dst already masked
+ * @return OK if the route was indexed, SYSERR if its prefix is invalid
+ */
+xinu_syscall rtTrieInsert(struct rtEntry *rtptr)
+{
+    const unsigned char *key = rtptr->dst.addr;
+    unsigned int plen = rtptr->masklen;
+    struct rtNode **link;
+    struct rtNode *node, *glue, *leaf;
+    struct rtEntry **rlink;
+    unsigned int common;
+
+    /* A split never needs more than two new nodes */
+    if ((plen > rtptr->dst.len * 8) || (rtnfree < 2))
+    {
+        return SYSERR;
+    }
+
+    link = &rtroot;
+    while (NULL != (node = *link))
+    {
+        common = rtMatchlen(key, node->key,
+                            (plen < node->bits) ? plen : node->bits);
+        if (common < node->bits)
+        {
+            leaf = rtNodeAlloc(key, plen);
+            if (common == plen)
+            {
+                /* New prefix is an ancestor of this node */
+                leaf->child[rtbit(node->key, plen)] = node;
+                *link = leaf;
+            }
+            else
+            {
+                /* Prefixes diverge, join them under a routeless node */
+                glue = rtNodeAlloc(key, common);
+                glue->child[rtbit(node->key, common)] = node;
+                glue->child[rtbit(key, common)] = leaf;
+                *link = glue;
+            }
+            node = leaf;
+            break;
+        }
+        if (node->bits == plen)
+        {
+            break;
+        }
+        link = &node->child[rtbit(key, node->bits)];
+    }
+    if (NULL == node)
+    {
+        node = rtNodeAlloc(key, plen);
+        *link = node;
+    }
+
+    /* Earlier routes for the same prefix keep precedence */
+    rtptr->next = NULL;
+    rlink = &node->routes;
+    while (NULL != *rlink)
+    {
+        rlink = &(*rlink)->next;
+    }
+    *rlink = rtptr;
+
+    rtgen++;
+    return OK;
+}
+
+/**
+ * @ingroup route
+ *
+ * Remove a route table entry from the index.  Nodes left without routes are
+ * merged away so the trie stays path-compressed.
+ * @param rtptr route table entry previously passed to rtTrieInsert()
+ */
+void rtTrieRemove(struct rtEntry *rtptr)
+{
+    const unsigned char *key = rtptr->dst.addr;
+    unsigned int plen = rtptr->masklen;
+    struct rtNode **link, **plink = NULL;
+    struct rtNode *node, *parent = NULL;
+    struct rtEntry **rlink;
+
+    /* Find the node for the route's prefix */
+    link = &rtroot;
+    while ((NULL != (node = *link)) && (node->bits < plen))
+    {
+        plink = link;
+        parent = node;
+        link = &node->child[rtbit(key, node->bits)];
+    }
+    if ((NULL == node) || (node->bits != plen)
+        || (rtMatchlen(key, node->key, plen) != plen))
+    {
+        return;
+    }
+
+    rlink = &node->routes;
+    while ((NULL != *rlink) && (*rlink != rtptr))
+    {
+        rlink = &(*rlink)->next;
+    }
+    if (NULL == *rlink)
+    {
+        return;
+    }
+    *rlink = rtptr->next;
+    rtptr->next = NULL;
+    rtgen++;
+    if (NULL != node->routes)
+    {
+        return;
+    }
+
+    /* Splice out the node if it no longer joins two subtrees */
+    if ((NULL != node->child[0]) && (NULL != node->child[1]))
+    {
+        return;
+    }
+    *link = (NULL != node->child[0]) ? node->child[0] : node->child[1];
+    rtNodeFree(node);
+
+    /* A routeless parent left with one child goes too */
+    if ((NULL != parent) && (NULL == parent->routes)
+        && ((NULL == parent->child[0]) || (NULL == parent->child[1])))
+    {
+        *plink = (NULL != parent->child[0]) ?
+            parent->child[0] : parent->child[1];
+        rtNodeFree(parent);
+    }
+}
+
+/**
+ * @ingroup route
+ *
+ * Find the route with the longest prefix matching an address.
+ * @param addr destination address
+ * @return matching route table entry, NULL if none matches
+ */
+struct rtEntry *rtTrieLookup(const struct netaddr *addr)
+{
+    struct rtNode *node = rtroot;
+    struct rtEntry *best = NULL;
+    struct rtEntry *rtptr;
+    unsigned int abits = addr->len * 8;
+
+    while ((NULL != node) && (node->bits <= abits)
+           && (rtMatchlen(addr->addr, node->key, node->bits) == node->bits))
+    {
+        for (rtptr = node->routes; NULL != rtptr; rtptr = rtptr->next)
+        {
+            if ((rtptr->dst.type == addr->type)
+                && (rtptr->dst.len == addr->len))
+            {
+                best = rtptr;
+                break;
+            }
+        }
+        if (node->bits == abits)
+        {
+            break;
+        }
+        node = node->child[rtbit(addr->addr, node->bits)];
+    }
+
+    return best;
+}
@@ -4,18 +4,69 @@
 /* Embedded Xinu, Copyright (C) 2009, 2018.  All rights reserved. */
 
 #include <xinu.h>
+#include <clock.h>
+#include <CriticalSection.h>
 #include <snoop.h>
+#include <string.h>
+
+/*
+ * Determine if a packet belongs to the capture's own export stream, which
+ * would otherwise be captured and exported again without end.
+ */
+static bool snoopExported(struct snoop *cap, struct packet *pkt)
+{
+    struct etherPkt *ether;
+    struct ipv4Pkt *ip;
+    unsigned short *ports;
+    unsigned int ihl;
+
+    if (0 == cap->expport)
+    {
+        return FALSE;
+    }
+
+    ether = (struct etherPkt *)pkt->curr;
+    if ((pkt->len < ETH_HDR_LEN + IPv4_HDR_LEN)
+        || (ETHER_TYPE_IPv4 != net2hs(ether->type)))
+    {
+        return FALSE;
+    }
+    ip = (struct ipv4Pkt *)ether->data;
+    if ((IPv4_PROTO_UDP != ip->proto) && (IPv4_PROTO_TCP != ip->proto))
+    {
+        return FALSE;
+    }
+    ihl = (ip->ver_ihl & IPv4_IHL) << 2;
+    if (pkt->len < ETH_HDR_LEN + ihl + 2 * sizeof(*ports))
+    {
+        return FALSE;
+    }
+
+    /* UDP and TCP headers both open with the source and destination port */
+    ports = (unsigned short *)((unsigned char *)ip + ihl);
+    return (((cap->expport == net2hs(ports[1]))
+             && (0 == memcmp(ip->dst, cap->expaddr.addr, IPv4_ADDR_LEN)))
+            || ((cap->expport == net2hs(ports[0]))
+                && (0 == memcmp(ip->src, cap->expaddr.addr,
+                                IPv4_ADDR_LEN))));
+}
 
 /**
  * @ingroup snoop
  *
- * Captures a network packet from a network interface.
+ * Captures a network packet from a network interface.  The packet is
+ * copied into the capture ring, never into a network buffer, so capturing
+ * does not draw on the packet pool.  Space in the ring is claimed in a
+ * short critical section and filled outside it, so captures on several
+ * interfaces never wait on each other or on the reader.
  * @return OK if capture was successful, otherwise SYSERR
  */
 int snoopCapture(struct snoop *cap, struct packet *pkt)
 {
-    struct packet *buf;
-    int len;
+    struct snoopRec *rec;
+    unsigned int len, size, pos, skip;
+    unsigned long sec, usec;
+    unsigned int nwait;
 
     /* Error check pointers */
     if ((NULL == cap) || (NULL == pkt))
@@ -28,8 +79,10 @@ int snoopCapture(struct snoop *cap, struct packet *pkt)
     /* Increment count of packets captured */
     cap->ncap++;
 
-    /* Check if packet matches capture filter, if not return OK */
-    if (FALSE == snoopFilter(cap, pkt))
+    /* Check if packet matches capture filter, if not return OK.  The
+     * filter also says how much of the packet to capture. */
+    len = snoopFilter(cap, pkt);
+    if ((0 == len) || snoopExported(cap, pkt))
     {
         SNOOP_TRACE("Packet does not match filter");
         return OK;
@@ -38,39 +91,55 @@ int snoopCapture(struct snoop *cap, struct packet *pkt)
     /* Increment count of packets matching filter */
     cap->nmatch++;
 
-    /* Try to get a buffer to put packet into */
-    buf = netGetbuf();
-    if (SYSERR == (int)buf)
-    {
-        SNOOP_TRACE("Failed to get buffer");
-        return SYSERR;
-    }
-
-    /* Copy packet header into buffer */
-	memcpy(buf, pkt, sizeof(struct packet));
+    size = (SNOOP_REC_HDRLEN + len + 3) & ~3;
 
-    /* Copy packet contents into buffer */
-    len = pkt->len;
-    if (len > cap->caplen)
+    /* Claim space for the record.  Records never wrap, so a record that
+     * would is preceded by one padding out the end of the ring. */
+	ENTER_KERNEL_CRITICAL_SECTION();
+    pos = cap->head & (cap->ringlen - 1);
+    skip = cap->ringlen - pos;
+    if (skip >= size)
     {
-        len = cap->caplen;
+        skip = 0;
     }
-	memcpy(buf->data, pkt->curr, len);
-    buf->curr = buf->data;
-
-    /* Queue packet */
-    if (mailboxCount(cap->queue) >= SNOOP_QLEN)
+    if (cap->head + skip + size - cap->tail > cap->ringlen)
     {
-        netFreebuf(buf);
         cap->novrn++;
-        SNOOP_TRACE("Capture queue full");
+		EXIT_KERNEL_CRITICAL_SECTION();
+        SNOOP_TRACE("Capture ring full");
         return SYSERR;
     }
-    if (SYSERR == mailboxSend(cap->queue, (int)buf))
+    if (skip > 0)
     {
-        netFreebuf(buf);
-        SNOOP_TRACE("Failed to enqueue packet");
-        return SYSERR;
+        rec = (struct snoopRec *)(cap->ring + pos);
+        rec->size = skip;
+        rec->state = SNOOP_REC_SKIP;
+        pos = 0;
+    }
+    rec = (struct snoopRec *)(cap->ring + pos);
+    rec->size = size;
+    rec->state = SNOOP_REC_BUSY;
+    clkgettime(&sec, &usec);
+    rec->hdr.sec = sec;
+    rec->hdr.usec = usec;
+    cap->head += skip + size;
+    cap->nbusy++;
+	EXIT_KERNEL_CRITICAL_SECTION();
+
+    /* Fill in the record and hand it to the reader */
+    rec->hdr.caplen = len;
+    rec->hdr.len = pkt->len;
+    memcpy(rec->data, pkt->curr, len);
+	ENTER_KERNEL_CRITICAL_SECTION();
+    rec->state = SNOOP_REC_READY;
+    cap->nbusy--;
+    nwait = cap->nwait;
+    cap->nwait = 0;
+	EXIT_KERNEL_CRITICAL_SECTION();
+    signal(cap->nready);
+    if (nwait > 0)
+    {
+        signaln(cap->filled, nwait);
     }
 
     return OK;
@@ -5,6 +5,7 @@
 
 #include <xinu.h>
 #include <CriticalSection.h>
+#include <memory.h>
 #include <network.h>
 #include <snoop.h>
 
@@ -17,7 +18,6 @@
  */
 int snoopClose(struct snoop *cap)
 {
-    struct packet *pkt;
     int i;
 
     /* Error check pointers */
@@ -37,20 +37,21 @@ int snoopClose(struct snoop *cap)
         }
     }
 #endif
-	EXIT_KERNEL_CRITICAL_SECTION();
 
-    /* Free queued packets */
-    while (mailboxCount(cap->queue) > 0)
+    /* Captures already under way still write into the ring */
+    while (cap->nbusy > 0)
     {
-        pkt = (struct packet *)mailboxReceive(cap->queue);
-        if (SYSERR == netFreebuf(pkt))
-        {
-            return SYSERR;
-        }
+        cap->nwait++;
+		EXIT_KERNEL_CRITICAL_SECTION();
+        wait(cap->filled);
+		ENTER_KERNEL_CRITICAL_SECTION();
     }
+	EXIT_KERNEL_CRITICAL_SECTION();
 
-    /* Free mailbox */
-    if (SYSERR == mailboxFree(cap->queue))
+    /* Free capture ring, along with any records still in it */
+    if ((SYSERR == memfree(cap->ring, cap->ringlen))
+        || (SYSERR == semfree(cap->nready))
+        || (SYSERR == semfree(cap->filled)))
     {
         return SYSERR;
     }
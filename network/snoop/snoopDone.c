@@ -0,0 +1,19 @@
+/* @file snoopDone.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <snoop.h>
+
+/**
+ * @ingroup snoop
+ *
+ * Returns the space held by a capture record to the capture ring.
+ * @param cap pointer to capture structure
+ * @param rec record most recently returned by snoopRead()
+ */
+void snoopDone(struct snoop *cap, struct snoopRec *rec)
+{
+    cap->tail += rec->size;
+}
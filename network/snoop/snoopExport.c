@@ -0,0 +1,69 @@
+/* @file snoopExport.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <device.h>
+#include <snoop.h>
+
+/**
+ * @ingroup snoop
+ *
+ * Streams captured packets to a device in libpcap format: a file header,
+ * then each record's header and octets in a single write.  Over an open
+ * UDP device every record is a datagram of its own, provided the snaplen
+ * is at most ::SNOOP_UDP_SNAPLEN; over TCP the stream is a pcap file.
+ * Records go straight from the capture ring, without being copied.
+ * @param cap pointer to open capture structure
+ * @param dev device to write to, open to the remote host
+ * @param count number of packets to export, 0 to export until killed
+ * @return OK once count packets are exported, SYSERR if a write fails
+ */
+int snoopExport(struct snoop *cap, int dev, unsigned int count)
+{
+    struct pcap_file_header fhdr;
+    struct snoopRec *rec;
+    unsigned int len;
+    bool forever = (0 == count);
+
+    /* Error check pointers */
+    if (NULL == cap)
+    {
+        return SYSERR;
+    }
+
+    fhdr.magic = PCAP_MAGIC;
+    fhdr.version_major = PCAP_VERSION_MAJOR;
+    fhdr.version_minor = PCAP_VERSION_MINOR;
+    fhdr.thiszone = 0;
+    fhdr.sigfigs = 0;
+    fhdr.snaplen = cap->caplen;
+    fhdr.linktype = SNOOP_LINKTYPE;
+    if (sizeof(fhdr) != write(dev, &fhdr, sizeof(fhdr)))
+    {
+        SNOOP_TRACE("Failed to export file header");
+        return SYSERR;
+    }
+
+    while (forever || (count > 0))
+    {
+        rec = snoopRead(cap);
+        if (SYSERR == (int)rec)
+        {
+            return SYSERR;
+        }
+        len = sizeof(struct pcap_pkthdr) + rec->hdr.caplen;
+        if (len != write(dev, &rec->hdr, len))
+        {
+            snoopDone(cap, rec);
+            SNOOP_TRACE("Failed to export record");
+            return SYSERR;
+        }
+        snoopDone(cap, rec);
+        cap->nprint++;
+        count--;
+    }
+
+    return OK;
+}
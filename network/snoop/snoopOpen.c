@@ -4,19 +4,31 @@
 /* Embedded Xinu, Copyright (C) 2009, 2018.  All rights reserved. */
 
 #include <xinu.h>
+#include <bpf.h>
 #include <device.h>
 #include <CriticalSection.h>
+#include <memory.h>
 #include <network.h>
 #include <snoop.h>
 
+/* Release the capture ring after a failed open */
+static void snoopRingFree(struct snoop *cap)
+{
+    memfree(cap->ring, cap->ringlen);
+    semfree(cap->nready);
+    semfree(cap->filled);
+}
+
 /**
  * @ingroup snoop
  *
- * Opens a capture from a network device.
+ * Opens a capture from a network device.  The capture ring is allocated
+ * here, ringlen octets or ::SNOOP_RINGLEN if ringlen is 0, rounded down to
+ * a power of 2.
  * @param cap pointer to capture structure
  * @param name of underlying device, ALL for all network devices
  * @return OK if open was successful, otherwise SYSERR
- * @pre-condition filter settings should already be setup in cap
+ * @pre-condition filter program, if any, should already be setup in cap
  */
 int snoopOpen(struct snoop *cap, char *devname)
 {
@@ -32,16 +44,55 @@ int snoopOpen(struct snoop *cap, char *devname)
 
     SNOOP_TRACE("Opening capture on %s", devname);
 
+    /* A filter program must be safe to run on any packet */
+    if ((NULL != cap->filter.bf_insns)
+        && (OK != bpfValidate(cap->filter.bf_insns, cap->filter.bf_len)))
+    {
+        SNOOP_TRACE("Invalid filter program");
+        return SYSERR;
+    }
+
     /* Reset statistics */
     cap->ncap = 0;
     cap->nmatch = 0;
     cap->novrn = 0;
 
-    /* Allocated mailbox for queue packets */
-    cap->queue = mailboxAlloc(SNOOP_QLEN);
-    if (SYSERR == (int)cap->queue)
+    /* Allocate the capture ring */
+    if (0 == cap->ringlen)
+    {
+        cap->ringlen = SNOOP_RINGLEN;
+    }
+    if (cap->ringlen > SNOOP_RINGMAX)
+    {
+        cap->ringlen = SNOOP_RINGMAX;
+    }
+    while (cap->ringlen & (cap->ringlen - 1))
+    {
+        cap->ringlen &= cap->ringlen - 1;
+    }
+    cap->head = 0;
+    cap->tail = 0;
+    cap->nbusy = 0;
+    cap->nwait = 0;
+    cap->ring = memget(cap->ringlen);
+    if (SYSERR == (int)cap->ring)
+    {
+        SNOOP_TRACE("Failed to allocate capture ring");
+        return SYSERR;
+    }
+    cap->nready = semcreate(0);
+    if (SYSERR == (int)cap->nready)
+    {
+        SNOOP_TRACE("Failed to allocate semaphore");
+        memfree(cap->ring, cap->ringlen);
+        return SYSERR;
+    }
+    cap->filled = semcreate(0);
+    if (SYSERR == (int)cap->filled)
     {
-        SNOOP_TRACE("Failed to allocate mailbox");
+        SNOOP_TRACE("Failed to allocate semaphore");
+        memfree(cap->ring, cap->ringlen);
+        semfree(cap->nready);
         return SYSERR;
     }
 
@@ -64,7 +115,7 @@ int snoopOpen(struct snoop *cap, char *devname)
         if (0 == count)
         {
             SNOOP_TRACE("Capture not attached to any interface");
-            mailboxFree(cap->queue);
+            snoopRingFree(cap);
             return SYSERR;
         }
         return OK;
@@ -75,7 +126,7 @@ int snoopOpen(struct snoop *cap, char *devname)
     if (SYSERR == devnum)
     {
         SNOOP_TRACE("Invalid device");
-        mailboxFree(cap->queue);
+        snoopRingFree(cap);
         return SYSERR;
     }
 	ENTER_KERNEL_CRITICAL_SECTION();
@@ -96,6 +147,6 @@ int snoopOpen(struct snoop *cap, char *devname)
     /* No network interface found */
 	EXIT_KERNEL_CRITICAL_SECTION();
     SNOOP_TRACE("No network interface found");
-    mailboxFree(cap->queue);
+    snoopRingFree(cap);
     return SYSERR;
 }
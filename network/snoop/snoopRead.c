@@ -4,29 +4,52 @@
 /* Embedded Xinu, Copyright (C) 2009, 2018.  All rights reserved. */
 
 #include <xinu.h>
+#include <CriticalSection.h>
 #include <snoop.h>
 
 /**
  * @ingroup snoop
  *
- * Returns a packet captured from a network interface.
- * @return a packet if read was successful, otherwise SYSERR
+ * Waits for the next packet captured from a network interface.  The
+ * record stays in the capture ring, and must be handed back with
+ * snoopDone() before the next one is read.
+ * @return the next capture record if read was successful, otherwise SYSERR
  */
-struct packet *snoopRead(struct snoop *cap)
+struct snoopRec *snoopRead(struct snoop *cap)
 {
-    struct packet *pkt;
+    struct snoopRec *rec;
 
     /* Error check pointers */
     if (NULL == cap)
     {
-        return (struct packet *)SYSERR;
+        return (struct snoopRec *)SYSERR;
     }
 
-    pkt = (struct packet *)mailboxReceive(cap->queue);
-    if ((SYSERR == (int)pkt) || (NULL == pkt))
+    if (SYSERR == wait(cap->nready))
     {
-        return (struct packet *)SYSERR;
+        return (struct snoopRec *)SYSERR;
     }
 
-    return pkt;
+    /* Step over padding at the end of the ring */
+    rec = (struct snoopRec *)(cap->ring + (cap->tail & (cap->ringlen - 1)));
+    while (SNOOP_REC_SKIP == rec->state)
+    {
+        cap->tail += rec->size;
+        rec = (struct snoopRec *)(cap->ring +
+                                  (cap->tail & (cap->ringlen - 1)));
+    }
+
+    /* A later record may have woken us while this one is still being
+     * filled by a capture that was preempted */
+	ENTER_KERNEL_CRITICAL_SECTION();
+    while (SNOOP_REC_BUSY == rec->state)
+    {
+        cap->nwait++;
+		EXIT_KERNEL_CRITICAL_SECTION();
+        wait(cap->filled);
+		ENTER_KERNEL_CRITICAL_SECTION();
+    }
+	EXIT_KERNEL_CRITICAL_SECTION();
+
+    return rec;
 }
@@ -36,6 +36,9 @@ const struct centry commandtab[] = {
     {"gpiostat", FALSE, xsh_gpiostat},
 #endif
     {"help", FALSE, xsh_help},
+#ifdef _XINU_PLATFORM_ARM_RPI_
+    {"irqstat", FALSE, xsh_irqstat},
+#endif
 #if defined(ETH0) || defined(_XINU_PLATFORM_ARM_RPI_)
     {"kexec", FALSE, xsh_kexec},
 #endif
@@ -0,0 +1,95 @@
+/**
+ * @file     xsh_irqstat.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+
+#ifdef _XINU_PLATFORM_ARM_RPI_
+
+#include <interrupt.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @ingroup shell
+ *
+ * Shell command (irqstat).  Shows how often each interrupt handler has run
+ * and how long it takes, to find the drivers that spend the most time with
+ * interrupts disabled.
+ * @param nargs  number of arguments in args array
+ * @param args   array of arguments
+ * @return OK for success, SYSERR otherwise
+ */
+shellcmd xsh_irqstat(int nargs, char *args[])
+{
+    struct irqstat stat;
+    interrupt_handler_t handler;
+    unsigned long batches, spurious;
+    irqmask im;
+    int irq;
+
+    /* Output help, if '--help' argument was supplied */
+    if (nargs == 2 && strcmp(args[1], "--help") == 0)
+    {
+        printf("Usage: %s [-c]\n\n", args[0]);
+        printf("Description:\n");
+        printf("\tDisplays the number of times each interrupt handler\n");
+        printf("\thas run, and the shortest, average and longest time\n");
+        printf("\tit took in CPU cycles.\n");
+        printf("Options:\n");
+        printf("\t-c\tclear the statistics\n");
+        printf("\t--help\tdisplay this help and exit\n");
+        return OK;
+    }
+
+    if (nargs == 2 && strcmp(args[1], "-c") == 0)
+    {
+        irqstatclear();
+        return OK;
+    }
+
+    /* Check for correct number of arguments */
+    if (nargs > 1)
+    {
+        fprintf(stderr, "%s: invalid arguments\n", args[0]);
+        fprintf(stderr, "Try '%s --help' for more information\n",
+                args[0]);
+        return SYSERR;
+    }
+
+    printf("IRQ %-10s %10s %10s %10s %10s\n",
+           "Handler", "Count", "Min", "Avg", "Max");
+    for (irq = 0; irq < NIRQ; irq++)
+    {
+        /* Copy the statistics as a whole, since they change under us.  */
+        im = disable();
+        handler = interruptVector[irq];
+        memcpy(&stat, &irqstats[irq], sizeof(stat));
+        restore(im);
+
+        if (NULL == handler && 0 == stat.count)
+        {
+            continue;
+        }
+        printf("%3d 0x%08X %10lu", irq, (unsigned int)handler, stat.count);
+        if (0 != stat.count)
+        {
+            printf(" %10u %10u %10u", stat.min,
+                   (unsigned int)(stat.cycles / stat.count), stat.max);
+        }
+        printf("\n");
+    }
+
+    im = disable();
+    batches = irqbatches;
+    spurious = irqspurious;
+    restore(im);
+    printf("%lu interrupts dispatched, %lu with nothing pending\n",
+           batches, spurious);
+
+    return OK;
+}
+
+#endif /* _XINU_PLATFORM_ARM_RPI_ */
@@ -10,6 +10,7 @@
 #include <mips.h>
 #include <memory.h>
 #include <safemem.h>
+#include <bufpool.h>
 #include <stdio.h>
 #include <string.h>
 #include <thread.h>
@@ -19,6 +20,7 @@
 #define PRINT_KERNEL  0x02
 #define PRINT_REGION  0x04
 #define PRINT_THREAD  0x08
+#define PRINT_POOL    0x10
 
 extern char *maxaddr;
 
@@ -26,16 +28,18 @@ static void printMemUsage(void);
 static void printRegAllocList(void);
 static void printRegFreeList(void);
 static void printFreeList(struct memblock *, char *);
+static void printPoolStats(void);
 
 static void usage(char *command)
 {
-    printf("Usage: %s [-r] [-k] [-q] [-t <TID>]\n\n", command);
+    printf("Usage: %s [-r] [-k] [-p] [-q] [-t <TID>]\n\n", command);
     printf("Description:\n");
     printf("\tDisplays the current memory usage and prints the\n");
     printf("\tfree list.\n");
     printf("Options:\n");
     printf("\t-r\t\tprint region allocated and free lists\n");
     printf("\t-k\t\tprint kernel free list\n");
+    printf("\t-p\t\tprint buffer pool statistics\n");
     printf("\t-q\t\tsuppress current system memory usage screen\n");
     printf("\t-t <TID>\tprint user free list of thread id tid\n");
     printf("\t--help\t\tdisplay this help and exit\n");
@@ -89,6 +93,10 @@ shellcmd xsh_memstat(int nargs, char *args[])
         {
             print |= PRINT_KERNEL;
         }
+        else if (0 == strcmp(args[i], "-p"))
+        {
+            print |= PRINT_POOL;
+        }
         else if (0 == strcmp(args[i], "-q"))
         {
             print &= ~(PRINT_DEFAULT);
@@ -111,6 +119,11 @@ shellcmd xsh_memstat(int nargs, char *args[])
         printFreeList(&memlist, "kernel");
     }
 
+    if (print & PRINT_POOL)
+    {
+        printPoolStats();
+    }
+
     if (print & PRINT_THREAD)
     {
         if (isbadtid(tid))
@@ -282,3 +295,29 @@ static void printFreeList(struct memblock *base, char *ident)
     }
     printf("\n");
 }
+
+/**
+ * Dump the allocation statistics of each buffer pool in use.
+ */
+static void printPoolStats(void)
+{
+    int id;
+    struct bfpentry *bfpptr;
+
+    printf("Buffer Pools:\n");
+    printf("ID  BUFSIZE  NBUF  USED  HIGH  ALLOCS      WAITS     FAILS   \n");
+    printf("--  -------  ----  ----  ----  ----------  --------  --------\n");
+    for (id = 0; id < NPOOL; id++)
+    {
+        bfpptr = &bfptab[id];
+        if (BFPFREE == bfpptr->state)
+        {
+            continue;
+        }
+        printf("%2d  %7u  %4u  %4u  %4u  %10u  %8u  %8u\n", id,
+               bfpptr->bufsize - sizeof(struct poolbuf), bfpptr->nbuf,
+               bfpptr->inuse, bfpptr->highwater, bfpptr->nalloc,
+               bfpptr->nwait, bfpptr->nfail);
+    }
+    printf("\n");
+}
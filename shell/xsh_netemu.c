@@ -5,8 +5,134 @@
 /* Embedded Xinu, Copyright (C) 2009, 2018.  All rights reserved. */
 
 #include <xinu.h>
+#include <CriticalSection.h>
+#include <device.h>
+#include <netemu.h>
+#include <network.h>
+#include <stdio.h>
 #include <stdlib.h>
-#include <date.h>
+#include <string.h>
+
+#if NETEMU
+static void usage(char *command)
+{
+    printf("Usage:\n");
+    printf("\t%s [--help]\n", command);
+    printf("\t%s [NETIF]\n", command);
+    printf("\t%s NETIF [in|out] off\n", command);
+    printf("\t%s NETIF [in|out] [loss P] [duplicate P] [corrupt P]\n",
+           command);
+    printf("\t      [reorder P] [delay MS [JITTER]] [rate KBIT [BURST]]\n");
+    printf("\t%s seed N\n", command);
+    printf("Description:\n");
+    printf("\tEmulates a wide area link on the packets a network\n");
+    printf("\tinterface receives, sends, or both.  With no settings,\n");
+    printf("\tshows the emulation on each interface.  New settings\n");
+    printf("\treplace all earlier ones for that direction.\n");
+    printf("Settings:\n");
+    printf("\tloss\tDrop P percent of packets.\n");
+    printf("\tduplicate\tSend P percent of packets twice.\n");
+    printf("\tcorrupt\tFlip a bit in P percent of packets.\n");
+    printf("\treorder\tSend P percent of packets without the delay,\n");
+    printf("\t\tahead of those waiting.\n");
+    printf("\tdelay\tHold packets back MS milliseconds, give or take\n");
+    printf("\t\tup to JITTER milliseconds.\n");
+    printf("\trate\tLimit packets to KBIT kbit/s, letting BURST bytes\n");
+    printf("\t\tthrough at once, %d by default.\n", NETEMU_BURST);
+    printf("\tseed\tSeed the random choices, to repeat a run.\n");
+    printf("\tP is a percentage with up to two decimal places.\n");
+}
+
+/* Parse a percentage into chances out of NETEMU_PROB, SYSERR if invalid */
+static int parseChance(char *str)
+{
+    int value = 0;
+    int scale = NETEMU_PROB / 100;
+    bool point = FALSE;
+
+    if ('\0' == *str)
+    {
+        return SYSERR;
+    }
+    for (; ('\0' != *str) && ('%' != *str); str++)
+    {
+        if (('.' == *str) && !point)
+        {
+            point = TRUE;
+            continue;
+        }
+        if ((*str < '0') || (*str > '9') || (point && (scale < 10)))
+        {
+            return SYSERR;
+        }
+        if (point)
+        {
+            scale /= 10;
+            value += (*str - '0') * scale;
+        }
+        else
+        {
+            value = value * 10 + (*str - '0') * scale;
+        }
+        if (value > NETEMU_PROB)
+        {
+            return SYSERR;
+        }
+    }
+    if (('%' == *str) && ('\0' != str[1]))
+    {
+        return SYSERR;
+    }
+    return value;
+}
+
+/* Parse a number, SYSERR if invalid */
+static int parseNumber(char *str)
+{
+    int value = 0;
+
+    if ('\0' == *str)
+    {
+        return SYSERR;
+    }
+    for (; '\0' != *str; str++)
+    {
+        if ((*str < '0') || (*str > '9') || (value > 100000000))
+        {
+            return SYSERR;
+        }
+        value = value * 10 + (*str - '0');
+    }
+    return value;
+}
+
+static void emuStat(struct netif *netptr, int dir)
+{
+    struct netemu *emu = netemuStage(netptr, dir);
+
+    printf("%s %s:", devtab[netptr->dev].name,
+           (NETEMU_IN == dir) ? "in" : "out");
+    if (!emu->active)
+    {
+        printf(" off\n");
+        return;
+    }
+    printf("\n\tloss %d.%02d%%  duplicate %d.%02d%%  corrupt %d.%02d%%"
+           "  reorder %d.%02d%%\n",
+           emu->loss / 100, emu->loss % 100,
+           emu->duplicate / 100, emu->duplicate % 100,
+           emu->corrupt / 100, emu->corrupt % 100,
+           emu->reorder / 100, emu->reorder % 100);
+    printf("\tdelay %d ms  jitter %d ms", emu->delay, emu->jitter);
+    if (0 != emu->rate)
+    {
+        printf("  rate %d kbit/s  burst %d bytes", emu->rate, emu->burst);
+    }
+    printf("\n\t%d in, %d lost, %d duplicated, %d corrupted, "
+           "%d reordered\n", emu->nin, emu->ndrop, emu->ndup,
+           emu->ncorrupt, emu->nreorder);
+    printf("\t%d over limit, %d waiting\n", emu->nlimit, emu->nqueue);
+}
 
 /**
  * @ingroup shell
@@ -18,7 +144,172 @@
  */
 shellcmd xsh_netemu(int nargs, char *args[])
 {
-    srand(getRdate("192.168.6.10"));
-    return 0;
+    struct netemu set;
+    struct netemu *emu;
+    struct netif *netptr = NULL;
+    int first = NETEMU_IN;
+    int last = NETEMU_OUT;
+    int a, i, dir, value;
+
+    /* Output help, if '--help' argument was supplied */
+    if (nargs == 2 && strcmp(args[1], "--help") == 0)
+    {
+        usage(args[0]);
+        return 0;
+    }
 
+    if ((3 == nargs) && (0 == strcmp(args[1], "seed")))
+    {
+        value = parseNumber(args[2]);
+        if (SYSERR == value)
+        {
+            fprintf(stderr, "Invalid seed '%s'\n", args[2]);
+            return 1;
+        }
+        srand(value);
+        return 0;
+    }
+
+    /* Show emulation on every interface, or the one named */
+    if (nargs > 1)
+    {
+        netptr = netLookup(getdev(args[1]));
+        if (NULL == netptr)
+        {
+            fprintf(stderr, "No network interface '%s'\n", args[1]);
+            return 1;
+        }
+    }
+    if (nargs <= 2)
+    {
+        for (i = 0; i < NNETIF; i++)
+        {
+            if ((NET_ALLOC == netiftab[i].state)
+                && ((NULL == netptr) || (&netiftab[i] == netptr)))
+            {
+                emuStat(&netiftab[i], NETEMU_IN);
+                emuStat(&netiftab[i], NETEMU_OUT);
+            }
+        }
+        return 0;
+    }
+
+    /* Parse direction and settings */
+    a = 2;
+    if (0 == strcmp(args[a], "in"))
+    {
+        last = NETEMU_IN;
+        a++;
+    }
+    else if (0 == strcmp(args[a], "out"))
+    {
+        first = NETEMU_OUT;
+        a++;
+    }
+    bzero(&set, sizeof(set));
+    set.burst = NETEMU_BURST;
+    if ((a + 1 == nargs) && (0 == strcmp(args[a], "off")))
+    {
+        a++;
+    }
+    for (; a < nargs; a++)
+    {
+        if (a + 1 >= nargs)
+        {
+            fprintf(stderr, "Missing value for '%s', try %s --help\n",
+                    args[a], args[0]);
+            return 1;
+        }
+        if ((0 == strcmp(args[a], "loss"))
+            || (0 == strcmp(args[a], "duplicate"))
+            || (0 == strcmp(args[a], "corrupt"))
+            || (0 == strcmp(args[a], "reorder")))
+        {
+            value = parseChance(args[a + 1]);
+            if (SYSERR == value)
+            {
+                fprintf(stderr, "Invalid percentage '%s'\n", args[a + 1]);
+                return 1;
+            }
+            switch (args[a][0])
+            {
+            case 'l':
+                set.loss = value;
+                break;
+            case 'd':
+                set.duplicate = value;
+                break;
+            case 'c':
+                set.corrupt = value;
+                break;
+            default:
+                set.reorder = value;
+                break;
+            }
+            a++;
+        }
+        else if (0 == strcmp(args[a], "delay"))
+        {
+            set.delay = parseNumber(args[++a]);
+            if ((a + 1 < nargs) && ('0' <= args[a + 1][0])
+                && ('9' >= args[a + 1][0]))
+            {
+                set.jitter = parseNumber(args[++a]);
+            }
+            if ((SYSERR == (int)set.delay) || (SYSERR == (int)set.jitter)
+                || (set.delay > NETEMU_MAXDELAY)
+                || (set.jitter > NETEMU_MAXDELAY))
+            {
+                fprintf(stderr, "Invalid delay\n");
+                return 1;
+            }
+        }
+        else if (0 == strcmp(args[a], "rate"))
+        {
+            set.rate = parseNumber(args[++a]);
+            if ((a + 1 < nargs) && ('0' <= args[a + 1][0])
+                && ('9' >= args[a + 1][0]))
+            {
+                set.burst = parseNumber(args[++a]);
+            }
+            if ((SYSERR == (int)set.rate) || (SYSERR == (int)set.burst)
+                || (set.rate > NETEMU_MAXRATE)
+                || (set.burst < netptr->linkhdrlen + netptr->mtu)
+                || (set.burst > NETEMU_MAXBURST))
+            {
+                fprintf(stderr, "Invalid rate or burst\n");
+                return 1;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Invalid setting '%s', try %s --help\n",
+                    args[a], args[0]);
+            return 1;
+        }
+    }
+    set.active = (set.loss || set.duplicate || set.corrupt || set.reorder
+                  || set.delay || set.jitter || set.rate);
+
+    /* Replace the settings, keeping the statistics */
+    for (dir = first; dir <= last; dir++)
+    {
+        emu = netemuStage(netptr, dir);
+        ENTER_KERNEL_CRITICAL_SECTION();
+        emu->loss = set.loss;
+        emu->duplicate = set.duplicate;
+        emu->corrupt = set.corrupt;
+        emu->reorder = set.reorder;
+        emu->delay = set.delay;
+        emu->jitter = set.jitter;
+        emu->rate = set.rate;
+        emu->burst = set.burst;
+        emu->tokens = set.burst * 8;
+        emu->tokstamp = emuNow();
+        emu->active = set.active;
+        EXIT_KERNEL_CRITICAL_SECTION();
+    }
+
+    return 0;
 }
+#endif /* NETEMU */
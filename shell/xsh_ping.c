@@ -25,8 +25,8 @@ static void echoQueueDealloc(int echoent);
 static struct packet *echoQueueGet(int echoent);
 static void echoPrintPkt(const struct packet *pkt, unsigned long elapsed);
 static unsigned long echoTripTime(const struct packet *pkt);
-static unsigned long tickDiff(unsigned long startsec, unsigned long startticks,
-                      unsigned long endsec, unsigned long endticks);
+static unsigned long usecDiff(unsigned long startsec, unsigned long startusec,
+                              unsigned long endsec, unsigned long endusec);
 
 /**
  * @ingroup shell
@@ -50,8 +50,8 @@ shellcmd xsh_ping(int nargs, char *args[])
     unsigned int num_recv = 0;
     int echoq;
     unsigned long min_rtt = ULONG_MAX, max_rtt = 0, total_rtt = 0;
-    unsigned long startsec, startticks;
-    unsigned long endsec, endticks;
+    unsigned long startsec, startusec;
+    unsigned long endsec, endusec;
     struct netaddr target;
     char target_str[50];
 
@@ -131,16 +131,13 @@ shellcmd xsh_ping(int nargs, char *args[])
         return SHELL_ERROR;
     }
 
-	ENTER_KERNEL_CRITICAL_SECTION();
-    startsec = clktime;
-    startticks = clkticks;
-	EXIT_KERNEL_CRITICAL_SECTION();
+    clkgettime(&startsec, &startusec);
 
     intervalticks = interval * CLKTICKS_PER_SEC / 1000;
 
     for (i = 0; i < count; i++)
     {
-        unsigned long sendsec, sendticks;
+        unsigned long sendsec, sendusec;
 
         // Send ping packet
         if (OK != icmpEchoRequest(&target, gettid(), i))
@@ -150,10 +147,7 @@ shellcmd xsh_ping(int nargs, char *args[])
             return SHELL_ERROR;
         }
 
-		ENTER_KERNEL_CRITICAL_SECTION();
-        sendsec = clktime;
-        sendticks = clkticks;
-		EXIT_KERNEL_CRITICAL_SECTION();
+        clkgettime(&sendsec, &sendusec);
 
         // Wait for response
         if (TIMEOUT != recvtime(intervalticks))
@@ -178,14 +172,11 @@ shellcmd xsh_ping(int nargs, char *args[])
             if (i < count - 1)
             {
                 unsigned long elapsedticks;
-                unsigned long recvsec, recvticks;
-
-				ENTER_KERNEL_CRITICAL_SECTION();
-                recvsec = clktime;
-                recvticks = clkticks;
-				EXIT_KERNEL_CRITICAL_SECTION();
+                unsigned long recvsec, recvusec;
 
-                elapsedticks = tickDiff(sendsec, sendticks, recvsec, recvticks);
+                clkgettime(&recvsec, &recvusec);
+                elapsedticks = usecDiff(sendsec, sendusec, recvsec, recvusec)
+                    / (1000000 / CLKTICKS_PER_SEC);
 
                 if (elapsedticks < intervalticks)
                 {
@@ -202,17 +193,13 @@ shellcmd xsh_ping(int nargs, char *args[])
         min_rtt = 0;
     }
 
-	ENTER_KERNEL_CRITICAL_SECTION();
-    endsec = clktime;
-    endticks = clkticks;
-	EXIT_KERNEL_CRITICAL_SECTION();
+    clkgettime(&endsec, &endusec);
 
     printf("--- %s ping statistics ---\n", target_str);
     printf("%u packets transmitted, %u received,", count, num_recv);
     printf(" %u%% packet loss,", (count - num_recv) * 100 / count);
     printf(" time %lums\n",
-           tickDiff(startsec, startticks,
-                    endsec, endticks) * 1000 / CLKTICKS_PER_SEC);
+           usecDiff(startsec, startusec, endsec, endusec) / 1000);
     printf("rtt min/avg/max = %lu.%03lu/", min_rtt / 1000, min_rtt % 1000);
     if (0 != num_recv)
     {
@@ -260,8 +247,11 @@ static void echoQueueDealloc(int echoent)
 
     eq = &echotab[echoent];
 
+    /* No reply is queued once the tid is cleared, so the held packets can
+     * be freed outside the kernel lock.  */
 	ENTER_KERNEL_CRITICAL_SECTION();
     eq->tid = BADTID;
+	EXIT_KERNEL_CRITICAL_SECTION();
     while (eq->tail != eq->head)
     {
         pkt = eq->pkts[eq->tail];
@@ -269,8 +259,6 @@ static void echoQueueDealloc(int echoent)
         netFreebuf(pkt);
         eq->tail = (eq->tail + 1) % NPINGHOLD;
     }
-
-	EXIT_KERNEL_CRITICAL_SECTION();
 }
 
 /* Fetch a packet from an ICMP Echo Reply queue.  Returns a pointer to the
@@ -327,54 +315,28 @@ static void echoPrintPkt(const struct packet *pkt, unsigned long elapsed)
  * Return the elapsed round trip time of an ICMP echo request and reply, in
  * microseconds.
  *
- * This relies on the timecyc, timetic, and timesec fields that were stored in
- * the echo request and echoed back, as well as the arrivcyc, arrivtic, and
- * arrivsec fields which were set by icmpRecv().
+ * This relies on the timesec and timeusec fields that were stored in the echo
+ * request and echoed back, as well as the arrivsec and arrivusec fields which
+ * were set by icmpRecv().
  */
 static unsigned long echoTripTime(const struct packet *pkt)
 {
     const struct icmpPkt *icmp;
     const struct icmpEcho *echo;
-    unsigned long cycPerTick;
-    unsigned long elapsedticks, elapsedcyc;
 
     icmp = (const struct icmpPkt *)pkt->curr;
     echo = (const struct icmpEcho *)icmp->data;
 
-    cycPerTick = platform.clkfreq / CLKTICKS_PER_SEC;
-
-    elapsedticks = tickDiff(net2hl(echo->timesec), net2hl(echo->timetic),
-                            echo->arrivsec, echo->arrivtic);
-
-    elapsedcyc = elapsedticks * cycPerTick;
-
-    elapsedcyc += (echo->arrivcyc - net2hl(echo->timecyc)) % cycPerTick;
-
-    return elapsedcyc / (platform.clkfreq / 1000000);
+    return (echo->arrivsec - net2hl(echo->timesec)) * 1000000
+        + echo->arrivusec - net2hl(echo->timeusec);
 }
 
-/* Returns the number of timer ticks that have elapsed between two times.
- *
- * NOTE: This function is needed because tick wraparound occurs before
- * wraparound in the underlying data type and therefore needs special handling.
- */
-static unsigned long tickDiff(unsigned long startsec, unsigned long startticks,
-                      unsigned long endsec, unsigned long endticks)
+/* Returns the number of microseconds that have elapsed between two times
+ * read with clkgettime().  */
+static unsigned long usecDiff(unsigned long startsec, unsigned long startusec,
+                              unsigned long endsec, unsigned long endusec)
 {
-    unsigned long elapsedticks;
-
-    elapsedticks = (endsec - startsec) * CLKTICKS_PER_SEC;
-
-    if (endticks >= startticks)
-    {
-        elapsedticks += (endticks - startticks);
-    }
-    else
-    {
-        elapsedticks -= (startticks - endticks);
-    }
-
-    return elapsedticks;
+    return (endsec - startsec) * 1000000 + endusec - startusec;
 }
 
 #endif /* NETHER */
@@ -25,7 +25,7 @@ shellcmd xsh_ps (int nargs, char *args[])
     /* readable names for PR* status in thread.h */
     static const char * const pstnams[] = {
         "curr ", "free ", "ready", "recv ",
-        "sleep", "susp ", "wait ", "rtim "
+        "sleep", "susp ", "wait ", "rtim ", "migr ", "dead "
     };
 
     /* Output help, if '--help' argument was supplied */
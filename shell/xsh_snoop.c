@@ -5,8 +5,11 @@
 /* Embedded Xinu, Copyright (C) 2009, 2018.  All rights reserved. */
 
 #include <xinu.h>
+#include <bpf.h>
 #include <conf.h>
+#include <device.h>
 #include <ipv4.h>
+#include <memory.h>
 #include <shell.h>
 #include <snoop.h>
 #include <stdio.h>
@@ -14,6 +17,9 @@
 #include <string.h>
 
 #if NETHER
+
+#define SNOOP_EXPRLEN 128       /* longest filter expression */
+
 static void usage(char *command)
 {
     printf("Usage:\n");
@@ -21,6 +27,7 @@ static void usage(char *command)
     printf("\t%s [-c COUNT] [-i NETIF] [-s CAPLEN]\n", command);
     printf("\t      [-d] [-dd] [-v] [-vv] [-t TYPE]\n");
     printf("\t      [-da ADDR] [-dp PORT] [-sa ADDR] [-sp PORT]\n");
+    printf("\t      [-w ADDR -wp PORT [-wt]] [EXPRESSION]\n");
     printf("Description:\n");
     printf
         ("\tSnoop prints out a description and contents of packets on\n");
@@ -28,7 +35,8 @@ static void usage(char *command)
         ("\ta network interface. By default it lists all all inbound\n");
     printf
         ("\tand outbound traffic on all active network interfaces.  It\n");
-    printf("\tcan also be used to read a PCAP trace file.\n");
+    printf("\tcan also be used to read a PCAP trace file.  Only packets\n");
+    printf("\tmatching EXPRESSION and every filter option are captured.\n");
     printf("Output Options:\n");
     printf("\t-d\tDump the packet in hex.\n");
     printf("\t-dd\tDump the packet in hex and ASCII.\n");
@@ -37,6 +45,11 @@ static void usage(char *command)
     printf("\t\theader in each packet.\n");
     printf("\t-vv\tPrint details on the link layer header and more\n");
     printf("\t\tdetails on the network and transport layer headers.\n");
+    printf("\t-w\tInstead of printing, stream the packets in pcap format\n");
+    printf("\t\tto ADDR, one UDP datagram per packet.  Snaplen is at\n");
+    printf("\t\tmost %d bytes over UDP.\n", (int)SNOOP_UDP_SNAPLEN);
+    printf("\t-wp\tStream to PORT on ADDR.\n");
+    printf("\t-wt\tStream over a TCP connection to ADDR instead.\n");
     printf("Capture Options:\n");
     printf("\t-c\tExit after capturing COUNT packets.\n");
     printf("\t-i\tCapture only from the network interface NETIF\n");
@@ -48,14 +61,16 @@ static void usage(char *command)
     printf("\t\tis ADDR.\n");
     printf
         ("\t-dp\tCapture only packets whose destination port is PORT.\n");
-    printf("\t\tThis is ignored if -t UDP or TCP is not specified.\n");
     printf("\t-sa\tCapture only packets whose source IPv4 address\n");
     printf("\t\tis ADDR.\n");
     printf("\t-sp\tCapture only packets whose source port is PORT.\n");
-    printf("\t\tThis is ignored if -t UDP or TCP is not specified.\n");
     printf
         ("\t-t\tCapture only packets of type TYPE.  Valid values for\n");
     printf("\t\ttype are: ARP, ICMP, IPv4, TCP, UDP.\n");
+    printf("Filter Expressions:\n");
+    printf("\tarp, ip, icmp, tcp, udp, proto N, [src|dst] host ADDR,\n");
+    printf("\t[src|dst] port N, greater N and less N, combined with\n");
+    printf("\tnot, and, or and parentheses, as for tcpdump.\n");
 }
 
 static void error(char *arg)
@@ -64,10 +79,10 @@ static void error(char *arg)
 }
 
 static thread snoop(struct snoop *cap, unsigned int count, char dump,
-                    char verbose)
+                    char verbose, struct packet *pkt)
 {
     bool forever = FALSE;
-    struct packet *pkt = NULL;
+    struct snoopRec *rec = NULL;
     if (0 == count)
     {
         forever = TRUE;
@@ -75,20 +90,237 @@ static thread snoop(struct snoop *cap, unsigned int count, char dump,
 
     while (forever || count > 0)
     {
-        pkt = snoopRead(cap);
-        if ((SYSERR == (int)pkt) || (NULL == pkt))
+        rec = snoopRead(cap);
+        if (SYSERR == (int)rec)
         {
             continue;
         }
+        memcpy(pkt->data, rec->data, rec->hdr.caplen);
+        pkt->len = rec->hdr.caplen;
+        pkt->curr = pkt->data;
+        snoopDone(cap, rec);
         cap->nprint++;
         snoopPrint(pkt, dump, verbose);
-        netFreebuf(pkt);
         count--;
     }
 
     return OK;
 }
 
+/* Open a UDP or TCP device to the host captured packets are streamed to */
+static int exportOpen(char *devname, struct netaddr *dst,
+                      unsigned short port, bool tcp)
+{
+    struct netif *netptr = NULL;
+    unsigned short dev = SYSERR;
+    int i;
+
+    /* Send from the interface being captured, or the first one up */
+    if (0 != strcmp(devname, "ALL"))
+    {
+        netptr = netLookup(getdev(devname));
+    }
+#if NNETIF
+    for (i = 0; (NULL == netptr) && (i < NNETIF); i++)
+    {
+        if (NET_ALLOC == netiftab[i].state)
+        {
+            netptr = &netiftab[i];
+        }
+    }
+#endif
+    if (NULL == netptr)
+    {
+        return SYSERR;
+    }
+
+    if (tcp)
+    {
+#if NTCP
+        dev = tcpAlloc();
+        if ((unsigned short)SYSERR == dev)
+        {
+            return SYSERR;
+        }
+        if (SYSERR == open(dev, &netptr->ip, dst, NULL, port, TCP_ACTIVE))
+        {
+            close(dev);
+            return SYSERR;
+        }
+#endif
+    }
+    else
+    {
+#if NUDP
+        dev = udpAlloc();
+        if (((unsigned short)SYSERR == dev)
+            || (SYSERR == open(dev, &netptr->ip, dst, NULL, port)))
+        {
+            return SYSERR;
+        }
+#endif
+    }
+    return ((unsigned short)SYSERR == dev) ? SYSERR : dev;
+}
+
+/* Add a primitive to a filter expression, FALSE if it does not fit */
+static bool exprAnd(char *expr, const char *primitive)
+{
+    unsigned int len = strlen(expr);
+
+    if (len + strlen(primitive) + 5 >= SNOOP_EXPRLEN)
+    {
+        return FALSE;
+    }
+    if (len > 0)
+    {
+        len += strlcpy(expr + len, " and ", SNOOP_EXPRLEN - len);
+    }
+    strlcpy(expr + len, primitive, SNOOP_EXPRLEN - len);
+    return TRUE;
+}
+
+/* Compile the filter options and expression into the capture's program */
+static int filterCompile(struct snoop *cap, char *type, char *srcaddr,
+                         unsigned short srcport, char *dstaddr,
+                         unsigned short dstport, int nargs, char *args[])
+{
+    char expr[SNOOP_EXPRLEN];
+    char primitive[SNOOP_EXPRLEN];
+    struct netaddr addr;
+    bool fits = TRUE;
+    int len, a;
+
+    expr[0] = '\0';
+    if (NULL != type)
+    {
+        if (0 == strcmp(type, "ARP"))
+        {
+            fits = exprAnd(expr, "arp");
+        }
+        else if (0 == strcmp(type, "IPv4"))
+        {
+            fits = exprAnd(expr, "ip");
+        }
+        else if (0 == strcmp(type, "UDP"))
+        {
+            fits = exprAnd(expr, "udp");
+        }
+        else if (0 == strcmp(type, "TCP"))
+        {
+            fits = exprAnd(expr, "tcp");
+        }
+        else if (0 == strcmp(type, "ICMP"))
+        {
+            fits = exprAnd(expr, "icmp");
+        }
+        else
+        {
+            fprintf(stderr, "Invalid type '%s', try usage --help\n",
+                    type);
+            return SYSERR;
+        }
+    }
+    if (NULL != srcaddr)
+    {
+        if (SYSERR == dot2ipv4(srcaddr, &addr))
+        {
+            error(srcaddr);
+            return SYSERR;
+        }
+        sprintf(primitive, "src host %d.%d.%d.%d", addr.addr[0],
+                addr.addr[1], addr.addr[2], addr.addr[3]);
+        fits = fits && exprAnd(expr, primitive);
+    }
+    if (0 != srcport)
+    {
+        sprintf(primitive, "src port %d", srcport);
+        fits = fits && exprAnd(expr, primitive);
+    }
+    if (NULL != dstaddr)
+    {
+        if (SYSERR == dot2ipv4(dstaddr, &addr))
+        {
+            error(dstaddr);
+            return SYSERR;
+        }
+        sprintf(primitive, "dst host %d.%d.%d.%d", addr.addr[0],
+                addr.addr[1], addr.addr[2], addr.addr[3]);
+        fits = fits && exprAnd(expr, primitive);
+    }
+    if (0 != dstport)
+    {
+        sprintf(primitive, "dst port %d", dstport);
+        fits = fits && exprAnd(expr, primitive);
+    }
+
+    /* Whatever follows the options is an expression of its own */
+    if (nargs > 0)
+    {
+        len = strlcpy(primitive, "(", SNOOP_EXPRLEN);
+        for (a = 0; fits && (a < nargs); a++)
+        {
+            fits = (len + strlen(args[a]) + 1 < SNOOP_EXPRLEN);
+            if (fits)
+            {
+                len += strlcpy(primitive + len, args[a],
+                               SNOOP_EXPRLEN - len);
+                len += strlcpy(primitive + len, (a + 1 < nargs) ? " " : ")",
+                               SNOOP_EXPRLEN - len);
+            }
+        }
+        fits = fits && exprAnd(expr, primitive);
+    }
+    if (!fits)
+    {
+        fprintf(stderr, "Filter expression too long\n");
+        return SYSERR;
+    }
+
+    if ('\0' == expr[0])
+    {
+        return OK;
+    }
+    cap->filter.bf_insns = memget(BPF_MAXINSNS * sizeof(struct bpf_insn));
+    if (SYSERR == (int)cap->filter.bf_insns)
+    {
+        cap->filter.bf_insns = NULL;
+        fprintf(stderr, "Failed to allocate filter\n");
+        return SYSERR;
+    }
+    len = bpfCompile(expr, ETH_HDR_LEN, cap->caplen, cap->filter.bf_insns,
+                     BPF_MAXINSNS);
+    if (SYSERR == len)
+    {
+        memfree(cap->filter.bf_insns,
+                BPF_MAXINSNS * sizeof(struct bpf_insn));
+        cap->filter.bf_insns = NULL;
+        fprintf(stderr, "Invalid filter expression '%s'\n", expr);
+        return SYSERR;
+    }
+    cap->filter.bf_len = len;
+    return OK;
+}
+
+/* Release whichever of export device, print buffer and filter program
+ * was in use */
+static void release(struct snoop *cap, int expdev, struct packet *pkt)
+{
+    if (SYSERR != expdev)
+    {
+        close(expdev);
+    }
+    if (NULL != pkt)
+    {
+        netFreebuf(pkt);
+    }
+    if (NULL != cap->filter.bf_insns)
+    {
+        memfree(cap->filter.bf_insns,
+                BPF_MAXINSNS * sizeof(struct bpf_insn));
+    }
+}
+
 /**
  * @ingroup shell
  *
@@ -109,7 +341,12 @@ shellcmd xsh_snoop(int nargs, char *args[])
     unsigned short dstport = 0;
     char *srcaddr = NULL;
     unsigned short srcport = 0;
+    char *expaddr = NULL;
+    unsigned short expport = 0;
+    bool exptcp = FALSE;
+    int expdev = SYSERR;
     struct snoop cap;
+    struct packet *pkt = NULL;
     char devname[DEVMAXNAME];
     tid_typ tid;
 
@@ -125,10 +362,10 @@ shellcmd xsh_snoop(int nargs, char *args[])
     /* Parse arguments */
     for (a = 1; a < nargs; a++)
     {
+        /* The filter expression follows the options */
         if (args[a][0] != '-')
         {
-            error(args[a]);
-            return 1;
+            break;
         }
 
         switch (args[a][1])
@@ -235,9 +472,43 @@ shellcmd xsh_snoop(int nargs, char *args[])
             if (a >= nargs)
             {
                 error(args[a - 1]);
+                return 1;
             }
             type = args[a];
             break;
+            /* Export address OR Export port OR Export over TCP */
+        case 'w':
+            switch (args[a][2])
+            {
+                /* Export port */
+            case 'p':
+                a++;
+                if (a >= nargs)
+                {
+                    error(args[a - 1]);
+                    return 1;
+                }
+                expport = atoi(args[a]);
+                break;
+                /* Export over TCP */
+            case 't':
+                exptcp = TRUE;
+                break;
+                /* Export address */
+            case '\0':
+                a++;
+                if (a >= nargs)
+                {
+                    error(args[a - 1]);
+                    return 1;
+                }
+                expaddr = args[a];
+                break;
+            default:
+                error(args[a]);
+                return 1;
+            }
+            break;
             /* Output verbose */
         case 'v':
             if (args[a][2] == 'v')
@@ -255,76 +526,82 @@ shellcmd xsh_snoop(int nargs, char *args[])
         }
     }
 
-    /* Set filter */
     cap.caplen = caplen;
     cap.promisc = FALSE;
     cap.nprint = 0;
-    if (NULL == type)
+    cap.filter.bf_len = 0;
+    cap.filter.bf_insns = NULL;
+    cap.ringlen = 0;
+
+    /* Set filter */
+    if (SYSERR == filterCompile(&cap, type, srcaddr, srcport, dstaddr,
+                                dstport, nargs - a, &args[a]))
     {
-        cap.type = SNOOP_FILTER_ALL;
+        return 1;
     }
-    else
+
+    /* Connect to the host packets are streamed to, keeping its traffic
+     * out of the capture and each UDP record in one datagram */
+    cap.expaddr.type = NULL;
+    cap.expport = 0;
+    if (NULL != expaddr)
     {
-        if (0 == strcmp(type, "ARP"))
-        {
-            cap.type = SNOOP_FILTER_ARP;
-        }
-        else if (0 == strcmp(type, "IPv4"))
-        {
-            cap.type = SNOOP_FILTER_IPv4;
-        }
-        else if (0 == strcmp(type, "UDP"))
-        {
-            cap.type = SNOOP_FILTER_UDP;
-        }
-        else if (0 == strcmp(type, "TCP"))
+        if ((0 == expport) || (SYSERR == dot2ipv4(expaddr, &cap.expaddr)))
         {
-            cap.type = SNOOP_FILTER_TCP;
+            fprintf(stderr, "Invalid export address or port\n");
+            release(&cap, SYSERR, NULL);
+            return 1;
         }
-        else if (0 == strcmp(type, "ICMP"))
+        cap.expport = expport;
+        if (!exptcp && (cap.caplen > SNOOP_UDP_SNAPLEN))
         {
-            cap.type = SNOOP_FILTER_ICMP;
+            cap.caplen = SNOOP_UDP_SNAPLEN;
         }
-        else
+        expdev = exportOpen(devname, &cap.expaddr, expport, exptcp);
+        if (SYSERR == expdev)
         {
-            fprintf(stderr, "Invalid type '%s', try usage --help\n",
-                    type);
+            fprintf(stderr, "Failed to connect to %s port %d\n", expaddr,
+                    expport);
+            release(&cap, SYSERR, NULL);
             return 1;
         }
     }
-    if (NULL == srcaddr)
-    {
-        cap.srcaddr.type = NULL;
-    }
-    else
-    {
-        dot2ipv4(srcaddr, &cap.srcaddr);
-    }
-    cap.srcport = srcport;
-    if (NULL == dstaddr)
-    {
-        cap.dstaddr.type = NULL;
-    }
     else
     {
-        dot2ipv4(dstaddr, &cap.dstaddr);
+        /* One buffer to print from, whatever the traffic */
+        pkt = netGetbuf();
+        if (SYSERR == (int)pkt)
+        {
+            fprintf(stderr, "Failed to get buffer\n");
+            release(&cap, SYSERR, NULL);
+            return 1;
+        }
     }
-    cap.dstport = dstport;
 
     /* Open snoop */
     if (SYSERR == snoopOpen(&cap, devname))
     {
         fprintf(stderr, "Failed to open capture on network device '%s'\n",
                 devname);
+        release(&cap, expdev, pkt);
         return 1;
     }
 
     /* Spawn output thread */
-    tid = create((void *)snoop, SHELL_CMDSTK, SHELL_CMDPRIO, "snoop",
-                 4, &cap, count, dump, verbose);
+    if (SYSERR != expdev)
+    {
+        tid = create((void *)snoopExport, SHELL_CMDSTK, SHELL_CMDPRIO,
+                     "snoop", 3, &cap, expdev, count);
+    }
+    else
+    {
+        tid = create((void *)snoop, SHELL_CMDSTK, SHELL_CMDPRIO, "snoop",
+                     5, &cap, count, dump, verbose, pkt);
+    }
     if (SYSERR == tid)
     {
         snoopClose(&cap);
+        release(&cap, expdev, pkt);
         fprintf(stderr, "Failed to start capture\n");
         return 1;
     }
@@ -356,15 +633,18 @@ shellcmd xsh_snoop(int nargs, char *args[])
     /* Print out statistics */
     printf("%d packets captured\n", cap.ncap);
     printf("%d packets matched filter\n", cap.nmatch);
-    printf("%d packets printed\n", cap.nprint);
+    printf("%d packets %s\n", cap.nprint,
+           (SYSERR == expdev) ? "printed" : "exported");
     printf("%d packets overrun\n", cap.novrn);
 
     /* Close interface */
     if (SYSERR == snoopClose(&cap))
     {
+        release(&cap, expdev, pkt);
         fprintf(stderr, "Failed to stop capture\n");
         return 1;
     }
+    release(&cap, expdev, pkt);
 
     return 0;
 
@@ -112,23 +112,25 @@ shellcmd xsh_voip(int nargs, char *args[])
             }
             else if (strcmp(args[i], "-t") == 0)
             {
-				ENTER_KERNEL_CRITICAL_SECTION();
-                /* Scan threadtab for voip process */
+                /* Scan threadtab for voip process; each entry is checked
+                 * under the kernel lock, but the thread is signalled
+                 * outside it */
                 for (i = 0; i < NTHREAD; i++)
                 {
+                    bool found;
+
                     thrptr = &thrtab[i];
 
-                    if (THRFREE == thrptr->state)
-                    {
-                        continue;
-                    }
-                    if (strcmp(thrptr->name, T_NAME_SEND) == 0)
+                    ENTER_KERNEL_CRITICAL_SECTION();
+                    found = (THRFREE != thrptr->state) &&
+                        (strcmp(thrptr->name, T_NAME_SEND) == 0);
+                    EXIT_KERNEL_CRITICAL_SECTION();
+                    if (found)
                     {
                         printf("Signaling voip thread at tid %d.\n", i);
                         send(i, TOG_SAMP);
                     }
                 }
-				EXIT_KERNEL_CRITICAL_SECTION();
                 return OK;
             }
             else if (strcmp(args[i], "-p") == 0)
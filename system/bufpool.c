@@ -60,6 +60,11 @@ int bfpalloc (unsigned int bufsize, unsigned int nbuf)
 	EXIT_KERNEL_CRITICAL_SECTION();									// Ok to allow scheduler to operate
 
     bfpptr->nbuf = nbuf;											// Hold number of buffers
+    bfpptr->nalloc = 0;												// Clear the pool statistics
+    bfpptr->nwait = 0;
+    bfpptr->nfail = 0;
+    bfpptr->inuse = 0;
+    bfpptr->highwater = 0;
     bfpptr->bufsize = bufsize;										// Hold total size requested
     bufptr = (struct poolbuf *)memget(nbuf * bufsize);				// Allocate buffer as one big block
     if ((void *)SYSERR == bufptr)									// If allocate failed
@@ -123,6 +128,27 @@ xinu_syscall bfpfree (int poolid)
 }
 
 
+/**
+ * Take the first buffer off a pool's free list and account for it.  The
+ * caller holds the kernel critical section and has already claimed a count
+ * on the pool's semaphore.
+ */
+static void *bufpop (struct bfpentry *bfpptr)
+{
+	struct poolbuf *bufptr;
+
+	bufptr = bfpptr->next;											// Get pointer to current next pointers next
+	bfpptr->next = bufptr->next;									// Advance the pool next pointer
+	bufptr->next = bufptr;											// Buf ptr next points back to itself
+	bfpptr->nalloc++;												// Tally the allocation
+	if (++bfpptr->inuse > bfpptr->highwater)						// Track the most buffers ever out at once
+	{
+		bfpptr->highwater = bfpptr->inuse;
+	}
+	return (void *)(bufptr + 1);									// +1 to skip past accounting structure .. ptr arithmetic
+}
+
+
 /**
  * @ingroup memory_mgmt
  *
@@ -131,6 +157,9 @@ xinu_syscall bfpfree (int poolid)
  * returned buffer must be freed with buffree() when the calling code is
  * finished with it.
  *
+ * While the pool has free buffers the buffer is taken within a single
+ * critical section and the semaphore is only consulted, never waited on.
+ *
  * @param poolid
  *      Identifier of the buffer pool, as returned by bfpalloc().
  *
@@ -141,7 +170,8 @@ xinu_syscall bfpfree (int poolid)
 void *bufget (int poolid)
 {
 	struct bfpentry *bfpptr;
-	struct poolbuf *bufptr;
+	struct sement *semptr;
+	void *buffer;
 
 	ENTER_KERNEL_CRITICAL_SECTION();								// Disable scheduler we are playing with buffer table entries
 	if (isbadpool(poolid))											// Check pool id is valid
@@ -150,21 +180,70 @@ void *bufget (int poolid)
 		return (void *)SYSERR;										// Bad pool id so return system error
 	}
 	bfpptr = &bfptab[poolid];										// Fetch the pool buffer pointer from pool id
+	semptr = &semtab[bfpptr->freebuf];								// Fetch the free buffer semaphore
+	if (semptr->count > 0)											// Fast path .. a buffer is free and nobody waits
+	{
+		semptr->count--;											// Claim it exactly as wait() would
+		buffer = bufpop(bfpptr);
+		EXIT_KERNEL_CRITICAL_SECTION();								// Linking all done so enable scheduler again
+		return buffer;
+	}
+	bfpptr->nwait++;												// Tally that this request must block
 	EXIT_KERNEL_CRITICAL_SECTION();									// All clear so so enable scheduler again we may need to wait
 	wait(bfpptr->freebuf);											// Wait for a free buffer
-	ENTER_KERNEL_CRITICAL_SECTION();								// Disable scheduler while we fix linking	
-	bufptr = bfpptr->next;											// Get pointer to current next pointers next											
-	bfpptr->next = bufptr->next;									// Advance the pool next pointer
-	bufptr->next = bufptr;											// Buf ptr next points back to itself
+	ENTER_KERNEL_CRITICAL_SECTION();								// Disable scheduler while we fix linking
+	buffer = bufpop(bfpptr);
 	EXIT_KERNEL_CRITICAL_SECTION();									// Linking all done so enable scheduler again
-	return (void *)(bufptr + 1);									// +1 to skip past accounting structure .. ptr arithmetic
+	return buffer;
+}
+
+
+/**
+ * @ingroup memory_mgmt
+ *
+ * Allocate a buffer from a buffer pool without blocking.  Suitable for
+ * interrupt handlers, which must not wait for another thread to return a
+ * buffer.
+ *
+ * @param poolid
+ *      Identifier of the buffer pool, as returned by bfpalloc().
+ *
+ * @return
+ *      Pointer to the buffer, or ::SYSERR if @p poolid does not specify a
+ *      valid buffer pool or the pool has no free buffer.
+ */
+void *bufget_nowait (int poolid)
+{
+	struct bfpentry *bfpptr;
+	struct sement *semptr;
+	void *buffer;
+
+	ENTER_KERNEL_CRITICAL_SECTION();								// Disable scheduler we are playing with buffer table entries
+	if (isbadpool(poolid))											// Check pool id is valid
+	{
+		EXIT_KERNEL_CRITICAL_SECTION();								// We are going to exit so enable scheduler again
+		return (void *)SYSERR;										// Bad pool id so return system error
+	}
+	bfpptr = &bfptab[poolid];										// Fetch the pool buffer pointer from pool id
+	semptr = &semtab[bfpptr->freebuf];								// Fetch the free buffer semaphore
+	if (semptr->count <= 0)											// Pool is empty
+	{
+		bfpptr->nfail++;											// Tally the failure
+		EXIT_KERNEL_CRITICAL_SECTION();								// We are going to exit so enable scheduler again
+		return (void *)SYSERR;										// No buffer so return system error
+	}
+	semptr->count--;												// Claim it exactly as wait() would
+	buffer = bufpop(bfpptr);
+	EXIT_KERNEL_CRITICAL_SECTION();									// Linking all done so enable scheduler again
+	return buffer;
 }
 
 
 /**
  * @ingroup memory_mgmt
  *
- * Return a buffer to its buffer pool.
+ * Return a buffer to its buffer pool.  Only when a thread is waiting for a
+ * buffer is the semaphore signalled, which may reschedule.
  *
  * @param buffer
  *      Address of buffer to free, as returned by bufget().
@@ -178,6 +257,7 @@ xinu_syscall buffree (void *buffer)
 {
 	struct bfpentry *bfpptr;
 	struct poolbuf *bufptr;
+	struct sement *semptr;
 
 	bufptr = ((struct poolbuf *)buffer) - 1;						// -1 to skip back accounting structure .. ptr arithmetic
 	ENTER_KERNEL_CRITICAL_SECTION();								// Disable scheduler we are playing with buffer table entries
@@ -189,7 +269,15 @@ xinu_syscall buffree (void *buffer)
 	bfpptr = &bfptab[bufptr->poolid];								// Fetch the pool buffer pointer from pool id
 	bufptr->next = bfpptr->next;									// Set the next pointer on this buffer
 	bfpptr->next = bufptr;											// Set the pool next pointer to this entry
+	bfpptr->inuse--;												// One less buffer out
+	semptr = &semtab[bfpptr->freebuf];								// Fetch the free buffer semaphore
+	if (semptr->count >= 0)											// Fast path .. nobody is waiting
+	{
+		semptr->count++;											// Release it exactly as signal() would
+		EXIT_KERNEL_CRITICAL_SECTION();								// All clear so so enable scheduler again
+		return OK;
+	}
 	EXIT_KERNEL_CRITICAL_SECTION();									// All clear so so enable scheduler again
-	signaln(bfpptr->freebuf, 1);									// Signal to any thread waiting for a free buffer
+	signal(bfpptr->freebuf);										// Wake the thread waiting for a free buffer
 	return OK;														// Return OK
 }
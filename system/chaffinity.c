@@ -0,0 +1,68 @@
+/**
+ * @file chaffinity.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <thread.h>
+#include <queue.h>
+#include <CriticalSection.h>
+
+/**
+ * @ingroup threads
+ *
+ * Pin a thread to a core, or let it run on any core.  A ready thread moves
+ * to its new core's ready list at once.  A running thread on the wrong core
+ * is marked ::THRMIGRATE and moves when that core next reschedules, which
+ * is immediately if it is the calling thread.
+ * @param tid target thread
+ * @param core core to pin the thread to, or ::THRNOAFFINITY
+ * @return OK on success, SYSERR if @p tid or @p core is invalid
+ */
+xinu_syscall chaffinity(tid_typ tid, int core)
+{
+    register struct thrent *thrptr;     /* thread control block */
+    unsigned int running;               /* core the thread last ran on */
+
+    if ((THRNOAFFINITY != core) && ((core < 0) || (core >= NCORE)))
+    {
+        return SYSERR;
+    }
+
+	ENTER_KERNEL_CRITICAL_SECTION();
+    if (isbadtid(tid) || (NULLTHREAD == tid))
+    {
+		EXIT_KERNEL_CRITICAL_SECTION();
+        return SYSERR;
+    }
+    thrptr = &thrtab[tid];
+    running = thrptr->coreid;
+    thrptr->coreaffinity = (THRNOAFFINITY != core);
+    if (thrptr->coreaffinity)
+    {
+        thrptr->coreid = core;
+    }
+
+    if (THRREADY == thrptr->state)
+    {
+        getitem(tid);
+        insert(tid, readylist, thrptr->prio);
+    }
+    else if ((THRCURR == thrptr->state) && thrptr->coreaffinity &&
+             (running != (unsigned int)core))
+    {
+        thrptr->state = THRMIGRATE;
+        if (tid == thrcurrent)
+        {
+			EXIT_KERNEL_CRITICAL_SECTION();
+            resched();
+            return OK;
+        }
+#if NCORE > 1
+        coresignal(running);
+#endif
+    }
+	EXIT_KERNEL_CRITICAL_SECTION();
+    return OK;
+}
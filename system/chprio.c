@@ -6,30 +6,39 @@
 
 #include <xinu.h>
 #include <thread.h>
+#include <queue.h>
+#include <CriticalSection.h>
 
 /**
  * @ingroup threads
  *
- * Change the scheduling priority of a thread
+ * Change the scheduling priority of a thread.  A ready thread is moved to
+ * the ready list level of its new priority, which may also move it to a
+ * less busy core.
  * @param tid target thread
- * @param newprio new priority
- * @return old priority of thread
+ * @param newprio new priority, from 0 to NPRIO-1
+ * @return old priority of thread, or SYSERR if the thread or priority is
+ *         invalid
  */
 xinu_syscall chprio(tid_typ tid, int newprio)
 {
     register struct thrent *thrptr;     /* thread control block */
-    irqmask im;
     int oldprio;
 
-    im = disable();
-    if (isbadtid(tid))
+	ENTER_KERNEL_CRITICAL_SECTION();
+    if (isbadtid(tid) || isbadprio(newprio))
     {
-        restore(im);
+		EXIT_KERNEL_CRITICAL_SECTION();
         return SYSERR;
     }
     thrptr = &thrtab[tid];
     oldprio = thrptr->prio;
     thrptr->prio = newprio;
-    restore(im);
+    if (THRREADY == thrptr->state)
+    {
+        getitem(tid);
+        insert(tid, readylist, newprio);
+    }
+	EXIT_KERNEL_CRITICAL_SECTION();
     return oldprio;
 }
@@ -4,16 +4,99 @@
 /* Embedded Xinu, Copyright (C) 2009, 2013.  All rights reserved. */
 
 #include <stddef.h>
+#include <interrupt.h>
 #include <queue.h>
 #include <clock.h>
 #include <thread.h>
 #include <platform.h>
+#include <CriticalSection.h>
 
 #if RTCLOCK
 
 void wakeup(void);
 int resched(void);
 
+#if TICKLESS
+/** clkcount() value of the last tick boundary accounted for */
+unsigned long clklast;
+
+/**
+ * @ingroup timer
+ *
+ * Bring ::clkticks, ::clktime and the keys of ::sleepq up to date with
+ * the free-running counter.  With the timer left unarmed while idle they
+ * stop at the last interrupt, so this is done before anything is timed
+ * from them.  Must be called with interrupts disabled.
+ */
+void clkcatchup(void)
+{
+    unsigned long cycles = platform.clkfreq / CLKTICKS_PER_SEC;
+    unsigned long ticks;
+    tid_typ next;
+
+    ticks = (clkcount() - clklast) / cycles;
+    if (0 == ticks)
+    {
+        return;
+    }
+    clklast += ticks * cycles;
+
+    clkticks += ticks;
+    while (clkticks >= CLKTICKS_PER_SEC)
+    {
+        clktime++;
+        clkticks -= CLKTICKS_PER_SEC;
+    }
+
+    /* Charge elapsed ticks down the delta list; entries that reach  */
+    /* zero pass the remainder on to the ones behind them.           */
+    next = firstid(sleepq);
+    while ((ticks > 0) && (next < NTHREAD))
+    {
+        if (quetab[next].key > (int)ticks)
+        {
+            quetab[next].key -= ticks;
+            break;
+        }
+        ticks -= quetab[next].key;
+        quetab[next].key = 0;
+        next = quetab[next].next;
+    }
+}
+
+/**
+ * @ingroup timer
+ *
+ * Program the one-shot timer for the next event the scheduler needs:
+ * the head of ::sleepq, or the end of the current quantum if a thread
+ * of equal priority is waiting to run, whichever comes first.  When
+ * neither is pending the timer is left for ::CLK_MAXIDLE ticks.
+ * Called by resched() with interrupts disabled.
+ */
+void clkrearm(void)
+{
+    int ticks = CLK_MAXIDLE;
+    int top = rdqtop(0);
+
+    clkcatchup();
+    /* The system timer only preempts core 0; other cores tick locally. */
+#if NCORE > 1
+    if ((EMPTY != top) && (top >= thrtab[corecurrent[0]].prio))
+#else
+    if ((EMPTY != top) && (top >= thrtab[thrcurrent].prio))
+#endif
+    {
+        ticks = 1;
+    }
+    else if (nonempty(sleepq) && (firstkey(sleepq) < ticks))
+    {
+        ticks = (firstkey(sleepq) > 0) ? firstkey(sleepq) : 1;
+    }
+
+    clkalarm(clklast + ticks * (platform.clkfreq / CLKTICKS_PER_SEC));
+}
+#endif /* TICKLESS */
+
 /**
  * @ingroup timer
  *
@@ -21,9 +104,16 @@ int resched(void);
  * timer interrupt to occur at some point in the future, then updates ::clktime
  * and ::clkticks, then wakes sleeping threads if there are any, otherwise
  * reschedules the processor.
+ *
+ * In tickless mode the interrupt may arrive after several ticks have
+ * passed; the elapsed ticks are read back from the free-running counter
+ * and charged to the clock and to the sleep queue in one pass.
  */
 interrupt clkhandler(void)
 {
+#if TICKLESS
+    clkcatchup();
+#else
     clkupdate(platform.clkfreq / CLKTICKS_PER_SEC);
 
     /* Another clock tick passes. */
@@ -37,8 +127,14 @@ interrupt clkhandler(void)
     }
 
     /* If sleepq is not empty, decrement first key.   */
+    if (nonempty(sleepq))
+    {
+        --firstkey(sleepq);
+    }
+#endif /* TICKLESS */
+
     /* If key reaches zero, call wakeup.              */
-    if (nonempty(sleepq) && (--firstkey(sleepq) <= 0))
+    if (nonempty(sleepq) && (firstkey(sleepq) <= 0))
     {
         wakeup();
     }
@@ -48,4 +144,48 @@ interrupt clkhandler(void)
     }
 }
 
+/**
+ * @ingroup timer
+ *
+ * Read the time since boot, to the resolution of the free-running counter
+ * on tickless platforms and to the tick otherwise.  Unlike ::clktime and
+ * ::clkticks, this is right even while no timer interrupt is due.
+ *
+ * @param sec
+ *      Set to the whole seconds since boot.
+ * @param usec
+ *      Set to the microseconds past @p sec.
+ */
+void clkgettime(unsigned long *sec, unsigned long *usec)
+{
+    unsigned long s, part;
+#if TICKLESS
+    unsigned long cycles = platform.clkfreq / CLKTICKS_PER_SEC;
+
+    /* Cycles into the current second, from the last tick accounted for */
+    ENTER_KERNEL_CRITICAL_SECTION();
+    s = clktime;
+    part = clkticks * cycles + (clkcount() - clklast);
+    EXIT_KERNEL_CRITICAL_SECTION();
+
+    s += part / platform.clkfreq;
+    part %= platform.clkfreq;
+    if (platform.clkfreq >= 1000000)
+    {
+        part /= platform.clkfreq / 1000000;
+    }
+    else
+    {
+        part *= 1000000 / platform.clkfreq;
+    }
+#else
+    ENTER_KERNEL_CRITICAL_SECTION();
+    s = clktime;
+    part = clkticks * (1000000 / CLKTICKS_PER_SEC);
+    EXIT_KERNEL_CRITICAL_SECTION();
+#endif
+    *sec = s;
+    *usec = part;
+}
+
 #endif /* RTCLOCK */
@@ -7,9 +7,13 @@
 #include <platform.h>
 #include <string.h>
 #include <thread.h>
+#include <queue.h>
 #include <CriticalSection.h>
 
 static int thrnew (void);
+static tid_typ vcreate (int core, void *procaddr, unsigned int ssize,
+                        int priority, const char *name, int nargs,
+                        va_list ap);
 
 /**
  * @ingroup threads
@@ -21,7 +25,7 @@ static int thrnew (void);
  * @param ssize
  *      stack size in bytes
  * @param priority
- *      thread priority (0 is lowest priority)
+ *      thread priority, from 0 (lowest) to NPRIO-1
  * @param name
  *      name of the thread, used for debugging
  * @param nargs
@@ -30,17 +34,75 @@ static int thrnew (void);
  *      arguments to pass to thread procedure
  * @return
  *      the new thread's thread id, or ::SYSERR if a new thread could not be
- *      created (not enough memory or thread entries).
+ *      created (bad priority, not enough memory or thread entries).
  */
 tid_typ create (void *procaddr, unsigned int ssize, int priority,
                const char *name, int nargs, ...)
+{
+    tid_typ tid;
+    va_list ap;
+
+    va_start(ap, nargs);
+    tid = vcreate(THRNOAFFINITY, procaddr, ssize, priority, name, nargs, ap);
+    va_end(ap);
+    return tid;
+}
+
+/**
+ * @ingroup threads
+ *
+ * Create a thread pinned to one core.  The thread only ever runs on that
+ * core until chaffinity() releases or moves it.
+ *
+ * @param core
+ *      core to run the thread on, or ::THRNOAFFINITY for any core
+ * @param procaddr
+ *      procedure address
+ * @param ssize
+ *      stack size in bytes
+ * @param priority
+ *      thread priority, from 0 (lowest) to NPRIO-1
+ * @param name
+ *      name of the thread, used for debugging
+ * @param nargs
+ *      number of arguments that follow
+ * @param ...
+ *      arguments to pass to thread procedure
+ * @return
+ *      the new thread's thread id, or ::SYSERR if a new thread could not be
+ *      created or @p core is not a core of this platform.
+ */
+tid_typ createon (int core, void *procaddr, unsigned int ssize,
+                  int priority, const char *name, int nargs, ...)
+{
+    tid_typ tid;
+    va_list ap;
+
+    if ((THRNOAFFINITY != core) && ((core < 0) || (core >= NCORE)))
+    {
+        return SYSERR;
+    }
+    va_start(ap, nargs);
+    tid = vcreate(core, procaddr, ssize, priority, name, nargs, ap);
+    va_end(ap);
+    return tid;
+}
+
+/*
+ * Common body of create() and createon().
+ */
+static tid_typ vcreate (int core, void *procaddr, unsigned int ssize,
+                        int priority, const char *name, int nargs,
+                        va_list ap)
 {
     uintptr_t saddr;			/* stack address                       */
     tid_typ tid;                /* new thread ID                       */
     struct thrent *thrptr;      /* pointer to new thread control block */
-    va_list ap;                 /* list of thread arguments            */
-
 
+    if (isbadprio(priority))
+    {
+        return SYSERR;
+    }
 
     if (ssize < MINSTK)												// Check req stack size not below minimum allowed size
     {
@@ -73,6 +135,9 @@ tid_typ create (void *procaddr, unsigned int ssize, int priority,
     strlcpy(thrptr->name, name, TNMLEN);
     thrptr->parent = gettid();
     thrptr->hasmsg = FALSE;
+    thrptr->killed = FALSE;
+    thrptr->coreaffinity = (THRNOAFFINITY != core);
+    thrptr->coreid = (THRNOAFFINITY != core) ? core : getcpuid();
     thrptr->memlist.next = NULL;
     thrptr->memlist.length = 0;
 
@@ -85,9 +150,7 @@ tid_typ create (void *procaddr, unsigned int ssize, int priority,
 
     /* Set up new thread's stack with context record and arguments.
      * Architecture-specific.  */
-    va_start(ap, nargs);
     thrptr->stkptr = setupStack((void*)saddr, procaddr, INITRET, nargs, ap);
-    va_end(ap);
 
 	EXIT_KERNEL_CRITICAL_SECTION();								// We are exiting allow scheduler to operate
     return tid;													// Return the created thread id
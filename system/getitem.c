@@ -27,7 +27,7 @@ tid_typ getfirst(qid_typ q)
         return EMPTY;
     }
 
-    head = quehead(q);
+    head = firsthead(q);
     return getitem(quetab[head].next);
 }
 
@@ -51,14 +51,15 @@ tid_typ getlast(qid_typ q)
         return EMPTY;
     }
 
-    tail = quetail(q);
+    tail = lasttail(q);
     return getitem(quetab[tail].prev);
 }
 
 /**
  * @ingroup threads
  *
- * Remove a thread from anywhere in a queue
+ * Remove a thread from anywhere in a queue.  If this empties a ready
+ * list priority level, the level is cleared from the ready bitmap.
  * @param  tid  thread ID to get
  * @return thread ID of removed thread
  */
@@ -70,6 +71,12 @@ tid_typ getitem(tid_typ tid)
     prev = quetab[tid].prev;
     quetab[prev].next = next;
     quetab[next].prev = prev;
+    if ((next == quetail(prev)) && isrdqhead(prev))
+    {
+        int level = (prev - readylist) >> 1;
+        int prio = level % NPRIO;
+        rdqbits(level / NPRIO)[prio >> 5] &= ~(1u << (prio & 31));
+    }
     quetab[tid].next = EMPTY;
     quetab[tid].prev = EMPTY;
     return tid;
@@ -29,6 +29,7 @@
 #include <syscall.h>
 #include <safemem.h>
 #include <platform.h>
+#include <timer.h>
 
 #ifdef WITH_USB
 #  include <usb_subsystem.h>
@@ -47,7 +48,11 @@ struct memblock memlist;        /* List of free memory blocks     */
 
 /* Active system status */
 int thrcount;                   /* Number of live user threads         */
+#if NCORE > 1
+tid_typ corecurrent[NCORE];     /* Id of thread running on each core   */
+#else
 tid_typ thrcurrent;             /* Id of currently running thread      */
+#endif
 
 /* Params set by startup.S */
 uintptr_t memheap;              /* Bottom of heap (top of O/S stack)   */
@@ -76,6 +81,11 @@ void nulluser(void)
     /* Enable interrupts  */
     enable();
 
+#if NCORE > 1
+    /* Bring any other cores into the scheduler */
+    corestart();
+#endif
+
     /* Spawn the main thread  */
     ready(create(main, INITSTK, INITPRIO, "MAIN", 0));
 	resched();
@@ -110,6 +120,7 @@ static int sysinit(void)
     memlist.length = (unsigned int)(platform.maxaddr - memheap);
     pmblock->next = NULL;
     pmblock->length = (unsigned int)(platform.maxaddr - memheap);
+    slabinit();
 
     /* Initialize thread table */
     for (i = 0; i < NTHREAD; i++)
@@ -127,6 +138,8 @@ static int sysinit(void)
     thrptr->stkptr = 0;
     thrptr->memlist.next = NULL;
     thrptr->memlist.length = 0;
+    thrptr->coreaffinity = 1;
+    thrptr->coreid = 0;
     thrcurrent = NULLTHREAD;
 
     /* Initialize semaphores */
@@ -149,7 +162,7 @@ static int sysinit(void)
     }
 
     /* initialize thread ready list */
-    readylist = queinit();
+    readylist = readyinit();
 
 #if SB_BUS
     backplaneInit(NULL);
@@ -158,6 +171,9 @@ static int sysinit(void)
 #if RTCLOCK
     /* initialize real time clock */
     clkinit();
+
+    /* start kernel timer service */
+    timerInit();
 #endif                          /* RTCLOCK */
 
 #ifdef UHEAP_SIZE
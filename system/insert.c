@@ -8,10 +8,57 @@
 #include <thread.h>
 #include <queue.h>
 
+#if NCORE > 1
+/*
+ * Choose the core whose ready list a thread joins.  A thread still
+ * executing on another core (it has just blocked or been preempted there
+ * and not switched out yet) must go back to that core, since only that
+ * core may run it.  Otherwise a pinned thread goes to its core, a thread
+ * preempted here stays here, and any other to the core running the lowest
+ * priority thread, keeping the core it last ran on when there is a tie.
+ */
+static unsigned int rdqcore(tid_typ tid)
+{
+    struct thrent *thrptr = &thrtab[tid];
+    unsigned int self = getcpuid();
+    unsigned int core, best;
+
+    for (core = 0; core < coresonline; core++)
+    {
+        if ((core != self) && (corecurrent[core] == tid))
+        {
+            return core;
+        }
+    }
+    if (thrptr->coreaffinity)
+    {
+        return thrptr->coreid;
+    }
+    if (corecurrent[self] == tid)
+    {
+        return self;
+    }
+
+    best = (thrptr->coreid < coresonline) ? thrptr->coreid : self;
+    for (core = 0; core < coresonline; core++)
+    {
+        if (thrtab[corecurrent[core]].prio < thrtab[corecurrent[best]].prio)
+        {
+            best = core;
+        }
+    }
+    return best;
+}
+#endif
+
 /**
  * @ingroup threads
  *
- * Insert a thread into a queue in descending key order.
+ * Insert a thread into a queue in descending key order.  Insertion
+ * into the ready list appends to the FIFO of the thread's priority
+ * level, so equal keys keep the same round-robin order as before.  On
+ * multi-core platforms a thread readied for another core that outranks
+ * the thread running there makes that core reschedule.
  * @param tid    thread ID to insert
  * @param q      target queue
  * @param key    sorting key
@@ -27,10 +74,30 @@ int insert(tid_typ tid, qid_typ q, int key)
         return SYSERR;
     }
 
-    next = quetab[quehead(q)].next;
-    while (quetab[next].key >= key)
+    if (q == readylist)
+    {
+#if NCORE > 1
+        unsigned int core = rdqcore(tid);
+
+        if ((core != getcpuid()) &&
+            (key > thrtab[corecurrent[core]].prio))
+        {
+            coresignal(core);
+        }
+#else
+        unsigned int core = 0;
+#endif
+
+        next = quetail(rdqhead(core, key));
+        rdqbits(core)[key >> 5] |= 1u << (key & 31);
+    }
+    else
     {
-        next = quetab[next].next;
+        next = quetab[quehead(q)].next;
+        while (quetab[next].key >= key)
+        {
+            next = quetab[next].next;
+        }
     }
 
     /* insert tid between prev and next */
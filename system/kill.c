@@ -13,23 +13,91 @@
 
 extern void xdone (void);
 
+/* Threads that died while running, until no core runs them any more;
+ * NULLTHREAD, which is never killed, marks an empty slot.  At most one
+ * per core is still running, so NCORE slots always leave one to spare
+ * after thrreap(). */
+static tid_typ thrdead[NCORE];
+
+/*
+ * Is a thread running on a core?  It may be blocked already and just not
+ * switched out yet, in which case it is still on its stack.
+ */
+static bool thrrunning(tid_typ tid)
+{
+#if NCORE > 1
+    unsigned int core;
+
+    for (core = 0; core < NCORE; core++)
+    {
+        if (corecurrent[core] == tid)
+        {
+            return TRUE;
+        }
+    }
+    return FALSE;
+#else
+    return (thrcurrent == tid);
+#endif
+}
+
+/*
+ * Take a thread off the queue it waits in, if any.
+ */
+static void thrunlink(tid_typ tid)
+{
+    struct thrent *thrptr = &thrtab[tid];
+
+    switch (thrptr->state)
+    {
+    case THRSLEEP:
+    case THRTMOUT:
+        unsleep(tid);
+        break;
+
+    case THRWAIT:
+        semtab[thrptr->sem].count++;
+        getitem(tid);           /* removes from queue */
+        break;
+
+    case THRREADY:
+        getitem(tid);           /* removes from queue */
+        break;
+
+    default:
+        break;
+    }
+}
+
 /**
  * @ingroup threads
  *
- * Kill a thread and remove it from the system
+ * Kill a thread and remove it from the system.  A thread that is running,
+ * here or on another core, is only marked killed; it dies at its next
+ * reschedule, which is right away for the calling thread, and its stack is
+ * freed once no core runs on it.
  * @param tid target thread
  * @return OK on success, SYSERR otherwise
  */
 xinu_syscall kill(tid_typ tid)
 {
     register struct thrent *thrptr;     /* thread control block */
+    tid_typ parent;
+    bool running;
 
-    if (isbadtid(tid) || (NULLTHREAD == tid))
+    if (tid == gettid())
     {
-        return SYSERR;
+        /* Tell the parent now; once killed this thread may be switched
+         * out for good at any moment */
+        send(thrtab[tid].parent, tid);
     }
 
-	ENTER_KERNEL_CRITICAL_SECTION();
+    ENTER_KERNEL_CRITICAL_SECTION();
+    if (isbadtid(tid) || (NULLTHREAD == tid) || thrtab[tid].killed)
+    {
+        EXIT_KERNEL_CRITICAL_SECTION();
+        return SYSERR;
+    }
     thrptr = &thrtab[tid];
     if (--thrcount <= 1)
     {
@@ -40,31 +108,83 @@ xinu_syscall kill(tid_typ tid)
     /* reclaim used memory regions */
     memRegionReclaim(tid);
 #endif                          /* UHEAP_SIZE */
-	EXIT_KERNEL_CRITICAL_SECTION();
-
-    send(thrptr->parent, tid);
-
-    stkfree(thrptr->stkbase, thrptr->stklen);
 
-    switch (thrptr->state)
+    parent = thrptr->parent;
+    running = thrrunning(tid);
+    if (running)
     {
-    case THRSLEEP:
-        unsleep(tid);
+        thrptr->killed = TRUE;
+    }
+    else
+    {
+        thrunlink(tid);
+        stkfree(thrptr->stkbase, thrptr->stklen);
         thrptr->state = THRFREE;
-        break;
-    case THRCURR:
-        thrptr->state = THRFREE;        /* suicide */
-        resched();
-
-    case THRWAIT:
-        semtab[thrptr->sem].count++;
-
-    case THRREADY:
-        getitem(tid);           /* removes from queue */
+    }
+    EXIT_KERNEL_CRITICAL_SECTION();
 
-    default:
-        thrptr->state = THRFREE;
+    if (tid == gettid())
+    {
+        resched();              /* suicide; never returns */
     }
+    send(parent, tid);
+#if NCORE > 1
+    if (running)
+    {
+        unsigned int core;
 
+        for (core = 0; core < NCORE; core++)
+        {
+            if (corecurrent[core] == tid)
+            {
+                coresignal(core);
+            }
+        }
+    }
+#endif
     return OK;
 }
+
+/**
+ * @ingroup threads
+ *
+ * Finish off a thread that was killed while running, as it reschedules on
+ * its own core.  It is taken off any queue it has joined since and kept
+ * as ::THRDEAD until thrreap() frees its stack.  Called by resched() with
+ * the kernel lock held.
+ * @param tid the killed thread, which is running on the calling core
+ */
+void thrdie(tid_typ tid)
+{
+    unsigned int i;
+
+    thrreap();
+    thrunlink(tid);
+    thrtab[tid].state = THRDEAD;
+    for (i = 0; NULLTHREAD != thrdead[i]; i++)
+        ;
+    thrdead[i] = tid;
+}
+
+/**
+ * @ingroup threads
+ *
+ * Free the stacks of dead threads that no core is running on any more.
+ * Called by resched() with the kernel lock held.
+ */
+void thrreap(void)
+{
+    struct thrent *thrptr;
+    unsigned int i;
+
+    for (i = 0; i < NCORE; i++)
+    {
+        if ((NULLTHREAD != thrdead[i]) && !thrrunning(thrdead[i]))
+        {
+            thrptr = &thrtab[thrdead[i]];
+            stkfree(thrptr->stkbase, thrptr->stklen);
+            thrptr->state = THRFREE;
+            thrdead[i] = NULLTHREAD;
+        }
+    }
+}
@@ -64,7 +64,10 @@ xinu_syscall lock (monitor mon)
         /* if another thread owns the lock, wait on sem until monitor is free */
         else
         {
+            /* the kernel lock is not held across the wait */
+            EXIT_KERNEL_CRITICAL_SECTION();
             wait(monptr->sem);
+            ENTER_KERNEL_CRITICAL_SECTION();
             monptr->owner = thrcurrent;
             (monptr->count)++;
 
@@ -14,7 +14,8 @@
 /**
  * @ingroup memory_mgmt
  *
- * Frees a block of heap-allocated memory.
+ * Frees a block of heap-allocated memory.  Blocks from the slab arena go
+ * back to their slab; others are merged into the address ordered ::memlist.
  *
  * @param memptr
  *      Pointer to memory block allocated with memget().
@@ -39,6 +40,11 @@ xinu_syscall memfree (void *memptr, unsigned int nbytes)
         return SYSERR;
     }
 
+    if (isslab(memptr))
+    {
+        return slabfree(memptr, nbytes);
+    }
+
     block = (struct memblock *)memptr;
     nbytes = (unsigned int)roundmb(nbytes);
 
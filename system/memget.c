@@ -13,7 +13,9 @@
 /**
  * @ingroup memory_mgmt
  *
- * Allocate heap memory.
+ * Allocate heap memory.  Requests of up to ::SLAB_MAXSIZE bytes come from
+ * the slab arena in constant time; larger ones, and small ones the arena
+ * cannot hold, are taken first-fit from ::memlist.
  *
  * @param nbytes
  *      Number of bytes requested.
@@ -27,12 +29,22 @@
 void *memget (unsigned int nbytes)
 {
     struct memblock *prev, *curr, *leftover;
+    void *obj;
 
     if (0 == nbytes)
     {
         return (void *)SYSERR;
     }
 
+    if (nbytes <= SLAB_MAXSIZE)
+    {
+        obj = slabget(nbytes);
+        if ((void *)SYSERR != obj)
+        {
+            return obj;
+        }
+    }
+
     /* round to multiple of memblock size   */
     nbytes = (unsigned int)roundmb(nbytes);
 
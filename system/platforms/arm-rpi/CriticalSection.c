@@ -3,27 +3,102 @@
 #include <kernel.h>
 #include "CriticalSection.h"
 
-static bool inCrit = true;
-static uint32_t intmask = 0;
-
 extern uint32_t disable(void);        // In assembler file system/arch/arm/intutils.S
 extern void restore(uint32_t mask);   // In assembler file system/arch/arm/intutils.S
+extern void dmb(void);                // In assembler file memory_barrier.S
+
+unsigned int coresonline = 1;
+
+/* The kernel lock is a Lamport bakery lock.  It only relies on ordered
+ * loads and stores, so it works before the MMU is on when LDREX/STREX
+ * have no exclusive monitor to use on the BCM2836/7.  A core that already
+ * owns the lock just counts another level of nesting.  */
+static volatile uint32_t choosing[NCORE] = { 0 };
+static volatile uint32_t ticket[NCORE] = { 0 };
+static volatile int lockowner = -1;
+static unsigned int lockdepth[NCORE] = { 0 };
+static uint32_t lockmask[NCORE] = { 0 };
+
+/**
+ * Acquire the kernel lock for this core.  IRQs must already be disabled.
+ */
+void kernel_lock (void)
+{
+	unsigned int core = getcpuid();
+	unsigned int i;
+	uint32_t max;
+
+	if (lockowner == (int)core)										// This core already holds the lock
+	{
+		lockdepth[core]++;											// Just count the nesting
+		return;
+	}
+	choosing[core] = 1;
+	dmb();
+	for (i = 0, max = 0; i < NCORE; i++)							// Take a ticket above any in use
+	{
+		if (ticket[i] > max) max = ticket[i];
+	}
+	ticket[core] = max + 1;
+	dmb();
+	choosing[core] = 0;
+	dmb();
+	for (i = 0; i < NCORE; i++)										// Wait for every earlier ticket
+	{
+		while (choosing[i]) {}
+		while (ticket[i] && ((ticket[i] < ticket[core]) ||
+			((ticket[i] == ticket[core]) && (i < core)))) {}
+	}
+	lockowner = core;
+	lockdepth[core] = 1;
+	dmb();
+}
+
+/**
+ * Release one level of the kernel lock held by this core.
+ */
+void kernel_unlock (void)
+{
+	unsigned int core = getcpuid();
+
+	if (--lockdepth[core] == 0)
+	{
+		dmb();
+		lockowner = -1;
+		ticket[core] = 0;
+		dmb();
+	}
+}
+
+/**
+ * Does this core hold the kernel lock?  resched() uses this to catch a
+ * thread that would switch out inside a critical section.
+ */
+bool kernel_locked (void)
+{
+	return (lockowner == (int)getcpuid());
+}
 
 void ENTER_KERNEL_CRITICAL_SECTION (void)
 {
-	if (inCrit == false) {
-		kprintf("Aborting .. ENTER_KERNEL_CRITICAL_SECTION called twice without leaving \n");
-		while (1) {}
+	uint32_t im = disable();										// Stop interrupts on this core first
+
+	kernel_lock();													// Then keep the other cores out
+	if (1 == lockdepth[getcpuid()])									// Outermost section saves the mask
+	{
+		lockmask[getcpuid()] = im;
 	}
-	intmask = disable();
-	inCrit = true;
 }
 
 void EXIT_KERNEL_CRITICAL_SECTION (void)
 {
-	if (inCrit == false) {
-		kprintf("Aborting .. EXIT_KERNEL_CRITICAL_SECTION called twice without entering \n");
-		while (1) {}
+	unsigned int core = getcpuid();
+	uint32_t im = lockmask[core];
+	bool outer = (1 == lockdepth[core]);
+
+	kernel_unlock();
+	if (outer)														// Only the outermost section
+	{
+		restore(im);												// puts the interrupt mask back
 	}
-	restore(intmask);
-}
\ No newline at end of file
+}
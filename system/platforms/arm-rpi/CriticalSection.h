@@ -1,9 +1,56 @@
+/**
+ * @file CriticalSection.h
+ *
+ * Kernel critical section and the multi-core primitives it is built on.
+ * A critical section disables IRQs on the calling core and holds the
+ * kernel lock, so it excludes both interrupt handlers on this core and
+ * every other core.  Sections nest on the same core.
+ */
 #ifndef _CRITICAL_SECTION_H_
-#define _CRITICAL_DECTION_H_
+#define _CRITICAL_SECTION_H_
 
+#include <stdbool.h>
+#include <kernel.h>
+#include "rpi-platform.h"
+
+/** Number of cores running the scheduler, set once they are started */
+extern unsigned int coresonline;
+
+#if NCORE > 1
+/**
+ * Return the index of the core executing the caller.
+ */
+static inline unsigned int getcpuid (void)
+{
+	unsigned int mpidr;
+
+#if (__ARM_ARCH < 7)
+	if (0xB76 == RPi_CpuId.PartNumber)								// ARM6 code on a single core Pi1
+	{
+		return 0;													// has no MPIDR register to read
+	}
+#endif
+	__asm__ volatile ("mrc p15, 0, %0, c0, c0, 5" : "=r" (mpidr));	// Read the multiprocessor affinity register
+	return (mpidr & 0x3);											// Core id is the bottom 2 bits
+}
+#endif
+
+void kernel_lock (void);
+
+void kernel_unlock (void);
+
+bool kernel_locked (void);
 
 void ENTER_KERNEL_CRITICAL_SECTION (void);
 
 void EXIT_KERNEL_CRITICAL_SECTION (void);
 
+#if NCORE > 1
+void corestart (void);
+
+void coresignal (unsigned int core);
+
+void coredispatch (void);
+#endif
+
 #endif /* _CRITICAL_SECTION_H_ */
@@ -0,0 +1,183 @@
+/**
+ * @file cache.c
+ *
+ * Data cache maintenance for memory shared with DMA masters.  Before a
+ * device reads memory the CPU wrote, the lines are cleaned out to DRAM;
+ * before the CPU reads memory a device wrote, the lines are invalidated so
+ * the next access misses.  Operations by address reach the point of
+ * coherency, so they cover the Pi2/Pi3 L2 as well as L1.
+ *
+ * See B2.2 "Caches and branch predictors" of the ARMv7-A Architecture
+ * Reference Manual, and 3.2.22 "c7, Cache operations" of the ARM1176JZF-S
+ * Technical Reference Manual.
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <stdint.h>
+#include <mmu.h>
+
+#define DCACHE_FLUSH	0		/* Clean and invalidate by set/way, DCCISW	*/
+#define DCACHE_INVAL	1		/* Invalidate by set/way, DCISW			*/
+
+/* Smallest data cache line on this CPU, the stride of operations by address */
+static unsigned int dcacheLine (void)
+{
+	uint32_t ctr;
+
+	if (!iscachev7())
+	{
+		return 32;													// ARM1176
+	}
+	__asm__ volatile ("mrc p15, 0, %0, c0, c0, 1" : "=r" (ctr));	// CTR
+	return 4 << ((ctr >> 16) & 0xF);								// DminLine is log2 words
+}
+
+/**
+ * Write any dirty data cache lines holding a range of memory back to DRAM,
+ * so a device reading it sees what the CPU wrote.  The lines stay valid.
+ * @param addr  start of the range
+ * @param len   length of the range in bytes
+ */
+void dcacheClean (const void *addr, unsigned int len)
+{
+	unsigned int line = dcacheLine();
+	uintptr_t mva = (uintptr_t)addr & ~(line - 1);
+	uintptr_t end = (uintptr_t)addr + len;
+
+	for (; mva < end; mva += line)
+	{
+		__asm__ volatile ("mcr p15, 0, %0, c7, c10, 1" : : "r" (mva) : "memory");	// DCCMVAC
+	}
+	dsb();
+}
+
+/**
+ * Write back and discard the data cache lines holding a range of memory.
+ * @param addr  start of the range
+ * @param len   length of the range in bytes
+ */
+void dcacheFlush (const void *addr, unsigned int len)
+{
+	unsigned int line = dcacheLine();
+	uintptr_t mva = (uintptr_t)addr & ~(line - 1);
+	uintptr_t end = (uintptr_t)addr + len;
+
+	for (; mva < end; mva += line)
+	{
+		__asm__ volatile ("mcr p15, 0, %0, c7, c14, 1" : : "r" (mva) : "memory");	// DCCIMVAC
+	}
+	dsb();
+}
+
+/**
+ * Discard the data cache lines holding a range of memory, so the CPU next
+ * reads what a device wrote to DRAM.  Lines the range only partly covers
+ * are written back first rather than lost, since they also hold other
+ * data; a device must not write to them while they may be cached.
+ * @param addr  start of the range
+ * @param len   length of the range in bytes
+ */
+void dcacheInvalidate (void *addr, unsigned int len)
+{
+	unsigned int line = dcacheLine();
+	uintptr_t mva = (uintptr_t)addr;
+	uintptr_t end = (uintptr_t)addr + len;
+
+	if (mva & (line - 1))
+	{
+		mva &= ~(line - 1);
+		__asm__ volatile ("mcr p15, 0, %0, c7, c14, 1" : : "r" (mva) : "memory");	// DCCIMVAC
+		mva += line;
+	}
+	if ((end & (line - 1)) && (end > mva))
+	{
+		end &= ~(line - 1);
+		__asm__ volatile ("mcr p15, 0, %0, c7, c14, 1" : : "r" (end) : "memory");	// DCCIMVAC
+	}
+	for (; mva < end; mva += line)
+	{
+		__asm__ volatile ("mcr p15, 0, %0, c7, c6, 1" : : "r" (mva) : "memory");	// DCIMVAC
+	}
+	dsb();
+}
+
+/* Run a set/way operation over every data cache level up to levels */
+static void dcacheSetWay (unsigned int levels, int op)
+{
+	uint32_t clidr, ccsidr, sw;
+	unsigned int level, linelog, wayshift;
+	int way, set, ways, sets;
+
+	__asm__ volatile ("mrc p15, 1, %0, c0, c0, 1" : "=r" (clidr));	// CLIDR
+	if (levels > ((clidr >> 24) & 0x7))
+	{
+		levels = (clidr >> 24) & 0x7;								// No further than the level of coherency
+	}
+	for (level = 0; level < levels; level++)
+	{
+		if (((clidr >> (level * 3)) & 0x7) < 2)
+		{
+			continue;												// No data cache at this level
+		}
+		__asm__ volatile ("mcr p15, 2, %0, c0, c0, 0" : : "r" (level << 1));	// CSSELR
+		isb();
+		__asm__ volatile ("mrc p15, 1, %0, c0, c0, 0" : "=r" (ccsidr));		// CCSIDR
+		linelog = (ccsidr & 0x7) + 4;
+		ways = (ccsidr >> 3) & 0x3FF;
+		sets = (ccsidr >> 13) & 0x7FFF;
+		wayshift = (0 == ways) ? 0 : __builtin_clz(ways);
+		for (way = ways; way >= 0; way--)
+		{
+			for (set = sets; set >= 0; set--)
+			{
+				sw = (way << wayshift) | (set << linelog) | (level << 1);
+				if (DCACHE_INVAL == op)
+				{
+					__asm__ volatile ("mcr p15, 0, %0, c7, c6, 2" : : "r" (sw));	// DCISW
+				}
+				else
+				{
+					__asm__ volatile ("mcr p15, 0, %0, c7, c14, 2" : : "r" (sw));	// DCCISW
+				}
+			}
+		}
+	}
+	dsb();
+	isb();
+}
+
+/**
+ * Write back and discard the whole data cache, every level.  Used while
+ * turning the caches off, before handing the machine to another kernel,
+ * and before starting a core that will read memory with its caches off.
+ */
+void dcacheFlushAll (void)
+{
+	if (iscachev7())
+	{
+		dcacheSetWay(7, DCACHE_FLUSH);
+	}
+	else
+	{
+		__asm__ volatile ("mcr p15, 0, %0, c7, c14, 0" : : "r" (0) : "memory");	// Clean and invalidate entire data cache
+		dsb();
+	}
+}
+
+/**
+ * Discard whatever the calling core's L1 data cache holds, without
+ * writing it back.  Only safe before the core has turned its MMU on; the
+ * L2 of the Pi2/Pi3 is shared with cores already running and is left alone.
+ */
+void dcacheInvalidateL1 (void)
+{
+	if (iscachev7())
+	{
+		dcacheSetWay(1, DCACHE_INVAL);
+	}
+	else
+	{
+		__asm__ volatile ("mcr p15, 0, %0, c7, c6, 0" : : "r" (0) : "memory");	// Invalidate entire data cache
+		dsb();
+	}
+}
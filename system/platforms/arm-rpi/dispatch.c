@@ -19,8 +19,12 @@
 #include <kernel.h>
 #include <platform.h>
 #include <clock.h>
+#include <mmu.h>
+#include <string.h>
+#include <thread.h>
 #include "interrupt.h"
 #include "rpi-platform.h"
+#include "CriticalSection.h"
 
 /*==========================================================================}
 {  RASPBERRY PI SYSTEM TIMER HARDWARE REGISTERS - BCM2835 Manual Section 12	}
@@ -64,14 +68,72 @@ interrupt_handler_t interruptVector[BCM2835_NUM_IRQS] = { 0 };
 /** Bitwise table of IRQs that have been enabled on the ARM. They all start disabled */
 static uint32_t arm_enabled_irqs[3] = { 0 };
 
-/* Call the handler function for an IRQ that was received, or panic if it
- * doesn't exist.  */
+/* IRQ_basic_pending bits: the ARM-specific IRQs, then summaries of the
+ * other two registers, then a copy of some GPU IRQs.  The GPU IRQs copied
+ * here are left out of the summaries.  */
+#define BASIC_PENDING_ARM       0x000000FF  /* IRQs 64-71                   */
+#define BASIC_PENDING_1         0x00000100  /* More set in IRQ_pending_1    */
+#define BASIC_PENDING_2         0x00000200  /* More set in IRQ_pending_2    */
+#define BASIC_PENDING_SHORTCUT  10          /* First copied GPU IRQ bit     */
+#define BASIC_PENDING_NSHORTCUT 11          /* Number of copied GPU IRQs    */
+
+/* GPU IRQs copied into IRQ_basic_pending, in bit order  */
+static const uint8_t basic_shortcuts[BASIC_PENDING_NSHORTCUT] =
+    { 7, 9, 10, 18, 19, 53, 54, 55, 56, 57, 62 };
+
+/** Per-IRQ handler statistics, reset by irqstatclear() */
+struct irqstat irqstats[BCM2835_NUM_IRQS];
+
+/** Number of times dispatch() ran on core 0 */
+unsigned long irqbatches;
+
+/** Number of those times no enabled IRQ was pending */
+unsigned long irqspurious;
+
+/* Cycle counter of the Pi2/Pi3 performance monitor rather than the
+ * ARM1176's.  */
+static bool cyclev7;
+
+/* Read the cycle counter of the calling core.  */
+static inline uint32_t cyclecount (void)
+{
+    uint32_t count;
+
+    if (cyclev7)
+    {
+        __asm__ volatile ("mrc p15, 0, %0, c9, c13, 0" : "=r" (count));  // PMCCNTR
+    }
+    else
+    {
+        __asm__ volatile ("mrc p15, 0, %0, c15, c12, 1" : "=r" (count)); // CCR
+    }
+    return count;
+}
+
+/* Call the handler function for an IRQ that was received, timing it, or panic
+ * if it doesn't exist.  */
 static void handle_irq (uint8_t irq_num)
 {
     interrupt_handler_t handler = interruptVector[irq_num];
+    struct irqstat *stat = &irqstats[irq_num];
+    uint32_t start, cycles;
+
     if (handler)
     {
+        start = cyclecount();
         (*handler)();
+        cycles = cyclecount() - start;
+
+        stat->count++;
+        stat->cycles += cycles;
+        if (cycles < stat->min || 1 == stat->count)
+        {
+            stat->min = cycles;
+        }
+        if (cycles > stat->max)
+        {
+            stat->max = cycles;
+        }
     }
     else
     {
@@ -82,71 +144,134 @@ static void handle_irq (uint8_t irq_num)
     }
 }
 
-/* Check if the pending bit for an IRQ line is set; if so, call the handler
- * function.  */
-static void check_irq_pending (uint8_t irq_num)
+/* Find index of first set bit in a nonzero word. */
+static inline unsigned int first_set_bit (uint32_t word)
 {
-    bool handle = FALSE;
+    return 31 - __builtin_clz(word);
+}
 
-    /* Check the appropriate hardware register, depending on the IRQ number.  */
-    if (irq_num >= 64)
-    {
-        if (IRQ_CONTROL->IRQ_basic_pending & (1 << (irq_num - 64)))
-        {
-            handle = TRUE;
-        }
-    }
-    else if (irq_num >= 32)
+/* Handle every enabled IRQ pending on the interrupt controller.  The pending
+ * registers are read once, IRQ_pending_1 and IRQ_pending_2 only when the
+ * summary bits say they hold something more than the copies in
+ * IRQ_basic_pending.  An IRQ raised meanwhile interrupts again once this
+ * returns.  */
+static void dispatch_pending (void)
+{
+    uint32_t pending[3];
+    uint32_t basic, shortcuts;
+    unsigned int bit, irq;
+    bool handled = FALSE;
+
+    basic = IRQ_CONTROL->IRQ_basic_pending;
+    pending[0] = (basic & BASIC_PENDING_1) ? IRQ_CONTROL->IRQ_pending_1 : 0;
+    pending[1] = (basic & BASIC_PENDING_2) ? IRQ_CONTROL->IRQ_pending_2 : 0;
+    pending[2] = basic & BASIC_PENDING_ARM;
+    shortcuts = (basic >> BASIC_PENDING_SHORTCUT)
+                & ((1 << BASIC_PENDING_NSHORTCUT) - 1);
+    while (shortcuts != 0)
     {
-        if (IRQ_CONTROL->IRQ_pending_2 & (1 << (irq_num - 32)))
-        {
-            handle = TRUE;
-        }
+        bit = first_set_bit(shortcuts);
+        shortcuts ^= (1 << bit);
+        irq = basic_shortcuts[bit];
+        pending[irq >> 5] |= 1 << (irq & 31);
     }
-    else
+
+    for (int i = 0; i < 3; i++)
     {
-        if (IRQ_CONTROL->IRQ_pending_1 & (1 << irq_num))
+        uint32_t mask = pending[i] & arm_enabled_irqs[i];
+        while (mask != 0)
         {
-            handle = TRUE;
+            bit = first_set_bit(mask);
+            mask ^= (1 << bit);
+            handle_irq(bit + (i << 5));
+            /* The pending bit should have been cleared in a device-specific
+             * way by the handler function.  As far as we can tell, it cannot
+             * be cleared directly through the interrupt controller.  */
+            handled = TRUE;
         }
     }
-    if (handle)
+
+    irqbatches++;
+    if (!handled)
     {
-        handle_irq(irq_num);
-        /* The pending bit should have been cleared in a device-specific way by
-         * the handler function.  As far as we can tell, it cannot be cleared
-         * directly through the interrupt controller.  */
+        irqspurious++;
     }
 }
 
-/* Find index of first set bit in a nonzero word. */
-static inline unsigned int first_set_bit (uint32_t word)
-{
-    return 31 - __builtin_clz(word);
-}
-
 /**
  * Processes all pending interrupt requests.
  *
- * On the BCM2835 (Raspberry Pi), this done by iterating through all registered
- * interrupts on the ARM and checking whether each one is pending.  This is not
- * necessarily the fastest way to do it, but this should minimize problems with
- * the poorly-documented hardware and conflicts with the GPU.
+ * On the BCM2835 (Raspberry Pi), this is done by reading the pending
+ * registers once and calling the handler of each enabled IRQ found pending.
+ * Rescheduling is deferred on this core, through its own ::resdefer, until
+ * every handler has run, so a handler that wakes a thread does not hold up
+ * the others, and each handler's time in ::irqstats is its own.  Other cores
+ * keep scheduling meanwhile.
+ *
+ * GPU interrupts are only routed to core 0; other cores only take their own
+ * local interrupts, which every core handles last, inside the same deferral,
+ * so a batch reschedules at most once.
  */
 void dispatch (void)
 {
-    for (int i = 0; i < 3; i++)
+    unsigned int core = getcpuid();
+
+    resdefer[core] = 1;
+
+    if (0 == core)
     {
-        uint32_t mask = arm_enabled_irqs[i];
-        while (mask != 0)
-        {
-            unsigned int bit = first_set_bit(mask);
-            mask ^= (1 << bit);
-            check_irq_pending(bit + (i << 5));
-        }
+        dispatch_pending();
+    }
+#if NCORE > 1
+    if (coresonline > 1)
+    {
+        coredispatch();
+    }
+#endif
+
+    /* Now that all the handlers are finished, switch to any thread they
+     * woke.  */
+    if (--resdefer[core] > 0)
+    {
+        resdefer[core] = 0;
+        resched();
     }
 }
 
+/**
+ * Start the cycle counter of core 0, which times the interrupt handlers, and
+ * clear the statistics.  Called once at startup.
+ */
+void irqstatinit (void)
+{
+    STATIC_ASSERT(NIRQ == BCM2835_NUM_IRQS);
+    cyclev7 = iscachev7();
+    if (cyclev7)
+    {
+        __asm__ volatile ("mcr p15, 0, %0, c9, c12, 1" : : "r" (1u << 31));  // PMCNTENSET, cycle counter
+        __asm__ volatile ("mcr p15, 0, %0, c9, c12, 0" : : "r" (0x5));      // PMCR, reset it and enable
+    }
+    else
+    {
+        __asm__ volatile ("mcr p15, 0, %0, c15, c12, 0" : : "r" (0x5));     // PMNC, reset it and enable
+    }
+    irqstatclear();
+}
+
+/**
+ * Clear the interrupt handler statistics.
+ */
+void irqstatclear (void)
+{
+    irqmask im;
+
+    im = disable();
+    memset(irqstats, 0, sizeof(irqstats));
+    irqbatches = 0;
+    irqspurious = 0;
+    restore(im);
+}
+
 /**
  * Enable an interrupt request line.
  * @param irq_num
@@ -239,7 +364,12 @@ void clkinit(void)
 	/* register clock interrupt */
 	interruptVector[IRQ_TIMER] = clkhandler;
 	enable_irq(IRQ_TIMER);
+#if TICKLESS
+	clklast = clkcount();
+	clkalarm(clklast + platform.clkfreq / CLKTICKS_PER_SEC);
+#else
 	clkupdate(platform.clkfreq / CLKTICKS_PER_SEC);
+#endif
 }
 
 #endif                          /* RTCLOCK */
\ No newline at end of file
@@ -0,0 +1,96 @@
+/**
+ * @file dmafree.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <xinu.h>
+#include <CriticalSection.h>
+#include <mmu.h>
+
+/**
+ * @ingroup memory_mgmt
+ *
+ * Frees a block of DMA memory, merging it into the address ordered
+ * ::dmalist.
+ *
+ * @param memptr
+ *      Pointer to memory block allocated with dmaget().
+ *
+ * @param nbytes
+ *      Length of memory block, in bytes.  (Same value passed to dmaget().)
+ *
+ * @return
+ *      ::OK on success; ::SYSERR on failure.  This function can only fail
+ *      because of memory corruption or specifying an invalid memory block.
+ */
+xinu_syscall dmafree (void *memptr, unsigned int nbytes)
+{
+    struct memblock *block, *next, *prev;
+    uintptr_t top;
+
+    /* make sure block is in the DMA region */
+    if ((0 == nbytes) || (0 == dmaregion)
+        || ((uintptr_t)memptr < dmaregion)
+        || ((uintptr_t)memptr >= dmaregion + DMA_REGION_SIZE))
+    {
+        return SYSERR;
+    }
+
+    block = (struct memblock *)memptr;
+    nbytes = (unsigned int)roundcl(nbytes);
+
+	ENTER_KERNEL_CRITICAL_SECTION();
+
+    prev = &dmalist;
+    next = dmalist.next;
+    while ((next != NULL) && (next < block))
+    {
+        prev = next;
+        next = next->next;
+    }
+
+    /* find top of previous memblock */
+    if (prev == &dmalist)
+    {
+        top = 0;
+    }
+    else
+    {
+        top = (uintptr_t)prev + prev->length;
+    }
+
+    /* make sure block is not overlapping on prev or next blocks */
+    if ((top > (uintptr_t)block)
+        || ((next != NULL) && ((uintptr_t)block + nbytes) > (uintptr_t)next))
+    {
+		EXIT_KERNEL_CRITICAL_SECTION();
+        return SYSERR;
+    }
+
+    dmalist.length += nbytes;
+
+    /* coalesce with previous block if adjacent */
+    if (top == (uintptr_t)block)
+    {
+        prev->length += nbytes;
+        block = prev;
+    }
+    else
+    {
+        block->next = next;
+        block->length = nbytes;
+        prev->next = block;
+    }
+
+    /* coalesce with next block if adjacent */
+    if (((uintptr_t)block + block->length) == (uintptr_t)next)
+    {
+        block->length += next->length;
+        block->next = next->next;
+    }
+	EXIT_KERNEL_CRITICAL_SECTION();
+    return OK;
+}
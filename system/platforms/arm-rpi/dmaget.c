@@ -0,0 +1,72 @@
+/**
+ * @file dmaget.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <xinu.h>
+#include <CriticalSection.h>
+#include <mmu.h>
+
+/**
+ * @ingroup memory_mgmt
+ *
+ * Allocate uncached memory for buffers a DMA master or the GPU shares with
+ * the CPU, first-fit from ::dmalist.  Needs no cache maintenance, but every
+ * CPU access goes to DRAM, so keep it for the buffers the hardware touches.
+ *
+ * @param nbytes
+ *      Number of bytes requested.
+ *
+ * @return
+ *      ::SYSERR if @p nbytes was 0 or there is no DMA memory to satisfy the
+ *      request; otherwise returns a pointer to the allocated memory region,
+ *      aligned to ::CACHE_LINE_SIZE.  Free the block with dmafree() when
+ *      done with it.
+ */
+void *dmaget (unsigned int nbytes)
+{
+    struct memblock *prev, *curr, *leftover;
+
+    if (0 == nbytes)
+    {
+        return (void *)SYSERR;
+    }
+
+    /* round to multiple of cache line size */
+    nbytes = (unsigned int)roundcl(nbytes);
+
+	ENTER_KERNEL_CRITICAL_SECTION();
+
+    prev = &dmalist;
+    curr = dmalist.next;
+    while (curr != NULL)
+    {
+        if (curr->length == nbytes)
+        {
+            prev->next = curr->next;
+            dmalist.length -= nbytes;
+
+			EXIT_KERNEL_CRITICAL_SECTION();
+            return (void *)(curr);
+        }
+        else if (curr->length > nbytes)
+        {
+            /* split block into two */
+            leftover = (struct memblock *)((uintptr_t)curr + nbytes);
+            prev->next = leftover;
+            leftover->next = curr->next;
+            leftover->length = curr->length - nbytes;
+            dmalist.length -= nbytes;
+
+			EXIT_KERNEL_CRITICAL_SECTION();
+            return (void *)(curr);
+        }
+        prev = curr;
+        curr = curr->next;
+    }
+	EXIT_KERNEL_CRITICAL_SECTION();
+    return (void *)SYSERR;
+}
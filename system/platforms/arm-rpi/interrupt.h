@@ -8,8 +8,11 @@
 #ifndef _INTERRUPT_H_
 #define _INTERRUPT_H_
 
+#include <stdint.h>
 #include <xinu.h>
 
+/* IRQ lines: 64 shared with the GPU, then 8 specific to the ARM */
+#define NIRQ               72
 
 /* System timer - one IRQ line per output compare register.  */
 #define IRQ_SYSTEM_TIMER_0 0
@@ -41,6 +44,24 @@ typedef interrupt (*interrupt_handler_t)(void);
 
 typedef unsigned long irqmask;  /**< machine status for disable/restore  */
 
+/**
+ * Statistics of one IRQ line, kept by dispatch().  Times are in CPU cycles
+ * and cover the handler alone; rescheduling is deferred until all pending
+ * handlers have run.
+ */
+struct irqstat
+{
+    unsigned long count;        /**< Times the handler ran              */
+    uint32_t min;               /**< Shortest run                       */
+    uint32_t max;               /**< Longest run                        */
+    uint64_t cycles;            /**< Total of all runs                  */
+};
+
+extern interrupt_handler_t interruptVector[];
+extern struct irqstat irqstats[];
+extern unsigned long irqbatches;    /**< dispatch() calls on core 0       */
+extern unsigned long irqspurious;   /**< of those, with nothing to handle */
+
 
 irqmask disable(void);
 irqmask restore(irqmask);
@@ -48,5 +69,7 @@ void enable_irq(irqmask);
 void disable_irq(irqmask);
 
 int set_interrupt_handler(unsigned int intnum, interrupt_handler_t handler);
+void irqstatinit(void);
+void irqstatclear(void);
 
 #endif /* _INTERRUPT_H_ */
@@ -8,6 +8,7 @@
 #include <interrupt.h>
 #include <kernel.h>
 #include <kexec.h>
+#include <mmu.h>
 #include <string.h>
 
 
@@ -72,6 +73,10 @@ xinu_syscall kexec(const void *kernel, unsigned int size)
     /* Copy the assembly stub into a safe location.  */
 	memcpy(COPY_KERNEL_ADDR, copy_kernel, sizeof(copy_kernel));
 
+    /* Write everything back to memory and hand over with the MMU off, as
+     * the firmware would.  */
+    mmudisable();
+
     /* Enter the assembly stub to copy the new kernel into its final location,
      * then pass control to it.  */
     (( void (*)(const void *, unsigned long, void *))(COPY_KERNEL_ADDR))
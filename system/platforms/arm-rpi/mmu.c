@@ -0,0 +1,155 @@
+/**
+ * @file mmu.c
+ *
+ * Boot-time translation tables for the Raspberry Pi.  Memory is mapped flat
+ * in 1MB sections: ARM RAM as write-back cacheable normal memory, the top
+ * section of ARM RAM and the GPU's memory above it as uncached normal
+ * memory, and the peripherals as device memory.  Without the MMU every
+ * data access on the ARM is uncached, whatever the cache enable bits say.
+ *
+ * See B3 "Virtual Memory System Architecture" of the ARMv7-A Architecture
+ * Reference Manual, and 6.11 "Hardware page table translation" of the
+ * ARM1176JZF-S Technical Reference Manual.
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <stdint.h>
+#include <xinu.h>
+#include <mmu.h>
+#include "rpi-platform.h"
+
+/* Section descriptor bits */
+#define MMU_SECTION		0x00002		/* Section descriptor					*/
+#define MMU_B			0x00004		/* Bufferable							*/
+#define MMU_C			0x00008		/* Cacheable							*/
+#define MMU_XN			0x00010		/* Execute never						*/
+#define MMU_AP_RW		0x00C00		/* Read/write at any privilege			*/
+#define MMU_TEX1		0x01000		/* TEX = 001							*/
+#define MMU_S			0x10000		/* Shareable							*/
+
+/* Memory types, TEX:C:B.  Shareable is added for the Pi2/Pi3 cores, the
+ * ARM1176 does not cache shareable memory. */
+#define MMU_NORMAL		(MMU_SECTION | MMU_AP_RW | MMU_TEX1 | MMU_C | MMU_B)	/* Write-back, write-allocate	*/
+#define MMU_UNCACHED	(MMU_SECTION | MMU_AP_RW | MMU_TEX1)					/* Normal, not cached			*/
+#define MMU_DEVICE		(MMU_SECTION | MMU_AP_RW | MMU_B | MMU_XN)				/* Shared device				*/
+
+#define MMU_DOMAINS		0x55555555	/* Every domain a client, AP bits apply	*/
+
+/* Table walks through the cache, write-back write-allocate */
+#define TTBR_V6			0x09		/* C, RGN = 01							*/
+#define TTBR_V7			0x4A		/* IRGN = 01, S, RGN = 01				*/
+
+/* System control register bits */
+#define SCTLR_M			0x00000001	/* MMU enable							*/
+#define SCTLR_A			0x00000002	/* Alignment fault checking				*/
+#define SCTLR_C			0x00000004	/* Data cache enable					*/
+#define SCTLR_CP15BEN	0x00000020	/* CP15 barrier operations enable		*/
+#define SCTLR_Z			0x00000800	/* Branch prediction enable				*/
+#define SCTLR_I			0x00001000	/* Instruction cache enable				*/
+#define SCTLR_XP		0x00800000	/* ARMv6 extended page tables			*/
+
+#define IO_SIZE			0x01000000	/* BCM283x peripherals					*/
+#define LOCAL_IO_BASE	0x40000000	/* BCM2836/7 ARM local peripherals		*/
+
+/* First level table, 16KB aligned as TTBR0 requires */
+uint32_t mmutable[MMU_NSECTION] __attribute__((aligned(0x4000)));
+
+/* Uncached DMA region and its free list */
+uintptr_t dmaregion;
+struct memblock dmalist;
+
+/**
+ * Build the translation table, reserve the uncached DMA region and turn on
+ * the MMU of core 0.  The caller must keep the heap below the DMA region.
+ * @param armtop  end of the memory the GPU gives the ARM
+ */
+void mmuinit (uintptr_t armtop)
+{
+	uint32_t share = iscachev7() ? MMU_S : 0;
+	uintptr_t addr;
+	unsigned int i;
+
+	armtop &= ~(MMU_SECTION_SIZE - 1);
+	dmaregion = armtop - DMA_REGION_SIZE;
+
+	for (i = 0; i < MMU_NSECTION; i++)
+	{
+		addr = i * MMU_SECTION_SIZE;
+		if (addr < dmaregion)
+		{
+			mmutable[i] = addr | MMU_NORMAL | share;				// Kernel, heap and stacks
+		}
+		else if (addr < RPi_IO_Base_Addr)
+		{
+			mmutable[i] = addr | MMU_UNCACHED | share;				// DMA region, then GPU memory and framebuffer
+		}
+		else if ((addr < RPi_IO_Base_Addr + IO_SIZE) || (LOCAL_IO_BASE == addr))
+		{
+			mmutable[i] = addr | MMU_DEVICE;						// Peripherals
+		}
+		else
+		{
+			mmutable[i] = 0;										// Fault
+		}
+	}
+
+	dmalist.next = (struct memblock *)dmaregion;
+	dmalist.length = DMA_REGION_SIZE;
+	dmalist.next->next = NULL;
+	dmalist.next->length = DMA_REGION_SIZE;
+
+	mmuenable();
+}
+
+/**
+ * Turn on the MMU and caches of the calling core with the table mmuinit()
+ * built.  Cores 1-3 call this before touching memory core 0 has written.
+ * Coherency between cores also needs the SMP bit of the auxiliary control
+ * register, which the firmware's boot stub sets.
+ */
+void mmuenable (void)
+{
+	uint32_t ttbr = (uint32_t)mmutable | (iscachev7() ? TTBR_V7 : TTBR_V6);
+	uint32_t sctlr;
+
+	dcacheInvalidateL1();											// Nothing stale from before
+	__asm__ volatile ("mcr p15, 0, %0, c8, c7, 0" : : "r" (0));		// Invalidate TLBs
+	__asm__ volatile ("mcr p15, 0, %0, c3, c0, 0" : : "r" (MMU_DOMAINS));	// DACR
+	__asm__ volatile ("mcr p15, 0, %0, c2, c0, 2" : : "r" (0));		// TTBCR, TTBR0 only
+	__asm__ volatile ("mcr p15, 0, %0, c2, c0, 0" : : "r" (ttbr));	// TTBR0
+	dsb();
+	isb();
+
+	__asm__ volatile ("mrc p15, 0, %0, c1, c0, 0" : "=r" (sctlr));	// SCTLR
+	sctlr |= SCTLR_M | SCTLR_C | SCTLR_CP15BEN | SCTLR_Z | SCTLR_I | SCTLR_XP;
+	sctlr &= ~SCTLR_A;
+	__asm__ volatile ("mcr p15, 0, %0, c1, c0, 0" : : "r" (sctlr) : "memory");
+	isb();
+
+	__asm__ volatile ("mcr p15, 0, %0, c7, c5, 0" : : "r" (0));		// Invalidate instruction cache
+	__asm__ volatile ("mcr p15, 0, %0, c7, c5, 6" : : "r" (0));		// Invalidate branch predictor
+	dsb();
+	isb();
+}
+
+/**
+ * Write back the data cache and turn off the MMU and data cache of the
+ * calling core, leaving memory as a kernel loaded by the firmware expects
+ * to find it.  Interrupts must be disabled.
+ */
+void mmudisable (void)
+{
+	uint32_t sctlr;
+
+	dcacheFlushAll();
+	__asm__ volatile ("mrc p15, 0, %0, c1, c0, 0" : "=r" (sctlr));	// SCTLR
+	sctlr &= ~(SCTLR_M | SCTLR_C);
+	__asm__ volatile ("mcr p15, 0, %0, c1, c0, 0" : : "r" (sctlr) : "memory");
+	isb();
+
+	__asm__ volatile ("mcr p15, 0, %0, c8, c7, 0" : : "r" (0));		// Invalidate TLBs
+	__asm__ volatile ("mcr p15, 0, %0, c7, c5, 0" : : "r" (0));		// Invalidate instruction cache
+	__asm__ volatile ("mcr p15, 0, %0, c7, c5, 6" : : "r" (0));		// Invalidate branch predictor
+	dsb();
+	isb();
+}
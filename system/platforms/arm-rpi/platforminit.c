@@ -8,6 +8,8 @@
 #include <framebuffer.h>
 #include <usbkbd.h>
 #include <stdio.h>
+#include <mmu.h>
+#include "interrupt.h"
 #include "rpi-platform.h"
 #include "rpi-mailbox.h"
 
@@ -150,6 +152,9 @@ int platforminit(void)
     strlcpy(platform.name, "Raspberry Pi", PLT_STRMAX);
 	platform.minaddr = 0;
 	platform.maxaddr = RPi_LastARMAddr();					// Get last memory address valid on the ARM from mailbox
+	mmuinit(platform.maxaddr);								// Caches on, uncached DMA region at top of ARM memory
+	platform.maxaddr = dmaregion;							// Heap stops below the DMA region
+	irqstatinit();											// Cycle counter for timing interrupt handlers
     platform.clkfreq = 1000000;
     platform.serial_low = 0;   /* Used only if serial # not found in atags */
     platform.serial_high = 0;  /* Used only if serial # not found in atags */
@@ -1,5 +1,7 @@
 #include <stdint.h>				// As all the registers are 32 it make sense to use uint32_t
 #include <xinu.h>				// Needed for SYSERR an OK return values
+#include <mmu.h>				// Uncached memory for the messages
+#include <string.h>				// Needed for memcpy
 #include "CriticalSection.h"	// Need access to stop interrupts for critical section
 #include "rpi-platform.h"		// The generic pi platform header
 #include "rpi-mailbox.h"		// This units header
@@ -35,6 +37,12 @@ struct __attribute__((__packed__, aligned(4))) MailBoxRegisters {
 #define MAIL_EMPTY	0x40000000		/* Mailbox Status Register: Mailbox Empty */
 #define MAIL_FULL	0x80000000		/* Mailbox Status Register: Mailbox Full  */
 
+#define MAIL_BUFSIZE	1024		/* Largest message copied to uncached memory */
+#define MAIL_FBSIZE		40			/* Frame buffer channel message size		 */
+
+/* Uncached copy of the message in flight, once the MMU is on */
+static uint32_t *mailbuf = NULL;
+
 /*-[rpi_mailbox_read]-------------------------------------------------------}
 . This will read any pending data on the mailbox system on the given channel.
 . RETURN: Read value if success, 0x1 for failure as low 4 bits will be zero.
@@ -77,16 +85,37 @@ int rpi_mailbox_write (MAILBOX_CHANNEL channel, uint32_t message)
 . mailbox system on the given channel but disabling context switching.
 . This is required because when a PI mailbox message is posted a response
 . must be read before any chance of another PI mailbox message sent.
+. Once the data cache is on, tag and frame buffer messages are copied to
+. uncached memory for the GPU to read and answer, and copied back.
 . RETURN: OK for success, SYSERR for failure.
 .--------------------------------------------------------------------------*/
 int rpi_MailBoxAccess (uint32_t channel, uint32_t msg)
 {
 	int status = SYSERR;											// Preset status as system error
+	uint32_t *buf = (uint32_t *)(msg & ~RPi_ARM_TO_GPU_Alias);		// Message as the ARM sees it
+	unsigned int size = 0;											// Bytes copied through mailbuf
 	ENTER_KERNEL_CRITICAL_SECTION();								// CRITICAL SECTION START no context switch allowed
+	if ((0 != dmaregion) && (NULL == mailbuf)) {					// MMU is on but no uncached buffer yet
+		mailbuf = dmaget(MAIL_BUFSIZE);
+		if ((void *)SYSERR == mailbuf) mailbuf = NULL;
+	}
+	if (NULL != mailbuf) {
+		if (channel == MB_CHANNEL_TAGS) size = buf[0];				// Tag messages start with their size
+		else if (channel == MB_CHANNEL_FB) size = MAIL_FBSIZE;
+		if (size > MAIL_BUFSIZE) {
+			size = 0;												// Too big, maintain the cache instead
+			dcacheFlush(buf, buf[0]);
+		} else if (size > 0) {
+			memcpy(mailbuf, buf, size);
+			msg = (uint32_t)mailbuf | RPi_ARM_TO_GPU_Alias;
+		}
+	}
 	if ( (rpi_mailbox_write(channel, msg) & 0xF) == 0x0) {			// We know write worked if low 4 bits are zero
 		uint32_t result = rpi_mailbox_read(channel);				// Read the status back
 		if ( (result & 0xF) == 0x0) status = OK;					// We know read worked if low 4 bits are zero
 	}
+	if (size > 0) memcpy(buf, mailbuf, size);						// Copy the response back
+	else if ((NULL != mailbuf) && (channel == MB_CHANNEL_TAGS)) dcacheInvalidate(buf, buf[0]);
 	EXIT_KERNEL_CRITICAL_SECTION();									// END OF CRITICAL SECTION
 	return status;													// Return fail or success of call
 }
\ No newline at end of file
@@ -64,11 +64,11 @@ unsigned long clkcount(void)
 	unsigned long count;
 #if __SIZEOF_LONG__ == 8											// GCC compiler will set this its specified
 	uint32_t hicount;
-	uint32_t loCount;
+	uint32_t lowcount;
 	do {
-		hicount = SYSTEMTIMER->CHI; 								// Read Arm system timer high count
-		lowCount = SYSTEMTIMER->CLO;								// Read Arm system timer low count
-	} while (hicount != SYSTEMTIMER->CHI);							// Check hi counter hasn't rolled during last read
+		hicount = SYSTEM_TIMER->CHI; 								// Read Arm system timer high count
+		lowcount = SYSTEM_TIMER->CLO;								// Read Arm system timer low count
+	} while (hicount != SYSTEM_TIMER->CHI);							// Check hi counter hasn't rolled during last read
 	count = ((uint64_t)hicount << 32) | lowcount;					// Join the 32 bit values to a full 64 bit
 #else
 	count = SYSTEM_TIMER->CLO;
@@ -98,3 +98,27 @@ void clkupdate (unsigned long cycles)
 	 * 32 bits.  */
 	SYSTEM_TIMER->C3 = SYSTEM_TIMER->CLO + cycles;
 }
+
+#if TICKLESS
+/* Fewest counter cycles C3 may be set ahead of CLO and still match */
+#define CLKALARM_MIN_CYCLES 2
+
+/* clkalarm() interface is documented in clock.h  */
+void clkalarm (unsigned long count)
+{
+	uint32_t now;
+
+	/* Clear any pending match, exactly as clkupdate() does.  */
+	SYSTEM_TIMER->CS = BCM2835_SYSTEM_TIMER_MATCH_3;
+
+	/* C3 only compares against the low 32 bits of the counter, so a target
+	 * that has already gone by would not match again for over an hour.
+	 * Pull such targets forward to just ahead of the counter.  */
+	now = SYSTEM_TIMER->CLO;
+	if ((int32_t)((uint32_t)count - now) < CLKALARM_MIN_CYCLES)
+	{
+		count = now + CLKALARM_MIN_CYCLES;
+	}
+	SYSTEM_TIMER->C3 = (uint32_t)count;
+}
+#endif
@@ -20,6 +20,13 @@
  * rest spill onto the stack.  */
 #define MAX_REG_ARGS 4
 
+/* Context record word holding r4, which carries the thread procedure address
+ * through thrstart.  */
+#define PROCADDR_WORD 4
+
+/* In ctxsw.S: releases the kernel lock resched() holds, then jumps to r4 */
+extern void thrstart(void);
+
 /** Set up the context record and arguments on the stack for a new thread
  * (ARM version)  */
 void *setupStack(void *stackaddr, void *procaddr,
@@ -66,20 +73,22 @@ void *setupStack(void *stackaddr, void *procaddr,
         saddr[i + FPU_WORDS] = va_arg(ap, unsigned long);
     }
 
-    for (; i < CONTEXT_WORDS + FPU_WORDS - 3; i++)
+    for (; i < CONTEXT_WORDS - 3; i++)
     {
         saddr[i + FPU_WORDS] = 0;
     }
 
-    /* Control bits of program status register
-     * (SYS mode, IRQs initially enabled) */
-    saddr[CONTEXT_WORDS + FPU_WORDS - 3] = ARM_MODE_SYS | ARM_F_BIT;
+    /* Control bits of program status register (SYS mode, IRQs disabled
+     * until thrstart has released the kernel lock) */
+    saddr[CONTEXT_WORDS + FPU_WORDS - 3] = ARM_MODE_SYS | ARM_I_BIT | ARM_F_BIT;
 
     /* return address  */
     saddr[CONTEXT_WORDS + FPU_WORDS - 2] = (uint32_t)retaddr;
 
-    /* program counter  */
-    saddr[CONTEXT_WORDS + FPU_WORDS - 1] = (uint32_t)procaddr;
+    /* program counter: new threads start in thrstart, which enters the
+     * thread procedure held in r4 once the kernel lock is released  */
+    saddr[PROCADDR_WORD + FPU_WORDS] = (uint32_t)procaddr;
+    saddr[CONTEXT_WORDS + FPU_WORDS - 1] = (uint32_t)thrstart;
 
     /* Arguments spilled onto stack (not part of context record)  */
     for (i = 0; i < spilled_nargs; i++)
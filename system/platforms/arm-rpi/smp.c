@@ -0,0 +1,202 @@
+/**
+ * @file smp.c
+ *
+ * Brings cores 1-3 of the BCM2836/BCM2837 out of the start.S secondary spin
+ * loop and into the scheduler, and handles the per-core interrupts they need:
+ * a mailbox used as an inter-processor "reschedule" signal and the core's own
+ * generic (virtual) timer for preemption.  GPU interrupts, the system timer
+ * and the sleep queue all stay with core 0.
+ *
+ * See the "Quad-A7 control" document (QA7_rev3.4.pdf) for the ARM local
+ * peripherals at 0x40000000.
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <kernel.h>
+#include <clock.h>
+#include <thread.h>
+#include <queue.h>
+#include <mmu.h>
+#include "CriticalSection.h"
+#include "rpi-platform.h"
+
+#if NCORE > 1
+
+/*==========================================================================}
+{			  ARM LOCAL PERIPHERALS - QA7 Control Section 4					}
+{--------------------------------------------------------------------------*/
+/* The packing and alignment required for 64 bit compiler and not optional  }
+{==========================================================================*/
+struct __attribute__((__packed__, aligned(4))) qa7_local_regs
+{
+	uint32_t Control;				/** 0x00 Control register				*/
+	uint32_t _unused1;				/** 0x04								*/
+	uint32_t CoreTimerPrescaler;	/** 0x08 Core timer prescaler			*/
+	uint32_t GPUIntRouting;			/** 0x0C GPU interrupts routing			*/
+	uint32_t _unused2[12];			/** 0x10 - 0x3C							*/
+	uint32_t TimerIntControl[4];	/** 0x40 Core n timers interrupt control	*/
+	uint32_t MailboxIntControl[4];	/** 0x50 Core n mailbox interrupt control	*/
+	uint32_t IRQSource[4];			/** 0x60 Core n IRQ source				*/
+	uint32_t FIQSource[4];			/** 0x70 Core n FIQ source				*/
+	uint32_t MailboxSet[4][4];		/** 0x80 Core n mailbox m write-set		*/
+	uint32_t MailboxClear[4][4];	/** 0xC0 Core n mailbox m read/clear	*/
+};
+
+/*--------------------------------------------------------------------------}
+;{				  ARM LOCAL PERIPHERALS REGISTER LOCATION					}
+;{-------------------------------------------------------------------------*/
+#define QA7_LOCAL ((volatile __attribute__((aligned(4))) struct qa7_local_regs*)(0x40000000))
+
+#define QA7_IRQ_CNTV		(1 << 3)	/* Virtual timer interrupt			*/
+#define QA7_IRQ_MAILBOX0	(1 << 4)	/* Mailbox 0 interrupt				*/
+
+#define IPI_MAILBOX			0			/* Mailbox carrying reschedule signals	*/
+#define BOOT_MAILBOX		3			/* Mailbox start.S spins on			*/
+
+#define ARM1176_PART_NUMBER	0xB76		/* Pi1 ARM6 CPU has a single core	*/
+
+/* Stack each core uses between leaving SecondarySpin and switching to its
+ * null thread.  start.S expects 1KB per core (lsl #10).  */
+uint64_t coreboot_stack[NCORE][128];
+
+/* Null thread of each core, always ready to run on that core alone */
+static tid_typ corenull[NCORE];
+
+/* Secondary core entry point in start.S */
+extern void SecondaryCoreEntry(void);
+extern void ctxsw(void *, void *);
+extern void dmb(void);
+
+/* Generic timer counts per scheduler tick */
+static uint32_t coreticks;
+
+static inline void cntv_arm (uint32_t count)
+{
+	__asm__ volatile ("mcr p15, 0, %0, c14, c3, 0" : : "r" (count));	// CNTV_TVAL
+	__asm__ volatile ("mcr p15, 0, %0, c14, c3, 1" : : "r" (1));		// CNTV_CTL enable, unmasked
+}
+
+/* Null thread for cores 1-3; nothing to do but wait for an interrupt */
+static thread corenullthread (void)
+{
+	while (TRUE)
+	{
+		pause();
+	}
+	return OK;
+}
+
+/**
+ * C entry point of cores 1-3, reached from SecondaryCoreEntry with IRQs
+ * disabled on the core's boot stack.  Sets up the core's local interrupts
+ * and becomes its null thread; never returns.
+ * @param core  index of this core
+ */
+void coreentry (unsigned int core)
+{
+	struct thrent *thrptr;
+	void *bootsp;
+
+	mmuenable();													// Join core 0's coherent cached view of memory
+	thrptr = &thrtab[corenull[core]];
+	QA7_LOCAL->MailboxIntControl[core] = (1 << IPI_MAILBOX);		// Reschedule signals interrupt this core
+	QA7_LOCAL->TimerIntControl[core] = QA7_IRQ_CNTV;				// So does its virtual timer
+	cntv_arm(coreticks);											// Start preemption ticks
+
+	kernel_lock();													// Released by thrstart in the null thread
+	corecurrent[core] = corenull[core];
+	thrptr->state = THRCURR;
+	coresonline++;													// Core 0 waits for this
+	dmb();
+	ctxsw(&bootsp, &thrptr->stkptr);								// Never comes back here
+}
+
+/**
+ * Start the scheduler on cores 1-3.  Called once by core 0 from nulluser()
+ * after the kernel is initialized.  Does nothing on a single core Pi1, or
+ * when the cores were not parked in SecondarySpin by start.S.
+ */
+void corestart (void)
+{
+	unsigned int core;
+	unsigned int wait;
+	char name[TNMLEN];
+
+	if ((ARM1176_PART_NUMBER == RPi_CpuId.PartNumber) || (RPi_CoresReady < NCORE))
+	{
+		return;
+	}
+
+	__asm__ volatile ("mrc p15, 0, %0, c14, c0, 0" : "=r" (coreticks));	// CNTFRQ
+	coreticks /= CLKTICKS_PER_SEC;
+	QA7_LOCAL->MailboxIntControl[0] = (1 << IPI_MAILBOX);			// Core 0 takes reschedule signals too
+
+	for (core = 1; core < NCORE; core++)
+	{
+		sprintf(name, "prnull%u", core);
+		corenull[core] = createon(core, (void *)corenullthread, MINSTK * 4, 0, name, 0);
+		if (SYSERR == corenull[core])
+		{
+			break;
+		}
+		thrcount--;													// Like prnull it is not a user thread
+
+		/* The core starts with its caches off and reads main memory, so
+		 * everything set up for it so far must be written back first */
+		dcacheFlushAll();
+		dsb();
+
+		QA7_LOCAL->MailboxSet[core][BOOT_MAILBOX] = (uint32_t)SecondaryCoreEntry;
+		dmb();
+		__asm__ volatile ("sev");									// Wake it from its wfe spin
+
+		for (wait = 0; (coresonline <= core) && (wait < 1000); wait++)
+		{
+			udelay(100);
+		}
+		if (coresonline <= core)
+		{
+			kprintf("Core %u failed to start\r\n", core);
+			thrcount++;												// kill() will take it off again
+			kill(corenull[core]);
+			break;
+		}
+	}
+}
+
+/**
+ * Signal a core to reschedule.
+ * @param core  index of the core to signal
+ */
+void coresignal (unsigned int core)
+{
+	QA7_LOCAL->MailboxSet[core][IPI_MAILBOX] = 1;
+}
+
+/**
+ * Handle the interrupts local to the calling core: reschedule signals and
+ * the core's preemption timer.  Called from dispatch() with rescheduling
+ * deferred, so the switch happens once the whole batch is handled.
+ */
+void coredispatch (void)
+{
+	unsigned int core = getcpuid();
+	uint32_t source = QA7_LOCAL->IRQSource[core];
+
+	if (source & QA7_IRQ_MAILBOX0)
+	{
+		QA7_LOCAL->MailboxClear[core][IPI_MAILBOX] = 0xFFFFFFFF;	// Acknowledge all signals
+	}
+	if (source & QA7_IRQ_CNTV)
+	{
+		cntv_arm(coreticks);										// Next preemption tick
+	}
+	if (source & (QA7_IRQ_MAILBOX0 | QA7_IRQ_CNTV))
+	{
+		resched();
+	}
+}
+
+#endif /* NCORE > 1 */
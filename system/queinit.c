@@ -33,3 +33,36 @@ qid_typ queinit (void)
     quetab[quetail(q)].key = MINKEY;
     return q;
 }
+
+/**
+ * @ingroup threads
+ *
+ * Initialize the ready lists as NPRIO consecutive queues per core, one
+ * FIFO per priority level.  The returned queue ID is the head of level 0
+ * of core 0; the queue for priority p on core c is at rdqhead(c, p).
+ * @return queue ID of the ready list or SYSERR
+ */
+qid_typ readyinit (void)
+{
+    qid_typ first, q;
+    int i;
+
+    first = queinit();
+    if (SYSERR == first)
+    {
+        return SYSERR;
+    }
+    for (i = 1; i < NPRIO * NCORE; i++)
+    {
+        q = queinit();
+        if (SYSERR == q)
+        {
+            return SYSERR;
+        }
+    }
+    for (i = 0; i < RDQ_NWORDS * NCORE; i++)
+    {
+        rdqbitmap[i] = 0;
+    }
+    return first;
+}
@@ -9,11 +9,13 @@
 #include <queue.h>
 
 struct queent quetab[NQENT];    /**< global thread queue table       */
+unsigned int rdqbitmap[RDQ_NWORDS * NCORE]; /**< non-empty ready levels */
 
 /**
  * @ingroup threads
  *
- * Insert a thread at the tail of a queue
+ * Insert a thread at the tail of a queue.  The ready list has one tail
+ * per priority level, so there the thread joins the tail of its own.
  * @param  tid  thread ID to enqueue
  * @param  q    target queue
  * @return thread id of enqueued thread
@@ -26,6 +28,10 @@ tid_typ enqueue(tid_typ tid, qid_typ q)
     {
         return SYSERR;
     }
+    if (q == readylist)
+    {
+        return (OK == insert(tid, q, thrtab[tid].prio)) ? tid : SYSERR;
+    }
 
     tail = quetail(q);
     prev = quetab[tail].prev;
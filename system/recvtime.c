@@ -30,6 +30,10 @@ xinu_message recvtime (int maxwait)
     if (FALSE == thrptr->hasmsg)
     {
 #if RTCLOCK == TRUE
+#if TICKLESS
+        /* Time the wait from now, not from the last timer interrupt. */
+        clkcatchup();
+#endif
         if (SYSERR == insertd(thrcurrent, sleepq, maxwait))
         {
 			EXIT_KERNEL_CRITICAL_SECTION();
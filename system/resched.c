@@ -9,10 +9,12 @@
 #include <clock.h>
 #include <queue.h>
 #include <memory.h>
+#include <CriticalSection.h>
 
 extern void ctxsw(void *, void *);
+extern void halt(void);
 
-int resdefer = 0;				/* >0 if rescheduling deferred */
+int resdefer[NCORE];			/* >0 if rescheduling deferred, per core */
 
 /**
  * @ingroup threads
@@ -20,27 +22,61 @@ int resdefer = 0;				/* >0 if rescheduling deferred */
  * Reschedule processor to highest priority ready thread.
  * Upon entry, thrcurrent gives current thread id.
  * Threadtab[thrcurrent].pstate gives correct NEXT state
- * for current thread if other than THRREADY.
+ * for current thread if other than THRREADY.  A current thread left in
+ * THRMIGRATE is put back on the ready list of the core it is pinned to,
+ * and one that has been killed dies here.  The stacks of threads that
+ * died earlier are freed once their cores have switched away from them.
+ * The kernel lock is held across the context switch and released by
+ * the thread switched to.
+ *
+ * The caller must not hold the kernel lock: a thread switched out inside a
+ * critical section would keep every other core out until it ran again.
+ * Anything that may reschedule, such as wait(), signal() or send(), is
+ * called after EXIT_KERNEL_CRITICAL_SECTION().  Interrupt handlers instead
+ * set this core's ::resdefer, which holds rescheduling off until they are
+ * done.
  * @return OK when the thread is context switched back
  */
 int resched (void)
 {
     struct thrent *throld;      /* old thread entry */
     struct thrent *thrnew;      /* new thread entry */
+    irqmask intmask;            /* interrupt state on entry */
 
-    if (resdefer > 0)												// If reschedule deferred
-    {											 
-        resdefer++;													// Increment count
+    intmask = disable();											// Interrupts off before we look at this core
+    if (resdefer[getcpuid()] > 0)									// If reschedule deferred on this core
+    {
+        resdefer[getcpuid()]++;										// Increment count
+        restore(intmask);											// Restore the interrupt mask
         return (OK);												// Return back to the thread
     }
-
+    if (kernel_locked())											// Caller is in a critical section
+    {
+        kprintf("resched: thread %d holds the kernel lock\r\n", thrcurrent);
+        halt();														// Would stall every other core
+    }
+    kernel_lock();													// Keep other cores out of the ready lists
     throld = &thrtab[thrcurrent];									// Current thread pointer is thread at the current thread id
-    throld->intmask = disable();									// Save its interrupt masks
-    if (THRCURR == throld->state)									// Check the thread state is current
+    throld->intmask = intmask;										// Save its interrupt masks
+    thrreap();														// Free stacks no core runs on any more
+    if (throld->killed)												// Thread was killed while it ran
+    {
+        thrdie(thrcurrent);											// Never runs again
+    }
+    else if (THRMIGRATE == throld->state)								// Thread asked to move to another core
+    {
+        throld->state = THRREADY;									// Set the thread state to ready
+        insert(thrcurrent, readylist, throld->prio);				// Ready list of its pinned core gets it
+    }
+    else if (THRCURR == throld->state)									// Check the thread state is current
     {
         if (nonempty(readylist) &&									// If non threads in ready list 
 			(throld->prio > firstkey(readylist)))					// OR current thread priority greater than first on ready list
         {
+#if TICKLESS
+            clkrearm();												// Timer only needs the next sleeper
+#endif
+            kernel_unlock();										// Release the kernel lock
             restore(throld->intmask);								// Restore the interrupt mask
             return OK;												// Return back to the thread
         }
@@ -52,12 +88,21 @@ int resched (void)
     thrcurrent = dequeue(readylist);								// Dequeue the thread we are switching to
     thrnew = &thrtab[thrcurrent];									// Retrieve the pointer to that new thread we are switching to 									
     thrnew->state = THRCURR;										// Set the new thread state to current
+    if (!thrnew->coreaffinity)										// Unpinned threads remember their core
+    {
+        thrnew->coreid = getcpuid();
+    }
+#if TICKLESS
+    clkrearm();														// Program next sleeper or quantum for new thread
+#endif
 
     /* change address space identifier to thread id */
    // asid = thrcurrent & 0xff;										// Address space identifier
 	ctxsw(&throld->stkptr, &thrnew->stkptr);						// Call the context switch
 
     /* old thread returns here when resumed */
+    thrreap();														// Thread switched from may have died
+    kernel_unlock();												// Release lock taken by the thread we came from
     restore(throld->intmask);										// Restore the interrupt masks
     return OK;
 }
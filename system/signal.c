@@ -14,8 +14,8 @@
  * Signal a semaphore, releasing up to one waiting thread.
  *
  * signal() may reschedule the currently running thread.  As a result, signal()
- * should not be called from non-reentrant interrupt handlers unless ::resdefer
- * is set to a positive value at the start of the interrupt handler.
+ * should not be called from non-reentrant interrupt handlers unless the core's
+ * ::resdefer is set to a positive value at the start of the interrupt handler.
  *
  * @param sem
  *      Semaphore to signal.
@@ -15,7 +15,8 @@
  *
  * signaln() may reschedule the currently running thread.  As a result,
  * signaln() should not be called from non-reentrant interrupt handlers unless
- * ::resdefer is set to a positive value at the start of the interrupt handler.
+ * the core's ::resdefer is set to a positive value at the start of the
+ * interrupt handler.
  *
  * @param sem
  *      Semaphore to signal.
@@ -0,0 +1,219 @@
+/**
+ * @file slab.c
+ *
+ * Size-class slabs for small kernel allocations.  A fixed arena of pages is
+ * taken from the heap at boot.  Each page, while in use, serves objects of a
+ * single size class, so memget() and memfree() of small blocks are O(1) and
+ * never walk or fragment ::memlist.  Requests the arena cannot satisfy fall
+ * back to the free list.
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <xinu.h>
+#include <CriticalSection.h>
+#include <memory.h>
+
+uintptr_t slabarena;                        /* Base of arena, 0 if none   */
+struct slabpage slabtab[SLAB_NPAGES];       /* Page descriptors           */
+
+static struct slabpage *slabfreepages;      /* Pages serving no class     */
+static struct slabpage *slabpartial[SLAB_NCLASS];   /* Pages with room    */
+
+/* Object size of each class, all multiples of the memblock size */
+static const unsigned short slabsize[SLAB_NCLASS] = {
+    8, 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512
+};
+
+/* Class of each rounded request size, indexed by (nbytes - 1) / 8 */
+static unsigned char slabclass[SLAB_MAXSIZE / 8];
+
+/**
+ * @ingroup memory_mgmt
+ *
+ * Take the slab arena from the heap and build the size class table.  Called
+ * once from sysinit() after ::memlist is set up.  If the heap cannot spare
+ * the arena, slabs stay disabled and every request uses the free list.
+ */
+void slabinit(void)
+{
+    int i, c;
+    void *arena;
+
+    for (i = 0, c = 0; i < SLAB_MAXSIZE / 8; i++)
+    {
+        if ((i + 1) * 8 > slabsize[c])
+        {
+            c++;
+        }
+        slabclass[i] = c;
+    }
+
+    slabarena = 0;
+    slabfreepages = NULL;
+    for (c = 0; c < SLAB_NCLASS; c++)
+    {
+        slabpartial[c] = NULL;
+    }
+
+    arena = memget(SLAB_NPAGES * SLAB_PAGESIZE);
+    if ((void *)SYSERR == arena)
+    {
+        return;
+    }
+    for (i = SLAB_NPAGES - 1; i >= 0; i--)
+    {
+        slabtab[i].sclass = SLAB_NCLASS;
+        slabtab[i].next = slabfreepages;
+        slabfreepages = &slabtab[i];
+    }
+    slabarena = (uintptr_t)arena;
+}
+
+/**
+ * @ingroup memory_mgmt
+ *
+ * Allocate a small object from the slab arena.
+ *
+ * @param nbytes
+ *      Number of bytes requested, at most ::SLAB_MAXSIZE.
+ *
+ * @return
+ *      Pointer to an 8-byte aligned object, or ::SYSERR if @p nbytes is out
+ *      of range or the arena has no room for its class.
+ */
+void *slabget(unsigned int nbytes)
+{
+    struct slabpage *page;
+    unsigned int sclass, index;
+    uintptr_t base;
+    void *obj;
+
+    if ((0 == nbytes) || (nbytes > SLAB_MAXSIZE))
+    {
+        return (void *)SYSERR;
+    }
+    sclass = slabclass[(nbytes - 1) >> 3];
+
+	ENTER_KERNEL_CRITICAL_SECTION();
+    page = slabpartial[sclass];
+    if (NULL == page)
+    {
+        /* Give the class a fresh page, carved lazily as objects go out */
+        page = slabfreepages;
+        if (NULL == page)
+        {
+			EXIT_KERNEL_CRITICAL_SECTION();
+            return (void *)SYSERR;
+        }
+        slabfreepages = page->next;
+        page->next = NULL;
+        page->prev = NULL;
+        page->free = NULL;
+        page->carved = 0;
+        page->inuse = 0;
+        page->sclass = sclass;
+        slabpartial[sclass] = page;
+    }
+
+    index = page - slabtab;
+    base = slabarena + index * SLAB_PAGESIZE;
+    if (NULL != page->free)
+    {
+        obj = page->free;
+        page->free = *(void **)obj;
+    }
+    else
+    {
+        obj = (void *)(base + page->carved * slabsize[sclass]);
+        page->carved++;
+    }
+
+    /* A full page leaves the class list until an object comes back */
+    if ((++page->inuse == SLAB_PAGESIZE / slabsize[sclass]))
+    {
+        slabpartial[sclass] = page->next;
+        if (NULL != page->next)
+        {
+            page->next->prev = NULL;
+        }
+        page->next = NULL;
+    }
+	EXIT_KERNEL_CRITICAL_SECTION();
+    return obj;
+}
+
+/**
+ * @ingroup memory_mgmt
+ *
+ * Return an object to its slab.  A page whose last object is freed goes back
+ * to the arena for any class to use.
+ *
+ * @param memptr
+ *      Object allocated with slabget().
+ * @param nbytes
+ *      Size passed to slabget().
+ *
+ * @return
+ *      ::OK on success; ::SYSERR if @p memptr is not an allocated object of
+ *      the size class of @p nbytes.
+ */
+xinu_syscall slabfree(void *memptr, unsigned int nbytes)
+{
+    struct slabpage *page;
+    unsigned int sclass, offset;
+
+    if (!isslab(memptr) || (0 == nbytes) || (nbytes > SLAB_MAXSIZE))
+    {
+        return SYSERR;
+    }
+    sclass = slabclass[(nbytes - 1) >> 3];
+    offset = ((uintptr_t)memptr - slabarena) % SLAB_PAGESIZE;
+    page = &slabtab[((uintptr_t)memptr - slabarena) / SLAB_PAGESIZE];
+
+	ENTER_KERNEL_CRITICAL_SECTION();
+    if ((page->sclass != sclass) || (0 != offset % slabsize[sclass])
+        || (offset >= page->carved * slabsize[sclass]) || (0 == page->inuse))
+    {
+		EXIT_KERNEL_CRITICAL_SECTION();
+        return SYSERR;
+    }
+
+    /* A full page rejoins its class list */
+    if (page->inuse == SLAB_PAGESIZE / slabsize[sclass])
+    {
+        page->prev = NULL;
+        page->next = slabpartial[sclass];
+        if (NULL != page->next)
+        {
+            page->next->prev = page;
+        }
+        slabpartial[sclass] = page;
+    }
+
+    *(void **)memptr = page->free;
+    page->free = memptr;
+
+    if (0 == --page->inuse)
+    {
+        /* Unlink the empty page and hand it back to the arena */
+        if (NULL != page->prev)
+        {
+            page->prev->next = page->next;
+        }
+        else
+        {
+            slabpartial[sclass] = page->next;
+        }
+        if (NULL != page->next)
+        {
+            page->next->prev = page->prev;
+        }
+        page->sclass = SLAB_NCLASS;
+        page->next = slabfreepages;
+        slabfreepages = page;
+    }
+	EXIT_KERNEL_CRITICAL_SECTION();
+    return OK;
+}
@@ -34,6 +34,10 @@ xinu_syscall sleep (unsigned int ms)
 	ENTER_KERNEL_CRITICAL_SECTION();
     if (ticks > 0)
     {
+#if TICKLESS
+        /* Time the sleep from now, not from the last timer interrupt. */
+        clkcatchup();
+#endif
         if (SYSERR == insertd(thrcurrent, sleepq, ticks))
         {
 			EXIT_KERNEL_CRITICAL_SECTION();
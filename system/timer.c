@@ -0,0 +1,383 @@
+/**
+ * @file timer.c
+ *
+ * Hierarchical timing wheel behind the kernel timer service.  Level 0 has
+ * a slot for each of the next ::TIMER_NSLOT ticks; each level above has a
+ * slot for each of the next ::TIMER_NSLOT spans of the level below.  When
+ * the lower level wraps, the next slot of the level above is cascaded down
+ * into it.  Slots are doubly linked lists, so a timer is added or removed
+ * without searching.  All wheel state is guarded by the kernel critical
+ * section; timer functions run in the timer thread with it released.  The
+ * timer thread sleeps until the next tick that has work to do, and skips
+ * the wheel straight over the empty ticks in between.
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <clock.h>
+#include <CriticalSection.h>
+#include <thread.h>
+#include <timer.h>
+
+#define TIMER_MASK  (TIMER_NSLOT - 1)
+
+static struct timer *timerwheel[TIMER_NLEVEL][TIMER_NSLOT];
+static unsigned long timernow;          /* Current wheel tick */
+static unsigned int timercount;         /* Timers on the wheel */
+static bool timeridle;                  /* Timer thread waiting for work */
+static unsigned long timerdue;          /* Tick timer thread sleeps until */
+static tid_typ timertid;                /* Timer thread */
+
+/**
+ * Milliseconds since boot, wrapping.
+ */
+static unsigned long timerMs(void)
+{
+    unsigned long sec, usec;
+
+    clkgettime(&sec, &usec);
+    return sec * 1000 + usec / 1000;
+}
+
+/**
+ * Link a timer into the slot for its expiry tick.  Must be called inside a
+ * kernel critical section.
+ */
+static void timerAdd(struct timer *tmr)
+{
+    unsigned long delta = tmr->expires - timernow;
+    struct timer **slot;
+    int level = 0;
+
+    while ((level < TIMER_NLEVEL - 1)
+           && (delta >> (TIMER_SLOTBITS * (level + 1))))
+    {
+        level++;
+    }
+    slot = &timerwheel[level][(tmr->expires >> (TIMER_SLOTBITS * level))
+                              & TIMER_MASK];
+
+    tmr->next = *slot;
+    if (NULL != tmr->next)
+    {
+        tmr->next->pprev = &tmr->next;
+    }
+    tmr->pprev = slot;
+    *slot = tmr;
+}
+
+/**
+ * Unlink a pending timer.  Must be called inside a kernel critical section.
+ */
+static void timerUnlink(struct timer *tmr)
+{
+    *tmr->pprev = tmr->next;
+    if (NULL != tmr->next)
+    {
+        tmr->next->pprev = tmr->pprev;
+    }
+    tmr->next = NULL;
+    tmr->pprev = NULL;
+}
+
+/**
+ * Find the next tick with work on it: either a level 0 slot with timers
+ * in it, or a cascade of a non-empty slot from a level above.  Must be
+ * called inside a kernel critical section.
+ * @return ticks from now until that tick, at least 1
+ */
+static unsigned long timerNext(void)
+{
+    unsigned long next = ~0UL;
+    unsigned long base, tick;
+    int level, shift, i;
+
+    for (i = 1; i < TIMER_NSLOT; i++)
+    {
+        if (NULL != timerwheel[0][(timernow + i) & TIMER_MASK])
+        {
+            next = i;
+            break;
+        }
+    }
+
+    for (level = 1; level < TIMER_NLEVEL; level++)
+    {
+        shift = TIMER_SLOTBITS * level;
+        base = timernow >> shift;
+        for (i = 1; i <= TIMER_NSLOT; i++)
+        {
+            tick = (base + i) << shift;
+            if (tick - timernow >= next)
+            {
+                break;
+            }
+            if (NULL != timerwheel[level][(base + i) & TIMER_MASK])
+            {
+                next = tick - timernow;
+                break;
+            }
+        }
+    }
+
+    return next;
+}
+
+/**
+ * Advance the wheel one tick and run every timer that expires on it.
+ */
+static void timerTick(void)
+{
+    struct timer *run, *tmr;
+    void (*func) (void *);
+    void *arg;
+    int level;
+
+	ENTER_KERNEL_CRITICAL_SECTION();
+    timernow++;
+
+    /* Each level that wrapped pulls its next slot down a level */
+    for (level = 1; level < TIMER_NLEVEL; level++)
+    {
+        if (timernow & ((1UL << (TIMER_SLOTBITS * level)) - 1))
+        {
+            break;
+        }
+        run = timerwheel[level][(timernow >> (TIMER_SLOTBITS * level))
+                                & TIMER_MASK];
+        timerwheel[level][(timernow >> (TIMER_SLOTBITS * level))
+                          & TIMER_MASK] = NULL;
+        while (NULL != (tmr = run))
+        {
+            run = tmr->next;
+            timerAdd(tmr);
+        }
+    }
+
+    /* Move the due timers to a list of our own, still cancellable */
+    run = timerwheel[0][timernow & TIMER_MASK];
+    timerwheel[0][timernow & TIMER_MASK] = NULL;
+    if (NULL != run)
+    {
+        run->pprev = &run;
+    }
+
+    while (NULL != (tmr = run))
+    {
+        func = tmr->func;
+        arg = tmr->arg;
+        timerUnlink(tmr);
+        timercount--;
+		EXIT_KERNEL_CRITICAL_SECTION();
+        func(arg);
+		ENTER_KERNEL_CRITICAL_SECTION();
+    }
+	EXIT_KERNEL_CRITICAL_SECTION();
+}
+
+/**
+ * @ingroup timer
+ *
+ * Initialize the timer service and start its thread.
+ * @return OK if the service started, otherwise SYSERR
+ */
+xinu_syscall timerInit(void)
+{
+    tid_typ tid;
+
+    timernow = 0;
+    timercount = 0;
+    timeridle = FALSE;
+    timerdue = 0;
+
+    tid = create((void *)timerDaemon, TIMER_THR_STK, TIMER_THR_PRIO,
+                 "timerDaemon", 0);
+    if (SYSERR == tid)
+    {
+        return SYSERR;
+    }
+    timertid = tid;
+    ready(tid);
+    return OK;
+}
+
+/**
+ * @ingroup timer
+ *
+ * Prepare a timer for use.  Must not be called on a pending timer.
+ * @param tmr timer
+ * @param func function to call, from the timer thread, when it fires
+ * @param arg argument to pass to func
+ */
+void timerSetup(struct timer *tmr, void (*func) (void *), void *arg)
+{
+    tmr->next = NULL;
+    tmr->pprev = NULL;
+    tmr->expires = 0;
+    tmr->start = 0;
+    tmr->func = func;
+    tmr->arg = arg;
+}
+
+/**
+ * @ingroup timer
+ *
+ * Schedule a timer to fire after a delay, replacing any earlier schedule.
+ * The delay is rounded up to whole wheel ticks and capped at
+ * ::TIMER_MAXTICKS of them.
+ * @param tmr timer prepared with timerSetup()
+ * @param ms milliseconds until the timer fires
+ * @return OK
+ */
+xinu_syscall timerSched(struct timer *tmr, unsigned int ms)
+{
+    unsigned long ticks;
+    bool wake = FALSE;
+
+    ticks = (ms + TIMER_FREQ - 1) / TIMER_FREQ;
+    if (0 == ticks)
+    {
+        ticks = 1;
+    }
+    else if (ticks > TIMER_MAXTICKS)
+    {
+        ticks = TIMER_MAXTICKS;
+    }
+
+	ENTER_KERNEL_CRITICAL_SECTION();
+    if (timerPending(tmr))
+    {
+        timerUnlink(tmr);
+        timercount--;
+    }
+    tmr->start = timernow;
+    tmr->expires = timernow + ticks;
+    timerAdd(tmr);
+    timercount++;
+    if (timeridle || ((long)(tmr->expires - timerdue) < 0))
+    {
+        /* Timer thread is asleep and would wake too late */
+        timeridle = FALSE;
+        timerdue = tmr->expires;
+        wake = TRUE;
+    }
+	EXIT_KERNEL_CRITICAL_SECTION();
+
+    if (wake)
+    {
+        send(timertid, OK);
+    }
+    return OK;
+}
+
+/**
+ * @ingroup timer
+ *
+ * Stop a timer from firing.
+ * @param tmr timer prepared with timerSetup()
+ * @return milliseconds since the timer was scheduled, SYSERR if it was not
+ *         pending
+ */
+xinu_syscall timerCancel(struct timer *tmr)
+{
+    int elapsed = SYSERR;
+
+	ENTER_KERNEL_CRITICAL_SECTION();
+    if (timerPending(tmr))
+    {
+        timerUnlink(tmr);
+        timercount--;
+        elapsed = (timernow - tmr->start) * TIMER_FREQ;
+    }
+	EXIT_KERNEL_CRITICAL_SECTION();
+    return elapsed;
+}
+
+/**
+ * @ingroup timer
+ *
+ * Determine how long a timer has left to run.
+ * @param tmr timer prepared with timerSetup()
+ * @return milliseconds until the timer fires, 0 if it is not pending
+ */
+unsigned int timerRemain(struct timer *tmr)
+{
+    unsigned int remain = 0;
+
+	ENTER_KERNEL_CRITICAL_SECTION();
+    if (timerPending(tmr))
+    {
+        remain = (tmr->expires - timernow) * TIMER_FREQ;
+    }
+	EXIT_KERNEL_CRITICAL_SECTION();
+    return remain;
+}
+
+/**
+ * @ingroup timer
+ *
+ * Timer thread.  Sleeps until the next tick that has a timer to run or
+ * cascade, is woken early by timerSched() if a sooner timer arrives, and
+ * waits without waking at all while no timers are pending.  On waking it
+ * catches the wheel up on the ticks that have passed.
+ */
+thread timerDaemon(void)
+{
+    unsigned long last, elapsed, skip, next, ms;
+
+	ENTER_KERNEL_CRITICAL_SECTION();
+    last = timerMs();
+	EXIT_KERNEL_CRITICAL_SECTION();
+
+    while (TRUE)
+    {
+		ENTER_KERNEL_CRITICAL_SECTION();
+        elapsed = (timerMs() - last) / TIMER_FREQ;
+        last += elapsed * TIMER_FREQ;
+		EXIT_KERNEL_CRITICAL_SECTION();
+
+        while (elapsed > 0)
+        {
+            /* Nothing happens on the ticks before the next one with work */
+			ENTER_KERNEL_CRITICAL_SECTION();
+            skip = timerNext() - 1;
+            if (skip > elapsed - 1)
+            {
+                skip = elapsed - 1;
+            }
+            timernow += skip;
+			EXIT_KERNEL_CRITICAL_SECTION();
+            elapsed -= skip + 1;
+            timerTick();
+        }
+
+		ENTER_KERNEL_CRITICAL_SECTION();
+        if (0 == timercount)
+        {
+            timeridle = TRUE;
+			EXIT_KERNEL_CRITICAL_SECTION();
+            receive();
+			ENTER_KERNEL_CRITICAL_SECTION();
+            last = timerMs();
+			EXIT_KERNEL_CRITICAL_SECTION();
+            continue;
+        }
+        next = timerNext();
+        if (next > TIMER_NSLOT * TIMER_NSLOT)
+        {
+            /* Keep the wait within what recvtime() can count */
+            next = TIMER_NSLOT * TIMER_NSLOT;
+        }
+        timerdue = timernow + next;
+        ms = timerMs() - last;
+		EXIT_KERNEL_CRITICAL_SECTION();
+
+        if (ms < next * TIMER_FREQ)
+        {
+            ms = next * TIMER_FREQ - ms;
+            recvtime((ms * CLKTICKS_PER_SEC + 999) / 1000);
+        }
+    }
+
+    return OK;
+}
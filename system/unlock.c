@@ -57,7 +57,9 @@ xinu_syscall unlock (monitor mon)
     if (monptr->count == 0)
     {
         monptr->owner = NOOWNER;
+        EXIT_KERNEL_CRITICAL_SECTION();
         signal(monptr->sem);
+        return OK;
     }
 
 	EXIT_KERNEL_CRITICAL_SECTION();
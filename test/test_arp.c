@@ -351,6 +351,7 @@ thread test_arp(bool verbose)
         netaddrcpy(&entry->hwaddr, &hwaddr);
         netaddrcpy(&entry->praddr, &praddr);
         entry->expires = clktime + ARP_TTL_RESOLVED;
+        arpInsert(entry);
     }
     for (i = 1; i < nout; i++)
     {
@@ -377,6 +378,17 @@ thread test_arp(bool verbose)
         failif((arptab[0].state != ARP_FREE),
                "Did not free expired entry");
     }
+
+    /* Test arpExpire */
+    testPrint(verbose, "Expire entries");
+    entry = &arptab[1];
+    arpRemove(entry);
+    entry->expires = clktime - 1;
+    arpInsert(entry);
+    arpExpire();
+    praddr.addr[3] = 2;
+    failif((ARP_FREE != entry->state) || (NULL != arpGetEntry(&praddr))
+           || (arpexphead != &arptab[2]), "");
     for (i = 0; i < ARP_NENTRY; i++)
     {
         arpFree(&arptab[i]);
@@ -723,6 +735,7 @@ thread test_arp(bool verbose)
     netaddrcpy(&entry->hwaddr, &hwaddr);
     netaddrcpy(&entry->praddr, &praddr);
     entry->expires = clktime + ARP_TTL_UNRESOLVED;
+    arpInsert(entry);
     i = arpLookup(netptr, &praddr, &addrbuf);
     if ((SYSERR == i) || (TIMEOUT == i))
     {
@@ -730,8 +743,8 @@ thread test_arp(bool verbose)
     }
     else
     {
-        failif((FALSE == netaddrequal(&addrbuf, &hwaddr)),
-               "Wrong address");
+        failif((FALSE == netaddrequal(&addrbuf, &hwaddr))
+               || (netptr->arplast != entry), "Wrong address");
     }
 
     /* Test arpLookup */
@@ -744,6 +757,7 @@ thread test_arp(bool verbose)
     netaddrcpy(&entry->hwaddr, &hwaddr);
     netaddrcpy(&entry->praddr, &praddr);
     entry->expires = clktime + ARP_TTL_UNRESOLVED;
+    arpInsert(entry);
     control(ELOOP, ELOOP_CTRL_SETFLAG, ELOOP_FLAG_HOLDNXT, NULL);
     request = data;
     wait = phdr.caplen;
@@ -0,0 +1,160 @@
+#include <stddef.h>
+#include <bpf.h>
+#include <ethernet.h>
+#include <stdio.h>
+#include <testsuite.h>
+
+#define TEST_INSNS  64
+#define TEST_SNAP   96
+
+/* Ethernet, IPv4 and UDP headers, 192.168.6.1:500 > 192.168.6.6:501 */
+static const unsigned char udppkt[] = {
+    0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xAA,
+    0x08, 0x00,
+    0x45, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x00, 0x00, 0x40, 0x11, 0x00, 0x00,
+    0xC0, 0xA8, 0x06, 0x01, 0xC0, 0xA8, 0x06, 0x06,
+    0x01, 0xF4, 0x01, 0xF5, 0x00, 0x08, 0x00, 0x00
+};
+
+static struct bpf_insn prog[TEST_INSNS];
+
+/* Compile an expression and run it over the test packet */
+static int compileRun(const char *expr, unsigned int linklen)
+{
+    if (SYSERR == bpfCompile(expr, linklen, TEST_SNAP, prog, TEST_INSNS))
+    {
+        return SYSERR;
+    }
+    return bpfFilter(prog, udppkt + ETH_HDR_LEN - linklen,
+                     sizeof(udppkt) - ETH_HDR_LEN + linklen,
+                     sizeof(udppkt) - ETH_HDR_LEN + linklen);
+}
+
+/**
+ * Tests the packet filter validator, interpreter and compiler.
+ * @return OK when testing is complete
+ */
+thread test_bpf(bool verbose)
+{
+    bool passed = TRUE;
+    struct bpf_insn noret[] = {
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 0),
+    };
+    struct bpf_insn farjump[] = {
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0, 5, 0),
+        BPF_STMT(BPF_RET | BPF_K, 0),
+    };
+    struct bpf_insn badmem[] = {
+        BPF_STMT(BPF_ST, BPF_MEMWORDS),
+        BPF_STMT(BPF_RET | BPF_K, 0),
+    };
+    struct bpf_insn divzero[] = {
+        BPF_STMT(BPF_ALU | BPF_DIV | BPF_K, 0),
+        BPF_STMT(BPF_RET | BPF_K, 0),
+    };
+    struct bpf_insn ethertype[] = {
+        BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 12),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ETHER_TYPE_IPv4, 0, 1),
+        BPF_STMT(BPF_RET | BPF_K, 0xFFFFFFFF),
+        BPF_STMT(BPF_RET | BPF_K, 0),
+    };
+    struct bpf_insn beyond[] = {
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, sizeof(udppkt) - 2),
+        BPF_STMT(BPF_RET | BPF_K, 1),
+    };
+    struct bpf_insn dstport[] = {
+        BPF_STMT(BPF_LDX | BPF_B | BPF_MSH, ETH_HDR_LEN),
+        BPF_STMT(BPF_LD | BPF_H | BPF_IND, ETH_HDR_LEN + 2),
+        BPF_STMT(BPF_ST, 3),
+        BPF_STMT(BPF_LD | BPF_IMM, 1),
+        BPF_STMT(BPF_MISC | BPF_TAX, 0),
+        BPF_STMT(BPF_LD | BPF_MEM, 3),
+        BPF_STMT(BPF_ALU | BPF_SUB | BPF_X, 0),
+        BPF_STMT(BPF_RET | BPF_A, 0),
+    };
+    struct bpf_insn unstored[] = {
+        BPF_STMT(BPF_LD | BPF_MEM, 3),
+        BPF_STMT(BPF_ALU | BPF_ADD | BPF_K, 1),
+        BPF_STMT(BPF_RET | BPF_A, 0),
+    };
+    struct bpf_insn divx[] = {
+        BPF_STMT(BPF_LDX | BPF_IMM, 0),
+        BPF_STMT(BPF_LD | BPF_IMM, 1),
+        BPF_STMT(BPF_ALU | BPF_DIV | BPF_X, 0),
+        BPF_STMT(BPF_RET | BPF_K, 1),
+    };
+
+    testPrint(verbose, "Validate bad programs");
+    failif((SYSERR != bpfValidate(NULL, 0))
+           || (SYSERR != bpfValidate(noret, 1))
+           || (SYSERR != bpfValidate(farjump, 2))
+           || (SYSERR != bpfValidate(badmem, 2))
+           || (SYSERR != bpfValidate(divzero, 2)), "");
+
+    testPrint(verbose, "Validate good program");
+    failif((OK != bpfValidate(ethertype, 4)), "");
+
+    testPrint(verbose, "Filter loads and jumps");
+    failif((0xFFFFFFFF != bpfFilter(ethertype, udppkt, sizeof(udppkt),
+                                    sizeof(udppkt)))
+           || (0 != bpfFilter(ethertype, udppkt, sizeof(udppkt), 12)),
+           "");
+
+    testPrint(verbose, "Filter load past end rejects");
+    failif((0 != bpfFilter(beyond, udppkt, sizeof(udppkt),
+                           sizeof(udppkt))), "");
+
+    testPrint(verbose, "Filter index, scratch and arithmetic");
+    failif((500 != bpfFilter(dstport, udppkt, sizeof(udppkt),
+                             sizeof(udppkt))), "");
+
+    testPrint(verbose, "Filter scratch starts zeroed");
+    failif((1 != bpfFilter(unstored, udppkt, sizeof(udppkt),
+                           sizeof(udppkt))), "");
+
+    testPrint(verbose, "Filter divide by zero rejects");
+    failif((0 != bpfFilter(divx, udppkt, sizeof(udppkt), sizeof(udppkt))),
+           "");
+
+    testPrint(verbose, "Compile primitives");
+    failif((TEST_SNAP != compileRun("", ETH_HDR_LEN))
+           || (TEST_SNAP != compileRun("udp", ETH_HDR_LEN))
+           || (0 != compileRun("tcp", ETH_HDR_LEN))
+           || (0 != compileRun("arp", ETH_HDR_LEN))
+           || (TEST_SNAP != compileRun("dst port 501", ETH_HDR_LEN))
+           || (0 != compileRun("src port 501", ETH_HDR_LEN))
+           || (TEST_SNAP != compileRun("src host 192.168.6.1", ETH_HDR_LEN))
+           || (0 != compileRun("dst host 192.168.6.1", ETH_HDR_LEN))
+           || (TEST_SNAP != compileRun("less 42", ETH_HDR_LEN))
+           || (0 != compileRun("greater 43", ETH_HDR_LEN)), "");
+
+    testPrint(verbose, "Compile operators");
+    failif((TEST_SNAP != compileRun("udp and port 500", ETH_HDR_LEN))
+           || (TEST_SNAP != compileRun("arp or port 501", ETH_HDR_LEN))
+           || (0 != compileRun("not udp", ETH_HDR_LEN))
+           || (TEST_SNAP != compileRun("!(icmp || tcp) && host 192.168.6.6",
+                                       ETH_HDR_LEN))
+           || (0 != compileRun("udp (port 1 or port 2)", ETH_HDR_LEN)), "");
+
+    testPrint(verbose, "Compile without link header");
+    failif((TEST_SNAP != compileRun("ip and udp port 500", 0))
+           || (0 != compileRun("arp", 0)), "");
+
+    testPrint(verbose, "Compile errors");
+    failif((SYSERR != compileRun("udp and", ETH_HDR_LEN))
+           || (SYSERR != compileRun("port x", ETH_HDR_LEN))
+           || (SYSERR != compileRun("(udp", ETH_HDR_LEN))
+           || (SYSERR != compileRun("src udp", ETH_HDR_LEN))
+           || (SYSERR != compileRun("host 1.2.3", ETH_HDR_LEN)), "");
+
+    if (TRUE == passed)
+    {
+        testPass(TRUE, "");
+    }
+    else
+    {
+        testFail(TRUE, "");
+    }
+
+    return OK;
+}
@@ -97,6 +97,18 @@ thread test_bufpool(bool verbose)
         else
         {
             testPass(verbose, "");
+            /* Empty pool must not block a non-waiting request */
+            testPrint(verbose, "Non-blocking get from empty pool");
+            if (SYSERR != (unsigned long)bufget_nowait(id)
+                || 1 != bfptab[id].nfail)
+            {
+                passed = FALSE;
+                testFail(verbose, "\nbufget_nowait() did not fail");
+            }
+            else
+            {
+                testPass(verbose, "");
+            }
             /* Free all buffers in pool */
             testPrint(verbose, "Free all buffers");
             for (i = 0; i < TBUFNUM; i++)
@@ -119,6 +131,32 @@ thread test_bufpool(bool verbose)
         }
     }
 
+    /* Statistics */
+    testPrint(verbose, "Pool statistics");
+    if ((TBUFNUM + 1 != bfptab[id].nalloc) || (0 != bfptab[id].inuse)
+        || (TBUFNUM != bfptab[id].highwater) || (0 != bfptab[id].nwait))
+    {
+        passed = FALSE;
+        testFail(verbose, "\npool counters do not match usage");
+    }
+    else
+    {
+        testPass(verbose, "");
+    }
+
+    /* Non-blocking get from a pool with free buffers */
+    testPrint(verbose, "Non-blocking get");
+    pbuf = bufget_nowait(id);
+    if (SYSERR == (unsigned long)pbuf || SYSERR == buffree(pbuf))
+    {
+        passed = FALSE;
+        testFail(verbose, "\nbufget_nowait() returns SYSERR");
+    }
+    else
+    {
+        testPass(verbose, "");
+    }
+
     /* Release pool */
     testPrint(verbose, "Free buffer pool");
     im = disable();
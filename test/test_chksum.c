@@ -0,0 +1,159 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ipv4.h>
+#include <network.h>
+#include <testsuite.h>
+#include <udp.h>
+
+#define CK_LEN 64
+
+/* Byte at a time reference sum, in network order */
+static uint16_t refChksum(const uint8_t *data, unsigned int len)
+{
+    uint32_t sum = 0;
+    unsigned int i;
+
+    for (i = 0; i + 1 < len; i += 2)
+    {
+        sum += (data[i] << 8) | data[i + 1];
+    }
+    if (i < len)
+    {
+        sum += data[i] << 8;
+    }
+    while (sum >> 16)
+    {
+        sum = (sum >> 16) + (sum & 0xFFFF);
+    }
+    return (uint16_t)~sum;
+}
+
+/* Sum a received IPv4 packet as a network device reports it */
+static void deviceSum(struct packet *pkt, struct ipv4Pkt *ip)
+{
+    pkt->csum = (uint16_t)~netChksumFold(netChksumPartial(ip,
+                                                          net2hs(ip->len),
+                                                          0));
+    pkt->flags |= PKT_CSUM_COMPLETE;
+}
+
+/**
+ * Tests the Internet checksum engine against a byte at a time reference,
+ * including odd alignment, split partial sums, copy and RFC 1624 updates,
+ * and the checksums left to or summed by a network device.
+ * @return OK when testing is complete
+ */
+thread test_chksum(bool verbose)
+{
+    static const uint8_t rfc1071[] =
+        { 0x00, 0x01, 0xF2, 0x03, 0xF4, 0xF5, 0xF6, 0xF7 };
+    uint8_t data[CK_LEN + 8] __attribute__((aligned(4)));
+    uint8_t copy[CK_LEN + 8] __attribute__((aligned(4)));
+    static uint8_t pktbuf[sizeof(struct packet) + CK_LEN]
+        __attribute__((aligned(4)));
+    struct packet *pkt = (struct packet *)pktbuf;
+    struct ipv4Pkt *ip;
+    struct udpPkt *udp;
+    struct netaddr src, dst;
+    uint16_t old, new, chksum;
+    uint32_t sum;
+    unsigned int off, len, split;
+    bool ok;
+    bool passed = TRUE;
+
+    for (off = 0; off < sizeof(data); off++)
+    {
+        data[off] = off * 37 + 11;
+    }
+
+    testPrint(verbose, "RFC 1071 example");
+    failif(0x220D != net2hs(netChksum((void *)rfc1071, sizeof(rfc1071))),
+           "");
+
+    testPrint(verbose, "Every alignment and length");
+    ok = TRUE;
+    for (off = 0; off < 4 && ok; off++)
+    {
+        for (len = 0; len <= CK_LEN && ok; len++)
+        {
+            ok = (refChksum(data + off, len) ==
+                  net2hs(netChksum(data + off, len)));
+        }
+    }
+    failif(!ok, "");
+
+    testPrint(verbose, "Split partial sums");
+    ok = TRUE;
+    for (split = 0; split <= CK_LEN && ok; split += 2)
+    {
+        sum = netChksumPartial(data + 1, split, 0);
+        sum = netChksumPartial(data + 1 + split, CK_LEN - 1 - split, sum);
+        ok = (netChksumFold(sum) == netChksum(data + 1, CK_LEN - 1));
+    }
+    failif(!ok, "");
+
+    testPrint(verbose, "Copy and sum");
+    sum = netChksumCopy(copy, data, CK_LEN - 3, 0);
+    failif((0 != memcmp(copy, data, CK_LEN - 3))
+           || (netChksumFold(sum) != netChksum(data, CK_LEN - 3)), "");
+
+    testPrint(verbose, "Incremental update");
+    chksum = netChksum(data, 20);
+    memcpy(&old, data + 8, sizeof(old));
+    new = old - 0x0100;
+    memcpy(data + 8, &new, sizeof(new));
+    failif(netChksumUpdate(chksum, old, new) != netChksum(data, 20), "");
+
+    /* IPv4 datagram carrying UDP, with an odd length payload */
+    src.type = dst.type = NETADDR_IPv4;
+    src.len = dst.len = IPv4_ADDR_LEN;
+    memcpy(src.addr, "\xC0\xA8\x01\x02", IPv4_ADDR_LEN);
+    memcpy(dst.addr, "\x0A\x00\x00\x63", IPv4_ADDR_LEN);
+    len = CK_LEN - IPv4_HDR_LEN - 1;
+    bzero(pkt, sizeof(pktbuf));
+    ip = (struct ipv4Pkt *)pkt->data;
+    ip->ver_ihl = (IPv4_VERSION << 4) | (IPv4_HDR_LEN / 4);
+    ip->len = hs2net(IPv4_HDR_LEN + len);
+    ip->ttl = IPv4_TTL;
+    ip->proto = IPv4_PROTO_UDP;
+    memcpy(ip->src, src.addr, IPv4_ADDR_LEN);
+    memcpy(ip->dst, dst.addr, IPv4_ADDR_LEN);
+    ip->chksum = netChksum(ip, IPv4_HDR_LEN);
+    udp = (struct udpPkt *)(pkt->data + IPv4_HDR_LEN);
+    udp->srcPort = hs2net(1024);
+    udp->dstPort = hs2net(7);
+    udp->len = hs2net(len);
+    memcpy(udp->data, data, len - UDP_HDR_LEN);
+    chksum = netChksumFold(netChksumPartial(udp, len,
+                                            netChksumPseudo(&src, &dst,
+                                                            IPv4_PROTO_UDP,
+                                                            len)));
+
+    testPrint(verbose, "Transport checksum left to device");
+    udp->chksum = netChksumOffload(pkt, &src, &dst, IPv4_PROTO_UDP, len);
+    failif(!(pkt->flags & PKT_CSUM_TX), "");
+    ipv4ChksumFinish(pkt, ip);
+    failif((udp->chksum != chksum) || (pkt->flags & PKT_CSUM_TX), "");
+
+    testPrint(verbose, "Transport checksum summed by device");
+    failif(ipv4ChksumRecv(pkt, &src, &dst, IPv4_PROTO_UDP, len), "");
+    deviceSum(pkt, ip);
+    ok = ipv4ChksumRecv(pkt, &src, &dst, IPv4_PROTO_UDP, len);
+    udp->data[3] ^= 0x10;
+    deviceSum(pkt, ip);
+    failif(!ok || ipv4ChksumRecv(pkt, &src, &dst, IPv4_PROTO_UDP, len), "");
+
+    if (passed)
+    {
+        testPass(TRUE, "");
+    }
+    else
+    {
+        testFail(TRUE, "");
+    }
+
+    return OK;
+}
@@ -6,6 +6,8 @@
 
 #include <xinu.h>
 #include <platform.h>
+#include <arp.h>
+#include <clock.h>
 #include <device.h>
 #include <ethloop.h>
 #include <ipv4.h>
@@ -21,6 +23,12 @@
 extern int _binary_data_testip_pcap_start;
 #define MAX_WAIT 10
 
+#define FRAG_PORT       7777
+#define FRAG_DATALEN    1500    /* UDP payload, more than ELOOP_MTU     */
+#define FRAG_BIGLEN     4000    /* UDP payload, more than a net buffer  */
+#define FRAG_BIGSIZE    (sizeof(struct packet) + IPv4_FRAG_HDRROOM \
+                         + UDP_HDR_LEN + FRAG_BIGLEN)
+
 #ifndef ELOOP
 #define ELOOP (-1)
 #endif
@@ -40,6 +48,11 @@ thread test_ip(bool verbose)
     struct pcap_pkthdr phdr;
     struct packet *pktA;
     struct packet *pktB;
+    struct packet *pktC;
+    struct packet *pktD;
+    struct arpEntry *arp;
+    struct udpPkt *udppkt;
+    static unsigned char fragbuf[FRAG_BIGLEN + 1];
     unsigned char *data;
     unsigned char buf[500];
     int i;
@@ -170,26 +183,118 @@ thread test_ip(bool verbose)
         }
     }
 
-    /* ipv4Recv Testing */
-    //TODO: Finish ipv4Recv
-/*	testPrint(verbose, "ipv4Recv");
-	pktA->curr -= IPv4_HDR_LEN;
-
-	if (SYSERR == rawOpen(RAW0, IPv4_PROTO_UDP, ))
+#if NUDP
+    /* A datagram larger than the MTU leaves in fragments and must come
+     * back up to the UDP socket in one piece */
+    testPrint(verbose, "Reassemble fragments");
+    arp = arpAlloc();
+    pktC = netGetbuf();
+    if ((SYSERR == (int)arp) || (SYSERR == (int)pktC))
     {
-        failif(TRUE, "Open returned SYSERR");
+        failif(TRUE, "Allocation failed");
     }
+    else if (SYSERR == open(UDP0, &src, &src, FRAG_PORT, FRAG_PORT))
+    {
+        failif(TRUE, "UDP open returned SYSERR");
+    }
+    else
+    {
+        /* Loop back to ourselves without waiting on ARP */
+        arp->state = ARP_RESOLVED;
+        arp->nif = netptr;
+        netaddrcpy(&arp->hwaddr, &netptr->hwaddr);
+        netaddrcpy(&arp->praddr, &src);
+        arp->expires = clktime + ARP_TTL_RESOLVED;
+        arpInsert(arp);
+        control(UDP0, UDP_CTRL_SETFLAG, UDP_FLAG_NOBLOCK, NULL);
 
-	
+        pktC->curr -= UDP_HDR_LEN + FRAG_DATALEN;
+        pktC->len += UDP_HDR_LEN + FRAG_DATALEN;
+        udppkt = (struct udpPkt *)pktC->curr;
+        udppkt->srcPort = hs2net(FRAG_PORT);
+        udppkt->dstPort = hs2net(FRAG_PORT);
+        udppkt->len = hs2net(UDP_HDR_LEN + FRAG_DATALEN);
+        udppkt->chksum = 0;
+        for (i = 0; i < FRAG_DATALEN; i++)
+        {
+            udppkt->data[i] = i * 7;
+        }
+
+        if (OK != ipv4Send(pktC, &src, &src, IPv4_PROTO_UDP))
+        {
+            failif(TRUE, "ipv4Send didn't return okay");
+        }
+        else
+        {
+            i = 0;
+            for (wait = 0; wait < MAX_WAIT; wait++)
+            {
+                i = read(UDP0, fragbuf, sizeof(fragbuf));
+                if (0 != i)
+                {
+                    break;
+                }
+                sleep(10);
+            }
+            failif((FRAG_DATALEN != i)
+                   || (0 != memcmp(fragbuf, udppkt->data, FRAG_DATALEN)),
+                   "");
+        }
+
+        /* Reassembled datagrams may be several times the size of any
+         * network buffer, so build this one in memory of its own */
+        testPrint(verbose, "Reassemble multi-KB datagram");
+        pktD = (struct packet *)memget(FRAG_BIGSIZE);
+        if (SYSERR == (int)pktD)
+        {
+            failif(TRUE, "Allocation failed");
+        }
+        else
+        {
+            bzero(pktD, FRAG_BIGSIZE);
+            pktD->curr = pktD->data + IPv4_FRAG_HDRROOM;
+            pktD->len = UDP_HDR_LEN + FRAG_BIGLEN;
+            udppkt = (struct udpPkt *)pktD->curr;
+            udppkt->srcPort = hs2net(FRAG_PORT);
+            udppkt->dstPort = hs2net(FRAG_PORT);
+            udppkt->len = hs2net(UDP_HDR_LEN + FRAG_BIGLEN);
+            udppkt->chksum = 0;
+            for (i = 0; i < FRAG_BIGLEN; i++)
+            {
+                udppkt->data[i] = i * 13;
+            }
+
+            if (OK != ipv4Send(pktD, &src, &src, IPv4_PROTO_UDP))
+            {
+                failif(TRUE, "ipv4Send didn't return okay");
+            }
+            else
+            {
+                i = 0;
+                for (wait = 0; wait < MAX_WAIT; wait++)
+                {
+                    i = read(UDP0, fragbuf, sizeof(fragbuf));
+                    if (0 != i)
+                    {
+                        break;
+                    }
+                    sleep(10);
+                }
+                failif((FRAG_BIGLEN != i)
+                       || (0 != memcmp(fragbuf, udppkt->data, FRAG_BIGLEN)),
+                       "");
+            }
+            memfree(pktD, FRAG_BIGSIZE);
+        }
+        close(UDP0);
+        arpFree(arp);
+    }
+    if (SYSERR != (int)pktC)
+    {
+        netFreebuf(pktC);
+    }
+#endif /* NUDP */
 
-	if (OK != ipv4Recv(pktA))
-	{
-		failif(TRUE, "Didn't return okay");
-	}
-	else
-	{
-	}
-*/
     netDown(ELOOP);
     close(ELOOP);
 
@@ -1,10 +1,21 @@
 #include <stddef.h>
 #include <string.h>
 #include <stdio.h>
+#include <clock.h>
+#include <platform.h>
 #include <testsuite.h>
 
 #define LEN_STR 7
 
+#define BENCH_BUF   4104        /* largest size plus worst alignment    */
+#define BENCH_BYTES (1 << 20)   /* bytes moved per measurement          */
+
+static unsigned char benchsrc[BENCH_BUF];
+static unsigned char benchdst[BENCH_BUF];
+
+static bool alignedops(void);
+static void benchmark(bool verbose);
+
 /**
  * Tests the string.h header in the Xinu Standard Library.
  * @return OK when testing is complete
@@ -134,6 +145,21 @@ thread test_libString(bool verbose)
     s1 = memset(sJ, 'F', 3);
     failif(((0 != memcmp(sJ, "FFFDE", 5)) || (s1 != sJ)), "");
 
+    /* memmove */
+    testPrint(verbose, "Memory move (overlapping)");
+    char sK[12] = "0123456789";
+
+    s1 = memmove(sK + 1, sK, 9);
+    s2 = memmove(sK + 1, sK + 2, 5);
+    failif(((0 != memcmp(sK, "0123455678", 10))
+            || (s1 != sK + 1) || (s2 != sK + 1)), "");
+
+    /* Word paths at every head/tail alignment */
+    testPrint(verbose, "Aligned and unaligned copy, set, compare");
+    failif(!alignedops(), "");
+
+    benchmark(verbose);
+
     if (passed)
     {
         testPass(TRUE, "");
@@ -145,3 +171,125 @@ thread test_libString(bool verbose)
 
     return OK;
 }
+
+/**
+ * Check the word-at-a-time string routines against a byte by byte
+ * comparison at every source and destination alignment, for lengths that
+ * exercise the head, bulk and tail of each.
+ * @return TRUE if every result was correct
+ */
+static bool alignedops(void)
+{
+    int so, dof, n, i;
+    bool ok = TRUE;
+
+    for (i = 0; i < 256; i++)
+    {
+        benchsrc[i] = i * 7 + 1;
+    }
+    for (so = 0; so < 4 && ok; so++)
+    {
+        for (dof = 0; dof < 4 && ok; dof++)
+        {
+            for (n = 0; n < 80 && ok; n++)
+            {
+                memset(benchdst, 0xA5, 96);
+                memcpy(benchdst + dof, benchsrc + so, n);
+                ok = (0 == memcmp(benchdst + dof, benchsrc + so, n))
+                    && (0xA5 == benchdst[dof + n])
+                    && (0 == dof || 0xA5 == benchdst[dof - 1]);
+                for (i = 0; i < n && ok; i++)
+                {
+                    ok = (benchdst[dof + i] == benchsrc[so + i]);
+                }
+                if (ok && n > 0)
+                {
+                    benchdst[dof + n - 1] ^= 1;
+                    ok = (0 != memcmp(benchdst + dof, benchsrc + so, n));
+                }
+                benchsrc[200 + so + n] = '\0';
+                memset(benchsrc + 200 + so, 'x', n);
+                ok = ok && (n == strlen((char *)benchsrc + 200 + so));
+            }
+        }
+    }
+
+    return ok;
+}
+
+/* Reference byte loop; the volatile keeps the compiler from widening it */
+static void bytecopy(void *dest, const void *src, size_t n)
+{
+    volatile unsigned char *d = dest;
+    const unsigned char *s = src;
+
+    while (n--)
+    {
+        *d++ = *s++;
+    }
+}
+
+/* Throughput of one copy routine in MB/s */
+static unsigned int throughput(void *(*copy)(void *, const void *, size_t),
+                               int size, int so, int dof)
+{
+    unsigned long start, cycles;
+    int i, reps;
+
+    reps = BENCH_BYTES / size;
+    start = clkcount();
+    for (i = 0; i < reps; i++)
+    {
+        if (copy)
+        {
+            copy(benchdst + dof, benchsrc + so, size);
+        }
+        else
+        {
+            bytecopy(benchdst + dof, benchsrc + so, size);
+        }
+    }
+    cycles = clkcount() - start;
+    if (0 == cycles)
+    {
+        cycles = 1;
+    }
+    return (unsigned long long)reps * size * platform.clkfreq /
+        cycles / (1024 * 1024);
+}
+
+/**
+ * Print memcpy() and memset() throughput against a byte loop for packet
+ * sized buffers at aligned and unaligned offsets.
+ */
+static void benchmark(bool verbose)
+{
+    static const int sizes[] = { 16, 64, 256, 1514, 4096 };
+    static const int offs[][2] = { {0, 0}, {1, 1}, {1, 3} };
+    unsigned long start, cycles;
+    char str[80];
+    int i, j, k;
+
+    testPrint(verbose, "\n  size  src/dst  byte MB/s  memcpy MB/s  "
+              "memset MB/s\n");
+    for (i = 0; i < ARRAY_LEN(sizes); i++)
+    {
+        for (j = 0; j < ARRAY_LEN(offs); j++)
+        {
+            start = clkcount();
+            for (k = 0; k < BENCH_BYTES / sizes[i]; k++)
+            {
+                memset(benchdst + offs[j][1], k, sizes[i]);
+            }
+            cycles = clkcount() - start;
+            sprintf(str, "  %4d    %d/%d    %9u  %11u  %11u\n", sizes[i],
+                    offs[j][0], offs[j][1],
+                    throughput(NULL, sizes[i], offs[j][0], offs[j][1]),
+                    throughput(memcpy, sizes[i], offs[j][0], offs[j][1]),
+                    (unsigned int)((unsigned long long)BENCH_BYTES *
+                                   platform.clkfreq / (cycles ? cycles : 1)
+                                   / (1024 * 1024)));
+            testPrint(verbose, str);
+        }
+    }
+}
@@ -1,12 +1,18 @@
 #include <stddef.h>
+#include <clock.h>
 #include <memory.h>
+#include <platform.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <testsuite.h>
 
+#define CHURN_OPS   2000        /* allocations timed by the benchmark   */
+#define CHURN_LIVE  64          /* most blocks held at once             */
+
 /* function prototypes */
 static bool list_check(void);
 static void fatprocess(void);
+static bool churn(bool);
 
 /* test_memory -- allocates and frees memory; tests consistency of
  * memlist accounting.  Called by xsh_testsuite()
@@ -87,6 +93,18 @@ thread test_memory(bool verbose)
         }
     }
 
+    /* Allocation latency and fragmentation under random churn */
+    testPrint(verbose, "Allocation churn benchmark");
+    if (!churn(verbose) || !list_check())
+    {
+        passed = FALSE;
+        testFail(verbose, "\nchurn left memlist inconsistent");
+    }
+    else
+    {
+        testPass(verbose, "");
+    }
+
     /* Final report */
     if (TRUE == passed)
     {
@@ -158,3 +176,103 @@ static void fatprocess(void)
         memfree(fnext, fnext->flen);
     }
 }
+
+static int cmpcycles(const void *a, const void *b)
+{
+    unsigned long x = *(const unsigned long *)a;
+    unsigned long y = *(const unsigned long *)b;
+
+    return (x > y) - (x < y);
+}
+
+static unsigned int cyclens(unsigned long cycles)
+{
+    return (unsigned int)((unsigned long long)cycles * 1000000000ULL /
+                          platform.clkfreq);
+}
+
+/**
+ * Allocate and free blocks of random size, mostly small, timing every
+ * memget().  Prints latency percentiles and how fragmented the free list
+ * is before the survivors are released.
+ * @return FALSE if an allocation or free failed
+ */
+static bool churn(bool verbose)
+{
+    static unsigned long lat[CHURN_OPS];
+    void *live[CHURN_LIVE];
+    unsigned int len[CHURN_LIVE];
+    struct memblock *mptr;
+    unsigned long start, total, largest;
+    unsigned int frag;
+    bool ok = TRUE;
+    char str[80];
+    int i, slot;
+
+    for (slot = 0; slot < CHURN_LIVE; slot++)
+    {
+        live[slot] = NULL;
+    }
+
+    srand(CHURN_OPS);
+    for (i = 0; i < CHURN_OPS; i++)
+    {
+        slot = rand() % CHURN_LIVE;
+        if (NULL != live[slot])
+        {
+            if (SYSERR == memfree(live[slot], len[slot]))
+            {
+                ok = FALSE;
+            }
+        }
+
+        /* Four in five requests are small objects */
+        if (rand() % 5)
+        {
+            len[slot] = 1 + rand() % SLAB_MAXSIZE;
+        }
+        else
+        {
+            len[slot] = SLAB_MAXSIZE + 1 + rand() % (8 * SLAB_MAXSIZE);
+        }
+        start = clkcount();
+        live[slot] = memget(len[slot]);
+        lat[i] = clkcount() - start;
+        if ((void *)SYSERR == live[slot])
+        {
+            live[slot] = NULL;
+            ok = FALSE;
+        }
+    }
+
+    total = largest = 0;
+    for (mptr = memlist.next; mptr != NULL; mptr = mptr->next)
+    {
+        total += mptr->length;
+        if (mptr->length > largest)
+        {
+            largest = mptr->length;
+        }
+    }
+
+    for (slot = 0; slot < CHURN_LIVE; slot++)
+    {
+        if ((NULL != live[slot]) && (SYSERR == memfree(live[slot], len[slot])))
+        {
+            ok = FALSE;
+        }
+    }
+
+    qsort(lat, CHURN_OPS, sizeof(lat[0]), cmpcycles);
+    sprintf(str, "\n  memget latency p50 %u ns, p90 %u ns, p99 %u ns, "
+            "max %u ns", cyclens(lat[CHURN_OPS / 2]),
+            cyclens(lat[CHURN_OPS * 9 / 10]),
+            cyclens(lat[CHURN_OPS * 99 / 100]), cyclens(lat[CHURN_OPS - 1]));
+    testPrint(verbose, str);
+    frag = total ? 100 - (unsigned long long)largest * 100 / total : 0;
+    sprintf(str, "\n  fragmentation after churn %u%% (largest %lu of %lu "
+            "free)\n", frag, largest, total);
+    testPrint(verbose, str);
+
+    return ok;
+}
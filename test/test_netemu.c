@@ -0,0 +1,224 @@
+/**
+ * @file test_netemu.c
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <xinu.h>
+#include <CriticalSection.h>
+#include <ethloop.h>
+#include <limits.h>
+#include <netemu.h>
+#include <network.h>
+#include <snoop.h>
+#include <stdlib.h>
+#include <string.h>
+#include <testsuite.h>
+
+#if NETEMU && NETHER
+
+#ifndef ELOOP
+#define ELOOP (-1)
+#endif
+
+#ifndef NNETIF
+#define NNETIF (-1)
+#endif
+
+#define EMU_PKTLEN  100         /* octets in each test packet           */
+#define EMU_NLOSS   1000        /* packets sent to measure loss         */
+#define EMU_NPKT    4           /* packets sent to time delay and rate  */
+#define EMU_DELAY   50          /* ms of added latency                  */
+#define EMU_RATE    80          /* kbit/s, one test packet per 10 ms    */
+#define EMU_GAP     (EMU_PKTLEN * 8 / EMU_RATE) /* ms between packets  */
+
+/* Capture of what comes out of the emulator */
+static struct snoop cap;
+
+/* Clear the settings and statistics of an emulation stage */
+static void emuReset(struct netemu *emu)
+{
+    unsigned char dir;
+
+    ENTER_KERNEL_CRITICAL_SECTION();
+    dir = emu->dir;
+    bzero(emu, sizeof(struct netemu));
+    emu->dir = dir;
+    EXIT_KERNEL_CRITICAL_SECTION();
+}
+
+/* Send a packet, numbered in its first octet, out through the emulator */
+static bool emuSend(struct netif *netptr, unsigned char seq)
+{
+    struct packet *pkt;
+    int result;
+
+    pkt = netGetbuf();
+    if (SYSERR == (int)pkt)
+    {
+        return FALSE;
+    }
+    pkt->nif = netptr;
+    pkt->curr -= EMU_PKTLEN;
+    pkt->len = EMU_PKTLEN;
+    pkt->linkhdr = pkt->curr;
+    pkt->curr[0] = seq;
+    result = netemu(pkt, NETEMU_OUT);
+    netFreebuf(pkt);
+    return (OK == result);
+}
+
+/*
+ * Check that the next n captured packets are numbered in order and came
+ * out of the emulator no sooner than start plus first ms, and each gap ms
+ * after the one before.
+ */
+static bool emuCheck(unsigned long start, unsigned int first,
+                     unsigned int gap, unsigned int n)
+{
+    struct snoopRec *rec;
+    unsigned long ms;
+    unsigned int i;
+    bool ok = (semcount(cap.nready) == n);
+
+    for (i = 0; ok && (i < n); i++)
+    {
+        rec = snoopRead(&cap);
+        ms = rec->hdr.sec * 1000 + rec->hdr.usec / 1000;
+        ok = (i == rec->data[0])
+            && ((long)(ms - start) >= (long)(first + i * gap));
+        snoopDone(&cap, rec);
+    }
+    return ok;
+}
+
+#endif /* NETEMU && NETHER */
+
+/**
+ * Tests the network emulator's loss, delay and rate limit on the egress
+ * stage of the loopback interface.  What the emulator writes is dropped by
+ * the loopback device and seen only through a capture.
+ * @return OK when testing is complete
+ */
+thread test_netemu(bool verbose)
+{
+#if NETEMU && NETHER
+    struct netaddr ip;
+    struct netaddr mask;
+    struct netif *netptr = NULL;
+    struct netemu *emu;
+    unsigned long start;
+    unsigned int i;
+    bool ok;
+    bool passed = TRUE;
+
+    ip.type = NETADDR_IPv4;
+    ip.len = IPv4_ADDR_LEN;
+    ip.addr[0] = 192;
+    ip.addr[1] = 168;
+    ip.addr[2] = 1;
+    ip.addr[3] = 6;
+    mask.type = NETADDR_IPv4;
+    mask.len = IPv4_ADDR_LEN;
+    mask.addr[0] = 255;
+    mask.addr[1] = 255;
+    mask.addr[2] = 255;
+    mask.addr[3] = 0;
+
+    testPrint(verbose, "Initialization");
+    if ((SYSERR != open(ELOOP))
+        && (SYSERR != netUp(ELOOP, &ip, &mask, NULL)))
+    {
+        for (i = 0; i < NNETIF; i++)
+        {
+            if ((NET_ALLOC == netiftab[i].state)
+                && (ELOOP == netiftab[i].dev))
+            {
+                netptr = &netiftab[i];
+                break;
+            }
+        }
+    }
+    failif((NULL == netptr), "Loopback interface not up");
+    if (NULL == netptr)
+    {
+        close(ELOOP);
+        testFail(TRUE, "");
+        return OK;
+    }
+    control(ELOOP, ELOOP_CTRL_SETFLAG, ELOOP_FLAG_DROPALL, NULL);
+    emu = netemuStage(netptr, NETEMU_OUT);
+    emuReset(emu);
+
+    testPrint(verbose, "Drop rate");
+    ENTER_KERNEL_CRITICAL_SECTION();
+    emu->loss = NETEMU_PROB / 4;
+    EXIT_KERNEL_CRITICAL_SECTION();
+    for (i = 0, ok = TRUE; ok && (i < EMU_NLOSS); i++)
+    {
+        ok = emuSend(netptr, i);
+    }
+    failif(!ok || (EMU_NLOSS != emu->nin)
+           || (emu->ndrop < EMU_NLOSS / 4 - EMU_NLOSS / 20)
+           || (emu->ndrop > EMU_NLOSS / 4 + EMU_NLOSS / 20), "");
+
+    bzero(&cap, sizeof(struct snoop));
+    cap.caplen = USHRT_MAX;
+    if (SYSERR == snoopOpen(&cap, "ELOOP"))
+    {
+        failif(TRUE, "No capture");
+    }
+    else
+    {
+        testPrint(verbose, "Delay keeps order");
+        emuReset(emu);
+        ENTER_KERNEL_CRITICAL_SECTION();
+        emu->delay = EMU_DELAY;
+        EXIT_KERNEL_CRITICAL_SECTION();
+        start = emuNow();
+        for (i = 0, ok = TRUE; ok && (i < EMU_NPKT); i++)
+        {
+            ok = emuSend(netptr, i);
+        }
+        sleep(EMU_DELAY / 2);
+        ok = ok && (0 == semcount(cap.nready))
+            && (EMU_NPKT == emu->nqueue);
+        sleep(2 * EMU_DELAY);
+        failif(!ok || !emuCheck(start, EMU_DELAY, 0, EMU_NPKT)
+               || (0 != emu->nqueue), "");
+
+        testPrint(verbose, "Rate limit");
+        emuReset(emu);
+        ENTER_KERNEL_CRITICAL_SECTION();
+        emu->rate = EMU_RATE;
+        emu->burst = EMU_PKTLEN;
+        EXIT_KERNEL_CRITICAL_SECTION();
+        start = emuNow();
+        for (i = 0, ok = TRUE; ok && (i < EMU_NPKT); i++)
+        {
+            ok = emuSend(netptr, i);
+        }
+        sleep(EMU_NPKT * EMU_GAP + EMU_DELAY);
+        failif(!ok || !emuCheck(start, 0, EMU_GAP, EMU_NPKT)
+               || (0 != emu->nlimit), "");
+
+        snoopClose(&cap);
+    }
+
+    emuReset(emu);
+    control(ELOOP, ELOOP_CTRL_CLRFLAG, ELOOP_FLAG_DROPALL, NULL);
+    netDown(ELOOP);
+    close(ELOOP);
+
+    if (TRUE == passed)
+    {
+        testPass(TRUE, "");
+    }
+    else
+    {
+        testFail(TRUE, "");
+    }
+#else /* NETEMU && NETHER */
+    testSkip(TRUE, "");
+#endif /* NETEMU && NETHER */
+    return OK;
+}
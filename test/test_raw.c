@@ -6,6 +6,7 @@
 
 #include <xinu.h>
 #include <platform.h>
+#include <bpf.h>
 #include <device.h>
 #include <ethloop.h>
 #include <ethernet.h>
@@ -40,6 +41,8 @@ thread test_raw(bool verbose)
     struct pcap_file_header pcap;
     unsigned char *data;
     unsigned char buf[500];
+    struct bpf_insn reject[] = { BPF_STMT(BPF_RET | BPF_K, 0) };
+    struct bpf_program prog;
     int nproc;
     int wait;
     int i;
@@ -172,7 +175,7 @@ thread test_raw(bool verbose)
 
     /* Test demux */
     testPrint(verbose, "Demulitplexing (No sockets)");
-    failif((NULL != rawDemux(&rip, &lip, IPv4_PROTO_ICMP)), "");
+    failif((NULL != rawDemux(NULL, &rip, &lip, IPv4_PROTO_ICMP)), "");
 
     testPrint(verbose, "Demulitplexing (All Protos)");
     if ((SYSERR == open(RAW0, &lip, &rip, IPv4_PROTO_IGMP))
@@ -184,7 +187,7 @@ thread test_raw(bool verbose)
     {
         devptr = (device *)&devtab[RAW1];
         rawptr = &rawtab[devptr->minor];
-        if (rawptr != rawDemux(&rip, &lip, IPv4_PROTO_ICMP))
+        if (rawptr != rawDemux(NULL, &rip, &lip, IPv4_PROTO_ICMP))
         {
             failif(TRUE, "Incorrect socket");
         }
@@ -205,7 +208,7 @@ thread test_raw(bool verbose)
     {
         devptr = (device *)&devtab[RAW0];
         rawptr = &rawtab[devptr->minor];
-        if (rawptr != rawDemux(&rip, &lip, IPv4_PROTO_ICMP))
+        if (rawptr != rawDemux(NULL, &rip, &lip, IPv4_PROTO_ICMP))
         {
             failif(TRUE, "Incorrect socket");
         }
@@ -226,7 +229,7 @@ thread test_raw(bool verbose)
     {
         devptr = (device *)&devtab[RAW1];
         rawptr = &rawtab[devptr->minor];
-        if (rawptr != rawDemux(&rip, &lip, IPv4_PROTO_ICMP))
+        if (rawptr != rawDemux(NULL, &rip, &lip, IPv4_PROTO_ICMP))
         {
             failif(TRUE, "Incorrect socket");
         }
@@ -247,7 +250,7 @@ thread test_raw(bool verbose)
     {
         devptr = (device *)&devtab[RAW1];
         rawptr = &rawtab[devptr->minor];
-        if (rawptr != rawDemux(&rip, &lip, IPv4_PROTO_ICMP))
+        if (rawptr != rawDemux(NULL, &rip, &lip, IPv4_PROTO_ICMP))
         {
             failif(TRUE, "Incorrect socket");
         }
@@ -258,6 +261,43 @@ thread test_raw(bool verbose)
         }
     }
 
+    testPrint(verbose, "Demulitplexing (Filter)");
+    pkt->len = ETH_HDR_LEN + IPv4_HDR_LEN;
+    pkt->linkhdr = pkt->data;
+    pkt->nethdr = pkt->linkhdr + ETH_HDR_LEN;
+    prog.bf_len = 1;
+    prog.bf_insns = reject;
+    if ((SYSERR == open(RAW0, NULL, NULL, IPv4_PROTO_ICMP))
+        || (SYSERR == open(RAW1, NULL, NULL, NULL)))
+    {
+        failif(TRUE, "Open failed");
+    }
+    else if (OK != control(RAW0, RAW_CTRL_SETFILTER, (long)&prog, NULL))
+    {
+        failif(TRUE, "Filter not set");
+    }
+    else
+    {
+        devptr = (device *)&devtab[RAW1];
+        rawptr = &rawtab[devptr->minor];
+        if (rawptr != rawDemux(pkt, &rip, &lip, IPv4_PROTO_ICMP))
+        {
+            failif(TRUE, "Filter not applied");
+        }
+        else if (OK != control(RAW0, RAW_CTRL_SETFILTER, NULL, NULL))
+        {
+            failif(TRUE, "Filter not cleared");
+        }
+        else
+        {
+            devptr = (device *)&devtab[RAW0];
+            rawptr = &rawtab[devptr->minor];
+            failif(((rawptr != rawDemux(pkt, &rip, &lip, IPv4_PROTO_ICMP))
+                    || (SYSERR == close(RAW0)) || (SYSERR == close(RAW1))),
+                   "Incorrect socket");
+        }
+    }
+
     /* Test Open */
     testPrint(verbose, "Open RAW (Full Spec)");
     if (SYSERR == open(RAW0, &lip, &rip, IPv4_PROTO_ICMP))
@@ -0,0 +1,158 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <clock.h>
+#include <ipv4.h>
+#include <network.h>
+#include <platform.h>
+#include <route.h>
+#include <testsuite.h>
+
+#define LOOKUPS 2000            /* lookups per benchmark run          */
+
+/* Test routes live in 198.18.0.0/15, set aside for benchmarking */
+static void mkaddr(struct netaddr *addr, unsigned int host)
+{
+    addr->type = NETADDR_IPv4;
+    addr->len = IPv4_ADDR_LEN;
+    addr->addr[0] = 198;
+    addr->addr[1] = 18 + ((host >> 16) & 1);
+    addr->addr[2] = host >> 8;
+    addr->addr[3] = host;
+}
+
+static void mkmask(struct netaddr *mask, unsigned int bits)
+{
+    unsigned int i;
+
+    mask->type = NETADDR_IPv4;
+    mask->len = IPv4_ADDR_LEN;
+    for (i = 0; i < IPv4_ADDR_LEN; i++)
+    {
+        mask->addr[i] = (bits >= 8) ? 0xFF : (0xFF << (8 - bits)) & 0xFF;
+        bits = (bits >= 8) ? bits - 8 : 0;
+    }
+}
+
+/**
+ * Time LOOKUPS route lookups cycling through naddr destinations.
+ * @return nanoseconds per lookup
+ */
+static unsigned int bench(unsigned int nroute, unsigned int naddr)
+{
+    struct netaddr addr;
+    unsigned long cycles;
+    unsigned int i;
+
+    cycles = clkcount();
+    for (i = 0; i < LOOKUPS; i++)
+    {
+        mkaddr(&addr, ((i % naddr) * 7 % (nroute + 1)) << 8 | 1);
+        rtLookup(&addr);
+    }
+    cycles = clkcount() - cycles;
+    return (unsigned long long)cycles * 1000000000ULL / platform.clkfreq
+        / LOOKUPS;
+}
+
+/**
+ * Tests longest prefix matching in the route table and times route
+ * lookups as the table fills.
+ * @return OK when testing is complete
+ */
+thread test_route(bool verbose)
+{
+    struct netaddr dst, mask, addr;
+    struct rtEntry *rtptr;
+    struct netif *nif = &netiftab[0];
+    char str[80];
+    unsigned int nfree, nroute, i;
+    bool ok;
+    bool passed = TRUE;
+
+    for (nfree = 0, i = 0; i < RT_NENTRY; i++)
+    {
+        if (RT_FREE == rttab[i].state)
+        {
+            nfree++;
+        }
+    }
+    if (nfree < 4)
+    {
+        testSkip(TRUE, "Route table full");
+        return OK;
+    }
+
+    testPrint(verbose, "Longest prefix wins");
+    mkaddr(&dst, 0);
+    mkmask(&mask, 15);
+    ok = (OK == rtAdd(&dst, NULL, &mask, nif));
+    mkaddr(&dst, 0x0100);
+    mkmask(&mask, 24);
+    ok = ok && (OK == rtAdd(&dst, NULL, &mask, nif));
+    mkaddr(&addr, 0x0105);
+    rtptr = rtLookup(&addr);
+    failif(!ok || (NULL == rtptr) || (24 != rtptr->masklen), "");
+
+    testPrint(verbose, "Shorter prefix after remove");
+    rtRemove(&dst);
+    rtptr = rtLookup(&addr);
+    failif((NULL == rtptr) || (15 != rtptr->masklen), "");
+
+    testPrint(verbose, "Non-contiguous mask rejected");
+    mkmask(&mask, 8);
+    mask.addr[3] = 0xFF;
+    failif(SYSERR != rtAdd(&dst, NULL, &mask, nif), "");
+    mkaddr(&dst, 0);
+    rtRemove(&dst);
+
+    /* Fill the free entries with /24 routes, timing lookups as we go */
+    testPrint(verbose, "Route lookup times:\n");
+    mkmask(&mask, 24);
+    for (nroute = 0; nroute < nfree; nroute++)
+    {
+        if ((nroute & (nroute - 1)) == 0)
+        {
+            sprintf(str, "%4u routes: %5u ns cached, %5u ns uncached\n",
+                    nroute, bench(nroute, 1), bench(nroute, 4 * RT_NCACHE));
+            testPrint(verbose, str);
+        }
+        mkaddr(&dst, nroute << 8);
+        if (SYSERR == rtAdd(&dst, NULL, &mask, nif))
+        {
+            break;
+        }
+    }
+
+    testPrint(verbose, "Every /24 routes to itself");
+    for (i = 0; i < nroute; i++)
+    {
+        mkaddr(&addr, (i << 8) | 0x42);
+        rtptr = rtLookup(&addr);
+        mkaddr(&dst, i << 8);
+        if ((NULL == rtptr) || !netaddrequal(&rtptr->dst, &dst))
+        {
+            break;
+        }
+    }
+    failif(i != nroute, "");
+
+    for (i = 0; i < nroute; i++)
+    {
+        mkaddr(&dst, i << 8);
+        rtRemove(&dst);
+    }
+    mkaddr(&addr, 0x0142);
+    rtptr = rtLookup(&addr);
+    failif((NULL != rtptr) && (24 == rtptr->masklen), "Stale route");
+
+    if (TRUE == passed)
+    {
+        testPass(TRUE, "");
+    }
+    else
+    {
+        testFail(TRUE, "");
+    }
+
+    return OK;
+}
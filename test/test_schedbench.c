@@ -0,0 +1,104 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <clock.h>
+#include <platform.h>
+#include <thread.h>
+#include <testsuite.h>
+
+#define SWITCHES 200            /* yields per thread per run          */
+#define MAXLOAD  64             /* largest number of ready threads    */
+
+static void bench(int times, int *done)
+{
+    int i;
+
+    for (i = 0; i < times; i++)
+    {
+        yield();
+    }
+    (*done)++;
+}
+
+/**
+ * Time one run of nthr equal-priority threads yielding to each other.
+ * @return native clock cycles the run took, or 0 on failure
+ */
+static unsigned long benchrun(int nthr, int prio)
+{
+    tid_typ tids[MAXLOAD];
+    unsigned long start;
+    irqmask im;
+    int done = 0;
+    int i;
+
+    im = disable();
+    for (i = 0; i < nthr; i++)
+    {
+        /* Keep the run on our core so the yields really contend */
+        tids[i] = createon(getcpuid(), (void *)bench, INITSTK, prio,
+                           "SCHEDBENCH", 2, SWITCHES, &done);
+        if (SYSERR == tids[i])
+        {
+            while (--i >= 0)
+            {
+                kill(tids[i]);
+            }
+            restore(im);
+            return 0;
+        }
+    }
+    for (i = 0; i < nthr; i++)
+    {
+        ready(tids[i]);
+    }
+
+    /* The benchmark threads all outrank us, so we only return here   */
+    /* once every one of them has finished yielding.                  */
+    start = clkcount();
+    yield();
+    start = clkcount() - start;
+    restore(im);
+
+    return (done == nthr) ? start : 0;
+}
+
+thread test_schedbench(bool verbose)
+{
+    static const int loads[] = { 1, 4, 16, 64 };
+    char str[80];
+    unsigned long cycles;
+    unsigned long long nsec;
+    bool passed = TRUE;
+    int prio;
+    int i;
+
+    prio = getprio(gettid()) + 1;
+    testPrint(verbose, "Switch latency against ready threads:\n");
+    for (i = 0; i < ARRAY_LEN(loads); i++)
+    {
+        cycles = benchrun(loads[i], prio);
+        if (0 == cycles)
+        {
+            passed = FALSE;
+            sprintf(str, "Could not run %d threads", loads[i]);
+            testFail(verbose, str);
+            continue;
+        }
+        nsec = (unsigned long long)cycles * 1000000000ULL /
+            platform.clkfreq / ((unsigned long long)loads[i] * SWITCHES);
+        sprintf(str, "%3d threads: %6u ns per switch\n", loads[i],
+                (unsigned int)nsec);
+        testPrint(verbose, str);
+    }
+
+    if (TRUE == passed)
+    {
+        testPass(TRUE, "");
+    }
+    else
+    {
+        testFail(TRUE, "");
+    }
+
+    return OK;
+}
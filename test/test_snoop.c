@@ -21,6 +21,8 @@
 #define NNETIF (-1)
 #endif
 
+#define SNOOP_TEST_INSNS 16
+
 extern int _binary_data_testsnoop_pcap_start;
 
 static unsigned int filterTest(struct snoop *cap, struct packet *pktA)
@@ -45,7 +47,7 @@ static unsigned int filterTest(struct snoop *cap, struct packet *pktA)
         pktA->len = phdr.caplen;
         pktA->curr = pktA->data;
         memcpy(pktA->data, data, phdr.caplen);
-        if (TRUE == snoopFilter(cap, pktA))
+        if (0 != snoopFilter(cap, pktA))
         {
             nmatch++;
         }
@@ -73,7 +75,9 @@ thread test_snoop(bool verbose)
     struct pcap_file_header pcap;
     struct pcap_pkthdr phdr;
     struct packet *pktA;
-    struct packet *pktB;
+    struct snoopRec *rec;
+    struct bpf_insn arp[SNOOP_TEST_INSNS];
+    struct bpf_insn ip[SNOOP_TEST_INSNS];
     unsigned char *data;
     int i;
 
@@ -118,8 +122,19 @@ thread test_snoop(bool verbose)
     testPrint(verbose, "Filter type");
     bzero(&cap, sizeof(struct snoop));
     cap.caplen = USHRT_MAX;
-    cap.type = SNOOP_FILTER_ARP;
-    failif((7 != filterTest(&cap, pktA)), "");
+    cap.filter.bf_len = bpfCompile("arp", ETH_HDR_LEN, USHRT_MAX, arp,
+                                   SNOOP_TEST_INSNS);
+    cap.filter.bf_insns = arp;
+    failif(((SYSERR == (int)cap.filter.bf_len)
+            || (7 != filterTest(&cap, pktA))), "");
+
+    testPrint(verbose, "Filter snaplen");
+    cap.filter.bf_len = bpfCompile("arp", ETH_HDR_LEN, ETH_HDR_LEN, ip,
+                                   SNOOP_TEST_INSNS);
+    cap.filter.bf_insns = ip;
+    failif(((SYSERR == (int)cap.filter.bf_len)
+            || (7 != filterTest(&cap, pktA))
+            || (ETH_HDR_LEN != snoopFilter(&cap, pktA))), "");
 
     /* Test open */
     testPrint(verbose, "Open capture (bad params)");
@@ -187,6 +202,16 @@ thread test_snoop(bool verbose)
         }
         failif((i < NNETIF), "Not removed from all");
     }
+
+    testPrint(verbose, "Open capture (bad filter)");
+    bzero(&cap, sizeof(struct snoop));
+    ip[0].code = BPF_LD | BPF_W | BPF_MEM;
+    ip[0].k = BPF_MEMWORDS;
+    ip[1].code = BPF_RET | BPF_A;
+    cap.filter.bf_len = 2;
+    cap.filter.bf_insns = ip;
+    failif((SYSERR != snoopOpen(&cap, "ELOOP")), "");
+
     testPrint(verbose, "Open capture on ELOOP");
     bzero(&cap, sizeof(struct snoop));
     netptr = NULL;
@@ -228,12 +253,14 @@ thread test_snoop(bool verbose)
     pktA->nif = netptr;
     pktA->curr = pktA->data;
     cap.caplen = USHRT_MAX;
-    cap.type = SNOOP_FILTER_IPv4;
+    cap.filter.bf_len = bpfCompile("ip", ETH_HDR_LEN, USHRT_MAX, ip,
+                                   SNOOP_TEST_INSNS);
+    cap.filter.bf_insns = ip;
     failif(((SYSERR == snoopCapture(&cap, pktA))
-            || (0 != cap.nmatch) || (mailboxCount(cap.queue) > 0)), "");
+            || (0 != cap.nmatch) || (semcount(cap.nready) > 0)), "");
 
     testPrint(verbose, "Capture match");
-    cap.type = SNOOP_FILTER_ALL;
+    cap.filter.bf_insns = NULL;
     if (SYSERR == snoopCapture(&cap, pktA))
     {
         failif(TRUE, "Returned SYSERR");
@@ -242,36 +269,58 @@ thread test_snoop(bool verbose)
     {
         failif(TRUE, "Packet did not match");
     }
-    else if (mailboxCount(cap.queue) != 1)
+    else if (semcount(cap.nready) != 1)
     {
         failif(TRUE, "Packet not enqueued");
     }
     else
     {
-        pktB = (struct packet *)mailboxReceive(cap.queue);
-        failif((0 !=
-                memcmp(pktB->data, pktA->data, phdr.caplen)),
+        rec = snoopRead(&cap);
+        failif(((phdr.caplen != rec->hdr.caplen)
+                || (phdr.caplen != rec->hdr.len)
+                || (0 != memcmp(rec->data, pktA->data, phdr.caplen))),
                "Dequeued packet doesn't match");
+        snoopDone(&cap, rec);
+    }
+
+    testPrint(verbose, "Capture snaplen");
+    cap.caplen = ETH_HDR_LEN;
+    if (SYSERR == snoopCapture(&cap, pktA))
+    {
+        failif(TRUE, "Returned SYSERR");
+    }
+    else
+    {
+        rec = snoopRead(&cap);
+        failif(((ETH_HDR_LEN != rec->hdr.caplen)
+                || (phdr.caplen != rec->hdr.len)
+                || (0 != memcmp(rec->data, pktA->data, ETH_HDR_LEN))),
+               "Record not cut to snaplen");
+        snoopDone(&cap, rec);
     }
 
     testPrint(verbose, "Capture overrun");
-    cap.type = SNOOP_FILTER_ALL;
-    for (i = 0; i < SNOOP_QLEN; i++)
+    cap.caplen = USHRT_MAX;
+    for (i = 0; i < cap.ringlen; i++)
     {
         if (SYSERR == snoopCapture(&cap, pktA))
         {
             break;
         }
     }
-    if (i < SNOOP_QLEN)
-    {
-        failif(TRUE, "Returned SYSERR");
-    }
-    else
+    failif(((0 == i) || (i >= cap.ringlen) || (1 != cap.novrn)
+            || (i != semcount(cap.nready))), "Packet did not overrun");
+
+    testPrint(verbose, "Capture ring wraps");
+    for (; i > 0; i--)
     {
-        failif(((SYSERR != snoopCapture(&cap, pktA)) || (1 != cap.novrn)),
-               "Packet did not overrun");
+        snoopDone(&cap, snoopRead(&cap));
+        if (SYSERR == snoopCapture(&cap, pktA))
+        {
+            break;
+        }
     }
+    failif(((0 != i) || (1 != cap.novrn)), "");
 
     testPrint(verbose, "Close capture");
     failif((SYSERR == snoopClose(&cap)), "Returned SYSERR");
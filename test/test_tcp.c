@@ -0,0 +1,317 @@
+/**
+ * @file test_tcp.c
+ */
+/* Embedded Xinu, Copyright (C) 2018.  All rights reserved. */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ipv4.h>
+#include <network.h>
+#include <semaphore.h>
+#include <tcp.h>
+#include <testsuite.h>
+
+#if NTCP
+#define TEST_RCVNXT 1000        /* first sequence number expected      */
+#define TEST_MSS    1000        /* sender MSS for congestion tests     */
+#define TEST_WND    8000        /* peer window for congestion tests    */
+
+/* Control block and input buffer under test, too large for a test
+ * thread's stack */
+static struct tcb tcbtest;
+static unsigned char tcbtestin[TCP_IBLEN];
+static unsigned char tcbtestout[TCP_MIN_BUFLEN];
+
+/**
+ * Hand tcpRecvData() a segment of len octets, each the low byte of its
+ * own sequence number.
+ * @return FALSE if no buffer could be had for the segment
+ */
+static bool segment(struct tcb *tcbptr, tcpseq seq, unsigned int len)
+{
+    struct packet *pkt;
+    struct tcpPkt *tcp;
+    unsigned int i;
+
+    pkt = netGetbuf();
+    if (SYSERR == (int)pkt)
+    {
+        return FALSE;
+    }
+    pkt->linkhdr = pkt->data;
+    pkt->curr = pkt->data;
+    pkt->len = TCP_HDR_LEN + len;
+    tcp = (struct tcpPkt *)pkt->curr;
+    bzero(tcp, TCP_HDR_LEN);
+    tcp->seqnum = seq;
+    tcp->acknum = tcbptr->sndnxt;
+    tcp->offset = octets2offset(TCP_HDR_LEN);
+    tcp->control = TCP_CTRL_ACK;
+    for (i = 0; i < len; i++)
+    {
+        tcp->data[i] = seq + i;
+    }
+    tcpRecvData(pkt, tcbptr);
+    netFreebuf(pkt);
+    return TRUE;
+}
+
+/**
+ * Hand tcpRecvAck() a bare acknowledgement.
+ * @return FALSE if no buffer could be had for the segment
+ */
+static bool ack(struct tcb *tcbptr, tcpseq acknum)
+{
+    struct packet *pkt;
+    struct tcpPkt *tcp;
+
+    pkt = netGetbuf();
+    if (SYSERR == (int)pkt)
+    {
+        return FALSE;
+    }
+    pkt->linkhdr = pkt->data;
+    pkt->curr = pkt->data;
+    pkt->len = TCP_HDR_LEN;
+    tcp = (struct tcpPkt *)pkt->curr;
+    bzero(tcp, TCP_HDR_LEN);
+    tcp->seqnum = tcbptr->rcvnxt;
+    tcp->acknum = acknum;
+    tcp->offset = octets2offset(TCP_HDR_LEN);
+    tcp->control = TCP_CTRL_ACK;
+    tcp->window = TEST_WND;
+    tcpRecvAck(pkt, tcbptr);
+    netFreebuf(pkt);
+    return TRUE;
+}
+#endif /* NTCP */
+
+/**
+ * Tests the TCP receive queue, delayed ACKs, SACK scoreboard, congestion
+ * control and segment coalescing on a control block that is not attached
+ * to a device.  Its segments go to an unroutable address.
+ * @return OK when testing is complete
+ */
+thread test_tcp(bool verbose)
+{
+#if NTCP
+    struct tcb *tcbptr = &tcbtest;
+    unsigned int i;
+    bool ok;
+    bool passed = TRUE;
+
+    bzero(tcbptr, sizeof(struct tcb));
+    tcbptr->state = TCP_ESTAB;
+    tcbptr->in = tcbtestin;
+    tcbptr->iblen = TCP_IBLEN;
+    tcbptr->readers = semcreate(0);
+    tcbptr->writers = semcreate(0);
+    tcbptr->mutex = semcreate(1);
+    tcbptr->out = tcbtestout;
+    tcbptr->oblen = TCP_MIN_BUFLEN;
+    tcbptr->rxttime = TCP_RXT_MAXTIME;
+    tcbptr->rcvnxt = TEST_RCVNXT;
+    tcbptr->rcvwnd = TEST_RCVNXT + tcbptr->iblen;
+    tcbptr->rcvmss = TCP_INIT_MSS - TCP_HDR_LEN;
+    tcbptr->rcvflg = TCP_FLG_SACK;
+    tcbptr->sndmss = TCP_INIT_MSS - TCP_HDR_LEN;
+    tcbptr->localip.type = NETADDR_IPv4;
+    tcbptr->localip.len = IPv4_ADDR_LEN;
+    tcbptr->remoteip.type = NETADDR_IPv4;
+    tcbptr->remoteip.len = IPv4_ADDR_LEN;
+    tcbptr->remoteip.addr[0] = 198;         /* TEST-NET-2 */
+    tcbptr->remoteip.addr[1] = 51;
+    tcbptr->remoteip.addr[2] = 100;
+    tcbptr->remoteip.addr[3] = 1;
+    if ((SYSERR == (int)tcbptr->readers)
+        || (SYSERR == (int)tcbptr->writers)
+        || (SYSERR == (int)tcbptr->mutex))
+    {
+        testFail(TRUE, "No semaphore");
+        return OK;
+    }
+
+    testPrint(verbose, "Hold out-of-order data");
+    ok = segment(tcbptr, TEST_RCVNXT + 100, 100);
+    ok = ok && segment(tcbptr, TEST_RCVNXT + 300, 100);
+    failif(!ok || (TEST_RCVNXT != tcbptr->rcvnxt) || (0 != tcbptr->icount)
+           || (2 != tcbptr->rcvnooo)
+           || (TEST_RCVNXT + 300 != tcbptr->rcvooo[0].start)
+           || (TEST_RCVNXT + 100 != tcbptr->rcvooo[1].start), "");
+
+    testPrint(verbose, "Fill first hole");
+    ok = segment(tcbptr, TEST_RCVNXT, 100);
+    failif(!ok || (TEST_RCVNXT + 200 != tcbptr->rcvnxt)
+           || (200 != tcbptr->icount) || (1 != tcbptr->rcvnooo), "");
+
+    testPrint(verbose, "Fill last hole");
+    ok = segment(tcbptr, TEST_RCVNXT + 200, 100);
+    for (i = 0; i < 400; i++)
+    {
+        if (tcbptr->in[i] != (unsigned char)(TEST_RCVNXT + i))
+        {
+            break;
+        }
+    }
+    failif(!ok || (TEST_RCVNXT + 400 != tcbptr->rcvnxt)
+           || (400 != tcbptr->icount) || (0 != tcbptr->rcvnooo)
+           || (400 != i), "");
+
+    testPrint(verbose, "Scaled window advertisement");
+    tcbptr->rcvscale = 7;
+    tcbptr->rcvwnd = tcbptr->rcvnxt;
+    i = tcpSendWindow(tcbptr);
+    failif((((TCP_IBLEN - 400) & ~0x7F) != i)
+           || (tcpSeqdiff(tcbptr->rcvwnd, tcbptr->rcvnxt) != i), "");
+
+    testPrint(verbose, "Delay ACK of lone segment");
+    ok = segment(tcbptr, TEST_RCVNXT + 400, 100);
+    ok = ok && (1 == tcbptr->rcvnack)
+        && (tcpTimerRemain(tcbptr, TCP_EVT_DELACK) > 0);
+    ok = ok && segment(tcbptr, TEST_RCVNXT + 500, 100);
+    failif(!ok || (0 != tcbptr->rcvnack)
+           || (tcpTimerRemain(tcbptr, TCP_EVT_DELACK) > 0), "");
+
+    testPrint(verbose, "Forget oldest range when full");
+    for (i = 0, ok = TRUE; ok && (i <= TCP_NRANGE); i++)
+    {
+        ok = segment(tcbptr, TEST_RCVNXT + 700 + 200 * i, 100);
+    }
+    ok = ok && (TCP_NRANGE == tcbptr->rcvnooo)
+        && (TEST_RCVNXT + 700 + 200 * TCP_NRANGE ==
+            tcbptr->rcvooo[0].start);
+    for (i = 0; ok && (i < tcbptr->rcvnooo); i++)
+    {
+        ok = (TEST_RCVNXT + 700 != tcbptr->rcvooo[i].start);
+    }
+    ok = ok && segment(tcbptr, TEST_RCVNXT + 600, 100);
+    failif(!ok || (TEST_RCVNXT + 700 != tcbptr->rcvnxt)
+           || (TCP_NRANGE != tcbptr->rcvnooo), "");
+
+    testPrint(verbose, "Refill forgotten range");
+    ok = segment(tcbptr, TEST_RCVNXT + 700, 200);
+    failif(!ok || (TEST_RCVNXT + 1000 != tcbptr->rcvnxt)
+           || (TCP_NRANGE - 1 != tcbptr->rcvnooo), "");
+
+    testPrint(verbose, "Merge SACK blocks");
+    tcbptr->snduna = 5000;
+    tcbptr->sndnxt = 9000;
+    tcpRecvSack(tcbptr, 6000, 7000);
+    tcpRecvSack(tcbptr, 8000, 8500);
+    tcpRecvSack(tcbptr, 7000, 8000);
+    failif((1 != tcbptr->sndnsack) || (6000 != tcbptr->sndsack[0].start)
+           || (8500 != tcbptr->sndsack[0].end), "");
+
+    testPrint(verbose, "Clip SACK blocks to window");
+    tcpRecvSack(tcbptr, 9000, 9500);
+    tcpRecvSack(tcbptr, 4000, 5500);
+    failif((2 != tcbptr->sndnsack) || (5000 != tcbptr->sndsack[0].start)
+           || (5500 != tcbptr->sndsack[0].end)
+           || (6000 != tcbptr->sndsack[1].start), "");
+
+    testPrint(verbose, "NewReno slow start and loss");
+    tcbptr->sndmss = TEST_MSS;
+    tcbptr->sndnsack = 0;
+    tcpnewreno.init(tcbptr);
+    ok = (4 * TEST_MSS == tcbptr->sndcwn);
+    tcpnewreno.ack(tcbptr, TEST_MSS);
+    ok = ok && (5 * TEST_MSS == tcbptr->sndcwn);
+    tcpnewreno.loss(tcbptr);
+    failif(!ok || (2 * TEST_MSS != tcbptr->sndsst)
+           || (tcbptr->sndsst != tcbptr->sndcwn), "");
+
+    testPrint(verbose, "CUBIC loss and regrowth");
+    tcpcubic.init(tcbptr);
+    tcbptr->sndcwn = 20 * TEST_MSS;
+    tcpcubic.loss(tcbptr);
+    ok = (20 * TEST_MSS == tcbptr->ccwmax)
+        && (14 * TEST_MSS == tcbptr->sndcwn);
+    tcpcubic.ack(tcbptr, TEST_MSS);
+    ok = ok && (0 != tcbptr->ccepoch) && (tcbptr->sndcwn > 14 * TEST_MSS)
+        && (tcbptr->sndcwn < 20 * TEST_MSS);
+    tcpcubic.loss(tcbptr);
+    failif(!ok || (tcbptr->ccwmax >= 20 * TEST_MSS)
+           || (tcbptr->sndsst != tcbptr->sndcwn), "");
+
+    testPrint(verbose, "Fast retransmit on third duplicate ACK");
+    tcbptr->sndcc = TCP_CC_NEWRENO;
+    tcpnewreno.init(tcbptr);
+    tcbptr->snduna = 5000;
+    tcbptr->sndnxt = 9000;
+    tcbptr->sndrecover = 4000;
+    tcbptr->sndwnd = TEST_WND;
+    tcbptr->sndwl1 = tcbptr->rcvnxt;
+    tcbptr->sndwl2 = tcbptr->snduna;
+    tcbptr->ostart = 0;
+    tcbptr->ocount = 4000;
+    ok = ack(tcbptr, 5000) && ack(tcbptr, 5000);
+    ok = ok && (4 * TEST_MSS == tcbptr->sndcwn);
+    ok = ok && ack(tcbptr, 5000);
+    failif(!ok || (TCP_DUPACK_THRESH != tcbptr->sndndup)
+           || (9000 != tcbptr->sndrecover)
+           || (5 * TEST_MSS != tcbptr->sndcwn), "");
+
+    testPrint(verbose, "Recover across partial ACK");
+    ok = ack(tcbptr, 6000);
+    ok = ok && (TCP_DUPACK_THRESH == tcbptr->sndndup)
+        && (5 * TEST_MSS == tcbptr->sndcwn);
+    ok = ok && ack(tcbptr, 9000);
+    failif(!ok || (0 != tcbptr->sndndup)
+           || (2 * TEST_MSS != tcbptr->sndcwn), "");
+
+    testPrint(verbose, "Nagle holds small segment");
+    tcbptr->rxttime = TCP_RXT_MAXTIME;
+    tcbptr->ocount = 100;
+    ok = (100 == tcpSendData(tcbptr));
+    tcbptr->ocount = 200;
+    failif(!ok || (0 != tcpSendData(tcbptr)) || (9100 != tcbptr->sndnxt),
+           "");
+
+    testPrint(verbose, "No delay sends small segment");
+    tcbptr->sndmode = TCP_MODE_NODELAY;
+    failif((100 != tcpSendData(tcbptr)) || (9200 != tcbptr->sndnxt), "");
+
+    testPrint(verbose, "Cork holds all but full segments");
+    tcbptr->sndmode = TCP_MODE_CORK;
+    tcbptr->ocount = 250;
+    ok = (0 == tcpSendData(tcbptr)) && (9200 == tcbptr->sndnxt);
+    tcbptr->ocount = 200 + TEST_MSS;
+    failif(!ok || (TEST_MSS != tcpSendData(tcbptr))
+           || (9200 + TEST_MSS != tcbptr->sndnxt), "");
+
+    testPrint(verbose, "Distrust SACK at cumulative ACK");
+    tcbptr->sndnsack = 1;
+    tcbptr->sndsack[0].start = tcbptr->snduna;
+    tcbptr->sndsack[0].end = seqadd(tcbptr->snduna, 500);
+    failif((TEST_MSS != tcpSendLost(tcbptr)) || (0 != tcbptr->sndnsack),
+           "");
+
+    testPrint(verbose, "Forget SACK blocks on timeout");
+    tcbptr->sndnsack = 1;
+    tcbptr->sndsack[0].start = seqadd(tcbptr->snduna, 500);
+    tcbptr->sndsack[0].end = seqadd(tcbptr->snduna, 700);
+    tcbptr->sndndup = TCP_DUPACK_THRESH;
+    failif((TEST_MSS != tcpSendRxt(tcbptr)) || (0 != tcbptr->sndnsack)
+           || (0 != tcbptr->sndndup)
+           || (tcbptr->sndnxt != tcbptr->sndrecover), "");
+
+    tcpTimerPurge(tcbptr, NULL);
+    semfree(tcbptr->readers);
+    semfree(tcbptr->writers);
+    semfree(tcbptr->mutex);
+
+    if (TRUE == passed)
+    {
+        testPass(TRUE, "");
+    }
+    else
+    {
+        testFail(TRUE, "");
+    }
+#else /* NTCP */
+    testSkip(TRUE, "");
+#endif /* NTCP == 0 */
+    return OK;
+}
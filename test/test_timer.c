@@ -0,0 +1,68 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <thread.h>
+#include <timer.h>
+#include <testsuite.h>
+
+#define NFIRED 4
+
+static int fired[NFIRED];       /* ids of timers, in firing order */
+static int nfired;
+
+static void record(void *arg)
+{
+    if (nfired < NFIRED)
+    {
+        fired[nfired] = (int)arg;
+    }
+    nfired++;
+}
+
+/**
+ * Tests the kernel timer service, including timers far enough out to be
+ * cascaded down the wheel.
+ * @return OK when testing is complete
+ */
+thread test_timer(bool verbose)
+{
+    struct timer a, b, c;
+    int elapsed;
+    bool passed = TRUE;
+
+    nfired = 0;
+    timerSetup(&a, record, (void *)1);
+    timerSetup(&b, record, (void *)2);
+    timerSetup(&c, record, (void *)3);
+
+    testPrint(verbose, "Schedule and reschedule");
+    timerSched(&a, 500);
+    timerSched(&b, 900);
+    timerSched(&c, 20);
+    timerSched(&a, 30);
+    failif(!timerPending(&a) || !timerPending(&b)
+           || (timerRemain(&a) > 30) || (timerRemain(&b) < 800), "");
+
+    testPrint(verbose, "Cancel");
+    elapsed = timerCancel(&c);
+    failif((SYSERR == elapsed) || timerPending(&c)
+           || (SYSERR != timerCancel(&c)), "");
+
+    testPrint(verbose, "Fire in order");
+    sleep(1200);
+    failif((2 != nfired) || (1 != fired[0]) || (2 != fired[1])
+           || timerPending(&a) || timerPending(&b), "");
+
+    timerCancel(&a);
+    timerCancel(&b);
+
+    if (TRUE == passed)
+    {
+        testPass(TRUE, "");
+    }
+    else
+    {
+        testFail(TRUE, "");
+    }
+
+    return OK;
+}
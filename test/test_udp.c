@@ -437,6 +437,11 @@ thread test_udp(bool verbose)
     close(UDP0);
     close(UDP1);
 
+    /* Closed sockets must leave the demux hash */
+    testPrint(verbose, "UDP Demux after close");
+    failif((NULL != udpDemux(pta, ptb, &ipl, &ipc))
+           || (NULL != udpDemux(ptb, pta, &ipl, &ipc)), "");
+
     /* Print out the overall test's status (pass or fail) */
     if (passed)
     {
@@ -7,6 +7,7 @@ struct testcase testtab[] = {
     {"Argument Passing", test_bigargs},
     {"Priority Scheduling", test_schedule},
     {"Thread Preemption", test_preempt},
+    {"Scheduler Latency", test_schedbench},
     {"Recursion", test_recursion},
     {"Single Semaphore", test_semaphore},
     {"Multiple Semaphores", test_semaphore2},
@@ -14,6 +15,7 @@ struct testcase testtab[] = {
     {"Killing Semaphores", test_semaphore4},
     {"Process Queues", test_procQueue},
     {"Delta Queues", test_deltaQueue},
+    {"Timers", test_timer},
     {"Standard Input/Output", test_libStdio},
     {"TTY Driver", test_ttydriver},
     {"Character Types", test_libCtype},
@@ -29,10 +31,15 @@ struct testcase testtab[] = {
     {"Ethernet Driver", test_ether},
     {"Ethernet Loopback Driver", test_ethloop},
     {"Network Addresses", test_netaddr},
+    {"Internet Checksum", test_chksum},
+    {"Routing", test_route},
     {"Network Interface", test_netif},
     {"ARP", test_arp},
+    {"Packet Filter", test_bpf},
     {"Snoop", test_snoop},
+    {"Network Emulator", test_netemu},
     {"UDP Sockets", test_udp},
+    {"TCP", test_tcp},
     {"Raw Sockets", test_raw},
     {"IP", test_ip},
     {"User Memory", test_umemory},